@@ -554,9 +554,11 @@ extern "C" JNIEXPORT void JNICALL Java_com_google_android_filament_Engine_nSetBu
         jlong jobSystemThreadCount, jboolean disableParallelShaderCompile,
         jint stereoscopicType, jlong stereoscopicEyeCount,
         jlong resourceAllocatorCacheSizeMB, jlong resourceAllocatorCacheMaxAge,
+        jlong resourceAllocatorCacheBudgetMB,
         jboolean disableHandleUseAfterFreeCheck,
         jint preferredShaderLanguage,
-        jboolean forceGLES2Context, jboolean assertNativeWindowIsValid) {
+        jboolean forceGLES2Context, jboolean assertNativeWindowIsValid,
+        jlong parallelCullingThreshold) {
     Engine::Builder* builder = (Engine::Builder*) nativeBuilder;
     Engine::Config config = {
             .commandBufferSizeMB = (uint32_t) commandBufferSizeMB,
@@ -570,10 +572,12 @@ extern "C" JNIEXPORT void JNICALL Java_com_google_android_filament_Engine_nSetBu
             .stereoscopicEyeCount = (uint8_t) stereoscopicEyeCount,
             .resourceAllocatorCacheSizeMB = (uint32_t) resourceAllocatorCacheSizeMB,
             .resourceAllocatorCacheMaxAge = (uint8_t) resourceAllocatorCacheMaxAge,
+            .resourceAllocatorCacheBudgetMB = (uint32_t) resourceAllocatorCacheBudgetMB,
             .disableHandleUseAfterFreeCheck = (bool) disableHandleUseAfterFreeCheck,
             .preferredShaderLanguage = (Engine::Config::ShaderLanguage) preferredShaderLanguage,
             .forceGLES2Context = (bool) forceGLES2Context,
             .assertNativeWindowIsValid = (bool) assertNativeWindowIsValid,
+            .parallelCullingThreshold = (uint32_t) parallelCullingThreshold,
     };
     builder->config(&config);
 }
@@ -596,6 +600,14 @@ extern "C" JNIEXPORT void JNICALL Java_com_google_android_filament_Engine_nSetBu
     builder->paused((bool) paused);
 }
 
+extern "C" JNIEXPORT void JNICALL Java_com_google_android_filament_Engine_nSetBuilderProgramCache(
+        JNIEnv* env, jclass, jlong nativeBuilder, jstring directory_, jlong maxSize) {
+    Engine::Builder* builder = (Engine::Builder*) nativeBuilder;
+    const char* directory = env->GetStringUTFChars(directory_, 0);
+    builder->programCache(directory, (size_t) maxSize);
+    env->ReleaseStringUTFChars(directory_, directory);
+}
+
 extern "C"
 JNIEXPORT void JNICALL
 Java_com_google_android_filament_Engine_nSetBuilderFeature(JNIEnv *env, jclass clazz,
@@ -227,9 +227,11 @@ public class Engine {
                     config.jobSystemThreadCount, config.disableParallelShaderCompile,
                     config.stereoscopicType.ordinal(), config.stereoscopicEyeCount,
                     config.resourceAllocatorCacheSizeMB, config.resourceAllocatorCacheMaxAge,
+                    config.resourceAllocatorCacheBudgetMB,
                     config.disableHandleUseAfterFreeCheck,
                     config.preferredShaderLanguage.ordinal(),
-                    config.forceGLES2Context, config.assertNativeWindowIsValid);
+                    config.forceGLES2Context, config.assertNativeWindowIsValid,
+                    config.parallelCullingThreshold);
             return this;
         }
 
@@ -258,6 +260,37 @@ public class Engine {
             return this;
         }
 
+        /**
+         * Enables a persistent cache of compiled programs, stored in the given directory.
+         *
+         * <p>The cache is used by the backends that can retrieve program binaries (e.g. OpenGL).
+         * It also records which variants of which materials were used, so that they can be
+         * compiled in the background as soon as the materials are created in later runs, rather
+         * than when they are first drawn. This state is saved while rendering as it changes, so
+         * it survives the process being killed.</p>
+         *
+         * @param directory Directory where the cache is stored, it is created if needed, e.g. a
+         *                  subdirectory of {@code Context.getCacheDir()}.
+         * @param maxSize   Maximum size in bytes of the cache on disk. The least recently used
+         *                  programs are evicted first.
+         * @return A reference to this Builder for chaining calls.
+         */
+        public Builder programCache(@NonNull String directory, long maxSize) {
+            nSetBuilderProgramCache(mNativeBuilder, directory, maxSize);
+            return this;
+        }
+
+        /**
+         * Enables a persistent cache of compiled programs of up to 64 MiB.
+         *
+         * @param directory Directory where the cache is stored, it is created if needed.
+         * @return A reference to this Builder for chaining calls.
+         * @see #programCache(String, long)
+         */
+        public Builder programCache(@NonNull String directory) {
+            return programCache(directory, 64L * 1024L * 1024L);
+        }
+
         /**
          * Set a feature flag value. This is the only way to set constant feature flags.
          * @param name feature name
@@ -443,6 +476,15 @@ public class Engine {
          */
         public long resourceAllocatorCacheMaxAge = 1;
 
+        /**
+         * Maximum size in MiB of the textures kept in the render target cache of each Renderer,
+         * i.e. textures not used by the current frame. When the cache exceeds this budget at the
+         * end of a frame, the textures with the most size times age are evicted first.
+         * A value of 0 disables the budget.
+         * The default is 0.
+         */
+        public long resourceAllocatorCacheBudgetMB = 0;
+
         /**
          * Disable backend handles use-after-free checks.
          * @Deprecated use "backend.disable_handle_use_after_free_check" feature flag instead
@@ -485,6 +527,15 @@ public class Engine {
          * @Deprecated use "backend.opengl.assert_native_window_is_valid" feature flag instead
          */
         public boolean assertNativeWindowIsValid = false;
+
+        /**
+         * Minimum number of renderables in a scene for frustum culling to be split across the
+         * Engine's JobSystem.
+         *
+         * Below this count, culling runs on the calling thread because the overhead of the
+         * JobSystem dominates the cost of culling itself. A value of 0 always culls in parallel.
+         */
+        public long parallelCullingThreshold = 32768;
     }
 
     private Engine(long nativeEngine, Config config) {
@@ -1465,12 +1516,15 @@ public class Engine {
             long minCommandBufferSizeMB, long perFrameCommandsSizeMB, long jobSystemThreadCount,
             boolean disableParallelShaderCompile, int stereoscopicType, long stereoscopicEyeCount,
             long resourceAllocatorCacheSizeMB, long resourceAllocatorCacheMaxAge,
+            long resourceAllocatorCacheBudgetMB,
             boolean disableHandleUseAfterFreeCheck,
             int preferredShaderLanguage,
-            boolean forceGLES2Context, boolean assertNativeWindowIsValid);
+            boolean forceGLES2Context, boolean assertNativeWindowIsValid,
+            long parallelCullingThreshold);
     private static native void nSetBuilderFeatureLevel(long nativeBuilder, int ordinal);
     private static native void nSetBuilderSharedContext(long nativeBuilder, long sharedContext);
     private static native void nSetBuilderPaused(long nativeBuilder, boolean paused);
+    private static native void nSetBuilderProgramCache(long nativeBuilder, String directory, long maxSize);
     private static native void nSetBuilderFeature(long nativeBuilder, String name, boolean value);
     private static native long nBuilderBuild(long nativeBuilder);
 }
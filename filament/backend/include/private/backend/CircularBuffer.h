@@ -32,6 +32,11 @@ public:
     //      to set it to 3*requiredSize to avoid blocking the render thread (usually the UI thread).
     explicit CircularBuffer(size_t bufferSize);
 
+    // Records into the `size` bytes at `data`, which must outlive this CircularBuffer. This is
+    // used for recording commands in a range of another CircularBuffer, the range never wraps
+    // around and getBuffer() can't be used.
+    CircularBuffer(void* data, size_t size) noexcept;
+
     // can't be moved or copy-constructed
     CircularBuffer(CircularBuffer const& rhs) = delete;
     CircularBuffer(CircularBuffer&& rhs) noexcept = delete;
@@ -79,6 +84,9 @@ private:
     void* mData = nullptr;
     int mAshmemFd = -1;
 
+    // false if mData is owned by someone else (constant)
+    bool mOwnsData = true;
+
     // size of the circular buffer (constant)
     size_t const mSize;
 
@@ -210,6 +210,10 @@ class CommandStream {
 public:
     CommandStream(Driver& driver, CircularBuffer& buffer) noexcept;
 
+    // Creates a secondary CommandStream, which records commands for the same Driver as
+    // `primary` into `buffer`, see reserve().
+    CommandStream(CommandStream const& primary, CircularBuffer& buffer) noexcept;
+
     CommandStream(CommandStream const& rhs) noexcept = delete;
     CommandStream& operator=(CommandStream const& rhs) noexcept = delete;
 
@@ -259,6 +263,29 @@ public:
 
     void execute(void* buffer);
 
+    /*
+     * Secondary CommandStreams allow several threads to record commands in parallel:
+     * - reserve() a range of this CommandStream for each thread, in execution order
+     * - each thread records into a secondary CommandStream backed by a CircularBuffer
+     *   constructed over its range
+     * - each secondary CommandStream is terminated with terminate(range.head), so that
+     *   execution continues with the next range.
+     * A secondary CommandStream can't record more than size - getTerminatorSize() bytes, and
+     * all recording must be finished before this CommandStream is flushed.
+     */
+    CircularBuffer::Range reserve(size_t size) noexcept {
+        void* const p = allocateCommand(CommandBase::align(size));
+        return { p, static_cast<char*>(p) + CommandBase::align(size) };
+    }
+
+    void terminate(void* next) noexcept {
+        new(allocateCommand(getTerminatorSize())) NoopCommand(next);
+    }
+
+    static constexpr size_t getTerminatorSize() noexcept {
+        return CommandBase::align(sizeof(NoopCommand));
+    }
+
     /*
      * queueCommand() allows to queue a lambda function as a command.
      * This is much less efficient than using the Driver* API.
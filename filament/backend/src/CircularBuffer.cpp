@@ -51,8 +51,18 @@ CircularBuffer::CircularBuffer(size_t size)
     mHead = mData;
 }
 
+CircularBuffer::CircularBuffer(void* data, size_t size) noexcept
+    : mData(data),
+      mOwnsData(false),
+      mSize(size) {
+    mTail = mData;
+    mHead = mData;
+}
+
 CircularBuffer::~CircularBuffer() noexcept {
-    dealloc();
+    if (mOwnsData) {
+        dealloc();
+    }
 }
 
 // If the system support mmap(), use it for creating a "hard circular buffer" where two virtual
@@ -158,6 +168,7 @@ void CircularBuffer::dealloc() noexcept {
 
 
 CircularBuffer::Range CircularBuffer::getBuffer() noexcept {
+    assert_invariant(mOwnsData);
     Range const range{ .tail = mTail, .head = mHead };
 
     char* const pData = static_cast<char*>(mData);
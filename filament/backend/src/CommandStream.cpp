@@ -78,6 +78,17 @@ CommandStream::CommandStream(Driver& driver, CircularBuffer& buffer) noexcept
 #endif
 }
 
+CommandStream::CommandStream(CommandStream const& primary, CircularBuffer& buffer) noexcept
+        : mDriver(primary.mDriver),
+          mCurrentBuffer(buffer),
+          mDispatcher(primary.mDispatcher)
+#ifndef NDEBUG
+          , mThreadId(ThreadUtils::getThreadId())
+#endif
+          , mUsePerformanceCounter(primary.mUsePerformanceCounter)
+{
+}
+
 void CommandStream::execute(void* buffer) {
     // NOTE: we can't use SYSTRACE_CALL() or similar here because, execute() below, also
     // uses systrace BEGIN/END and the END is not guaranteed to be happening in this scope.
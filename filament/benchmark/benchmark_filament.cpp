@@ -22,9 +22,18 @@
 #include <filament/Box.h>
 #include <filament/Frustum.h>
 #include "Culler.h"
+#include "RenderableBvh.h"
+#include "RenderPass.h"
+
+#include "details/Scene.h"
+#include "details/View.h"
 
 #include <utils/Allocator.h>
+#include <utils/JobSystem.h>
 
+#include <algorithm>
+#include <limits>
+#include <numeric>
 #include <vector>
 #include <random>
 
@@ -103,3 +112,184 @@ BENCHMARK_F(FilamentCullingFixture, sphereCulling)(benchmark::State& state) {
         state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
     }
 }
+
+/*
+ * Culls a scene of state.range(0) renderables, either serially (state.range(1) == 0) or split
+ * across the JobSystem (state.range(1) == 1). Comparing both series shows where the crossover
+ * for Engine::Config::parallelCullingThreshold sits on a given device.
+ */
+static void cullRenderables(benchmark::State& state) {
+    size_t const count = size_t(state.range(0));
+    size_t const parallelThreshold = state.range(1) ? 0 : std::numeric_limits<size_t>::max();
+
+    JobSystem js;
+    js.adopt();
+
+    std::default_random_engine gen; // NOLINT
+    std::uniform_real_distribution<float> rand(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> size(0.11f, 25.0f);
+
+    Frustum const frustum{ mat4f::perspective(45.0f, 1.0f, 0.1f, 100.0f) };
+
+    FScene::RenderableSoa renderableData;
+    renderableData.setCapacity((count + 0xFu) & ~0xFu);
+    renderableData.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        float const z = std::fabs(rand(gen));
+        renderableData.elementAt<FScene::WORLD_AABB_CENTER>(i) = {
+                rand(gen, std::uniform_real_distribution<float>::param_type{ -z, z }),
+                rand(gen, std::uniform_real_distribution<float>::param_type{ -z, z }),
+                -z };
+        renderableData.elementAt<FScene::WORLD_AABB_EXTENT>(i) = { size(gen), size(gen), size(gen) };
+        renderableData.elementAt<FScene::VISIBLE_MASK>(i) = 0;
+    }
+
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            FView::cullRenderables(js, renderableData, frustum, 0, parallelThreshold, nullptr);
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * count));
+    }
+
+    js.emancipate();
+}
+
+BENCHMARK(cullRenderables)
+        ->ArgNames({ "count", "parallel" })
+        ->Apply([](benchmark::internal::Benchmark* b) {
+            for (int64_t count = 1024; count <= 262144; count *= 4) {
+                b->Args({ count, 0 });
+                b->Args({ count, 1 });
+            }
+        });
+
+/*
+ * Culls a city-like scene of state.range(0) renderables spread over a large area, of which the
+ * camera only sees a small fraction, either with a flat loop (state.range(1) == 0) or with a
+ * RenderableBvh (state.range(1) == 1).
+ */
+static void cullRenderablesHierarchical(benchmark::State& state) {
+    size_t const count = size_t(state.range(0));
+    bool const hierarchical = state.range(1) != 0;
+
+    JobSystem js;
+    js.adopt();
+
+    std::default_random_engine gen; // NOLINT
+    std::uniform_real_distribution<float> position(-2000.0f, 2000.0f);
+    std::uniform_real_distribution<float> size(0.5f, 10.0f);
+
+    Frustum const frustum{ mat4f::perspective(45.0f, 1.0f, 0.1f, 500.0f) };
+
+    std::vector<float3> centers(count);
+    std::vector<float3> extents(count);
+    for (size_t i = 0; i < count; i++) {
+        centers[i] = { position(gen), size(gen), position(gen) };
+        extents[i] = { size(gen), size(gen), size(gen) };
+    }
+
+    // store the boxes in tree order, as FScene does
+    RenderableBvh bvh;
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0u);
+    if (hierarchical) {
+        bvh.build(centers.data(), count, order.data());
+    }
+
+    FScene::RenderableSoa renderableData;
+    renderableData.setCapacity((count + 0xFu) & ~0xFu);
+    renderableData.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        renderableData.elementAt<FScene::WORLD_AABB_CENTER>(i) = centers[order[i]];
+        renderableData.elementAt<FScene::WORLD_AABB_EXTENT>(i) = extents[order[i]];
+        renderableData.elementAt<FScene::VISIBLE_MASK>(i) = 0;
+    }
+
+    if (hierarchical) {
+        bvh.refit(js, renderableData.data<FScene::WORLD_AABB_CENTER>(),
+                renderableData.data<FScene::WORLD_AABB_EXTENT>(), count);
+    }
+
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            FView::cullRenderables(js, renderableData, frustum, 0,
+                    std::numeric_limits<size_t>::max(), hierarchical ? &bvh : nullptr);
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * count));
+    }
+
+    js.emancipate();
+}
+
+BENCHMARK(cullRenderablesHierarchical)
+        ->ArgNames({ "count", "hierarchical" })
+        ->Apply([](benchmark::internal::Benchmark* b) {
+            for (int64_t count = 1024; count <= 262144; count *= 4) {
+                b->Args({ count, 0 });
+                b->Args({ count, 1 });
+            }
+        });
+
+/*
+ * Sorts a pass of state.range(0) commands, a third of which are sentinels, either with the
+ * comparison sort (state.range(1) == 0) or with the radix sort (state.range(1) == 1).
+ * Comparing both series shows where the crossover for RenderPass::RADIX_SORT_THRESHOLD sits
+ * on a given device. Each iteration includes restoring the unsorted commands.
+ */
+static void sortCommands(benchmark::State& state) {
+    size_t const count = size_t(state.range(0));
+    bool const radix = state.range(1) != 0;
+
+    JobSystem js;
+    js.adopt();
+
+    // room for the commands and the radix sort's scratch memory
+    std::vector<uint8_t> memory(count * sizeof(RenderPass::Command) * 2);
+    RenderPass::Arena arena("sortCommands", { memory.data(), memory.data() + memory.size() });
+    RenderPass::Command* const commands = arena.alloc<RenderPass::Command>(count);
+
+    std::default_random_engine gen; // NOLINT
+    std::uniform_int_distribution<uint32_t> materialId(0, 500);
+    std::uniform_int_distribution<uint32_t> zBucket(0, 1023);
+
+    // keys typical of a color pass, see RenderPass::generateCommandsImpl()
+    std::vector<RenderPass::Command> unsorted(count);
+    for (size_t i = 0; i < count; i++) {
+        RenderPass::CommandKey key = uint64_t(RenderPass::Pass::COLOR);
+        key |= uint64_t(zBucket(gen)) << RenderPass::Z_BUCKET_SHIFT;
+        key |= materialId(gen);
+        unsorted[i].key = (i % 3 == 2) ? uint64_t(RenderPass::Pass::SENTINEL) : key;
+    }
+
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            std::copy(unsorted.begin(), unsorted.end(), commands);
+            RenderPass::Command const* last = radix ?
+                    RenderPass::sortCommandsRadix(js, arena, commands, commands + count) :
+                    RenderPass::sortCommands(commands, commands + count);
+            benchmark::DoNotOptimize(last);
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * count));
+    }
+
+    js.emancipate();
+}
+
+BENCHMARK(sortCommands)
+        ->ArgNames({ "count", "radix" })
+        ->Apply([](benchmark::internal::Benchmark* b) {
+            for (int64_t count = 256; count <= 262144; count *= 4) {
+                b->Args({ count, 0 });
+                b->Args({ count, 1 });
+            }
+        })
+        ->Unit(benchmark::kMicrosecond);
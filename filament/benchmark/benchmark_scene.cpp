@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PerformanceCounters.h"
+
+#include <benchmark/benchmark.h>
+
+#include <filament/Box.h>
+#include <filament/Engine.h>
+#include <filament/IndexBuffer.h>
+#include <filament/RenderableManager.h>
+#include <filament/Scene.h>
+#include <filament/TransformManager.h>
+#include <filament/VertexBuffer.h>
+
+#include "Allocators.h"
+#include "details/Engine.h"
+#include "details/Scene.h"
+
+#include <utils/Entity.h>
+#include <utils/EntityManager.h>
+
+#include <math/mat4.h>
+#include <math/vec3.h>
+
+#include <random>
+#include <vector>
+
+using namespace filament;
+using namespace filament::math;
+using namespace utils;
+
+/*
+ * A scene of 100K renderables, of which only a few move each frame.
+ */
+class SceneFixture : public benchmark::Fixture {
+protected:
+    static constexpr size_t ENTITY_COUNT = 100'000;
+
+    Engine* engine = nullptr;
+    Scene* scene = nullptr;
+    VertexBuffer* vb = nullptr;
+    IndexBuffer* ib = nullptr;
+    std::vector<Entity> entities;
+
+public:
+    void SetUp(benchmark::State&) override {
+        engine = Engine::Builder().backend(Engine::Backend::NOOP).build();
+        scene = engine->createScene();
+
+        static float3 const positions[3] = {{ 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }};
+        static uint16_t const indices[3] = { 0, 1, 2 };
+
+        vb = VertexBuffer::Builder()
+                .vertexCount(3)
+                .bufferCount(1)
+                .attribute(VertexAttribute::POSITION, 0, VertexBuffer::AttributeType::FLOAT3)
+                .build(*engine);
+        vb->setBufferAt(*engine, 0, { positions, sizeof(positions) });
+
+        ib = IndexBuffer::Builder()
+                .indexCount(3)
+                .bufferType(IndexBuffer::IndexType::USHORT)
+                .build(*engine);
+        ib->setBuffer(*engine, { indices, sizeof(indices) });
+
+        std::default_random_engine gen; // NOLINT
+        std::uniform_real_distribution<float> rand(-1000.0f, 1000.0f);
+
+        auto& tcm = engine->getTransformManager();
+        entities.resize(ENTITY_COUNT);
+        EntityManager::get().create(entities.size(), entities.data());
+        for (Entity const e : entities) {
+            tcm.create(e, {}, mat4f::translation(float3{ rand(gen), rand(gen), rand(gen) }));
+            RenderableManager::Builder(1)
+                    .boundingBox({{ 0, 0, 0 }, { 1, 1, 1 }})
+                    .geometry(0, RenderableManager::PrimitiveType::TRIANGLES, vb, ib)
+                    .build(*engine, e);
+        }
+        scene->addEntities(entities.data(), entities.size());
+    }
+
+    void TearDown(benchmark::State&) override {
+        for (Entity const e : entities) {
+            engine->destroy(e);
+        }
+        EntityManager::get().destroy(entities.size(), entities.data());
+        entities.clear();
+        engine->destroy(vb);
+        engine->destroy(ib);
+        engine->destroy(scene);
+        Engine::destroy(&engine);
+    }
+};
+
+/*
+ * state.range(0): number of renderables moved each frame
+ * state.range(1): whether incremental updates are enabled
+ */
+BENCHMARK_DEFINE_F(SceneFixture, prepare)(benchmark::State& state) {
+    FEngine& fengine = downcast(*engine);
+    FScene& fscene = downcast(*scene);
+    auto& tcm = engine->getTransformManager();
+    size_t const changeCount = size_t(state.range(0));
+
+    scene->setIncrementalUpdateEnabled(state.range(1) != 0);
+
+    size_t frame = 0;
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            for (size_t i = 0; i < changeCount; i++) {
+                Entity const e = entities[(frame * changeCount + i) % entities.size()];
+                tcm.setTransform(tcm.getInstance(e),
+                        mat4f::translation(float3{ float(frame), 0, 0 }));
+            }
+            RootArenaScope rootArenaScope(fengine.getPerRenderPassArena());
+            fscene.prepare(fengine.getJobSystem(), rootArenaScope, mat4{}, false);
+            frame++;
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * ENTITY_COUNT));
+
+    scene->setIncrementalUpdateEnabled(false);
+}
+
+BENCHMARK_REGISTER_F(SceneFixture, prepare)
+        ->ArgNames({ "changes", "incremental" })
+        ->Args({     0, 0 })->Args({     0, 1 })
+        ->Args({    10, 0 })->Args({    10, 1 })
+        ->Args({   100, 0 })->Args({   100, 1 })
+        ->Args({  1000, 0 })->Args({  1000, 1 })
+        ->Args({ 10000, 0 })->Args({ 10000, 1 })
+        ->Unit(benchmark::kMicrosecond);
@@ -352,6 +352,17 @@ public:
          */
         uint32_t resourceAllocatorCacheMaxAge = 1;
 
+        /*
+         * Maximum size in MiB of the textures kept in the render target cache of each Renderer,
+         * i.e. textures not used by the current frame. When the cache exceeds this budget at the
+         * end of a frame, the textures with the most size times age are evicted first, which
+         * favors keeping small and recently used textures.
+         * This doesn't limit the size of the textures needed to render a frame.
+         * A value of 0 disables the budget.
+         * The default is 0.
+         */
+        uint32_t resourceAllocatorCacheBudgetMB = 0;
+
         /*
          * Disable backend handles use-after-free checks.
          * @deprecated use "backend.disable_handle_use_after_free_check" feature flag instead
@@ -394,6 +405,22 @@ public:
          * @deprecated use "backend.opengl.assert_native_window_is_valid" feature flag instead
          */
         bool assertNativeWindowIsValid = false;
+
+        /**
+         * Minimum number of renderables in a scene for frustum culling to be split across the
+         * Engine's JobSystem.
+         *
+         * Below this count, culling runs on the calling thread because the overhead of the
+         * JobSystem dominates the cost of culling itself. Above it, renderables are culled in
+         * cache-line aligned chunks, in parallel. This applies to the camera frustum as well as
+         * the directional shadow frustum.
+         *
+         * A value of 0 always culls in parallel. Use std::numeric_limits<uint32_t>::max() to
+         * never cull in parallel.
+         *
+         * The default value is 32768.
+         */
+        uint32_t parallelCullingThreshold = 32768;
     };
 
 
@@ -489,6 +516,27 @@ public:
          */
         Builder& paused(bool paused) noexcept;
 
+        /**
+         * Enables a persistent cache of compiled programs, stored in the given directory.
+         *
+         * The cache is used by the backends that can retrieve program binaries (e.g. OpenGL). It
+         * also records which variants of which materials were used, so that they can be compiled
+         * in the background as soon as the materials are created in later runs, rather than when
+         * they are first drawn. This state is saved while rendering as it changes, so it survives
+         * the process being killed.
+         *
+         * This has no effect on program binaries if the Platform already has blob functions set
+         * with Platform::setBlobFunc().
+         *
+         * @param directory Directory where the cache is stored, it is created if needed. The
+         *                  string is copied.
+         * @param maxSize   Maximum size in bytes of the cache on disk. The least recently used
+         *                  programs are evicted first.
+         * @return A reference to this Builder for chaining calls.
+         */
+        Builder& programCache(const char* UTILS_NONNULL directory,
+                size_t maxSize = 64u * 1024u * 1024u) noexcept;
+
         /**
          * Set a feature flag value. This is the only way to set constant feature flags.
          * @param name feature name
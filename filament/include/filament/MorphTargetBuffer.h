@@ -26,6 +26,7 @@
 #include <math/mathfwd.h>
 
 #include <stddef.h>
+#include <stdint.h>
 
 namespace filament {
 
@@ -34,6 +35,10 @@ namespace filament {
  *
  * Both positions and tangents are required.
  *
+ * By default, every target stores a position and a tangent for each vertex, which takes
+ * vertexCount x count entries. Targets that only affect a few vertices (e.g. facial blend shapes)
+ * should use the sparse format instead (see Builder::sparse()), which only stores the affected
+ * vertices of each target, much like glTF sparse accessors.
  */
 class UTILS_PUBLIC MorphTargetBuffer : public FilamentAPI {
     struct BuilderDetails;
@@ -63,6 +68,19 @@ public:
          */
         Builder& count(size_t count) noexcept;
 
+        /**
+         * Enables the sparse format, where only the vertices affected by each target are stored.
+         *
+         * Sparse MorphTargetBuffers are updated with setSparseTargets(), and use about
+         * (vertexCount + deltaCount) entries of GPU memory, instead of vertexCount x count.
+         *
+         * @param deltaCount Maximum number of (vertex, target) pairs the MorphTargetBuffer can
+         *                   hold, summed over all targets. 0 (the default) disables the sparse
+         *                   format.
+         * @return A reference to this Builder for chaining calls.
+         */
+        Builder& sparse(size_t deltaCount) noexcept;
+
         /**
          * Associate an optional name with this MorphTargetBuffer for debugging purposes.
          *
@@ -142,6 +160,34 @@ public:
     void setTangentsAt(Engine& engine, size_t targetIndex,
             math::short4 const* UTILS_NONNULL tangents, size_t count, size_t offset = 0);
 
+    /**
+     * Sparse morph target data, the vertices of a target that aren't listed aren't affected by it.
+     */
+    struct SparseTarget {
+        /** indices of the affected vertices, no vertex may appear more than once */
+        uint32_t const* UTILS_NULLABLE indices = nullptr;
+        /** position offset of each affected vertex */
+        math::float3 const* UTILS_NULLABLE positions = nullptr;
+        /** tangents of each affected vertex, in the same format as setTangentsAt() */
+        math::short4 const* UTILS_NULLABLE tangents = nullptr;
+        /** number of affected vertices */
+        size_t count = 0;
+    };
+
+    /**
+     * Updates all the targets of a sparse MorphTargetBuffer at once.
+     *
+     * This replaces the content of the whole MorphTargetBuffer. The total number of affected
+     * vertices across all targets must not exceed the delta count given to Builder::sparse().
+     *
+     * @param engine Reference to the filament::Engine associated with this MorphTargetBuffer.
+     * @param targets pointer to "count" SparseTarget, one per target
+     * @param count number of targets, must be equal to getCount()
+     * @see Builder::sparse
+     */
+    void setSparseTargets(Engine& engine,
+            SparseTarget const* UTILS_NONNULL targets, size_t count);
+
     /**
      * Returns the vertex count of this MorphTargetBuffer.
      * @return The number of vertices the MorphTargetBuffer holds.
@@ -154,6 +200,12 @@ public:
      */
     size_t getCount() const noexcept;
 
+    /**
+     * Returns whether this MorphTargetBuffer uses the sparse format.
+     * @return true if Builder::sparse() was called with a non-zero delta count.
+     */
+    bool isSparse() const noexcept;
+
 protected:
     // prevent heap allocation
     ~MorphTargetBuffer() = default;
@@ -323,6 +323,18 @@ public:
          */
         Builder& culling(bool enable) noexcept;
 
+        /**
+         * Designates this renderable as an occluder for the View's occlusion culling, false by
+         * default.
+         *
+         * The renderable's bounding box (see boundingBox()) is then assumed to be entirely
+         * opaque and is used to hide the renderables behind it. This is typically used for walls,
+         * floors or buildings whose geometry fills their bounding box.
+         *
+         * @see View::setOcclusionCullingEnabled()
+         */
+        Builder& occluder(bool enable) noexcept;
+
         /**
          * Enables or disables a light channel. Light channel 0 is enabled by default.
          *
@@ -643,6 +655,20 @@ public:
      */
     void setCulling(Instance instance, bool enable) noexcept;
 
+    /**
+     * Changes whether or not the renderable is used as an occluder.
+     *
+     * \see Builder::occluder()
+     */
+    void setOccluder(Instance instance, bool enable) noexcept;
+
+    /**
+     * Checks if the renderable is used as an occluder.
+     *
+     * \see Builder::occluder()
+     */
+    bool isOccluder(Instance instance) const noexcept;
+
     /**
      * Changes whether or not the large-scale fog is applied to this renderable
      * @see Builder::fog()
@@ -114,6 +114,28 @@ public:
      */
     size_t getMaxFrameHistorySize() const noexcept;
 
+    /**
+     * Activity of the cache of render targets and other transient textures during the last
+     * frame. Sizes are estimates in bytes.
+     * @see getResourceCacheStats()
+     * @see Engine::Config::resourceAllocatorCacheBudgetMB
+     */
+    struct ResourceCacheStats {
+        uint32_t hitCount;          //!< textures reused from the cache
+        uint32_t missCount;         //!< textures created because none was available in the cache
+        uint32_t evictionCount;     //!< textures evicted from the cache
+        size_t createdSize;         //!< size of the textures created
+        size_t evictedSize;         //!< size of the textures evicted
+        size_t cacheSize;           //!< size of the textures in the cache at the end of the frame
+        size_t cacheSizeHighWaterMark;  //!< largest cache size since this Renderer was created
+    };
+
+    /**
+     * Returns the activity of the cache of transient textures during the last frame.
+     * @return A ResourceCacheStats
+     */
+    ResourceCacheStats getResourceCacheStats() const noexcept;
+
     /**
      * Use FrameRateOptions to set the desired frame rate and control how quickly the system
      * reacts to GPU load changes.
@@ -177,6 +177,54 @@ public:
      */
     void forEach(utils::Invocable<void(utils::Entity entity)>&& functor) const noexcept;
 
+    /**
+     * Enables or disables incremental updates of the Scene.
+     *
+     * By default, the per-frame data of every renderable in the Scene is recomputed each time
+     * the Scene is rendered. When incremental updates are enabled, this data is kept from one
+     * frame to the next and only the renderables that were added, removed or modified since
+     * the previous frame are updated, which is much cheaper for mostly static scenes.
+     *
+     * Changes made through TransformManager, RenderableManager and LightManager, as well as
+     * entities added to or removed from the Scene are tracked automatically. Destroying a
+     * renderable component, changing the View's world origin or modifying a large part of the
+     * Scene causes a full update on the next frame.
+     *
+     * Incremental updates are most effective when a Scene is rendered by a single View.
+     *
+     * @param enabled true to enable incremental updates, false to disable them (default).
+     */
+    void setIncrementalUpdateEnabled(bool enabled) noexcept;
+
+    /**
+     * @return Whether incremental updates are enabled.
+     * @see setIncrementalUpdateEnabled
+     */
+    bool isIncrementalUpdateEnabled() const noexcept;
+
+    /**
+     * Enables or disables hierarchical culling of the Scene.
+     *
+     * By default, every renderable of the Scene is tested individually against the camera
+     * frustum and each shadow map frustum. When hierarchical culling is enabled, a bounding
+     * volume hierarchy is maintained over the renderables, which allows accepting or rejecting
+     * large groups of renderables at once. This is beneficial for large scenes (tens of
+     * thousands of renderables) of which only a fraction is visible at a time.
+     *
+     * The hierarchy is rebuilt when renderables are added to or removed from the Scene, and its
+     * bounds are updated each frame. Hierarchical culling takes precedence over incremental
+     * updates of renderables (see setIncrementalUpdateEnabled()).
+     *
+     * @param enabled true to enable hierarchical culling, false to disable it (default).
+     */
+    void setHierarchicalCullingEnabled(bool enabled) noexcept;
+
+    /**
+     * @return Whether hierarchical culling is enabled.
+     * @see setHierarchicalCullingEnabled
+     */
+    bool isHierarchicalCullingEnabled() const noexcept;
+
 protected:
     // prevent heap allocation
     ~Scene() = default;
@@ -21,10 +21,12 @@
 
 #include <filament/FilamentAPI.h>
 
+#include <backend/CallbackHandler.h>
 #include <backend/DriverEnums.h>
 #include <backend/PixelBufferDescriptor.h>
 
 #include <utils/compiler.h>
+#include <utils/Invocable.h>
 
 #include <utility>
 
@@ -516,7 +518,8 @@ public:
      * The reflections cubemap's dimension must be a power-of-two.
      *
      * @warning This operation is computationally intensive, especially with large environments and
-     *          is currently synchronous. Expect about 1ms for a 16x16 cubemap.
+     *          is synchronous. Expect about 1ms for a 16x16 cubemap.
+     *          See generatePrefilterMipmapAsync() to process the environment in the background.
      *
      * @param engine        Reference to the filament::Engine to associate this IndirectLight with.
      * @param buffer        Client-side buffer containing the images to set.
@@ -531,6 +534,38 @@ public:
             PixelBufferDescriptor&& buffer, const FaceOffsets& faceOffsets,
             PrefilterOptions const* UTILS_NULLABLE options = nullptr);
 
+    /**
+     * Asynchronous version of generatePrefilterMipmap(), with the same constraints.
+     *
+     * This returns immediately, the environment is processed by background jobs of the Engine's
+     * JobSystem. Each level is uploaded as soon as it's ready, from the roughest to the sharpest,
+     * when the next frame begins (i.e. in Renderer::beginFrame() or Renderer::render()). Only the
+     * uploaded levels are sampled in the meantime, so reflections get sharper as levels arrive.
+     *
+     * Calling this again, or destroying the texture, cancels the pending processing, in which
+     * case the callback is not called.
+     *
+     * Unlike generatePrefilterMipmap(), \p buffer is consumed: its callback is called once the
+     * environment has been read, possibly from a background thread if it has no handler.
+     *
+     * @param engine        Reference to the filament::Engine to associate this IndirectLight with.
+     * @param buffer        Client-side buffer containing the images to set.
+     * @param faceOffsets   Offsets in bytes into \p buffer for all six images. The offsets
+     *                      are specified in the following order: +x, -x, +y, -y, +z, -z
+     * @param options       Optional parameter to controlling user-specified quality and options.
+     * @param handler       Handler to dispatch the callback or nullptr for the default handler
+     * @param callback      Callback called on the main thread once all levels are uploaded
+     *
+     * @exception utils::PreConditionPanic if the source data constraints are not respected.
+     *
+     * @see generatePrefilterMipmap()
+     */
+    void generatePrefilterMipmapAsync(Engine& engine,
+            PixelBufferDescriptor&& buffer, const FaceOffsets& faceOffsets,
+            PrefilterOptions const* UTILS_NULLABLE options = nullptr,
+            backend::CallbackHandler* UTILS_NULLABLE handler = nullptr,
+            utils::Invocable<void(Texture* UTILS_NONNULL)>&& callback = {});
+
 
     /** @deprecated */
     struct FaceOffsets {
@@ -743,6 +743,47 @@ public:
      */
     StereoscopicOptions const& getStereoscopicOptions() const noexcept;
 
+    /**
+     * Enables or disables CPU occlusion culling. Disabled by default.
+     *
+     * When enabled, the bounding boxes of the visible renderables marked as occluders (see
+     * RenderableManager::Builder::occluder()) are rasterized into a low resolution depth buffer
+     * on the CPU, and renderables entirely hidden behind them are culled. Shadow casting is
+     * not affected.
+     *
+     * This is only beneficial for scenes with large opaque occluders (e.g. walls or buildings)
+     * hiding many renderables.
+     *
+     * @param enabled true enables occlusion culling, false disables it.
+     */
+    void setOcclusionCullingEnabled(bool enabled) noexcept;
+
+    /**
+     * Returns whether CPU occlusion culling is enabled.
+     *
+     * @return value set by setOcclusionCullingEnabled().
+     */
+    bool isOcclusionCullingEnabled() const noexcept;
+
+    /**
+     * Enables or disables the caching of the color pass commands. Disabled by default.
+     *
+     * When enabled, the sorted draw commands of the color pass are kept from one frame to the
+     * next, and only the commands that changed are sorted again. This reduces the CPU cost
+     * of the color pass for mostly static scenes, in particular when the camera doesn't move,
+     * at the expense of some memory.
+     *
+     * @param enabled true enables command caching, false disables it and releases the cache.
+     */
+    void setCommandCachingEnabled(bool enabled) noexcept;
+
+    /**
+     * Returns whether command caching is enabled.
+     *
+     * @return value set by setCommandCachingEnabled().
+     */
+    bool isCommandCachingEnabled() const noexcept;
+
     // for debugging...
 
     //! debugging: allows to entirely disable frustum culling. (culling enabled by default).
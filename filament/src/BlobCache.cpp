@@ -0,0 +1,355 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BlobCache.h"
+
+#include <utils/Hash.h>
+#include <utils/Log.h>
+#include <utils/Path.h>
+#include <utils/Systrace.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(WIN32)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#    define HAS_MMAP 1
+#else
+#    define HAS_MMAP 0
+#endif
+
+namespace filament {
+
+using namespace utils;
+
+// Must be bumped when the format of the entries or of the index changes.
+static constexpr uint32_t VERSION = 1;
+static constexpr uint32_t ENTRY_MAGIC = 'F' | 'B' << 8 | 'C' << 16 | 'E' << 24;
+static constexpr uint32_t INDEX_MAGIC = 'F' | 'B' << 8 | 'C' << 16 | 'I' << 24;
+static constexpr const char* INDEX_NAME = "index";
+static constexpr const char* ENTRY_EXTENSION = ".blob";
+static constexpr const char* TEMP_MARKER = ".tmp.";
+
+struct EntryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t keySize;
+    uint64_t valueSize;
+};
+
+struct IndexEntry {
+    uint64_t hash;
+    uint64_t lastUse;
+};
+
+// Writes a file atomically, by writing a temporary file first and renaming it.
+static bool writeFile(std::string const& path, std::string const& temp,
+        std::initializer_list<std::pair<void const*, size_t>> parts) noexcept {
+    FILE* const file = fopen(temp.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = true;
+    for (auto const& [data, size] : parts) {
+        ok = ok && fwrite(data, 1, size, file) == size;
+    }
+    ok = (fclose(file) == 0) && ok;
+    if (ok && rename(temp.c_str(), path.c_str()) != 0) {
+        // rename() doesn't replace existing files on all platforms
+        ::remove(path.c_str());
+        ok = rename(temp.c_str(), path.c_str()) == 0;
+    }
+    if (!ok) {
+        ::remove(temp.c_str());
+    }
+    return ok;
+}
+
+// Reads the value of an entry file if its key matches. Returns false if the file is invalid.
+static bool readEntry(std::string const& path, void const* key, size_t keySize,
+        void* value, size_t capacity, size_t* outValueSize) noexcept {
+    auto const check = [&](uint8_t const* data, size_t size) {
+        EntryHeader header{};
+        if (size < sizeof(header)) {
+            return false;
+        }
+        memcpy(&header, data, sizeof(header));
+        if (header.magic != ENTRY_MAGIC || header.version != VERSION ||
+                header.keySize != keySize || size != sizeof(header) + keySize + header.valueSize ||
+                memcmp(data + sizeof(header), key, keySize) != 0) {
+            return false;
+        }
+        *outValueSize = size_t(header.valueSize);
+        return true;
+    };
+
+#if HAS_MMAP
+    int const fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st{};
+    void* data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    auto const* bytes = static_cast<uint8_t const*>(data);
+    bool const ok = check(bytes, size_t(st.st_size));
+    if (ok && *outValueSize <= capacity) {
+        memcpy(value, bytes + sizeof(EntryHeader) + keySize, *outValueSize);
+    }
+    munmap(data, size_t(st.st_size));
+    return ok;
+#else
+    std::ifstream in(path, std::ios::binary);
+    std::vector<uint8_t> const file{
+            std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+    bool const ok = check(file.data(), file.size());
+    if (ok && *outValueSize <= capacity) {
+        memcpy(value, file.data() + sizeof(EntryHeader) + keySize, *outValueSize);
+    }
+    return ok;
+#endif
+}
+
+static size_t getFileSize(std::string const& path) noexcept {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    return in ? size_t(std::streamoff(in.tellg())) : 0;
+}
+
+BlobCache::BlobCache(std::string directory, size_t maxSize)
+        : mDirectory(std::move(directory)), mMaxSize(maxSize),
+          mTempSeed(std::random_device{}()) {
+    load();
+}
+
+BlobCache::~BlobCache() noexcept {
+    flush();
+}
+
+uint64_t BlobCache::hash(void const* key, size_t keySize) noexcept {
+    auto const* const data = static_cast<uint8_t const*>(key);
+    return uint64_t(hash::murmurSlow(data, keySize, 0x9e3779b9u)) << 32 |
+            hash::murmurSlow(data, keySize, 0x85ebca6bu);
+}
+
+std::string BlobCache::getEntryPath(uint64_t hash) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx%s", (unsigned long long) hash, ENTRY_EXTENSION);
+    return Path::concat(mDirectory, name).getPath();
+}
+
+void BlobCache::load() noexcept {
+    SYSTRACE_CALL();
+    Path const directory(mDirectory);
+    if (!directory.exists() && !directory.mkdirRecursive()) {
+        slog.w << "BlobCache: can't create " << mDirectory << io::endl;
+        return;
+    }
+
+    // the last uses of the entries, the index can be missing or out of date
+    tsl::robin_map<uint64_t, uint64_t> lastUses;
+    std::ifstream in(Path::concat(mDirectory, INDEX_NAME).getPath(), std::ios::binary);
+    uint32_t header[2] = {};
+    uint64_t clock = 0;
+    uint64_t count = 0;
+    if (in.read(reinterpret_cast<char*>(header), sizeof(header)) &&
+            header[0] == INDEX_MAGIC && header[1] == VERSION &&
+            in.read(reinterpret_cast<char*>(&clock), sizeof(clock)) &&
+            in.read(reinterpret_cast<char*>(&count), sizeof(count))) {
+        IndexEntry entry{};
+        for (uint64_t i = 0; i < count &&
+                in.read(reinterpret_cast<char*>(&entry), sizeof(entry)); i++) {
+            lastUses[entry.hash] = entry.lastUse;
+        }
+        mClock = clock;
+    }
+
+    for (Path const& path : directory.listContents()) {
+        std::string const name = path.getName();
+        if (name.find(TEMP_MARKER) != std::string::npos) {
+            // left behind by a crash or a failed write
+            Path(path).unlinkFile();
+            continue;
+        }
+        if (name.size() != 16 + strlen(ENTRY_EXTENSION) ||
+                name.compare(16, std::string::npos, ENTRY_EXTENSION) != 0) {
+            continue;
+        }
+        char* end = nullptr;
+        uint64_t const hash = strtoull(name.c_str(), &end, 16);
+        if (end != name.c_str() + 16) {
+            continue;
+        }
+        auto const pos = lastUses.find(hash);
+        Entry const entry{
+                .size = getFileSize(path.getPath()),
+                .lastUse = pos != lastUses.end() ? pos->second : 0 };
+        mEntries[hash] = entry;
+        mTotalSize += entry.size;
+    }
+
+    evict();
+}
+
+void BlobCache::insert(void const* key, size_t keySize,
+        void const* value, size_t valueSize) noexcept {
+    SYSTRACE_CALL();
+    size_t const size = sizeof(EntryHeader) + keySize + valueSize;
+    if (size > mMaxSize) {
+        return;
+    }
+
+    uint64_t const h = hash(key, keySize);
+    std::string const path = getEntryPath(h);
+    char suffix[48];
+    snprintf(suffix, sizeof(suffix), "%s%016llx.%u", TEMP_MARKER, (unsigned long long) mTempSeed,
+            mTempCount.fetch_add(1, std::memory_order_relaxed));
+
+    EntryHeader const header{
+            .magic = ENTRY_MAGIC,
+            .version = VERSION,
+            .keySize = keySize,
+            .valueSize = valueSize };
+    if (!writeFile(path, path + suffix,
+            { { &header, sizeof(header) }, { key, keySize }, { value, valueSize } })) {
+        return;
+    }
+
+    std::lock_guard const lock(mLock);
+    auto [pos, inserted] = mEntries.try_emplace(h, Entry{ size, ++mClock });
+    if (!inserted) {
+        mTotalSize -= pos->second.size;
+        pos.value() = { size, mClock };
+    }
+    mTotalSize += size;
+    mDirty = true;
+    evict();
+}
+
+size_t BlobCache::retrieve(void const* key, size_t keySize,
+        void* value, size_t valueSize) noexcept {
+    SYSTRACE_CALL();
+    uint64_t const h = hash(key, keySize);
+    {
+        std::lock_guard const lock(mLock);
+        auto pos = mEntries.find(h);
+        if (pos == mEntries.end()) {
+            return 0;
+        }
+        // this alone doesn't dirty the index, the entries' last uses are only needed to pick
+        // the ones to evict, they're saved with the next change or when the cache is closed.
+        pos.value().lastUse = ++mClock;
+    }
+
+    size_t size = 0;
+    if (!readEntry(getEntryPath(h), key, keySize, value, valueSize, &size)) {
+        // corrupted, or a collision with another key
+        std::lock_guard const lock(mLock);
+        remove(h);
+        return 0;
+    }
+    return size;
+}
+
+void BlobCache::remove(uint64_t hash) noexcept {
+    auto const pos = mEntries.find(hash);
+    if (pos != mEntries.end()) {
+        mTotalSize -= pos->second.size;
+        mEntries.erase(pos);
+        ::remove(getEntryPath(hash).c_str());
+        mDirty = true;
+    }
+}
+
+void BlobCache::evict() noexcept {
+    if (mTotalSize <= mMaxSize) {
+        return;
+    }
+
+    // evict down to 3/4 of the budget, so that we don't have to do this on each insert
+    std::vector<std::pair<uint64_t, uint64_t>> entries; // last use, hash
+    entries.reserve(mEntries.size());
+    for (auto const& [hash, entry] : mEntries) {
+        entries.emplace_back(entry.lastUse, hash);
+    }
+    std::sort(entries.begin(), entries.end());
+    size_t const target = mMaxSize - mMaxSize / 4;
+    for (auto const& [lastUse, hash] : entries) {
+        if (mTotalSize <= target) {
+            break;
+        }
+        remove(hash);
+    }
+}
+
+void BlobCache::flush() const noexcept {
+    SYSTRACE_CALL();
+    std::vector<IndexEntry> entries;
+    uint64_t clock;
+    {
+        std::lock_guard const lock(mLock);
+        entries.reserve(mEntries.size());
+        for (auto const& [hash, entry] : mEntries) {
+            entries.push_back({ hash, entry.lastUse });
+        }
+        clock = mClock;
+        mDirty = false;
+    }
+
+    uint32_t const header[2] = { INDEX_MAGIC, VERSION };
+    uint64_t const count = entries.size();
+    std::string const path = Path::concat(mDirectory, INDEX_NAME).getPath();
+    char suffix[48];
+    snprintf(suffix, sizeof(suffix), "%s%016llx.%u", TEMP_MARKER, (unsigned long long) mTempSeed,
+            mTempCount.fetch_add(1, std::memory_order_relaxed));
+    if (!writeFile(path, path + suffix, {
+            { header, sizeof(header) },
+            { &clock, sizeof(clock) },
+            { &count, sizeof(count) },
+            { entries.data(), entries.size() * sizeof(IndexEntry) } })) {
+        std::lock_guard const lock(mLock);
+        mDirty = true;
+    }
+}
+
+bool BlobCache::isDirty() const noexcept {
+    std::lock_guard const lock(mLock);
+    return mDirty;
+}
+
+size_t BlobCache::getSize() const noexcept {
+    std::lock_guard const lock(mLock);
+    return mTotalSize;
+}
+
+} // namespace filament
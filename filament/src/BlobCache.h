@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_BLOBCACHE_H
+#define TNT_FILAMENT_BLOBCACHE_H
+
+#include <utils/Mutex.h>
+
+#include <tsl/robin_map.h>
+
+#include <atomic>
+#include <string>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+
+/*
+ * A persistent key/value cache stored in a directory, which implements the blob functions of
+ * backend::Platform.
+ *
+ * Each value is stored in its own file, named after the hash of its key, which is written to a
+ * temporary file first and then renamed, so that a crash never leaves a partial entry behind.
+ * Values are read by memory-mapping their file when possible.
+ *
+ * The total size of the entries is bounded, the least recently used ones are evicted first. The
+ * sizes and last uses of the entries are kept in an index file written by flush(). It doesn't
+ * need to be up to date: entries missing from it are found when the cache is opened, they're
+ * just considered older than the others.
+ *
+ * All methods are thread-safe.
+ */
+class BlobCache {
+public:
+    BlobCache(std::string directory, size_t maxSize);
+
+    // flushes the index
+    ~BlobCache() noexcept;
+
+    BlobCache(BlobCache const&) = delete;
+    BlobCache& operator=(BlobCache const&) = delete;
+
+    // Stores a value, failures are ignored since this is only a cache
+    void insert(void const* key, size_t keySize, void const* value, size_t valueSize) noexcept;
+
+    // Returns the size of the value associated with key, or 0 if there is none. The value is
+    // copied to `value` only if it fits in `valueSize` bytes.
+    size_t retrieve(void const* key, size_t keySize, void* value, size_t valueSize) noexcept;
+
+    // Writes the index
+    void flush() const noexcept;
+
+    // Returns whether entries were added or removed since the index was loaded or last flushed
+    bool isDirty() const noexcept;
+
+    size_t getSize() const noexcept;
+
+private:
+    struct Entry {
+        size_t size;        // size of the entry's file
+        uint64_t lastUse;   // value of mClock when last used
+    };
+
+    static uint64_t hash(void const* key, size_t keySize) noexcept;
+    std::string getEntryPath(uint64_t hash) const;
+    void load() noexcept;
+    void remove(uint64_t hash) noexcept;
+    void evict() noexcept;
+
+    std::string const mDirectory;
+    size_t const mMaxSize;
+    uint64_t const mTempSeed;
+    mutable std::atomic<uint32_t> mTempCount = 0;
+
+    mutable utils::Mutex mLock;
+    tsl::robin_map<uint64_t, Entry> mEntries;
+    size_t mTotalSize = 0;
+    uint64_t mClock = 0;
+    mutable bool mDirty = false;
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_BLOBCACHE_H
@@ -35,6 +35,11 @@ void MorphTargetBuffer::setTangentsAt(Engine& engine, size_t targetIndex,
     downcast(this)->setTangentsAt(downcast(engine), targetIndex, tangents, count, offset);
 }
 
+void MorphTargetBuffer::setSparseTargets(Engine& engine,
+        SparseTarget const* targets, size_t count) {
+    downcast(this)->setSparseTargets(downcast(engine), targets, count);
+}
+
 size_t MorphTargetBuffer::getVertexCount() const noexcept {
     return downcast(this)->getVertexCount();
 }
@@ -43,5 +48,9 @@ size_t MorphTargetBuffer::getCount() const noexcept {
     return downcast(this)->getCount();
 }
 
+bool MorphTargetBuffer::isSparse() const noexcept {
+    return downcast(this)->isSparse();
+}
+
 } // namespace filament
 
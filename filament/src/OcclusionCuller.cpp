@@ -0,0 +1,311 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "OcclusionCuller.h"
+
+#include <filament/Box.h>
+
+#include <utils/debug.h>
+
+#include <math/mat4.h>
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace filament::math;
+
+namespace filament {
+
+static constexpr float FAR_DEPTH = std::numeric_limits<float>::infinity();
+
+void OcclusionCuller::prepare(uint32_t width, uint32_t height,
+        mat4f const& clipFromWorld) noexcept {
+    mClipFromWorld = clipFromWorld;
+    mTileCountX = std::max(1u, uint32_t((width + TILE_SIZE - 1) / TILE_SIZE));
+    mTileCountY = std::max(1u, uint32_t((height + TILE_SIZE - 1) / TILE_SIZE));
+    mWidth = uint32_t(mTileCountX * TILE_SIZE);
+    mHeight = uint32_t(mTileCountY * TILE_SIZE);
+    mDepth.assign(size_t(mWidth) * mHeight, FAR_DEPTH);
+    mTileMaxDepth.assign(size_t(mTileCountX) * mTileCountY, FAR_DEPTH);
+}
+
+void OcclusionCuller::rasterizeOccluder(Box const& box, mat4f const& worldFromModel) noexcept {
+    mat4f const clipFromModel = mClipFromWorld * worldFromModel;
+    float3 const lo = box.getMin();
+    float3 const hi = box.getMax();
+
+    float4 corners[8];
+    for (size_t i = 0; i < 8; i++) {
+        float3 const p{ (i & 1) ? hi.x : lo.x, (i & 2) ? hi.y : lo.y, (i & 4) ? hi.z : lo.z };
+        corners[i] = clipFromModel * float4{ p, 1.0f };
+    }
+
+    // the corners of each face of the box, in order around the face
+    constexpr uint8_t faces[6][4] = {
+            { 0, 2, 6, 4 },     // -x
+            { 1, 3, 7, 5 },     // +x
+            { 0, 1, 5, 4 },     // -y
+            { 2, 3, 7, 6 },     // +y
+            { 0, 1, 3, 2 },     // -z
+            { 4, 5, 7, 6 },     // +z
+    };
+
+    // clip each face against the near plane (z >= -w) and project it to screen-space
+    float3 points[MAX_POINTS];
+    size_t pointCount = 0;
+    size_t faceFirst[6];
+    size_t faceCount[6];
+    for (size_t f = 0; f < 6; f++) {
+        faceFirst[f] = pointCount;
+        for (size_t i = 0; i < 4; i++) {
+            float4 const& a = corners[faces[f][i]];
+            float4 const& b = corners[faces[f][(i + 1) % 4]];
+            float const da = a.z + a.w;
+            float const db = b.z + b.w;
+            float4 out[2];
+            size_t count = 0;
+            if (da >= 0) {
+                out[count++] = a;
+            }
+            if ((da >= 0) != (db >= 0)) {
+                out[count++] = a + (b - a) * (da / (da - db));
+            }
+            for (size_t k = 0; k < count; k++) {
+                float const w = std::max(out[k].w, std::numeric_limits<float>::min());
+                float3 const ndc = out[k].xyz / w;
+                points[pointCount++] = {
+                        (ndc.x * 0.5f + 0.5f) * float(mWidth),
+                        (ndc.y * 0.5f + 0.5f) * float(mHeight),
+                        ndc.z };
+            }
+        }
+        faceCount[f] = pointCount - faceFirst[f];
+    }
+    if (pointCount < 3) {
+        return;
+    }
+
+    // The eye in model-space, which is a direction for orthographic projections. In both cases
+    // it's the point that projects to (0, 0, -1, 0), with a positive w for perspective ones.
+    float4 const eye = inverse(clipFromModel) * float4{ 0, 0, -1, 0 };
+
+    // The clipped box is still convex in screen-space, so its front surface is the farthest of
+    // its front-facing face planes.
+    float3 planes[6];
+    size_t planeCount = 0;
+    for (size_t f = 0; f < 6; f++) {
+        size_t const axis = f / 2;
+        float const side = (f & 1) ? eye[axis] - hi[axis] * eye.w : lo[axis] * eye.w - eye[axis];
+        if (faceCount[f] < 3 || side <= 0) {
+            // clipped away or not facing the camera
+            continue;
+        }
+        // Newell's method, which is robust to the degenerate edges introduced by clipping
+        float3 const* const v = points + faceFirst[f];
+        float3 n{};
+        float3 c{};
+        for (size_t i = 0, e = faceCount[f]; i < e; i++) {
+            float3 const& p = v[i];
+            float3 const& q = v[(i + 1) % e];
+            n += float3{ (p.y - q.y) * (p.z + q.z),
+                         (p.z - q.z) * (p.x + q.x),
+                         (p.x - q.x) * (p.y + q.y) };
+            c += p;
+        }
+        c /= float(faceCount[f]);
+        size_t const s = (axis + 1) % 3;
+        size_t const t = (axis + 2) % 3;
+        if (hi[s] == lo[s] || hi[t] == lo[t]) {
+            // the box is flat and this face is empty
+            continue;
+        }
+        float3 const plane{ -n.x / n.z, -n.y / n.z, dot(n, c) / n.z };
+        // the farthest depth over the pixel instead of the depth at its center
+        float const slope = 0.5f * (std::abs(plane.x) + std::abs(plane.y));
+        if (UTILS_LIKELY(std::isfinite(plane.z) && slope < 2.0f)) {
+            planes[planeCount++] = plane + float3{ 0, 0, slope };
+        } else {
+            // The face is almost edge-on and its plane can't be trusted, its farthest depth
+            // everywhere is conservative. This only affects the few pixels it could cover.
+            float farthest = v[0].z;
+            for (size_t i = 1; i < faceCount[f]; i++) {
+                farthest = std::max(farthest, v[i].z);
+            }
+            planes[planeCount++] = { 0, 0, farthest };
+        }
+    }
+    if (!planeCount) {
+        // the camera is inside the box
+        return;
+    }
+
+    // silhouette of the box, i.e. the convex hull of its vertices (Andrew's monotone chain)
+    std::sort(points, points + pointCount, [](float3 const& a, float3 const& b) {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    });
+    auto cross = [](float3 const& o, float3 const& a, float3 const& b) {
+        return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+    };
+    float3 hull[MAX_POINTS + 1];
+    size_t hullCount = 0;
+    for (size_t i = 0; i < pointCount; i++) {
+        while (hullCount >= 2 &&
+                cross(hull[hullCount - 2], hull[hullCount - 1], points[i]) <= 0) {
+            hullCount--;
+        }
+        hull[hullCount++] = points[i];
+    }
+    for (size_t i = pointCount - 1, first = hullCount + 1; i-- > 0;) {
+        while (hullCount >= first &&
+                cross(hull[hullCount - 2], hull[hullCount - 1], points[i]) <= 0) {
+            hullCount--;
+        }
+        hull[hullCount++] = points[i];
+    }
+    hullCount--; // the last point is the first one
+    if (hullCount < 3) {
+        return;
+    }
+
+    // edge functions e(x, y) = a.x + b.y + c, positive inside the counter-clockwise hull, and
+    // offset so that they're positive only when the whole pixel is inside.
+    float3 edges[MAX_POINTS];
+    float2 lower{ std::numeric_limits<float>::max() };
+    float2 upper{ std::numeric_limits<float>::lowest() };
+    for (size_t i = 0; i < hullCount; i++) {
+        float3 const& p = hull[i];
+        float3 const& q = hull[(i + 1) % hullCount];
+        float const a = p.y - q.y;
+        float const b = q.x - p.x;
+        edges[i] = { a, b, -(a * p.x + b * p.y) - 0.5f * (std::abs(a) + std::abs(b)) };
+        lower = min(lower, p.xy);
+        upper = max(upper, p.xy);
+    }
+
+    rasterizeConvex(edges, hullCount, planes, planeCount, lower, upper);
+}
+
+void OcclusionCuller::rasterizeConvex(float3 const* const edges, size_t const edgeCount,
+        float3 const* const planes, size_t const planeCount,
+        float2 const& lo, float2 const& hi) noexcept {
+    if (hi.x < 0.0f || hi.y < 0.0f || lo.x >= float(mWidth) || lo.y >= float(mHeight)) {
+        return;
+    }
+    int32_t const x0 = std::max(0, int32_t(lo.x));
+    int32_t const y0 = std::max(0, int32_t(lo.y));
+    int32_t const x1 = std::min(int32_t(mWidth) - 1, int32_t(hi.x));
+    int32_t const y1 = std::min(int32_t(mHeight) - 1, int32_t(hi.y));
+
+    for (int32_t ty = y0 / int32_t(TILE_SIZE); ty <= y1 / int32_t(TILE_SIZE); ty++) {
+        for (int32_t tx = x0 / int32_t(TILE_SIZE); tx <= x1 / int32_t(TILE_SIZE); tx++) {
+            float* const UTILS_RESTRICT tile = getTile(tx, ty);
+            for (size_t j = 0; j < TILE_SIZE; j++) {
+                float const py = float(ty * TILE_SIZE + j) + 0.5f;
+                float* const UTILS_RESTRICT row = tile + j * TILE_SIZE;
+                for (size_t i = 0; i < TILE_SIZE; i++) {
+                    float const px = float(tx * TILE_SIZE + i) + 0.5f;
+                    bool inside = true;
+                    for (size_t k = 0; k < edgeCount; k++) {
+                        inside &= edges[k].x * px + edges[k].y * py + edges[k].z >= 0;
+                    }
+                    float d = -1.0f;
+                    for (size_t k = 0; k < planeCount; k++) {
+                        d = std::max(d, planes[k].x * px + planes[k].y * py + planes[k].z);
+                    }
+                    row[i] = inside ? std::min(row[i], d) : row[i];
+                }
+            }
+        }
+    }
+}
+
+void OcclusionCuller::finalize() noexcept {
+    for (size_t ty = 0; ty < mTileCountY; ty++) {
+        for (size_t tx = 0; tx < mTileCountX; tx++) {
+            float const* const UTILS_RESTRICT tile = getTile(tx, ty);
+            float farthest = tile[0];
+            for (size_t i = 1; i < TILE_SIZE * TILE_SIZE; i++) {
+                farthest = std::max(farthest, tile[i]);
+            }
+            mTileMaxDepth[ty * mTileCountX + tx] = farthest;
+        }
+    }
+}
+
+bool OcclusionCuller::isOccluded(float3 const& center, float3 const& extent) const noexcept {
+    // screen-space bounds and closest depth of the box
+    float xmin = std::numeric_limits<float>::max();
+    float ymin = std::numeric_limits<float>::max();
+    float xmax = std::numeric_limits<float>::lowest();
+    float ymax = std::numeric_limits<float>::lowest();
+    float zmin = std::numeric_limits<float>::max();
+    for (size_t i = 0; i < 8; i++) {
+        float3 const p = center + float3{ (i & 1) ? extent.x : -extent.x,
+                                          (i & 2) ? extent.y : -extent.y,
+                                          (i & 4) ? extent.z : -extent.z };
+        float4 const c = mClipFromWorld * float4{ p, 1.0f };
+        if (c.z < -c.w || c.w <= 0) {
+            // the box crosses the near plane
+            return false;
+        }
+        float3 const ndc = c.xyz / c.w;
+        xmin = std::min(xmin, ndc.x);
+        xmax = std::max(xmax, ndc.x);
+        ymin = std::min(ymin, ndc.y);
+        ymax = std::max(ymax, ndc.y);
+        zmin = std::min(zmin, ndc.z);
+    }
+
+    xmin = (xmin * 0.5f + 0.5f) * float(mWidth);
+    xmax = (xmax * 0.5f + 0.5f) * float(mWidth);
+    ymin = (ymin * 0.5f + 0.5f) * float(mHeight);
+    ymax = (ymax * 0.5f + 0.5f) * float(mHeight);
+    if (xmax < 0.0f || ymax < 0.0f || xmin >= float(mWidth) || ymin >= float(mHeight)) {
+        // off-screen, that's for frustum culling to decide
+        return false;
+    }
+    int32_t const x0 = std::max(0, int32_t(xmin));
+    int32_t const y0 = std::max(0, int32_t(ymin));
+    int32_t const x1 = std::min(int32_t(mWidth) - 1, int32_t(xmax));
+    int32_t const y1 = std::min(int32_t(mHeight) - 1, int32_t(ymax));
+
+    for (int32_t ty = y0 / int32_t(TILE_SIZE); ty <= y1 / int32_t(TILE_SIZE); ty++) {
+        for (int32_t tx = x0 / int32_t(TILE_SIZE); tx <= x1 / int32_t(TILE_SIZE); tx++) {
+            if (zmin > mTileMaxDepth[ty * mTileCountX + tx]) {
+                // the whole tile is in front of the box
+                continue;
+            }
+            float const* const UTILS_RESTRICT tile = getTile(tx, ty);
+            int32_t const i0 = std::max(x0 - tx * int32_t(TILE_SIZE), 0);
+            int32_t const i1 = std::min(x1 - tx * int32_t(TILE_SIZE), int32_t(TILE_SIZE) - 1);
+            int32_t const j0 = std::max(y0 - ty * int32_t(TILE_SIZE), 0);
+            int32_t const j1 = std::min(y1 - ty * int32_t(TILE_SIZE), int32_t(TILE_SIZE) - 1);
+            for (int32_t j = j0; j <= j1; j++) {
+                for (int32_t i = i0; i <= i1; i++) {
+                    if (zmin <= tile[j * TILE_SIZE + i]) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace filament
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_OCCLUSIONCULLER_H
+#define TNT_FILAMENT_OCCLUSIONCULLER_H
+
+#include <utils/compiler.h>
+
+#include <math/mat4.h>
+#include <math/vec2.h>
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+
+class Box;
+
+/*
+ * A CPU software occlusion culler.
+ *
+ * Occluders are boxes assumed to be entirely opaque, they're rasterized into a low resolution
+ * depth buffer, which is then used to test whether world-space AABBs are entirely hidden.
+ *
+ * Occluders are rasterized conservatively: a pixel is only covered if it lies entirely inside
+ * the occluder's silhouette, and it's given the farthest depth of the occluder over the pixel.
+ * Occludees are tested against all the pixels they touch, so an occludee is never reported
+ * hidden when part of it is visible, regardless of the buffer's resolution.
+ *
+ * The depth buffer is stored in tiles of TILE_SIZE x TILE_SIZE pixels, so that rasterization
+ * and tests process rows of TILE_SIZE contiguous pixels, which vectorizes well. The farthest
+ * depth of each tile is also kept, which lets most tests reject or accept a whole tile at once.
+ *
+ * Depths are NDC z (GL convention, i.e. smaller is closer), which works for both perspective and
+ * orthographic projections since it's linear in screen-space.
+ *
+ * Usage:
+ *  prepare()
+ *  rasterizeOccluder() for each occluder
+ *  finalize()
+ *  isOccluded() for each potential occludee
+ */
+class OcclusionCuller {
+public:
+    static constexpr size_t TILE_SIZE = 8;
+
+    // Resets the depth buffer, which is sized to approximately `width` x `height` pixels
+    void prepare(uint32_t width, uint32_t height, math::mat4f const& clipFromWorld) noexcept;
+
+    // Rasterizes the box `box` transformed by `worldFromModel`, which must be entirely opaque
+    void rasterizeOccluder(Box const& box, math::mat4f const& worldFromModel) noexcept;
+
+    // Must be called after all the occluders have been rasterized
+    void finalize() noexcept;
+
+    // Returns whether the given world-space AABB is entirely hidden by the occluders
+    bool isOccluded(math::float3 const& center, math::float3 const& extent) const noexcept;
+
+    uint32_t getWidth() const noexcept { return mWidth; }
+    uint32_t getHeight() const noexcept { return mHeight; }
+
+private:
+    // A box clipped by the near plane has at most 6 faces of 5 vertices
+    static constexpr size_t MAX_POINTS = 6 * 5;
+
+    // edges are (a, b, c) such that a.x + b.y + c >= 0 for pixels entirely inside the silhouette,
+    // planes are (a, b, c) such that a.x + b.y + c is the farthest depth of the pixel at (x, y).
+    void rasterizeConvex(math::float3 const* edges, size_t edgeCount,
+            math::float3 const* planes, size_t planeCount,
+            math::float2 const& lo, math::float2 const& hi) noexcept;
+
+    float* getTile(size_t tx, size_t ty) noexcept {
+        return mDepth.data() + (ty * mTileCountX + tx) * (TILE_SIZE * TILE_SIZE);
+    }
+
+    float const* getTile(size_t tx, size_t ty) const noexcept {
+        return mDepth.data() + (ty * mTileCountX + tx) * (TILE_SIZE * TILE_SIZE);
+    }
+
+    math::mat4f mClipFromWorld;
+    std::vector<float> mDepth;          // closest occluder depth of each pixel, tile by tile
+    std::vector<float> mTileMaxDepth;   // farthest depth of each tile
+    uint32_t mWidth = 0;
+    uint32_t mHeight = 0;
+    uint32_t mTileCountX = 0;
+    uint32_t mTileCountY = 0;
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_OCCLUSIONCULLER_H
@@ -74,7 +74,6 @@
 #include <utils/BitmaskEnum.h>
 #include <utils/debug.h>
 #include <utils/compiler.h>
-#include <utils/FixedCapacityVector.h>
 
 #include <algorithm>
 #include <array>
@@ -1042,18 +1041,18 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::generateGaussianMipmap(Frame
     auto const subResourceDesc = fg.getSubResourceDescriptor(input);
 
     // Create one subresource per level to be generated from the input. These will be our
-    // destinations.
+    // destinations. The pass data lives in the FrameGraph's arena, so this doesn't allocate.
     struct MipmapPassData {
-        FixedCapacityVector<FrameGraphId<FrameGraphTexture>> out;
+        FrameGraphId<FrameGraphTexture> out[32]; // a texture can't have more levels
     };
+    assert_invariant(levels <= 32);
     auto& mipmapPass = fg.addPass<MipmapPassData>("Mipmap Pass",
             [&](FrameGraph::Builder& builder, auto& data) {
-                data.out.reserve(levels - 1);
                 for (size_t i = 1; i < levels; i++) {
-                    data.out.push_back(builder.createSubresource(input,
+                    data.out[i - 1] = builder.createSubresource(input,
                             "Mipmap output", {
                                     .level = uint8_t(subResourceDesc.level + i),
-                                    .layer = subResourceDesc.layer }));
+                                    .layer = subResourceDesc.layer });
                 }
             });
 
@@ -54,6 +54,7 @@
 #include <functional>
 #include <limits>
 #include <utility>
+#include <vector>
 
 #include <stddef.h>
 #include <stdint.h>
@@ -159,8 +160,15 @@ RenderPass::RenderPass(FEngine const& engine, backend::DriverApi& driver,
     }
 
     // sort commands once we're done adding commands
-    commandEnd = resize(builder.mArena,
-            RenderPass::sortCommands(commandBegin, commandEnd));
+    if (builder.mCommandCache) {
+        commandEnd = resize(builder.mArena,
+                builder.mCommandCache->sortCommands(engine.getJobSystem(), builder.mArena,
+                        commandBegin, commandEnd));
+    } else {
+        commandEnd = resize(builder.mArena,
+                RenderPass::sortCommands(engine.getJobSystem(), builder.mArena,
+                        commandBegin, commandEnd));
+    }
 
     if (engine.isAutomaticInstancingEnabled()) {
         int32_t stereoscopicEyeCount = 1;
@@ -272,6 +280,27 @@ void RenderPass::appendCustomCommand(Command* commands,
     commands->key = cmd;
 }
 
+RenderPass::Command* RenderPass::sortCommands(JobSystem& js, Arena& arena,
+        Command* const begin, Command* const end) noexcept {
+    size_t const count = end - begin;
+    if (count < RADIX_SORT_THRESHOLD) {
+        return sortCommands(begin, end);
+    }
+    if (UTILS_UNLIKELY(!hasRadixSortScratch(js, arena, count))) {
+        // the radix sort's scratch memory would come from the heap, which costs more than
+        // what the radix sort saves.
+        static bool sLogOnce = true;
+        if (UTILS_UNLIKELY(sLogOnce)) {
+            sLogOnce = false;
+            PANIC_LOG("RenderPass arena is too small to radix sort commands, using slower sort. "
+                      "Please increase the appropriate constant "
+                      "(e.g. FILAMENT_PER_RENDER_PASS_ARENA_SIZE_IN_MB).");
+        }
+        return sortCommands(begin, end);
+    }
+    return sortCommandsRadix(js, arena, begin, end);
+}
+
 RenderPass::Command* RenderPass::sortCommands(
         Command* const begin, Command* const end) noexcept {
     SYSTRACE_NAME("sort commands");
@@ -287,6 +316,329 @@ RenderPass::Command* RenderPass::sortCommands(
     return last;
 }
 
+namespace {
+
+struct SortEntry {
+    RenderPass::CommandKey key;
+    uint32_t index;
+};
+
+// LSD radix sort with 8 bits digits
+constexpr size_t RADIX_BITS = 8;
+constexpr size_t RADIX_SIZE = 1u << RADIX_BITS;
+constexpr size_t RADIX_DIGITS = sizeof(RenderPass::CommandKey) * 8 / RADIX_BITS;
+
+inline uint32_t getDigit(RenderPass::CommandKey key, size_t digit) noexcept {
+    return uint32_t(key >> (digit * RADIX_BITS)) & (RADIX_SIZE - 1);
+}
+
+} // anonymous namespace
+
+bool RenderPass::hasRadixSortScratch(JobSystem const& js, Arena const& arena,
+        size_t const count) noexcept {
+    // see sortCommandsRadix() and sortCommandKeys(), we assume all commands could be sorted in
+    // parallel and allow for the alignment of each allocation.
+    size_t const threadCount = js.getThreadCount();
+    size_t const chunkCount = count >= RADIX_SORT_PARALLEL_THRESHOLD && threadCount > 1 ?
+            threadCount : 0;
+    size_t const size = count * sizeof(uint32_t) + 2 * count * sizeof(SortEntry) +
+            chunkCount * RADIX_SIZE * sizeof(uint32_t) + 3 * alignof(SortEntry);
+    return size <= arena.getAllocator().available();
+}
+
+RenderPass::Command* RenderPass::sortCommandsRadix(JobSystem& js, Arena& arena,
+        Command* const begin, Command* const end) noexcept {
+    SYSTRACE_NAME("sort commands (radix)");
+
+    size_t const count = end - begin;
+    if (!count) {
+        return end;
+    }
+
+    void* const scratch = arena.getCurrent();
+    uint32_t* const order = arena.alloc<uint32_t>(count);
+    size_t const n = sortCommandKeys(js, arena, begin, count, order);
+    permuteCommands(begin, count, order);
+    arena.rewind(scratch);
+    return begin + n;
+}
+
+size_t RenderPass::sortCommandKeys(JobSystem& js, Arena& arena,
+        Command const* const begin, size_t const count, uint32_t* const from) noexcept {
+    // all scratch allocations are released when we return
+    void* const scratch = arena.getCurrent();
+    SortEntry* src = arena.alloc<SortEntry>(count);
+    SortEntry* dst = arena.alloc<SortEntry>(count);
+
+    // Sentinels don't need sorting since they're trimmed anyway, in practice they're the
+    // majority of the commands. The sort entries are gathered at the start of `src`, while the
+    // sentinels' indices are gathered at the end of `from` (their order doesn't matter).
+    // Meanwhile, compute the histograms of all digits, which don't depend on the order.
+    uint32_t histograms[RADIX_DIGITS][RADIX_SIZE] = {};
+    size_t n = 0;
+    for (size_t i = 0, s = count; i < count; i++) {
+        CommandKey const key = begin[i].key;
+        if (key == uint64_t(Pass::SENTINEL)) {
+            from[--s] = uint32_t(i);
+            continue;
+        }
+        src[n++] = { key, uint32_t(i) };
+        for (size_t d = 0; d < RADIX_DIGITS; d++) {
+            histograms[d][getDigit(key, d)]++;
+        }
+    }
+
+    size_t const threadCount = js.getThreadCount();
+    bool const parallel = n >= RADIX_SORT_PARALLEL_THRESHOLD && threadCount > 1;
+
+    // Below this size, a chunk doesn't amortize the cost of its job.
+    constexpr size_t MIN_CHUNK_SIZE = 16384;
+    size_t const chunkCount = parallel ?
+            std::min(threadCount, (n + MIN_CHUNK_SIZE - 1) / MIN_CHUNK_SIZE) : 1;
+    size_t const chunkSize = (n + chunkCount - 1) / chunkCount;
+    uint32_t (*const offsets)[RADIX_SIZE] = parallel ?
+            arena.alloc<uint32_t[RADIX_SIZE]>(chunkCount) : nullptr;
+
+    for (size_t d = 0; d < RADIX_DIGITS; d++) {
+        // skip the digits that are the same for all keys, e.g. most high bits
+        if (!n || histograms[d][getDigit(src[0].key, d)] == n) {
+            continue;
+        }
+
+        if (!parallel) {
+            uint32_t offset = 0;
+            uint32_t* const UTILS_RESTRICT histogram = histograms[d];
+            for (size_t b = 0; b < RADIX_SIZE; b++) {
+                uint32_t const c = histogram[b];
+                histogram[b] = offset;
+                offset += c;
+            }
+            for (size_t i = 0; i < n; i++) {
+                dst[histogram[getDigit(src[i].key, d)]++] = src[i];
+            }
+        } else {
+            // each chunk scatters its entries after the ones of the previous chunks with the
+            // same digit, which keeps the sort stable
+            auto countChunk = [src, n, chunkSize, offsets, d](size_t c) {
+                uint32_t* const UTILS_RESTRICT histogram = offsets[c];
+                std::fill_n(histogram, RADIX_SIZE, 0u);
+                for (size_t i = c * chunkSize, e = std::min(n, i + chunkSize); i < e; i++) {
+                    histogram[getDigit(src[i].key, d)]++;
+                }
+            };
+            auto scatterChunk = [src, dst, n, chunkSize, offsets, d](size_t c) {
+                uint32_t* const UTILS_RESTRICT offset = offsets[c];
+                for (size_t i = c * chunkSize, e = std::min(n, i + chunkSize); i < e; i++) {
+                    dst[offset[getDigit(src[i].key, d)]++] = src[i];
+                }
+            };
+            auto runChunks = [&js, chunkCount](auto const& work) {
+                JobSystem::Job* parent = js.createJob();
+                for (size_t c = 0; c < chunkCount; c++) {
+                    js.run(js.createJob(parent, [&work, c](JobSystem&, JobSystem::Job*) {
+                        work(c);
+                    }));
+                }
+                js.runAndWait(parent);
+            };
+
+            runChunks(countChunk);
+            uint32_t offset = 0;
+            for (size_t b = 0; b < RADIX_SIZE; b++) {
+                for (size_t c = 0; c < chunkCount; c++) {
+                    uint32_t const k = offsets[c][b];
+                    offsets[c][b] = offset;
+                    offset += k;
+                }
+            }
+            runChunks(scatterChunk);
+        }
+        std::swap(src, dst);
+    }
+
+    // `from` now holds the index of the command that goes at each position
+    for (size_t i = 0; i < n; i++) {
+        from[i] = src[i].index;
+    }
+
+    arena.rewind(scratch);
+    return n;
+}
+
+void RenderPass::permuteCommands(Command* const UTILS_RESTRICT begin, size_t const count,
+        uint32_t* const UTILS_RESTRICT from) noexcept {
+    // apply the permutation in place by following its cycles
+    for (uint32_t i = 0; i < count; i++) {
+        if (from[i] == i) {
+            continue;
+        }
+        Command const tmp = begin[i];
+        uint32_t j = i;
+        for (uint32_t k = from[j]; k != i; k = from[j]) {
+            begin[j] = begin[k];
+            from[j] = j;
+            j = k;
+        }
+        begin[j] = tmp;
+        from[j] = j;
+    }
+}
+
+// Whether two commands are the same, ignoring their unused fields.
+static bool isSameCommand(RenderPass::Command const& lhs, RenderPass::Command const& rhs) noexcept {
+    if (lhs.key != rhs.key) {
+        return false;
+    }
+    if (lhs.key == uint64_t(RenderPass::Pass::SENTINEL) ||
+            (lhs.key & RenderPass::CUSTOM_MASK) != uint64_t(RenderPass::CustomCommand::PASS)) {
+        // only the key of sentinels and custom commands is meaningful
+        return true;
+    }
+    RenderPass::PrimitiveInfo const& l = lhs.info;
+    RenderPass::PrimitiveInfo const& r = rhs.info;
+    return l.mi == r.mi &&
+           l.rph == r.rph &&
+           l.vbih == r.vbih &&
+           l.dsh == r.dsh &&
+           l.indexOffset == r.indexOffset &&
+           l.indexCount == r.indexCount &&
+           l.index == r.index &&
+           l.skinningOffset == r.skinningOffset &&
+           l.morphingOffset == r.morphingOffset &&
+           l.rasterState.u == r.rasterState.u &&
+           l.instanceCount == r.instanceCount &&
+           l.materialVariant == r.materialVariant &&
+           l.type == r.type &&
+           l.hasSkinning == r.hasSkinning &&
+           l.hasMorphing == r.hasMorphing &&
+           l.hasHybridInstancing == r.hasHybridInstancing;
+}
+
+void RenderPass::CommandCache::clear() noexcept {
+    mCommands.clear();
+    mCommands.shrink_to_fit();
+    mSorted.clear();
+    mSorted.shrink_to_fit();
+    mSortedIndices.clear();
+    mSortedIndices.shrink_to_fit();
+    mMerged.clear();
+    mMerged.shrink_to_fit();
+    mMergedIndices.clear();
+    mMergedIndices.shrink_to_fit();
+    mSortedCommandCount = 0;
+}
+
+RenderPass::Command* RenderPass::CommandCache::rebuild(JobSystem& js, Arena& arena,
+        Command* const begin, Command* const end) {
+    SYSTRACE_NAME("sort commands (rebuild cache)");
+
+    size_t const count = end - begin;
+    if (UTILS_UNLIKELY(!hasRadixSortScratch(js, arena, count))) {
+        // don't cache anything, so that we try again next frame
+        clear();
+        return RenderPass::sortCommands(js, arena, begin, end);
+    }
+
+    mCommands.assign(begin, end);
+
+    void* const scratch = arena.getCurrent();
+    uint32_t* const order = arena.alloc<uint32_t>(count);
+    size_t const n = sortCommandKeys(js, arena, begin, count, order);
+    mSortedIndices.assign(order, order + n);
+    permuteCommands(begin, count, order);
+    arena.rewind(scratch);
+
+    mSorted.assign(begin, begin + n);
+    mSortedCommandCount = n;
+    return begin + n;
+}
+
+RenderPass::Command* RenderPass::CommandCache::sortCommands(JobSystem& js, Arena& arena,
+        Command* const begin, Command* const end) {
+    SYSTRACE_NAME("sort commands (cached)");
+
+    // commands are generated at a position that only depends on the renderable and primitive
+    // they're for, so a change in the command count means the scene changed too much.
+    size_t const count = end - begin;
+    if (mCommands.size() != count) {
+        return rebuild(js, arena, begin, end);
+    }
+
+    void* const scratch = arena.getCurrent();
+
+    // find the commands that changed since the previous frame
+    size_t const maxChangedCount = size_t(float(mSorted.size()) * MAX_CHANGED_RATIO);
+    uint32_t* const changed = arena.alloc<uint32_t>(maxChangedCount + 1);
+    size_t changedCount = 0;
+    Command const* const UTILS_RESTRICT cached = mCommands.data();
+    for (size_t i = 0; i < count; i++) {
+        if (UTILS_UNLIKELY(!isSameCommand(begin[i], cached[i]))) {
+            if (UTILS_UNLIKELY(changedCount == maxChangedCount)) {
+                arena.rewind(scratch);
+                return rebuild(js, arena, begin, end);
+            }
+            changed[changedCount++] = uint32_t(i);
+        }
+    }
+
+    size_t addedCount = 0;
+    if (changedCount) {
+        // sort the new version of the commands that changed, sentinels are dropped
+        bool* const isChanged = arena.alloc<bool>(count);
+        std::fill_n(isChanged, count, false);
+        uint32_t* const added = arena.alloc<uint32_t>(changedCount);
+        for (size_t k = 0; k < changedCount; k++) {
+            uint32_t const i = changed[k];
+            isChanged[i] = true;
+            mCommands[i] = begin[i];
+            if (begin[i].key != uint64_t(Pass::SENTINEL)) {
+                added[addedCount++] = i;
+            }
+        }
+        std::sort(added, added + addedCount, [begin](uint32_t lhs, uint32_t rhs) {
+            return begin[lhs].key < begin[rhs].key;
+        });
+
+        // and merge them with the sorted commands that didn't change
+        Command const* const sorted = mSorted.data();
+        uint32_t const* const sortedIndices = mSortedIndices.data();
+        size_t const sortedCount = mSorted.size();
+        mMerged.clear();
+        mMergedIndices.clear();
+        mMerged.reserve(sortedCount + addedCount);
+        mMergedIndices.reserve(sortedCount + addedCount);
+        size_t i = 0;
+        size_t j = 0;
+        while (true) {
+            while (i < sortedCount && isChanged[sortedIndices[i]]) {
+                i++;
+            }
+            bool const hasSorted = i < sortedCount;
+            bool const hasAdded = j < addedCount;
+            if (!hasSorted && !hasAdded) {
+                break;
+            }
+            if (hasAdded && (!hasSorted || begin[added[j]].key < sorted[i].key)) {
+                mMerged.push_back(begin[added[j]]);
+                mMergedIndices.push_back(added[j]);
+                j++;
+            } else {
+                mMerged.push_back(sorted[i]);
+                mMergedIndices.push_back(sortedIndices[i]);
+                i++;
+            }
+        }
+        std::swap(mSorted, mMerged);
+        std::swap(mSortedIndices, mMergedIndices);
+    }
+
+    arena.rewind(scratch);
+
+    std::copy(mSorted.begin(), mSorted.end(), begin);
+    mSortedCommandCount = addedCount;
+    return begin + mSorted.size();
+}
+
 RenderPass::Command* RenderPass::instanceify(backend::DriverApi& driver,
         DescriptorSetLayoutHandle perRenderableDescriptorSetLayoutHandle,
         Command* curr, Command* const last,
@@ -902,6 +1254,21 @@ backend::Viewport RenderPass::Executor::applyScissorViewport(
     return { int32_t(s.l), int32_t(s.b), uint32_t(s.r - s.l), uint32_t(s.t - s.b) };
 }
 
+// Maximum space occupied in the CircularBuffer by a single `Command`. This must be
+// reevaluated when encode() adds DriverApi commands or when we change the
+// CommandStream protocol. Currently, the maximum is 248 bytes.
+// The batch size is calculated by adding the size of all commands that can possibly be
+// emitted per draw call:
+static constexpr size_t MAX_COMMAND_SIZE_IN_BYTES =
+        sizeof(COMMAND_TYPE(scissor)) +
+        sizeof(COMMAND_TYPE(bindDescriptorSet)) +
+        sizeof(COMMAND_TYPE(bindDescriptorSet)) +
+        sizeof(COMMAND_TYPE(bindPipeline)) +
+        sizeof(COMMAND_TYPE(bindRenderPrimitive)) +
+        sizeof(COMMAND_TYPE(bindDescriptorSet)) + backend::CustomCommand::align(sizeof(NoopCommand) + 8) +
+        sizeof(COMMAND_TYPE(setPushConstant)) +
+        sizeof(COMMAND_TYPE(draw2));
+
 UTILS_NOINLINE // no need to be inlined
 void RenderPass::Executor::execute(FEngine const& engine, backend::DriverApi& driver,
         Command const* first, Command const* last) const noexcept {
@@ -916,59 +1283,40 @@ void RenderPass::Executor::execute(FEngine const& engine, backend::DriverApi& dr
         SYSTRACE_VALUE32("commandCount", last - first);
 
         // The scissor rectangle is associated to a render pass, so the tracking can be local.
-        backend::Viewport currentScissor{ 0, 0, INT32_MAX, INT32_MAX };
-        bool const hasScissorOverride = mScissorOverride;
-        bool const hasScissorViewport = mHasScissorViewport;
-        if (UTILS_UNLIKELY(hasScissorViewport || hasScissorOverride)) {
+        EncoderState state{};
+        if (UTILS_UNLIKELY(mHasScissorViewport || mScissorOverride)) {
             // we should never have both an override and scissor-viewport
-            assert_invariant(!hasScissorViewport || !hasScissorOverride);
-            currentScissor = mScissor;
+            assert_invariant(!mHasScissorViewport || !mScissorOverride);
+            state.currentScissor = mScissor;
             driver.scissor(mScissor);
         }
 
-        bool const polygonOffsetOverride = mPolygonOffsetOverride;
-        PipelineState pipeline{
-                // initialize with polygon offset override
-                .polygonOffset = mPolygonOffset,
-        };
-
-        pipeline.pipelineLayout.setLayout[+DescriptorSetBindingPoints::PER_RENDERABLE] =
+        // initialize with polygon offset override
+        state.pipeline.polygonOffset = mPolygonOffset;
+        state.pipeline.pipelineLayout.setLayout[+DescriptorSetBindingPoints::PER_RENDERABLE] =
                 engine.getPerRenderableDescriptorSetLayout().getHandle();
 
-        PipelineState currentPipeline{};
-        Handle<HwRenderPrimitive> currentPrimitiveHandle{};
-
-        FMaterialInstance const* UTILS_RESTRICT mi = nullptr;
-        FMaterial const* UTILS_RESTRICT ma = nullptr;
-        auto const* UTILS_RESTRICT pCustomCommands = mCustomCommands.data();
-
-        // Maximum space occupied in the CircularBuffer by a single `Command`. This must be
-        // reevaluated when the inner loop below adds DriverApi commands or when we change the
-        // CommandStream protocol. Currently, the maximum is 248 bytes.
-        // The batch size is calculated by adding the size of all commands that can possibly be
-        // emitted per draw call:
-        constexpr size_t const maxCommandSizeInBytes =
-                sizeof(COMMAND_TYPE(scissor)) +
-                sizeof(COMMAND_TYPE(bindDescriptorSet)) +
-                sizeof(COMMAND_TYPE(bindDescriptorSet)) +
-                sizeof(COMMAND_TYPE(bindPipeline)) +
-                sizeof(COMMAND_TYPE(bindRenderPrimitive)) +
-                sizeof(COMMAND_TYPE(bindDescriptorSet)) + backend::CustomCommand::align(sizeof(NoopCommand) + 8) +
-                sizeof(COMMAND_TYPE(setPushConstant)) +
-                sizeof(COMMAND_TYPE(draw2));
-
+        // Space needed to terminate the ranges encoded in parallel
+        constexpr size_t terminatorsSizeInBytes =
+                MAX_ENCODING_CHUNK_COUNT * DriverApi::getTerminatorSize();
 
         // Number of Commands that can be issued and guaranteed to fit in the current
         // CircularBuffer allocation. In practice, we'll have tons of headroom especially if
         // skinning and morphing aren't used. With a 2 MiB buffer (the default) a batch is
         // 6553 commands (i.e. draw calls).
-        size_t const batchCommandCount = capacity / maxCommandSizeInBytes;
+        size_t const batchCommandCount =
+                (capacity - terminatorsSizeInBytes) / MAX_COMMAND_SIZE_IN_BYTES;
+
+        JobSystem& js = engine.getJobSystem();
+        size_t const maxChunkCount = std::min(MAX_ENCODING_CHUNK_COUNT, js.getThreadCount() + 1);
+
         while(first != last) {
             Command const* const batchLast = std::min(first + batchCommandCount, last);
 
             // actual number of commands we need to write (can be smaller than batchCommandCount)
             size_t const commandCount = batchLast - first;
-            size_t const commandSizeInBytes = commandCount * maxCommandSizeInBytes;
+            size_t const commandSizeInBytes =
+                    commandCount * MAX_COMMAND_SIZE_IN_BYTES + terminatorsSizeInBytes;
 
             // check we have enough capacity to write these commandCount commands, if not,
             // request a new CircularBuffer allocation of `capacity` bytes.
@@ -978,136 +1326,267 @@ void RenderPass::Executor::execute(FEngine const& engine, backend::DriverApi& dr
                 const_cast<FEngine&>(engine).flush();
             }
 
-            first--;
-            while (++first != batchLast) {
-                assert_invariant(first->key != uint64_t(Pass::SENTINEL));
+            // Large batches are encoded in parallel when possible
+            size_t const chunkCount = std::min(maxChunkCount,
+                    commandCount / MIN_ENCODING_CHUNK_SIZE);
+            if (commandCount >= PARALLEL_ENCODING_THRESHOLD && chunkCount > 1 &&
+                    prepareParallelEncoding(first, batchLast)) {
+                encodeParallel(engine, driver, state, first, batchLast, chunkCount);
+            } else {
+                encode(engine, driver, state, first, batchLast);
+            }
+            first = batchLast;
+        }
 
-                /*
-                 * Be careful when changing code below, this is the hot inner-loop
-                 */
+        // If the remaining space is less than half the capacity, we flush right away to
+        // allow some headroom for commands that might come later.
+        if (UTILS_UNLIKELY(circularBuffer.getUsed() > capacity / 2)) {
+            // FIXME: eventually we can't flush here because this will be a secondary
+            //        command buffer.
+            const_cast<FEngine&>(engine).flush();
+        }
+    }
+}
 
-                if (UTILS_UNLIKELY((first->key & CUSTOM_MASK) != uint64_t(CustomCommand::PASS))) {
-                    mi = nullptr; // custom command could change the currently bound MaterialInstance
-                    uint32_t const index = (first->key & CUSTOM_INDEX_MASK) >> CUSTOM_INDEX_SHIFT;
-                    assert_invariant(index < mCustomCommands.size());
-                    pCustomCommands[index]();
-                    continue;
-                }
+bool RenderPass::Executor::prepareParallelEncoding(
+        Command const* first, Command const* last) const noexcept {
+    SYSTRACE_CALL();
 
-                // primitiveHandle may be invalid if no geometry was set on the renderable.
-                if (UTILS_UNLIKELY(!first->info.rph)) {
-                    continue;
-                }
+    FMaterialInstance const* mi = nullptr;
+    for (Command const* command = first; command != last; ++command) {
+        // custom commands can only be called from this thread
+        if (UTILS_UNLIKELY((command->key & CUSTOM_MASK) != uint64_t(CustomCommand::PASS))) {
+            return false;
+        }
+        if (UTILS_UNLIKELY(!command->info.rph)) {
+            continue;
+        }
+        if (UTILS_UNLIKELY(mi != command->info.mi)) {
+            mi = command->info.mi;
+            FMaterial const* const ma = mi->getMaterial();
+            // the post-process descriptor-set is not prepared here, these are rare anyway
+            if (UTILS_UNLIKELY(ma->getMaterialDomain() == MaterialDomain::POST_PROCESS)) {
+                return false;
+            }
+            // encode() binds the same descriptor sets, which is now free of side effects.
+            if (mColorPassDescriptorSet) {
+                mColorPassDescriptorSet->validateBind(ma->getPerViewLayoutIndex());
+            }
+            mi->prepareUse();
+        }
+    }
+    return true;
+}
 
-                // per-renderable uniform
-                PrimitiveInfo const info = first->info;
-                pipeline.rasterState = info.rasterState;
-                pipeline.vertexBufferInfo = info.vbih;
-                pipeline.primitiveType = info.type;
-                assert_invariant(pipeline.vertexBufferInfo);
-
-                if (UTILS_UNLIKELY(mi != info.mi)) {
-                    // this is always taken the first time
-                    assert_invariant(info.mi);
-
-                    mi = info.mi;
-                    ma = mi->getMaterial();
-
-                    // if we have the scissor override, the material instance and scissor-viewport
-                    // are ignored (typically used for shadow maps).
-                    if (!hasScissorOverride) {
-                        // apply the MaterialInstance scissor
-                        backend::Viewport scissor = mi->getScissor();
-                        if (hasScissorViewport) {
-                            // apply the scissor viewport if any
-                            scissor = applyScissorViewport(mScissor, scissor);
-                        }
-                        if (scissor != currentScissor) {
-                            currentScissor = scissor;
-                            driver.scissor(scissor);
-                        }
-                    }
-
-                    if (UTILS_LIKELY(!polygonOffsetOverride)) {
-                        pipeline.polygonOffset = mi->getPolygonOffset();
-                    }
-                    pipeline.stencilState = mi->getStencilState();
-
-                    // Each material has its own version of the per-view descriptor-set layout,
-                    // because it depends on the material features (e.g. lit/unlit)
-                    pipeline.pipelineLayout.setLayout[+DescriptorSetBindingPoints::PER_VIEW] =
-                            ma->getPerViewDescriptorSetLayout(info.materialVariant).getHandle();
-
-                    // Each material has a per-material descriptor-set layout which encodes the
-                    // material's parameters (ubo and samplers)
-                    pipeline.pipelineLayout.setLayout[+DescriptorSetBindingPoints::PER_MATERIAL] =
-                            ma->getDescriptorSetLayout().getHandle();
-
-                    if (UTILS_UNLIKELY(ma->getMaterialDomain() == MaterialDomain::POST_PROCESS)) {
-                        // It is possible to get a post-process material here (even though it's
-                        // not technically a public API yet, it is used by the IBLPrefilterLibrary.
-                        // Ideally we would have a more formal compute API). In this case, we need
-                        // to set the post-process descriptor-set.
-                        engine.getPostProcessManager().bindPostProcessDescriptorSet(driver);
-                    } else {
-                        // If we have a ColorPassDescriptorSet we use it to bind the per-view
-                        // descriptor-set (ideally only if it changed). If we don't, it means
-                        // the descriptor-set is already bound and the layout we got from the
-                        // material above should match. This is the case for situations where we
-                        // have a known per-view descriptor-set layout, e.g.: shadow-maps, ssr and
-                        // structure passes.
-                        if (mColorPassDescriptorSet) {
-                            // We have a ColorPassDescriptorSet, we need to go through it for binding
-                            // the per-view descriptor-set because its layout can change based on the
-                            // material.
-                            mColorPassDescriptorSet->bind(driver, ma->getPerViewLayoutIndex());
-                        }
-                    }
-
-                    // Each MaterialInstance has its own descriptor set. This binds it.
-                    mi->use(driver);
-                }
+void RenderPass::Executor::encodeParallel(FEngine const& engine, backend::DriverApi& driver,
+        EncoderState& state, Command const* first, Command const* last,
+        size_t chunkCount) const noexcept {
+    SYSTRACE_CALL();
 
-                assert_invariant(ma);
-                pipeline.program = ma->getProgram(info.materialVariant);
+    assert_invariant(chunkCount <= MAX_ENCODING_CHUNK_COUNT);
 
-                if (UTILS_UNLIKELY(memcmp(&pipeline, &currentPipeline, sizeof(PipelineState)) != 0)) {
-                    currentPipeline = pipeline;
-                    driver.bindPipeline(pipeline);
-                }
+    struct Chunk {
+        Command const* first;
+        Command const* last;
+        CircularBuffer::Range range;
+        EncoderState state;
+    };
 
-                if (UTILS_UNLIKELY(info.rph != currentPrimitiveHandle)) {
-                    currentPrimitiveHandle = info.rph;
-                    driver.bindRenderPrimitive(info.rph);
-                }
+    // Reserve a range of the CommandStream for each chunk, in order, so that once each range
+    // is terminated with a jump to the next one, they're executed as if they had been encoded
+    // serially. No synchronization is needed besides waiting for all chunks to be encoded.
+    Chunk chunks[MAX_ENCODING_CHUNK_COUNT];
+    size_t const commandCount = last - first;
+    size_t const chunkSize = (commandCount + chunkCount - 1) / chunkCount;
+    for (size_t i = 0; i < chunkCount; i++) {
+        Chunk& chunk = chunks[i];
+        chunk.first = first + std::min(commandCount, i * chunkSize);
+        chunk.last = first + std::min(commandCount, (i + 1) * chunkSize);
+        chunk.range = driver.reserve((chunk.last - chunk.first) * MAX_COMMAND_SIZE_IN_BYTES +
+                DriverApi::getTerminatorSize());
+        // Only the first chunk knows what's bound, the others must bind everything they need.
+        // The scissor override or viewport is set by execute() and never changes.
+        chunk.state = state;
+        if (i) {
+            chunk.state.currentPipeline = {};
+            chunk.state.currentPrimitiveHandle = {};
+            chunk.state.mi = nullptr;
+            chunk.state.ma = nullptr;
+            chunk.state.hasCurrentScissor = false;
+        }
+    }
 
-                // Bind per-renderable uniform block. There is no need to attempt to skip this command
-                // because the backends already do this.
-                uint32_t const offset = info.hasHybridInstancing ?
-                                      0 : info.index * sizeof(PerRenderableData);
+    auto encodeChunk = [this, &engine, &driver](Chunk& chunk) {
+        size_t const size = uintptr_t(chunk.range.head) - uintptr_t(chunk.range.tail);
+        CircularBuffer buffer(chunk.range.tail, size);
+        DriverApi stream(driver, buffer);
+        encode(engine, stream, chunk.state, chunk.first, chunk.last);
+        stream.terminate(chunk.range.head);
+    };
+
+    JobSystem& js = engine.getJobSystem();
+    JobSystem::Job* parent = js.createJob();
+    JobSystem::Job* jobs[MAX_ENCODING_CHUNK_COUNT];
+    for (size_t i = 1; i < chunkCount; i++) {
+        jobs[i - 1] = jobs::createJob(js, parent, std::cref(encodeChunk), std::ref(chunks[i]));
+    }
+    js.run(jobs, chunkCount - 1);
+
+    // the first chunk is encoded on this thread
+    encodeChunk(chunks[0]);
+
+    js.runAndWait(parent);
+
+    // we continue with the state at the end of the last chunk
+    state = chunks[chunkCount - 1].state;
+}
+
+void RenderPass::Executor::encode(FEngine const& engine, backend::DriverApi& driver,
+        EncoderState& state, Command const* first, Command const* last) const noexcept {
+
+    bool const hasScissorViewport = mHasScissorViewport;
+    bool const hasScissorOverride = mScissorOverride;
+    bool const polygonOffsetOverride = mPolygonOffsetOverride;
+
+    PipelineState pipeline = state.pipeline;
+    PipelineState currentPipeline = state.currentPipeline;
+    Handle<HwRenderPrimitive> currentPrimitiveHandle = state.currentPrimitiveHandle;
+    backend::Viewport currentScissor = state.currentScissor;
+    bool hasCurrentScissor = state.hasCurrentScissor;
 
-                assert_invariant(info.dsh);
-                driver.bindDescriptorSet(info.dsh,
-                        +DescriptorSetBindingPoints::PER_RENDERABLE,
-                        {{ offset, info.skinningOffset }, driver});
+    FMaterialInstance const* UTILS_RESTRICT mi = state.mi;
+    FMaterial const* UTILS_RESTRICT ma = state.ma;
+    auto const* UTILS_RESTRICT pCustomCommands = mCustomCommands.data();
+
+    first--;
+    while (++first != last) {
+        assert_invariant(first->key != uint64_t(Pass::SENTINEL));
+
+        /*
+         * Be careful when changing code below, this is the hot inner-loop
+         */
+
+        if (UTILS_UNLIKELY((first->key & CUSTOM_MASK) != uint64_t(CustomCommand::PASS))) {
+            mi = nullptr; // custom command could change the currently bound MaterialInstance
+            uint32_t const index = (first->key & CUSTOM_INDEX_MASK) >> CUSTOM_INDEX_SHIFT;
+            assert_invariant(index < mCustomCommands.size());
+            pCustomCommands[index]();
+            continue;
+        }
+
+        // primitiveHandle may be invalid if no geometry was set on the renderable.
+        if (UTILS_UNLIKELY(!first->info.rph)) {
+            continue;
+        }
 
-                if (UTILS_UNLIKELY(info.hasMorphing)) {
-                    driver.setPushConstant(ShaderStage::VERTEX,
-                            +PushConstantIds::MORPHING_BUFFER_OFFSET, int32_t(info.morphingOffset));
+        // per-renderable uniform
+        PrimitiveInfo const info = first->info;
+        pipeline.rasterState = info.rasterState;
+        pipeline.vertexBufferInfo = info.vbih;
+        pipeline.primitiveType = info.type;
+        assert_invariant(pipeline.vertexBufferInfo);
+
+        if (UTILS_UNLIKELY(mi != info.mi)) {
+            // this is always taken the first time
+            assert_invariant(info.mi);
+
+            mi = info.mi;
+            ma = mi->getMaterial();
+
+            // if we have the scissor override, the material instance and scissor-viewport
+            // are ignored (typically used for shadow maps).
+            if (!hasScissorOverride) {
+                // apply the MaterialInstance scissor
+                backend::Viewport scissor = mi->getScissor();
+                if (hasScissorViewport) {
+                    // apply the scissor viewport if any
+                    scissor = applyScissorViewport(mScissor, scissor);
                 }
+                if (scissor != currentScissor || !hasCurrentScissor) {
+                    currentScissor = scissor;
+                    hasCurrentScissor = true;
+                    driver.scissor(scissor);
+                }
+            }
 
-                driver.draw2(info.indexOffset, info.indexCount, info.instanceCount);
+            if (UTILS_LIKELY(!polygonOffsetOverride)) {
+                pipeline.polygonOffset = mi->getPolygonOffset();
             }
+            pipeline.stencilState = mi->getStencilState();
+
+            // Each material has its own version of the per-view descriptor-set layout,
+            // because it depends on the material features (e.g. lit/unlit)
+            pipeline.pipelineLayout.setLayout[+DescriptorSetBindingPoints::PER_VIEW] =
+                    ma->getPerViewDescriptorSetLayout(info.materialVariant).getHandle();
+
+            // Each material has a per-material descriptor-set layout which encodes the
+            // material's parameters (ubo and samplers)
+            pipeline.pipelineLayout.setLayout[+DescriptorSetBindingPoints::PER_MATERIAL] =
+                    ma->getDescriptorSetLayout().getHandle();
+
+            if (UTILS_UNLIKELY(ma->getMaterialDomain() == MaterialDomain::POST_PROCESS)) {
+                // It is possible to get a post-process material here (even though it's
+                // not technically a public API yet, it is used by the IBLPrefilterLibrary.
+                // Ideally we would have a more formal compute API). In this case, we need
+                // to set the post-process descriptor-set.
+                engine.getPostProcessManager().bindPostProcessDescriptorSet(driver);
+            } else {
+                // If we have a ColorPassDescriptorSet we use it to bind the per-view
+                // descriptor-set (ideally only if it changed). If we don't, it means
+                // the descriptor-set is already bound and the layout we got from the
+                // material above should match. This is the case for situations where we
+                // have a known per-view descriptor-set layout, e.g.: shadow-maps, ssr and
+                // structure passes.
+                if (mColorPassDescriptorSet) {
+                    // We have a ColorPassDescriptorSet, we need to go through it for binding
+                    // the per-view descriptor-set because its layout can change based on the
+                    // material.
+                    mColorPassDescriptorSet->bind(driver, ma->getPerViewLayoutIndex());
+                }
+            }
+
+            // Each MaterialInstance has its own descriptor set. This binds it.
+            mi->use(driver);
         }
 
-        // If the remaining space is less than half the capacity, we flush right away to
-        // allow some headroom for commands that might come later.
-        if (UTILS_UNLIKELY(circularBuffer.getUsed() > capacity / 2)) {
-            // FIXME: eventually we can't flush here because this will be a secondary
-            //        command buffer.
-            const_cast<FEngine&>(engine).flush();
+        assert_invariant(ma);
+        pipeline.program = ma->getProgram(info.materialVariant);
+
+        if (UTILS_UNLIKELY(memcmp(&pipeline, &currentPipeline, sizeof(PipelineState)) != 0)) {
+            currentPipeline = pipeline;
+            driver.bindPipeline(pipeline);
+        }
+
+        if (UTILS_UNLIKELY(info.rph != currentPrimitiveHandle)) {
+            currentPrimitiveHandle = info.rph;
+            driver.bindRenderPrimitive(info.rph);
+        }
+
+        // Bind per-renderable uniform block. There is no need to attempt to skip this command
+        // because the backends already do this.
+        uint32_t const offset = info.hasHybridInstancing ?
+                              0 : info.index * sizeof(PerRenderableData);
+
+        assert_invariant(info.dsh);
+        driver.bindDescriptorSet(info.dsh,
+                +DescriptorSetBindingPoints::PER_RENDERABLE,
+                {{ offset, info.skinningOffset }, driver});
+
+        if (UTILS_UNLIKELY(info.hasMorphing)) {
+            driver.setPushConstant(ShaderStage::VERTEX,
+                    +PushConstantIds::MORPHING_BUFFER_OFFSET, int32_t(info.morphingOffset));
         }
+
+        driver.draw2(info.indexOffset, info.indexCount, info.instanceCount);
     }
+
+    state.pipeline = pipeline;
+    state.currentPipeline = currentPipeline;
+    state.currentPrimitiveHandle = currentPrimitiveHandle;
+    state.currentScissor = currentScissor;
+    state.hasCurrentScissor = hasCurrentScissor;
+    state.mi = mi;
+    state.ma = ma;
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -29,6 +29,7 @@
 #include <backend/DriverApiForward.h>
 #include <backend/DriverEnums.h>
 #include <backend/Handle.h>
+#include <backend/PipelineState.h>
 
 #include <utils/Allocator.h>
 #include <utils/BitmaskEnum.h>
@@ -50,12 +51,17 @@
 #include <stddef.h>
 #include <stdint.h>
 
+namespace utils {
+class JobSystem;
+} // namespace utils
+
 namespace filament {
 
 namespace backend {
 class CommandBufferQueue;
 }
 
+class FMaterial;
 class FMaterialInstance;
 class FRenderPrimitive;
 class RenderPassBuilder;
@@ -295,6 +301,69 @@ public:
             utils::TrackingPolicy::HighWatermark,
             utils::AreaPolicy::StaticArea>;
 
+    // Above this many commands, sortCommands() radix sorts (key, index) pairs instead of
+    // comparison sorting the commands themselves.
+    static constexpr size_t RADIX_SORT_THRESHOLD = 2048;
+
+    // Above this many commands, the radix sort is split across the JobSystem.
+    static constexpr size_t RADIX_SORT_PARALLEL_THRESHOLD = 65536;
+
+    // Sorts commands then trims sentinels, picking the fastest method for the command count.
+    // Scratch memory may be allocated from `arena`, it's released before returning. If `arena`
+    // is too small for the radix sort's scratch memory, the comparison sort is used instead.
+    static Command* sortCommands(utils::JobSystem& js, Arena& arena,
+            Command* begin, Command* end) noexcept;
+
+    // Sorts commands with a comparison sort then trims sentinels.
+    static Command* sortCommands(Command* begin, Command* end) noexcept;
+
+    // Sorts commands then trims sentinels. Sentinels are dropped first, then (key, index) pairs
+    // are radix sorted, and finally the commands are permuted in place, so that each 64 bytes
+    // command moves at most once. The result is the same as sortCommands(), except that
+    // commands with equal keys keep their relative order.
+    static Command* sortCommandsRadix(utils::JobSystem& js, Arena& arena,
+            Command* begin, Command* end) noexcept;
+
+    /*
+     * Keeps the sorted commands of a pass from one frame to the next (see
+     * RenderPassBuilder::commandCache()).
+     *
+     * Commands are still generated every frame, but they're compared with the ones from the
+     * previous frame, and only those that changed are sorted and merged with the previous
+     * sorted commands. When the camera doesn't move, most commands don't change. When it
+     * does, the blended commands are re-keyed with their new distance and end-up re-sorted
+     * separately, while most opaque commands stay in the same depth bucket.
+     */
+    class CommandCache {
+    public:
+        // Above this ratio of changed commands, all commands are sorted again.
+        static constexpr float MAX_CHANGED_RATIO = 0.25f;
+
+        // releases all the cached commands
+        void clear() noexcept;
+
+        // number of commands that were sorted by the last pass, for statistics
+        size_t getSortedCommandCount() const noexcept { return mSortedCommandCount; }
+
+    private:
+        friend class RenderPass;
+
+        // Like RenderPass::sortCommands(), but reuses the previous frame's work.
+        Command* sortCommands(utils::JobSystem& js, Arena& arena,
+                Command* begin, Command* end);
+
+        // Sorts all commands and caches them.
+        Command* rebuild(utils::JobSystem& js, Arena& arena,
+                Command* begin, Command* end);
+
+        std::vector<Command> mCommands;         // the last generated commands
+        std::vector<Command> mSorted;           // same, sorted and without sentinels
+        std::vector<uint32_t> mSortedIndices;   // index in mCommands of each mSorted entry
+        std::vector<Command> mMerged;           // scratch, kept to avoid reallocations
+        std::vector<uint32_t> mMergedIndices;   // scratch, kept to avoid reallocations
+        size_t mSortedCommandCount = 0;
+    };
+
     // RenderPass can only be moved
     RenderPass(RenderPass&& rhs) = default;
     RenderPass& operator=(RenderPass&& rhs) = delete;  // could be supported if needed
@@ -356,11 +425,44 @@ public:
         // whether the scissor-viewport is set
         bool mHasScissorViewport : 1;
 
+        // Batches of at least this many commands are encoded in parallel
+        static constexpr size_t PARALLEL_ENCODING_THRESHOLD = 4096;
+        // Minimum number of commands encoded by each job
+        static constexpr size_t MIN_ENCODING_CHUNK_SIZE = 1024;
+        // Maximum number of jobs a batch is split into
+        static constexpr size_t MAX_ENCODING_CHUNK_COUNT = 16;
+
+        // What's currently bound, which is carried over from one command to the next
+        struct EncoderState {
+            backend::PipelineState pipeline;
+            backend::PipelineState currentPipeline{};
+            backend::Handle<backend::HwRenderPrimitive> currentPrimitiveHandle{};
+            backend::Viewport currentScissor{ 0, 0, INT32_MAX, INT32_MAX };
+            // false if the scissor is unknown and must be set
+            bool hasCurrentScissor = true;
+            FMaterialInstance const* mi = nullptr;
+            FMaterial const* ma = nullptr;
+        };
+
         Executor(RenderPass const& pass, Command const* b, Command const* e) noexcept;
 
         void execute(FEngine const& engine, backend::DriverApi& driver,
                 Command const* first, Command const* last) const noexcept;
 
+        void encode(FEngine const& engine, backend::DriverApi& driver, EncoderState& state,
+                Command const* first, Command const* last) const noexcept;
+
+        // Returns whether [first, last) can be encoded in parallel, i.e. it has no custom
+        // commands and no post-process materials. If so, binding its materials and descriptor
+        // sets no longer modifies them, which is done here, on the calling thread.
+        bool prepareParallelEncoding(Command const* first, Command const* last) const noexcept;
+
+        // Splits [first, last) in chunkCount chunks encoded in parallel, the batch must have
+        // been accepted by prepareParallelEncoding().
+        void encodeParallel(FEngine const& engine, backend::DriverApi& driver,
+                EncoderState& state, Command const* first, Command const* last,
+                size_t chunkCount) const noexcept;
+
         static backend::Viewport applyScissorViewport(
                 backend::Viewport const& scissorViewport,
                 backend::Viewport const& scissor) noexcept;
@@ -421,9 +523,18 @@ private:
 
     static Command* resize(Arena& arena, Command* last) noexcept;
 
-    // sorts commands then trims sentinels
-    static Command* sortCommands(
-            Command* begin, Command* end) noexcept;
+    // Sorts the keys of commands and writes into `order` the index of the command that must go
+    // at each position. Returns the number of commands that aren't sentinels.
+    static size_t sortCommandKeys(utils::JobSystem& js, Arena& arena,
+            Command const* commands, size_t count, uint32_t* order) noexcept;
+
+    // Whether `arena` has room for the scratch memory of sortCommandKeys() and its `order`
+    // output, so that the radix sort doesn't fall back to the heap.
+    static bool hasRadixSortScratch(utils::JobSystem const& js, Arena const& arena,
+            size_t count) noexcept;
+
+    // Moves each command to its position given by sortCommandKeys(), `order` is destroyed.
+    static void permuteCommands(Command* commands, size_t count, uint32_t* order) noexcept;
 
     // instanceify commands then trims sentinels
     RenderPass::Command* instanceify(backend::DriverApi& driver,
@@ -485,6 +596,7 @@ class RenderPassBuilder {
     Variant mVariant{};
     ColorPassDescriptorSet const* mColorPassDescriptorSet = nullptr;
     FScene::VisibleMaskType mVisibilityMask = std::numeric_limits<FScene::VisibleMaskType>::max();
+    RenderPass::CommandCache* mCommandCache = nullptr;
 
     using CustomCommandRecord = std::tuple<
             uint8_t,
@@ -564,6 +676,14 @@ public:
         return *this;
     }
 
+    // Reuses the sorted commands of the previous pass built with the same cache when few of
+    // them changed. The cache must outlive the RenderPass built. Only one pass at a time should
+    // use a given cache, since it is updated by each pass.
+    RenderPassBuilder& commandCache(RenderPass::CommandCache* cache) noexcept {
+        mCommandCache = cache;
+        return *this;
+    }
+
     RenderPassBuilder& customCommand(
             uint8_t channel,
             RenderPass::Pass pass,
@@ -0,0 +1,315 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RenderableBvh.h"
+
+#include <filament/Frustum.h>
+
+#include <utils/debug.h>
+#include <utils/JobSystem.h>
+#include <utils/Systrace.h>
+
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+
+using namespace filament::math;
+using namespace utils;
+
+namespace filament {
+
+// Depth-first traversals never need more entries than the depth of the tree plus one, and
+// the tree is balanced.
+static constexpr size_t MAX_STACK_DEPTH = 64;
+
+static constexpr uint32_t ALL_PLANES = 0x3F;
+static constexpr uint32_t OUTSIDE = ~0u;
+
+// Returns the planes of `planeMask` the box straddles, or OUTSIDE if the box is entirely on
+// the outside of one of them. This is consistent with Culler::intersects().
+static inline uint32_t classify(float4 const* UTILS_RESTRICT planes,
+        float3 const& min, float3 const& max, uint32_t planeMask) noexcept {
+    uint32_t straddling = 0;
+    for (size_t j = 0; j < 6; j++) {
+        if (planeMask & (1u << j)) {
+            float4 const p = planes[j];
+            // corners of the box the closest and farthest along the plane's normal
+            float3 const near{ p.x >= 0 ? min.x : max.x, p.y >= 0 ? min.y : max.y,
+                               p.z >= 0 ? min.z : max.z };
+            float3 const far { p.x >= 0 ? max.x : min.x, p.y >= 0 ? max.y : min.y,
+                               p.z >= 0 ? max.z : min.z };
+            if (dot(p.xyz, near) + p.w >= 0) {
+                return OUTSIDE;
+            }
+            if (dot(p.xyz, far) + p.w >= 0) {
+                straddling |= 1u << j;
+            }
+        }
+    }
+    return straddling;
+}
+
+void RenderableBvh::clear() noexcept {
+    mNodes.clear();
+    mNodes.shrink_to_fit();
+    mLeaves.clear();
+    mLeaves.shrink_to_fit();
+    mCount = 0;
+    mBuildCost = 0.0f;
+    mCost = 0.0f;
+}
+
+void RenderableBvh::build(float3 const* center, size_t count, uint32_t* order) {
+    SYSTRACE_CALL();
+
+    mNodes.clear();
+    mLeaves.clear();
+    mCount = count;
+    mBuildCost = -1.0f; // set by the first refit()
+    mCost = 0.0f;
+    if (!count) {
+        return;
+    }
+
+    std::iota(order, order + count, 0u);
+    size_t const leafCount = (count + LEAF_SIZE - 1) / LEAF_SIZE;
+    mNodes.reserve(2 * leafCount - 1);
+    mLeaves.reserve(leafCount);
+    buildRecursive(center, order, 0, uint32_t(count));
+}
+
+uint32_t RenderableBvh::buildRecursive(float3 const* center, uint32_t* order,
+        uint32_t first, uint32_t last) noexcept {
+    uint32_t const index = uint32_t(mNodes.size());
+    mNodes.push_back({ {}, {}, first, last, 0 });
+    if (last - first <= LEAF_SIZE) {
+        mLeaves.push_back(index);
+        return index;
+    }
+
+    // split along the largest axis of the centers' bounds...
+    float3 lo{ std::numeric_limits<float>::max() };
+    float3 hi{ std::numeric_limits<float>::lowest() };
+    for (uint32_t i = first; i < last; i++) {
+        lo = min(lo, center[order[i]]);
+        hi = max(hi, center[order[i]]);
+    }
+    float3 const d = hi - lo;
+    size_t const axis = d.x >= d.y ? (d.x >= d.z ? 0 : 2) : (d.y >= d.z ? 1 : 2);
+
+    // ...at the median, rounded so that leaves start on a multiple of LEAF_SIZE
+    uint32_t const half = (last - first) / 2;
+    uint32_t const mid = first + uint32_t((half + LEAF_SIZE - 1) / LEAF_SIZE * LEAF_SIZE);
+    assert_invariant(mid > first && mid < last);
+    std::nth_element(order + first, order + mid, order + last,
+            [center, axis](uint32_t a, uint32_t b) {
+                return center[a][axis] < center[b][axis];
+            });
+
+    buildRecursive(center, order, first, mid);
+    uint32_t const right = buildRecursive(center, order, mid, last);
+    mNodes[index].right = right;
+    return index;
+}
+
+void RenderableBvh::refit(JobSystem& js,
+        float3 const* center, float3 const* extent, size_t count) noexcept {
+    SYSTRACE_CALL();
+    assert_invariant(count == mCount);
+
+    if (mNodes.empty()) {
+        return;
+    }
+
+    Node* const UTILS_RESTRICT nodes = mNodes.data();
+
+    auto refitLeaves = [nodes, center, extent](uint32_t const* leaves, uint32_t c) {
+        for (uint32_t l = 0; l < c; l++) {
+            Node& node = nodes[leaves[l]];
+            float3 lo{ std::numeric_limits<float>::max() };
+            float3 hi{ std::numeric_limits<float>::lowest() };
+            for (uint32_t i = node.first; i < node.last; i++) {
+                lo = min(lo, center[i] - extent[i]);
+                hi = max(hi, center[i] + extent[i]);
+            }
+            node.min = lo;
+            node.max = hi;
+        }
+    };
+
+    auto* job = jobs::parallel_for(js, nullptr, mLeaves.data(), uint32_t(mLeaves.size()),
+            std::cref(refitLeaves), jobs::CountSplitter<64>());
+    js.runAndWait(job);
+
+    // children are always stored after their parent
+    float cost = 0.0f;
+    for (size_t i = mNodes.size(); i-- > 0;) {
+        Node& node = nodes[i];
+        if (node.right) {
+            node.min = min(nodes[i + 1].min, nodes[node.right].min);
+            node.max = max(nodes[i + 1].max, nodes[node.right].max);
+        }
+        float3 const d = node.max - node.min;
+        cost += d.x * d.y + d.y * d.z + d.z * d.x;
+    }
+
+    mCost = cost;
+    if (mBuildCost < 0.0f) {
+        mBuildCost = cost;
+    }
+}
+
+void RenderableBvh::setRange(Culler::result_type* UTILS_RESTRICT results,
+        size_t first, size_t last, size_t bit, bool value) noexcept {
+    auto const mask = Culler::result_type(1u << bit);
+    auto const v = Culler::result_type(value ? mask : 0u);
+    for (size_t i = first; i < last; i++) {
+        results[i] = Culler::result_type((results[i] & ~mask) | v);
+    }
+}
+
+void RenderableBvh::intersectsSubtree(uint32_t root, Culler::result_type* results,
+        Frustum const& frustum, float3 const* center, float3 const* extent,
+        size_t bit) const noexcept {
+    float4 const* const planes = frustum.getNormalizedPlanes();
+    Node const* const nodes = mNodes.data();
+
+    struct Entry {
+        uint32_t node;
+        uint32_t planeMask; // planes the parent straddles, others needn't be tested
+    };
+    Entry stack[MAX_STACK_DEPTH];
+    size_t top = 0;
+    stack[top++] = { root, ALL_PLANES };
+
+    while (top) {
+        Entry const entry = stack[--top];
+        Node const& node = nodes[entry.node];
+        uint32_t const straddling = classify(planes, node.min, node.max, entry.planeMask);
+        if (straddling == OUTSIDE) {
+            setRange(results, node.first, node.last, bit, false);
+        } else if (!straddling) {
+            setRange(results, node.first, node.last, bit, true);
+        } else if (!node.right) {
+            // leaves start on a multiple of LEAF_SIZE, so the rounding performed by the
+            // Culler never spills into another leaf
+            Culler::intersects(results + node.first, frustum,
+                    center + node.first, extent + node.first, node.last - node.first, bit);
+        } else {
+            assert_invariant(top + 2 <= MAX_STACK_DEPTH);
+            stack[top++] = { node.right, straddling };
+            stack[top++] = { entry.node + 1, straddling };
+        }
+    }
+}
+
+void RenderableBvh::intersects(JobSystem& js, Culler::result_type* results,
+        Frustum const& frustum, float3 const* center, float3 const* extent, size_t bit,
+        size_t parallelThreshold) const noexcept {
+    SYSTRACE_CALL();
+
+    if (mNodes.empty()) {
+        return;
+    }
+
+    size_t const threadCount = js.getThreadCount();
+    if (mCount < parallelThreshold || threadCount <= 1) {
+        intersectsSubtree(0, results, frustum, center, extent, bit);
+        return;
+    }
+
+    // Below this size, a subtree doesn't amortize the cost of its job.
+    constexpr size_t MIN_CHUNK_SIZE = 2048;
+
+    // Hand subtrees of about `chunkSize` boxes to the JobSystem, aiming for a couple per thread
+    // so that work-stealing can balance the load. Subtrees cover whole leaves, so jobs never
+    // write the same results.
+    size_t const chunkSize = std::max(MIN_CHUNK_SIZE,
+            (mCount + threadCount * 2 - 1) / (threadCount * 2));
+
+    auto subtree = [this, results, &frustum, center, extent, bit](uint32_t root) {
+        intersectsSubtree(root, results, frustum, center, extent, bit);
+    };
+
+    JobSystem::Job* parent = js.createJob();
+    uint32_t stack[MAX_STACK_DEPTH];
+    size_t top = 0;
+    stack[top++] = 0;
+    while (top) {
+        uint32_t const index = stack[--top];
+        Node const& node = mNodes[index];
+        if (!node.right || node.last - node.first <= chunkSize) {
+            js.run(js.createJob(parent, [&subtree, index](JobSystem&, JobSystem::Job*) {
+                subtree(index);
+            }));
+        } else {
+            assert_invariant(top + 2 <= MAX_STACK_DEPTH);
+            stack[top++] = node.right;
+            stack[top++] = index + 1;
+        }
+    }
+    js.runAndWait(parent);
+}
+
+void RenderableBvh::intersects(Culler::result_type* results, float4 const& sphere,
+        float3 const* center, float3 const* extent, size_t bit) const noexcept {
+    if (mNodes.empty()) {
+        return;
+    }
+
+    float3 const s = sphere.xyz;
+    float const r2 = sphere.w * sphere.w;
+    auto const mask = Culler::result_type(1u << bit);
+
+    // squared distance between the sphere's center and a box
+    auto distance2 = [s](float3 const& lo, float3 const& hi) {
+        float3 const d = clamp(s, lo, hi) - s;
+        return dot(d, d);
+    };
+
+    Node const* const nodes = mNodes.data();
+    uint32_t stack[MAX_STACK_DEPTH];
+    size_t top = 0;
+    stack[top++] = 0;
+    while (top) {
+        uint32_t const index = stack[--top];
+        Node const& node = nodes[index];
+        if (distance2(node.min, node.max) > r2) {
+            continue;
+        }
+        float3 const farthest = max(abs(s - node.min), abs(node.max - s));
+        if (dot(farthest, farthest) <= r2) {
+            // the node is entirely inside the sphere
+            setRange(results, node.first, node.last, bit, true);
+        } else if (!node.right) {
+            for (uint32_t i = node.first; i < node.last; i++) {
+                if (distance2(center[i] - extent[i], center[i] + extent[i]) <= r2) {
+                    results[i] |= mask;
+                }
+            }
+        } else {
+            assert_invariant(top + 2 <= MAX_STACK_DEPTH);
+            stack[top++] = node.right;
+            stack[top++] = index + 1;
+        }
+    }
+}
+
+} // namespace filament
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_RENDERABLEBVH_H
+#define TNT_FILAMENT_RENDERABLEBVH_H
+
+#include "Culler.h"
+
+#include <utils/compiler.h>
+
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace utils {
+class JobSystem;
+} // namespace utils
+
+namespace filament {
+
+class Frustum;
+
+/*
+ * A bounding volume hierarchy over the world-space AABBs of the renderables of a scene.
+ *
+ * The hierarchy doesn't store the boxes, instead they're expected to be stored in "tree order"
+ * (see build()), so that each node covers a contiguous range of boxes. This lets culling accept
+ * or reject whole ranges at once, and use the SIMD Culler only on the leaves that straddle
+ * a frustum plane. Leaves always start on a multiple of LEAF_SIZE.
+ *
+ * The topology is built once and its bounds refit() when boxes move. build() should be called
+ * again when the set of boxes changes, or when needsRebuild() says the tree degraded too much.
+ */
+class RenderableBvh {
+public:
+    // must be a multiple of Culler::MODULO
+    static constexpr size_t LEAF_SIZE = 32;
+    static_assert(LEAF_SIZE % Culler::MODULO == 0);
+
+    // Builds the topology of the hierarchy for `count` boxes given their centers, and writes
+    // into `order` the index of the box that must be stored at each position (tree order).
+    // refit() must be called before the hierarchy is used.
+    void build(math::float3 const* center, size_t count, uint32_t* order);
+
+    // Recomputes the bounds of all nodes from boxes stored in tree order.
+    void refit(utils::JobSystem& js,
+            math::float3 const* center, math::float3 const* extent, size_t count) noexcept;
+
+    // Whether the bounds grew so much since build() that culling efficiency suffers.
+    bool needsRebuild() const noexcept {
+        return mCost > mBuildCost * REBUILD_COST_RATIO;
+    }
+
+    void clear() noexcept;
+
+    bool empty() const noexcept { return mNodes.empty(); }
+
+    size_t getCount() const noexcept { return mCount; }
+
+    /*
+     * Sets or clears `bit` of each result depending on whether the corresponding box in tree
+     * order intersects the frustum. The results are the same as Culler::intersects().
+     * Leaves that need per-box tests are processed in parallel above `parallelThreshold` boxes.
+     */
+    void intersects(utils::JobSystem& js, Culler::result_type* results, Frustum const& frustum,
+            math::float3 const* center, math::float3 const* extent, size_t bit,
+            size_t parallelThreshold) const noexcept;
+
+    /*
+     * Sets `bit` of each result whose box (in tree order) intersects the sphere; other results
+     * are left untouched, so that several spheres can be accumulated.
+     */
+    void intersects(Culler::result_type* results, math::float4 const& sphere,
+            math::float3 const* center, math::float3 const* extent, size_t bit) const noexcept;
+
+private:
+    // rebuild when the summed area of the nodes doubled
+    static constexpr float REBUILD_COST_RATIO = 2.0f;
+
+    struct Node {
+        math::float3 min;
+        math::float3 max;
+        uint32_t first;     // first box covered by this node
+        uint32_t last;      // one past the last box covered by this node
+        uint32_t right;     // index of the right child, 0 for leaves (the left child is next)
+    };
+
+    uint32_t buildRecursive(math::float3 const* center, uint32_t* order,
+            uint32_t first, uint32_t last) noexcept;
+
+    void intersectsSubtree(uint32_t root, Culler::result_type* results, Frustum const& frustum,
+            math::float3 const* center, math::float3 const* extent, size_t bit) const noexcept;
+
+    static void setRange(Culler::result_type* results, size_t first, size_t last,
+            size_t bit, bool value) noexcept;
+
+    std::vector<Node> mNodes;       // depth-first order
+    std::vector<uint32_t> mLeaves;  // indices of the leaf nodes
+    size_t mCount = 0;
+    float mBuildCost = 0.0f;
+    float mCost = 0.0f;
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_RENDERABLEBVH_H
@@ -76,6 +76,14 @@ void RenderableManager::setCulling(Instance instance, bool enable) noexcept {
     downcast(this)->setCulling(instance, enable);
 }
 
+void RenderableManager::setOccluder(Instance instance, bool enable) noexcept {
+    downcast(this)->setOccluder(instance, enable);
+}
+
+bool RenderableManager::isOccluder(Instance instance) const noexcept {
+    return downcast(this)->isOccluder(instance);
+}
+
 void RenderableManager::setCastShadows(Instance instance, bool enable) noexcept {
     downcast(this)->setCastShadows(instance, enable);
 }
@@ -115,4 +115,8 @@ size_t Renderer::getMaxFrameHistorySize() const noexcept {
     return downcast(this)->getMaxFrameHistorySize();
 }
 
+Renderer::ResourceCacheStats Renderer::getResourceCacheStats() const noexcept {
+    return downcast(this)->getResourceCacheStats();
+}
+
 } // namespace filament
@@ -102,7 +102,12 @@ ResourceAllocatorDisposerInterface::~ResourceAllocatorDisposerInterface() = defa
 // ------------------------------------------------------------------------------------------------
 
 size_t ResourceAllocator::TextureKey::getSize() const noexcept {
-    size_t const pixelCount = width * height * depth;
+    return getTextureSize(format, samples, levels, width, height, depth);
+}
+
+size_t ResourceAllocator::getTextureSize(TextureFormat format, uint8_t samples, uint8_t levels,
+        uint32_t width, uint32_t height, uint32_t depth) noexcept {
+    size_t const pixelCount = size_t(width) * height * depth;
     size_t size = pixelCount * FTexture::getFormatSize(format);
     size_t const s = std::max(uint8_t(1), samples);
     if (s > 1) {
@@ -120,6 +125,7 @@ size_t ResourceAllocator::TextureKey::getSize() const noexcept {
 
 ResourceAllocator::ResourceAllocator(Engine::Config const& config, DriverApi& driverApi) noexcept
         : mCacheMaxAge(config.resourceAllocatorCacheMaxAge),
+          mCacheBudget(size_t(config.resourceAllocatorCacheBudgetMB) << 20u),
           mBackend(driverApi),
           mDisposer(std::make_shared<ResourceAllocatorDisposer>(driverApi)) {
 }
@@ -127,6 +133,7 @@ ResourceAllocator::ResourceAllocator(Engine::Config const& config, DriverApi& dr
 ResourceAllocator::ResourceAllocator(std::shared_ptr<ResourceAllocatorDisposer> disposer,
         Engine::Config const& config, DriverApi& driverApi) noexcept
         : mCacheMaxAge(config.resourceAllocatorCacheMaxAge),
+          mCacheBudget(size_t(config.resourceAllocatorCacheBudgetMB) << 20u),
           mBackend(driverApi),
           mDisposer(std::move(disposer)) {
 }
@@ -181,8 +188,11 @@ backend::TextureHandle ResourceAllocator::createTexture(const char* name,
             handle = it->second.handle;
             mCacheSize -= it->second.size;
             textureCache.erase(it);
+            mFrameStats.hitCount++;
         } else {
             // we don't, allocate a new texture and populate the in-use list
+            mFrameStats.missCount++;
+            mFrameStats.createdSize += key.getSize();
             handle = mBackend.createTexture(
                     target, levels, format, samples, width, height, depth, usage);
             if (swizzle != defaultSwizzle) {
@@ -268,6 +278,21 @@ void ResourceAllocator::gc(bool skippedFrame) noexcept {
         }
     }
 
+    // if we're over budget, evict the entries that cost the most, i.e. the largest and oldest
+    if (mCacheBudget && mCacheSize > mCacheBudget) {
+        auto cost = [age](TextureCachePayload const& payload) {
+            return uint64_t(payload.size) * (age - payload.age + 1);
+        };
+        while (mCacheSize > mCacheBudget) {
+            auto const it = std::max_element(textureCache.begin(), textureCache.end(),
+                    [&cost](auto const& lhs, auto const& rhs) {
+                        return cost(lhs.second) < cost(rhs.second);
+                    });
+            assert_invariant(it != textureCache.end());
+            purge(it);
+        }
+    }
+
     // if we have MAX_UNIQUE_AGE_COUNT ages or more, we evict all the resources that
     // are older than the MAX_UNIQUE_AGE_COUNT'th age.
     if (!skippedFrame && ages.count() >= MAX_UNIQUE_AGE_COUNT) {
@@ -286,6 +311,14 @@ void ResourceAllocator::gc(bool skippedFrame) noexcept {
             }
         }
     }
+
+    // publish this frame's statistics, skipped frames are accounted with the next frame
+    if (!skippedFrame) {
+        mFrameStats.cacheSize = mCacheSize;
+        mFrameStats.cacheSizeHighWaterMark = mCacheSizeHiWaterMark;
+        mStats = mFrameStats;
+        mFrameStats = {};
+    }
 }
 
 UTILS_NOINLINE
@@ -312,6 +345,8 @@ ResourceAllocator::purge(
     //slog.d << "purging " << pos->second.handle.getId() << ", age=" << pos->second.age << io::endl;
     mBackend.destroyTexture(pos->second.handle);
     mCacheSize -= pos->second.size;
+    mFrameStats.evictionCount++;
+    mFrameStats.evictedSize += pos->second.size;
     return mTextureCache.erase(pos);
 }
 
@@ -18,6 +18,7 @@
 #define TNT_FILAMENT_RESOURCEALLOCATOR_H
 
 #include <filament/Engine.h>
+#include <filament/Renderer.h>
 
 #include <backend/DriverEnums.h>
 #include <backend/Handle.h>
@@ -115,8 +116,18 @@ public:
 
     void gc(bool skippedFrame = false) noexcept;
 
+    using Stats = Renderer::ResourceCacheStats;
+
+    // activity of the cache during the last frame, updated by gc()
+    Stats const& getStats() const noexcept { return mStats; }
+
+    // Estimated size in bytes of a texture, this assumes the full mip pyramid when levels > 1
+    static size_t getTextureSize(backend::TextureFormat format, uint8_t samples, uint8_t levels,
+            uint32_t width, uint32_t height, uint32_t depth) noexcept;
+
 private:
     size_t const mCacheMaxAge;
+    size_t const mCacheBudget;  // in bytes, 0 if there is no budget
 
     struct TextureKey {
         const char* name; // doesn't participate in the hash
@@ -224,6 +235,8 @@ private:
     size_t mAge = 0;
     uint32_t mCacheSize = 0;
     uint32_t mCacheSizeHiWaterMark = 0;
+    Stats mStats{};         // last frame
+    Stats mFrameStats{};    // current frame
     static constexpr bool mEnabled = true;
 
     friend class ResourceAllocatorDisposer;
@@ -75,4 +75,20 @@ void Scene::forEach(Invocable<void(utils::Entity)>&& functor) const noexcept {
     downcast(this)->forEach(std::move(functor));
 }
 
+void Scene::setIncrementalUpdateEnabled(bool enabled) noexcept {
+    downcast(this)->setIncrementalUpdateEnabled(enabled);
+}
+
+bool Scene::isIncrementalUpdateEnabled() const noexcept {
+    return downcast(this)->isIncrementalUpdateEnabled();
+}
+
+void Scene::setHierarchicalCullingEnabled(bool enabled) noexcept {
+    downcast(this)->setHierarchicalCullingEnabled(enabled);
+}
+
+bool Scene::isHierarchicalCullingEnabled() const noexcept {
+    return downcast(this)->isHierarchicalCullingEnabled();
+}
+
 } // namespace filament
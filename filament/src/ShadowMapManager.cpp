@@ -118,6 +118,8 @@ ShadowMapManager::ShadowTechnique ShadowMapManager::update(
         CameraInfo const& cameraInfo,
         FScene::RenderableSoa& renderableData, FScene::LightSoa const& lightData) noexcept {
 
+    mPunctualShadowCastersCulled = false;
+
     if (!builder.mDirectionalShadowMapCount && !builder.mSpotShadowMapCount) {
         // no shadows were recorder
         return ShadowTechnique::NONE;
@@ -161,6 +163,11 @@ ShadowMapManager::ShadowTechnique ShadowMapManager::update(
     shadowTechnique |= updateSpotShadowMaps(
             engine, lightData);
 
+    if (RenderableBvh const* const hierarchy = view.getScene()->getCullingHierarchy()) {
+        mPunctualShadowCastersCulled = cullPunctualShadowCasters(*hierarchy,
+                renderableData, lightData);
+    }
+
     mSceneInfo = info;
 
     return shadowTechnique;
@@ -615,7 +622,8 @@ ShadowMapManager::ShadowTechnique ShadowMapManager::updateCascadeShadowMaps(FEng
         if (hasVisibleShadows) {
             Frustum const& frustum = shadowMap.getCamera().getCullingFrustum();
             FView::cullRenderables(engine.getJobSystem(), renderableData, frustum,
-                    VISIBLE_DIR_SHADOW_RENDERABLE_BIT);
+                    VISIBLE_DIR_SHADOW_RENDERABLE_BIT,
+                    engine.getConfig().parallelCullingThreshold, scene->getCullingHierarchy());
         }
     }
 
@@ -838,6 +846,33 @@ void ShadowMapManager::cullSpotShadowMap(ShadowMap const& shadowMap,
             range.size());
 }
 
+bool ShadowMapManager::cullPunctualShadowCasters(RenderableBvh const& hierarchy,
+        FScene::RenderableSoa& renderableData, FScene::LightSoa const& lightData) const noexcept {
+    utils::Slice<ShadowMap> const spotShadowMaps = getSpotShadowMaps();
+    if (spotShadowMaps.empty()) {
+        return false;
+    }
+
+    // A caster can only shadow a receiver lit by the light if it's closer to the light than
+    // the receiver, i.e. if it's within the light's radius. This is coarser than the per
+    // shadow map culling done later, but it's done hierarchically and before the View
+    // partitions the renderables, which usually leaves far fewer renderables to cull per
+    // shadow map.
+    float3 const* worldAABBCenter = renderableData.data<FScene::WORLD_AABB_CENTER>();
+    float3 const* worldAABBExtent = renderableData.data<FScene::WORLD_AABB_EXTENT>();
+    FScene::VisibleMaskType* visibleArray = renderableData.data<FScene::VISIBLE_MASK>();
+    for (ShadowMap const& shadowMap : spotShadowMaps) {
+        // point lights have one shadow map per face, but we need to cull only once
+        if (shadowMap.getFace() == 0) {
+            float4 const sphere =
+                    lightData.elementAt<FScene::POSITION_RADIUS>(shadowMap.getLightIndex());
+            hierarchy.intersects(visibleArray, sphere, worldAABBCenter, worldAABBExtent,
+                    VISIBLE_DYN_SHADOW_RENDERABLE_BIT);
+        }
+    }
+    return true;
+}
+
 void ShadowMapManager::preparePointShadowMap(ShadowMap& shadowMap,
         FEngine& engine, FView& view, CameraInfo const& mainCameraInfo,
         FScene::LightSoa& lightData) noexcept {
@@ -139,6 +139,10 @@ public:
 
     bool hasSpotShadows() const { return !mSpotShadowMapCount; }
 
+    // valid after calling update() above. Whether VISIBLE_DYN_SHADOW_RENDERABLE was set on the
+    // renderables that may cast shadows in the spot and point shadow maps.
+    bool arePunctualShadowCastersCulled() const noexcept { return mPunctualShadowCastersCulled; }
+
     // for debugging only
     utils::FixedCapacityVector<Camera const*> getDirectionalShadowCameras() const noexcept;
 
@@ -164,6 +168,10 @@ private:
             FEngine& engine, FView& view, CameraInfo const& mainCameraInfo,
             FScene::LightSoa& lightData, ShadowMap::SceneInfo const& sceneInfo) noexcept;
 
+    bool cullPunctualShadowCasters(RenderableBvh const& hierarchy,
+            FScene::RenderableSoa& renderableData,
+            FScene::LightSoa const& lightData) const noexcept;
+
     static void cullSpotShadowMap(ShadowMap const& map,
             FEngine const& engine, FView const& view,
             FScene::RenderableSoa& renderableData, utils::Range<uint32_t> range,
@@ -232,6 +240,7 @@ private:
     ShadowMapCacheContainer mShadowMapCache;
     uint32_t mDirectionalShadowMapCount = 0;
     uint32_t mSpotShadowMapCount = 0;
+    bool mPunctualShadowCastersCulled = false;
     bool const mIsDepthClampSupported;
     bool mInitialized = false;
 
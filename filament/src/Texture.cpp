@@ -96,4 +96,11 @@ void Texture::generatePrefilterMipmap(Engine& engine, Texture::PixelBufferDescri
     downcast(this)->generatePrefilterMipmap(downcast(engine), std::move(buffer), faceOffsets, options);
 }
 
+void Texture::generatePrefilterMipmapAsync(Engine& engine, Texture::PixelBufferDescriptor&& buffer,
+        const Texture::FaceOffsets& faceOffsets, PrefilterOptions const* options,
+        backend::CallbackHandler* handler, utils::Invocable<void(Texture*)>&& callback) {
+    downcast(this)->generatePrefilterMipmapAsync(downcast(engine), std::move(buffer), faceOffsets,
+            options, handler, std::move(callback));
+}
+
 } // namespace filament
@@ -57,6 +57,22 @@ bool View::isFrustumCullingEnabled() const noexcept {
     return downcast(this)->isFrustumCullingEnabled();
 }
 
+void View::setOcclusionCullingEnabled(bool enabled) noexcept {
+    downcast(this)->setOcclusionCullingEnabled(enabled);
+}
+
+bool View::isOcclusionCullingEnabled() const noexcept {
+    return downcast(this)->isOcclusionCullingEnabled();
+}
+
+void View::setCommandCachingEnabled(bool enabled) noexcept {
+    downcast(this)->setCommandCachingEnabled(enabled);
+}
+
+bool View::isCommandCachingEnabled() const noexcept {
+    return downcast(this)->isCommandCachingEnabled();
+}
+
 void View::setDebugCamera(Camera* camera) noexcept {
     downcast(this)->setViewingCamera(downcast(camera));
 }
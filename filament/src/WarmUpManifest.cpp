@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "WarmUpManifest.h"
+
+#include <fstream>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <stdio.h>
+
+namespace filament {
+
+// Must be bumped when the format of the manifest changes.
+static constexpr uint32_t VERSION = 1;
+static constexpr uint32_t MAGIC = 'F' | 'W' << 8 | 'U' << 16 | 'M' << 24;
+
+// Materials that haven't been created for this many runs are dropped from the manifest.
+static constexpr uint32_t MAX_UNUSED_RUNS = 8;
+
+struct FileEntry {
+    uint64_t materialCacheId;
+    uint32_t lastRun;
+    uint32_t reserved;
+    VariantList variants;
+};
+
+WarmUpManifest::WarmUpManifest(std::string path) : mPath(std::move(path)) {
+    std::ifstream in(mPath, std::ios::binary);
+    uint32_t header[3] = {};
+    uint64_t count = 0;
+    if (in.read(reinterpret_cast<char*>(header), sizeof(header)) &&
+            header[0] == MAGIC && header[1] == VERSION &&
+            in.read(reinterpret_cast<char*>(&count), sizeof(count))) {
+        FileEntry entry{};
+        for (uint64_t i = 0; i < count &&
+                in.read(reinterpret_cast<char*>(&entry), sizeof(entry)); i++) {
+            mEntries[entry.materialCacheId] = { entry.variants, entry.lastRun };
+        }
+        mRun = header[2] + 1;
+    }
+}
+
+void WarmUpManifest::record(uint64_t materialCacheId, Variant variant) noexcept {
+    std::lock_guard const lock(mLock);
+    Entry& entry = mEntries[materialCacheId];
+    if (!entry.variants.test(variant.key) || entry.lastRun != mRun) {
+        entry.variants.set(variant.key);
+        entry.lastRun = mRun;
+        mDirty = true;
+    }
+}
+
+VariantList WarmUpManifest::acquire(uint64_t materialCacheId) noexcept {
+    std::lock_guard const lock(mLock);
+    auto pos = mEntries.find(materialCacheId);
+    if (pos == mEntries.end()) {
+        return {};
+    }
+    if (pos->second.lastRun != mRun) {
+        pos.value().lastRun = mRun;
+        mDirty = true;
+    }
+    return pos->second.variants;
+}
+
+bool WarmUpManifest::isDirty() const noexcept {
+    std::lock_guard const lock(mLock);
+    return mDirty;
+}
+
+bool WarmUpManifest::save() const noexcept {
+    std::vector<FileEntry> entries;
+    {
+        std::lock_guard const lock(mLock);
+        entries.reserve(mEntries.size());
+        for (auto const& [materialCacheId, entry] : mEntries) {
+            if (mRun - entry.lastRun < MAX_UNUSED_RUNS) {
+                entries.push_back({ materialCacheId, entry.lastRun, 0, entry.variants });
+            }
+        }
+        mDirty = false;
+    }
+
+    auto failed = [this]() {
+        std::lock_guard const lock(mLock);
+        mDirty = true;
+        return false;
+    };
+
+    // write to a temporary file first, so that a crash never leaves a partial manifest
+    std::string const temp = mPath + ".tmp";
+    {
+        uint32_t const header[3] = { MAGIC, VERSION, mRun };
+        uint64_t const count = entries.size();
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<char const*>(header), sizeof(header));
+        out.write(reinterpret_cast<char const*>(&count), sizeof(count));
+        out.write(reinterpret_cast<char const*>(entries.data()),
+                std::streamsize(entries.size() * sizeof(FileEntry)));
+        if (!out) {
+            out.close();
+            remove(temp.c_str());
+            return failed();
+        }
+    }
+    if (rename(temp.c_str(), mPath.c_str()) != 0) {
+        // rename() doesn't replace existing files on all platforms
+        remove(mPath.c_str());
+        if (rename(temp.c_str(), mPath.c_str()) != 0) {
+            remove(temp.c_str());
+            return failed();
+        }
+    }
+    return true;
+}
+
+} // namespace filament
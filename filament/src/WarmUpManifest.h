@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_WARMUPMANIFEST_H
+#define TNT_FILAMENT_WARMUPMANIFEST_H
+
+#include <private/filament/Variant.h>
+
+#include <utils/Mutex.h>
+
+#include <tsl/robin_map.h>
+
+#include <string>
+
+#include <stdint.h>
+
+namespace filament {
+
+/*
+ * Records which variants of which materials were drawn, so that a later run can compile them
+ * as soon as the materials are created instead of when they're first drawn.
+ *
+ * Materials are identified by their cache id, i.e. the hash of their package. Materials that
+ * haven't been created for a few runs are forgotten.
+ *
+ * All methods are thread-safe.
+ */
+class WarmUpManifest {
+public:
+    // Loads the manifest from `path`, if it exists
+    explicit WarmUpManifest(std::string path);
+
+    // Records that the program of a variant of a material was requested for drawing
+    void record(uint64_t materialCacheId, Variant variant) noexcept;
+
+    // Returns the variants of a material recorded so far, and marks the material as used
+    VariantList acquire(uint64_t materialCacheId) noexcept;
+
+    // Writes the manifest to the path it was loaded from
+    bool save() const noexcept;
+
+    // Returns whether the manifest changed since it was loaded or last saved
+    bool isDirty() const noexcept;
+
+private:
+    struct Entry {
+        VariantList variants;
+        uint32_t lastRun;
+    };
+
+    std::string const mPath;
+    uint32_t mRun = 0;
+    mutable utils::Mutex mLock;
+    tsl::robin_map<uint64_t, Entry> mEntries;
+    mutable bool mDirty = false;
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_WARMUPMANIFEST_H
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_COMPONENTS_CHANGELOG_H
+#define TNT_FILAMENT_COMPONENTS_CHANGELOG_H
+
+#include <utils/compiler.h>
+#include <utils/debug.h>
+#include <utils/Entity.h>
+#include <utils/Slice.h>
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+
+/*
+ * A ChangeLog records the entities whose component data changed, so that consumers (e.g.
+ * incremental FScenes) can catch-up with only the changes that happened since they last looked.
+ *
+ * Consumers keep a Cursor, which is a position in the (virtual, ever-growing) log.
+ * The log is bounded: when it grows past its maximum size, or when a change can't be expressed
+ * per entity (e.g. component instances got reordered), it is invalidated and every consumer
+ * must resynchronize from scratch.
+ *
+ * Nothing is recorded until at least one consumer has retained the log.
+ */
+class ChangeLog {
+public:
+    using Cursor = uint64_t;
+
+    explicit ChangeLog(size_t maxSize = 16384) noexcept : mMaxSize(maxSize) { }
+
+    void retain() noexcept {
+        mConsumerCount++;
+    }
+
+    void release() noexcept {
+        assert_invariant(mConsumerCount);
+        if (--mConsumerCount == 0) {
+            invalidate();
+            mEntities.clear();
+            mEntities.shrink_to_fit();
+        }
+    }
+
+    bool isEnabled() const noexcept {
+        return mConsumerCount != 0;
+    }
+
+    // records that the data associated to `e` has changed
+    void record(utils::Entity e) {
+        if (UTILS_UNLIKELY(isEnabled())) {
+            if (UTILS_UNLIKELY(mEntities.size() >= mMaxSize)) {
+                invalidate();
+            }
+            mEntities.push_back(e);
+        }
+    }
+
+    // invalidates all cursors handed out so far
+    void invalidate() noexcept {
+        mBase += mEntities.size() + 1;
+        mEntities.clear();
+    }
+
+    Cursor getCursor() const noexcept {
+        return mBase + mEntities.size();
+    }
+
+    // Retrieves the entities recorded since `cursor`, which may contain duplicates. Returns false
+    // if this history is not available anymore, in which case the consumer must resynchronize.
+    bool getChangesSince(Cursor cursor, utils::Slice<const utils::Entity>& changes) const noexcept {
+        if (UTILS_UNLIKELY(cursor < mBase || cursor > getCursor())) {
+            return false;
+        }
+        changes = { mEntities.data() + (cursor - mBase), mEntities.data() + mEntities.size() };
+        return true;
+    }
+
+private:
+    std::vector<utils::Entity> mEntities;
+    Cursor mBase = 0;
+    size_t const mMaxSize;
+    uint32_t mConsumerCount = 0;
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_COMPONENTS_CHANGELOG_H
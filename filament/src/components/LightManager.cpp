@@ -200,6 +200,8 @@ void FLightManager::create(const FLightManager::Builder& builder, utils::Entity
         setSunAngularRadius(i, builder->mSunAngle);
         setSunHaloSize(i, builder->mSunHaloSize);
         setSunHaloFalloff(i, builder->mSunHaloFalloff);
+
+        mChangeLog.record(entity);
     }
 }
 
@@ -211,6 +213,7 @@ void FLightManager::destroy(utils::Entity e) noexcept {
     if (i) {
         auto& manager = mManager;
         manager.removeComponent(e);
+        mChangeLog.record(e);
     }
 }
 
@@ -19,6 +19,8 @@
 
 #include "downcast.h"
 
+#include "components/ChangeLog.h"
+
 #include "backend/DriverApiForward.h"
 
 #include <filament/LightManager.h>
@@ -240,6 +242,10 @@ public:
 
     void setShadowOptions(Instance i, ShadowOptions const& options) noexcept;
 
+    // Records the entities which gained or lost their light component. This is used by
+    // incremental scenes.
+    ChangeLog& getChangeLog() noexcept { return mChangeLog; }
+
 private:
     friend class FScene;
 
@@ -309,6 +315,7 @@ private:
     };
 
     Sim mManager;
+    ChangeLog mChangeLog;
     FEngine& mEngine;
 };
 
@@ -85,6 +85,7 @@ struct RenderableManager::BuilderDetails {
     bool mScreenSpaceContactShadows : 1;
     bool mSkinningBufferMode : 1;
     bool mFogEnabled : 1;
+    bool mOccluder : 1;
     RenderableManager::Builder::GeometryType mGeometryType : 2;
     size_t mSkinningBoneCount = 0;
     size_t mMorphTargetCount = 0;
@@ -104,7 +105,7 @@ struct RenderableManager::BuilderDetails {
     explicit BuilderDetails(size_t count)
             : mEntries(count), mCulling(true), mCastShadows(false),
               mReceiveShadows(true), mScreenSpaceContactShadows(false),
-              mSkinningBufferMode(false), mFogEnabled(true),
+              mSkinningBufferMode(false), mFogEnabled(true), mOccluder(false),
               mGeometryType(RenderableManager::Builder::GeometryType::DYNAMIC),
               mBonePairs() {
     }
@@ -190,6 +191,11 @@ RenderableManager::Builder& RenderableManager::Builder::culling(bool enable) noe
     return *this;
 }
 
+RenderableManager::Builder& RenderableManager::Builder::occluder(bool enable) noexcept {
+    mImpl->mOccluder = enable;
+    return *this;
+}
+
 RenderableManager::Builder& RenderableManager::Builder::lightChannel(unsigned int channel, bool enable) noexcept {
     if (channel < 8) {
         const uint8_t mask = 1u << channel;
@@ -573,6 +579,7 @@ void FRenderableManager::create(
         setReceiveShadows(ci, builder->mReceiveShadows);
         setScreenSpaceContactShadows(ci, builder->mScreenSpaceContactShadows);
         setCulling(ci, builder->mCulling);
+        setOccluder(ci, builder->mOccluder);
         setSkinning(ci, false);
         setMorphing(ci, builder->mMorphTargetCount);
         setFogEnabled(ci, builder->mFogEnabled);
@@ -709,6 +716,8 @@ void FRenderableManager::create(
                 setMorphWeights(ci, initWeights, 1, 0);
             }
         }
+
+        recordChange(ci);
     }
     engine.flushIfNeeded();
 }
@@ -719,6 +728,8 @@ void FRenderableManager::destroy(utils::Entity e) noexcept {
     if (ci) {
         destroyComponent(ci);
         mManager.removeComponent(e);
+        // removeComponent() moved the last component into `ci`
+        mChangeLog.invalidate();
     }
 }
 
@@ -935,6 +946,7 @@ void FRenderableManager::setSkinningBuffer(FRenderableManager::Instance ci,
     bones.handle = skinningBuffer->getHwHandle();
     bones.count = uint16_t(count);
     bones.offset = uint16_t(offset);
+    recordChange(ci);
 }
 
 static void updateMorphWeights(FEngine& engine, backend::Handle<backend::HwBufferObject> handle,
@@ -994,6 +1006,7 @@ void FRenderableManager::setLightChannel(Instance ci, unsigned int channel, bool
             const uint8_t mask = 1u << channel;
             mManager[ci].channels &= ~mask;
             mManager[ci].channels |= enable ? mask : 0u;
+            recordChange(ci);
         }
     }
 }
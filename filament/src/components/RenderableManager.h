@@ -19,6 +19,8 @@
 
 #include "downcast.h"
 
+#include "components/ChangeLog.h"
+
 #include "HwRenderPrimitiveFactory.h"
 
 #include "ds/DescriptorSet.h"
@@ -77,6 +79,7 @@ public:
         bool screenSpaceContactShadows  : 1;
         bool reversedWindingOrder       : 1;
         bool fog                        : 1;
+        bool occluder                   : 1;
         GeometryType geometryType       : 2;
     };
 
@@ -138,6 +141,7 @@ public:
     inline void setReceiveShadows(Instance instance, bool enable) noexcept;
     inline void setScreenSpaceContactShadows(Instance instance, bool enable) noexcept;
     inline void setCulling(Instance instance, bool enable) noexcept;
+    inline void setOccluder(Instance instance, bool enable) noexcept;
     inline void setFogEnabled(Instance instance, bool enable) noexcept;
     inline bool getFogEnabled(Instance instance) const noexcept;
 
@@ -162,6 +166,7 @@ public:
     inline bool isShadowCaster(Instance instance) const noexcept;
     inline bool isShadowReceiver(Instance instance) const noexcept;
     inline bool isCullingEnabled(Instance instance) const noexcept;
+    inline bool isOccluder(Instance instance) const noexcept;
 
 
     inline Box const& getAABB(Instance instance) const noexcept;
@@ -228,7 +233,12 @@ public:
         } morphing;
     };
 
+    // Records the entities whose renderable data used by FScene changed. Component instances
+    // are reordered when a renderable is destroyed, which invalidates the log.
+    ChangeLog& getChangeLog() noexcept { return mChangeLog; }
+
 private:
+    void recordChange(Instance ci) { mChangeLog.record(mManager.getEntity(ci)); }
     void destroyComponent(Instance ci) noexcept;
     static void destroyComponentPrimitives(
             HwRenderPrimitiveFactory& factory, backend::DriverApi& driver,
@@ -309,6 +319,7 @@ private:
     };
 
     Sim mManager;
+    ChangeLog mChangeLog;
     FEngine& mEngine;
     HwRenderPrimitiveFactory mHwRenderPrimitiveFactory;
 };
@@ -322,6 +333,7 @@ void FRenderableManager::setAxisAlignedBoundingBox(Instance instance, const Box&
                 GeometryType::DYNAMIC)
                 << "This renderable has staticBounds enabled; its AABB cannot change.";
         mManager[instance].aabb = aabb;
+        recordChange(instance);
     }
 }
 
@@ -330,12 +342,14 @@ void FRenderableManager::setLayerMask(Instance instance,
     if (instance) {
         uint8_t& layers = mManager[instance].layers;
         layers = (layers & ~select) | (values & select);
+        recordChange(instance);
     }
 }
 
 void FRenderableManager::setLayerMask(Instance instance, uint8_t layerMask) noexcept {
     if (instance) {
         mManager[instance].layers = layerMask;
+        recordChange(instance);
     }
 }
 
@@ -343,6 +357,7 @@ void FRenderableManager::setPriority(Instance instance, uint8_t priority) noexce
     if (instance) {
         Visibility& visibility = mManager[instance].visibility;
         visibility.priority = std::min(priority, uint8_t(0x7));
+        recordChange(instance);
     }
 }
 
@@ -350,6 +365,7 @@ void FRenderableManager::setChannel(Instance instance, uint8_t channel) noexcept
     if (instance) {
         Visibility& visibility = mManager[instance].visibility;
         visibility.channel = std::min(channel, uint8_t(0x3));
+        recordChange(instance);
     }
 }
 
@@ -357,6 +373,7 @@ void FRenderableManager::setCastShadows(Instance instance, bool enable) noexcept
     if (instance) {
         Visibility& visibility = mManager[instance].visibility;
         visibility.castShadows = enable;
+        recordChange(instance);
     }
 }
 
@@ -364,6 +381,7 @@ void FRenderableManager::setReceiveShadows(Instance instance, bool enable) noexc
     if (instance) {
         Visibility& visibility = mManager[instance].visibility;
         visibility.receiveShadows = enable;
+        recordChange(instance);
     }
 }
 
@@ -371,6 +389,7 @@ void FRenderableManager::setScreenSpaceContactShadows(Instance instance, bool en
     if (instance) {
         Visibility& visibility = mManager[instance].visibility;
         visibility.screenSpaceContactShadows = enable;
+        recordChange(instance);
     }
 }
 
@@ -378,6 +397,15 @@ void FRenderableManager::setCulling(Instance instance, bool enable) noexcept {
     if (instance) {
         Visibility& visibility = mManager[instance].visibility;
         visibility.culling = enable;
+        recordChange(instance);
+    }
+}
+
+void FRenderableManager::setOccluder(Instance instance, bool enable) noexcept {
+    if (instance) {
+        Visibility& visibility = mManager[instance].visibility;
+        visibility.occluder = enable;
+        recordChange(instance);
     }
 }
 
@@ -385,6 +413,7 @@ void FRenderableManager::setFogEnabled(Instance instance, bool enable) noexcept
     if (instance) {
         Visibility& visibility = mManager[instance].visibility;
         visibility.fog = enable;
+        recordChange(instance);
     }
 }
 
@@ -400,6 +429,7 @@ void FRenderableManager::setSkinning(Instance instance, bool enable) {
                 << "Skinning can't be used with STATIC geometry";
 
         visibility.skinning = enable;
+        recordChange(instance);
     }
 }
 
@@ -411,6 +441,7 @@ void FRenderableManager::setMorphing(Instance instance, bool enable) {
                 << "Morphing can't be used with STATIC geometry";
 
         visibility.morphing = enable;
+        recordChange(instance);
     }
 }
 
@@ -438,6 +469,10 @@ bool FRenderableManager::isCullingEnabled(Instance instance) const noexcept {
     return getVisibility(instance).culling;
 }
 
+bool FRenderableManager::isOccluder(Instance instance) const noexcept {
+    return getVisibility(instance).occluder;
+}
+
 uint8_t FRenderableManager::getLayerMask(Instance instance) const noexcept {
     return mManager[instance].layers;
 }
@@ -19,8 +19,13 @@
 #include <math/mat4.h>
 
 #include <utils/debug.h>
+#include <utils/JobSystem.h>
+#include <utils/Systrace.h>
 #include <filament/TransformManager.h>
 
+#include <algorithm>
+#include <functional>
+
 
 using namespace utils;
 using namespace filament::math;
@@ -31,15 +36,25 @@ FTransformManager::FTransformManager() noexcept = default;
 
 FTransformManager::~FTransformManager() noexcept = default;
 
+void FTransformManager::init(JobSystem& js) noexcept {
+    mJobSystem = &js;
+}
+
 void FTransformManager::terminate() noexcept {
 }
 
 void FTransformManager::setAccurateTranslationsEnabled(bool enable) noexcept {
     if (enable != mAccurateTranslations) {
         mAccurateTranslations = enable;
+        // all world transforms are affected
+        mChangeLog.invalidate();
         // when enabling accurate translations, we have to recompute all world transforms
-        if (enable && !mLocalTransformTransactionOpen) {
-            computeAllWorldTransforms();
+        if (enable) {
+            if (mLocalTransformTransactionOpen) {
+                mAllDirty = true;
+            } else {
+                computeAllWorldTransforms();
+            }
         }
     }
 }
@@ -102,10 +117,14 @@ void FTransformManager::setParent(Instance i, Instance parent) noexcept {
             removeNode(i);
             insertNode(i, parent);
             updateNodeTransform(i);
+            recordChanges(i);
             // Note: setParent() doesn't reorder the child after the parent in the array,
             // but that's not a problem because TransformManager doesn't rely on that.
             // Also note that commitLocalTransformTransaction() does reorder all children after
             // their parent, as an optimization to calculate the world transform.
+            if (parent > i) {
+                mNeedsSort = true;
+            }
         }
     }
 }
@@ -154,15 +173,26 @@ void FTransformManager::destroy(Entity e) noexcept {
         Instance child = manager[i].firstChild;
         while (child) {
             manager[child].parent = 0;
+            if (UTILS_UNLIKELY(mLocalTransformTransactionOpen)) {
+                recordDirty(child);
+            }
             child = manager[child].next;
         }
 
         // 2) remove the component
         Instance const moved = manager.removeComponent(e);
 
+        // removeComponent() moved the last component into `i`, and our children's world
+        // transforms changed
+        mChangeLog.invalidate();
+
         // 3) update the references to the entry now with Instance i
         if (moved != i) {
             updateNode(i);
+            // the last node moved here, possibly before its parent
+            if (Instance(manager[i].parent) > i) {
+                mNeedsSort = true;
+            }
         }
     }
 }
@@ -175,6 +205,7 @@ void FTransformManager::setTransform(Instance ci, const mat4f& model) noexcept {
         manager[ci].local = model;
         manager[ci].localTranslationLo = {};
         updateNodeTransform(ci);
+        recordChanges(ci);
     }
 }
 
@@ -186,11 +217,13 @@ void FTransformManager::setTransform(Instance ci, const mat4& model) noexcept {
         manager[ci].local = mat4f(model);
         manager[ci].localTranslationLo = float3{ model[3].xyz - float3{ model[3].xyz }};
         updateNodeTransform(ci);
+        recordChanges(ci);
     }
 }
 
 void FTransformManager::updateNodeTransform(Instance i) noexcept {
     if (UTILS_UNLIKELY(mLocalTransformTransactionOpen)) {
+        recordDirty(i);
         return;
     }
 
@@ -221,15 +254,31 @@ void FTransformManager::openLocalTransformTransaction() noexcept {
 void FTransformManager::commitLocalTransformTransaction() noexcept {
     if (mLocalTransformTransactionOpen) {
         mLocalTransformTransactionOpen = false;
-        computeAllWorldTransforms();
+        if (mAllDirty) {
+            computeAllWorldTransforms();
+        } else {
+            computeDirtyWorldTransforms();
+        }
+        mDirtyEntities.clear();
+        mAllDirty = false;
     }
 }
 
-void FTransformManager::computeAllWorldTransforms() noexcept {
+void FTransformManager::recordDirty(Instance i) noexcept {
+    if (!mAllDirty) {
+        // past a certain number of dirty nodes, it's faster to recompute everything
+        mDirtyEntities.push_back(mManager.getEntity(i));
+        if (mDirtyEntities.size() > mManager.getComponentCount() / DIRTY_RATIO) {
+            mDirtyEntities.clear();
+            mAllDirty = true;
+        }
+    }
+}
+
+void FTransformManager::sortNodes() noexcept {
     auto& manager = mManager;
 
     // swapNode() below needs some temporary storage which we provide here
-    const bool accurate = mAccurateTranslations;
     auto& soa = manager.getSoA();
     soa.ensureCapacity(soa.size() + 1);
 
@@ -238,14 +287,155 @@ void FTransformManager::computeAllWorldTransforms() noexcept {
         while (UTILS_UNLIKELY(Instance(manager[i].parent) > i)) {
             swapNode(i, manager[i].parent);
         }
+        assert_invariant(Instance(manager[i].parent) < i);
+    }
+    mNeedsSort = false;
+}
+
+void FTransformManager::computeAllWorldTransforms() noexcept {
+    SYSTRACE_CALL();
+
+    sortNodes();
+
+    auto& manager = mManager;
+    const bool accurate = mAccurateTranslations;
+    size_t const count = manager.getComponentCount();
+
+    auto updateNode = [&manager, accurate](Instance i) {
         Instance const parent = manager[i].parent;
         assert_invariant(parent < i);
-
         FTransformManager::computeWorldTransform(
                 manager[i].world, manager[i].worldTranslationLo,
                 manager[parent].world, manager[i].local,
                 manager[parent].worldTranslationLo, manager[i].localTranslationLo,
                 accurate);
+    };
+
+    if (!mJobSystem || count < PARALLEL_THRESHOLD || mJobSystem->getThreadCount() <= 1) {
+        for (Instance i = manager.begin(), e = manager.end(); i != e; ++i) {
+            updateNode(i);
+        }
+        return;
+    }
+
+    // Nodes of the same depth don't depend on each other, so the hierarchy is updated one
+    // level at a time, each level in parallel. Parents are sorted before their children,
+    // so all depths are known after a single pass.
+    auto& depths = mScratchDepths;
+    depths.resize(manager.end());
+    uint32_t maxDepth = 0;
+    for (Instance i = manager.begin(), e = manager.end(); i != e; ++i) {
+        Instance const parent = manager[i].parent;
+        uint32_t const depth = parent ? depths[parent] + 1 : 0;
+        depths[i] = depth;
+        maxDepth = std::max(maxDepth, depth);
+    }
+
+    // Sort the nodes by depth, after this levels[d] is the end of level d in nodes
+    auto& levels = mScratchLevels;
+    levels.assign(maxDepth + 1, 0);
+    for (Instance i = manager.begin(), e = manager.end(); i != e; ++i) {
+        levels[depths[i]]++;
+    }
+    for (uint32_t d = 0, offset = 0; d <= maxDepth; d++) {
+        uint32_t const c = levels[d];
+        levels[d] = offset;
+        offset += c;
+    }
+    auto& nodes = mScratchNodes;
+    nodes.resize(count);
+    for (Instance i = manager.begin(), e = manager.end(); i != e; ++i) {
+        nodes[levels[depths[i]]++] = i;
+    }
+
+    auto update = [&updateNode](Instance const* nodes, uint32_t c) {
+        for (uint32_t k = 0; k < c; k++) {
+            updateNode(nodes[k]);
+        }
+    };
+
+    // Below this many nodes, a level is not worth a job
+    constexpr uint32_t MIN_LEVEL_SIZE = 512;
+
+    JobSystem& js = *mJobSystem;
+    for (uint32_t d = 0, first = 0; d <= maxDepth; d++) {
+        uint32_t const last = levels[d];
+        if (last - first < MIN_LEVEL_SIZE) {
+            update(nodes.data() + first, last - first);
+        } else {
+            auto* job = jobs::parallel_for(js, nullptr, nodes.data() + first, last - first,
+                    std::cref(update), jobs::CountSplitter<256>());
+            js.runAndWait(job);
+        }
+        first = last;
+    }
+}
+
+void FTransformManager::computeDirtyWorldTransforms() noexcept {
+    SYSTRACE_CALL();
+
+    auto& manager = mManager;
+
+    // The order of the nodes doesn't matter here, but commitLocalTransformTransaction()
+    // guarantees that children are sorted after their parent.
+    if (UTILS_UNLIKELY(mNeedsSort)) {
+        sortNodes();
+    }
+
+    // Gather the dirty nodes (destroyed ones don't have an instance anymore), sorted so they
+    // can be looked-up.
+    auto& nodes = mScratchNodes;
+    nodes.clear();
+    for (Entity const e : mDirtyEntities) {
+        Instance const i = manager.getInstance(e);
+        if (i) {
+            nodes.push_back(i);
+        }
+    }
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+
+    // A dirty node updates its whole subtree, so nodes with a dirty ancestor are skipped. The
+    // remaining nodes are roots of disjoint subtrees.
+    auto& roots = mScratchRoots;
+    roots.clear();
+    for (Instance const i : nodes) {
+        Instance p = manager[i].parent;
+        while (p && !std::binary_search(nodes.begin(), nodes.end(), p)) {
+            p = manager[p].parent;
+        }
+        if (!p) {
+            roots.push_back(i);
+        }
+    }
+
+    auto update = [this, &manager](Instance const* roots, uint32_t c) {
+        const bool accurate = mAccurateTranslations;
+        for (uint32_t k = 0; k < c; k++) {
+            Instance const i = roots[k];
+            Instance const parent = manager[i].parent;
+            FTransformManager::computeWorldTransform(
+                    manager[i].world, manager[i].worldTranslationLo,
+                    manager[parent].world, manager[i].local,
+                    manager[parent].worldTranslationLo, manager[i].localTranslationLo,
+                    accurate);
+            Instance const child = manager[i].firstChild;
+            if (child) {
+                transformChildren(manager, child);
+            }
+        }
+    };
+
+    // Below this many subtrees, it's not worth using jobs
+    constexpr size_t MIN_PARALLEL_ROOTS = 256;
+
+    if (!mJobSystem || roots.size() < MIN_PARALLEL_ROOTS || mJobSystem->getThreadCount() <= 1) {
+        update(roots.data(), uint32_t(roots.size()));
+    } else {
+        JobSystem& js = *mJobSystem;
+        auto* job = jobs::parallel_for(js, nullptr, roots.data(), uint32_t(roots.size()),
+                std::cref(update), jobs::CountSplitter<64>());
+        js.runAndWait(job);
     }
 }
 
@@ -393,6 +583,18 @@ void FTransformManager::transformChildren(Sim& manager, Instance i) noexcept {
     }
 }
 
+// records that the world transform of i and all its descendants changed
+void FTransformManager::recordChanges(Instance i) noexcept {
+    auto& manager = mManager;
+    if (UTILS_LIKELY(!mChangeLog.isEnabled())) {
+        return;
+    }
+    mChangeLog.record(manager.getEntity(i));
+    for (Instance child = manager[i].firstChild; child; child = manager[child].next) {
+        recordChanges(child);
+    }
+}
+
 void FTransformManager::computeWorldTransform(
         mat4f& UTILS_RESTRICT outWorld,
         float3& UTILS_RESTRICT inoutWorldTranslationLo,
@@ -19,6 +19,8 @@
 
 #include "downcast.h"
 
+#include "components/ChangeLog.h"
+
 #include <filament/TransformManager.h>
 
 #include <utils/compiler.h>
@@ -28,6 +30,14 @@
 
 #include <math/mat4.h>
 
+#include <vector>
+
+#include <stdint.h>
+
+namespace utils {
+class JobSystem;
+} // namespace utils
+
 namespace filament {
 
 class UTILS_PRIVATE FTransformManager : public TransformManager {
@@ -37,6 +47,9 @@ public:
     FTransformManager() noexcept;
     ~FTransformManager() noexcept;
 
+    // Large transactions are committed in parallel on `js`
+    void init(utils::JobSystem& js) noexcept;
+
     // free-up all resources
     void terminate() noexcept;
 
@@ -133,9 +146,13 @@ public:
         return r;
     }
 
+    // Records the entities whose world transform changed. This is used by incremental scenes.
+    ChangeLog& getChangeLog() noexcept { return mChangeLog; }
+
 private:
     struct Sim;
 
+    void recordChanges(Instance i) noexcept;
     void validateNode(Instance i) noexcept;
     void removeNode(Instance i) noexcept;
     void updateNode(Instance i) noexcept;
@@ -143,8 +160,11 @@ private:
     void insertNode(Instance i, Instance p) noexcept;
     void swapNode(Instance i, Instance j) noexcept;
     void transformChildren(Sim& manager, Instance firstChild) noexcept;
+    void recordDirty(Instance i) noexcept;
 
+    void sortNodes() noexcept;
     void computeAllWorldTransforms() noexcept;
+    void computeDirtyWorldTransforms() noexcept;
 
     static void computeWorldTransform(math::mat4f& outWorld, math::float3& inoutWorldTranslationLo,
             math::mat4f const& pt, math::mat4f const& local,
@@ -208,9 +228,30 @@ private:
         }
     };
 
+    // Transactions touching at most 1/DIRTY_RATIO of the nodes only update their subtrees
+    static constexpr size_t DIRTY_RATIO = 4;
+    // Below this many nodes, transactions are committed serially
+    static constexpr size_t PARALLEL_THRESHOLD = 4096;
+
     Sim mManager;
+    ChangeLog mChangeLog;
+    utils::JobSystem* mJobSystem = nullptr;
+
+    // nodes whose local transform or parent changed during the current transaction
+    std::vector<utils::Entity> mDirtyEntities;
+
+    // scratch storage for committing transactions, kept to avoid reallocating it
+    std::vector<Instance> mScratchNodes;
+    std::vector<Instance> mScratchRoots;
+    std::vector<uint32_t> mScratchDepths;
+    std::vector<uint32_t> mScratchLevels;
+
     bool mLocalTransformTransactionOpen = false;
     bool mAccurateTranslations = false;
+    // all world transforms must be recomputed when the transaction is committed
+    bool mAllDirty = false;
+    // some children are stored before their parent
+    bool mNeedsSort = false;
 };
 
 FILAMENT_DOWNCAST(TransformManager)
@@ -16,9 +16,11 @@
 
 #include "details/Engine.h"
 
+#include "BlobCache.h"
 #include "MaterialParser.h"
 #include "ResourceAllocator.h"
 #include "RenderPrimitive.h"
+#include "WarmUpManifest.h"
 
 #include "details/BufferObject.h"
 #include "details/Camera.h"
@@ -45,10 +47,12 @@
 #include <backend/DriverEnums.h>
 
 #include <utils/compiler.h>
+#include <utils/CString.h>
 #include <utils/debug.h>
 #include <utils/Invocable.h>
 #include <utils/Log.h>
 #include <utils/Panic.h>
+#include <utils/Path.h>
 #include <utils/PrivateImplementation-impl.h>
 #include <utils/Systrace.h>
 #include <utils/ThreadUtils.h>
@@ -58,9 +62,11 @@
 #include <memory>
 #include <optional>
 #include <thread>
+#include <string>
 #include <string_view>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <stddef.h>
 #include <stdint.h>
@@ -84,6 +90,8 @@ struct Engine::BuilderDetails {
     void* mSharedContext = nullptr;
     bool mPaused = false;
     std::unordered_map<std::string_view, bool> mFeatureFlags;
+    utils::CString mProgramCacheDirectory;
+    size_t mProgramCacheMaxSize = 0;
 
     static Config validateConfig(Config config) noexcept;
 };
@@ -122,6 +130,7 @@ Engine* FEngine::create(Engine::Builder const& builder) {
                 .stereoscopicType = instance->getConfig().stereoscopicType,
                 .assertNativeWindowIsValid = instance->features.backend.opengl.assert_native_window_is_valid,
         };
+        instance->installProgramCache(platform);
         instance->mDriver = platform->createDriver(sharedContext, driverConfig);
 
     } else {
@@ -258,6 +267,13 @@ FEngine::FEngine(Engine::Builder const& builder) :
     featureFlagsBackwardCompatibility("backend.opengl.assert_native_window_is_valid",
             mConfig.assertNativeWindowIsValid);
 
+    if (!builder->mProgramCacheDirectory.empty()) {
+        std::string const directory(builder->mProgramCacheDirectory.c_str_safe());
+        mBlobCache = std::make_unique<BlobCache>(directory, builder->mProgramCacheMaxSize);
+        mWarmUpManifest = std::make_unique<WarmUpManifest>(
+                Path::concat(directory, "warmup").getPath());
+    }
+
     // We're assuming we're on the main thread here.
     // (it may not be the case)
     mJobSystem.adopt();
@@ -450,6 +466,8 @@ void FEngine::init() {
 
     mPostProcessManager.init();
 
+    mTransformManager.init(mJobSystem);
+
     mDebugRegistry.registerProperty("d.shadowmap.debug_directional_shadowmap",
             &debug.shadowmap.debug_directional_shadowmap, [this]() {
                 mMaterials.forEach([this](FMaterial* material) {
@@ -540,6 +558,15 @@ void FEngine::shutdown() {
     destroy(mDummyMorphTargetBuffer);
     mDummyMorphTargetBuffer = nullptr;
 
+    // the background prefiltering jobs must be done before the JobSystem goes away
+    while (!mPendingPrefilters.empty()) {
+        mPendingPrefilters.back()->cancelPrefilterMipmap(*this, true);
+    }
+    for (JobSystem::Job* job : mCancelledPrefilterJobs) {
+        mJobSystem.waitAndRelease(job);
+    }
+    mCancelledPrefilterJobs.clear();
+
     destroy(mDefaultIblTexture);
     mDefaultIblTexture = nullptr;
 
@@ -620,6 +647,20 @@ void FEngine::shutdown() {
     // and destroy the CommandStream
     std::destroy_at(std::launder(reinterpret_cast<DriverApi*>(&mDriverApiStorage)));
 
+    // the driver is gone, nothing can use the program cache anymore
+    if (mOwnBlobFunc) {
+        mPlatform->setBlobFunc({}, {});
+        mOwnBlobFunc = false;
+    }
+    if (mProgramCacheSaveJob) {
+        mJobSystem.waitAndRelease(mProgramCacheSaveJob);
+    }
+    if (mWarmUpManifest) {
+        mWarmUpManifest->save();
+        mWarmUpManifest.reset();
+    }
+    mBlobCache.reset();
+
     /*
      * Terminate the JobSystem...
      */
@@ -646,6 +687,83 @@ void FEngine::prepare() {
         material->checkProgramEdits();
 #endif
     });
+
+    if (UTILS_UNLIKELY(mBlobCache)) {
+        saveProgramCache();
+    }
+
+    // upload the reflections levels that were prefiltered in the background since last time
+    if (UTILS_UNLIKELY(!mPendingPrefilters.empty())) {
+        mPendingPrefilters.erase(
+                std::remove_if(mPendingPrefilters.begin(), mPendingPrefilters.end(),
+                        [this](FTexture* texture) {
+                            return texture->updatePrefilterMipmap(*this);
+                        }),
+                mPendingPrefilters.end());
+    }
+
+    // and forget the cancelled ones that are done
+    if (UTILS_UNLIKELY(!mCancelledPrefilterJobs.empty())) {
+        mCancelledPrefilterJobs.erase(
+                std::remove_if(mCancelledPrefilterJobs.begin(), mCancelledPrefilterJobs.end(),
+                        [this](JobSystem::Job* job) {
+                            if (!JobSystem::hasJobCompleted(job)) {
+                                return false;
+                            }
+                            mJobSystem.release(job);
+                            return true;
+                        }),
+                mCancelledPrefilterJobs.end());
+    }
+}
+
+void FEngine::addPendingPrefilter(FTexture* texture) noexcept {
+    assert_invariant(std::find(mPendingPrefilters.begin(), mPendingPrefilters.end(), texture) ==
+            mPendingPrefilters.end());
+    mPendingPrefilters.push_back(texture);
+}
+
+void FEngine::saveProgramCache() noexcept {
+    // Applications are often killed rather than shut down (e.g. on Android), so the program
+    // cache's index and the warm-up manifest are saved as they change, at most once per second.
+    // The files are written by a background job, so that the frame doesn't wait on the disk.
+    if (mProgramCacheSaveJob) {
+        if (!JobSystem::hasJobCompleted(mProgramCacheSaveJob)) {
+            return;
+        }
+        mJobSystem.release(mProgramCacheSaveJob);
+    }
+    auto const now = clock::now();
+    if (now - mProgramCacheSaveTime < std::chrono::seconds(1)) {
+        return;
+    }
+    mProgramCacheSaveTime = now;
+    WarmUpManifest* const manifest = mWarmUpManifest->isDirty() ? mWarmUpManifest.get() : nullptr;
+    BlobCache* const cache = mBlobCache->isDirty() ? mBlobCache.get() : nullptr;
+    if (!manifest && !cache) {
+        return;
+    }
+    JobSystem::Job* const job = mJobSystem.createJob(nullptr,
+            [manifest, cache](JobSystem&, JobSystem::Job*) {
+                if (manifest) {
+                    manifest->save();
+                }
+                if (cache) {
+                    cache->flush();
+                }
+            });
+    mProgramCacheSaveJob = mJobSystem.runInBackgroundAndRetain(job);
+}
+
+void FEngine::addCancelledPrefilterJob(JobSystem::Job* job) noexcept {
+    mCancelledPrefilterJobs.push_back(job);
+}
+
+void FEngine::removePendingPrefilter(FTexture* texture) noexcept {
+    auto const pos = std::find(mPendingPrefilters.begin(), mPendingPrefilters.end(), texture);
+    if (pos != mPendingPrefilters.end()) {
+        mPendingPrefilters.erase(pos);
+    }
 }
 
 void FEngine::gc() {
@@ -713,6 +831,26 @@ void FEngine::flushAndWait() {
 // Render thread / command queue
 // -----------------------------------------------------------------------------------------------
 
+void FEngine::installProgramCache(Platform* platform) noexcept {
+    if (!mBlobCache) {
+        return;
+    }
+    if (platform->hasBlobFunc()) {
+        slog.w << "Platform already has blob functions, "
+                  "the program cache won't store program binaries" << io::endl;
+        return;
+    }
+    BlobCache* const cache = mBlobCache.get();
+    platform->setBlobFunc(
+            [cache](void const* key, size_t keySize, void const* value, size_t valueSize) {
+                cache->insert(key, keySize, value, valueSize);
+            },
+            [cache](void const* key, size_t keySize, void* value, size_t valueSize) {
+                return cache->retrieve(key, keySize, value, valueSize);
+            });
+    mOwnBlobFunc = true;
+}
+
 int FEngine::loop() {
     if (mPlatform == nullptr) {
         mPlatform = PlatformFactory::create(&mBackend);
@@ -760,6 +898,7 @@ int FEngine::loop() {
             .stereoscopicType =  mConfig.stereoscopicType,
             .assertNativeWindowIsValid = features.backend.opengl.assert_native_window_is_valid,
     };
+    installProgramCache(mPlatform);
     mDriver = mPlatform->createDriver(mSharedGLContext, driverConfig);
 
     mDriverBarrier.latch();
@@ -1438,6 +1577,12 @@ Engine::Builder& Engine::Builder::paused(bool paused) noexcept {
     return *this;
 }
 
+Engine::Builder& Engine::Builder::programCache(const char* directory, size_t maxSize) noexcept {
+    mImpl->mProgramCacheDirectory = CString(directory);
+    mImpl->mProgramCacheMaxSize = maxSize;
+    return *this;
+}
+
 Engine::Builder& Engine::Builder::feature(char const* name, bool value) noexcept {
     mImpl->mFeatureFlags[name] = value;
     return *this;
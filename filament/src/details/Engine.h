@@ -78,6 +78,7 @@
 #include <thread>
 #include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 #if FILAMENT_ENABLE_MATDBG
 #include <matdbg/DebugServer.h>
@@ -90,9 +91,11 @@ using MaterialKey = uint32_t;
 
 namespace filament {
 
+class BlobCache;
 class Renderer;
 class MaterialParser;
 class ResourceAllocatorDisposer;
+class WarmUpManifest;
 
 namespace backend {
 class Driver;
@@ -441,6 +444,18 @@ public:
         return const_cast<utils::JobSystem&>(mJobSystem);
     }
 
+    // textures with a pending generatePrefilterMipmapAsync(), updated in prepare()
+    void addPendingPrefilter(FTexture* texture) noexcept;
+    void removePendingPrefilter(FTexture* texture) noexcept;
+
+    // takes a retained prefiltering job that was cancelled, it's waited on in shutdown()
+    void addCancelledPrefilterJob(utils::JobSystem::Job* job) noexcept;
+
+    // the variants recorded in the program cache, or nullptr if there's no program cache
+    WarmUpManifest* getWarmUpManifest() const noexcept {
+        return mWarmUpManifest.get();
+    }
+
     std::default_random_engine& getRandomEngine() {
         return mRandomEngine;
     }
@@ -507,6 +522,7 @@ private:
     explicit FEngine(Engine::Builder const& builder);
     void init();
     void shutdown();
+    void installProgramCache(Platform* platform) noexcept;
 
     int loop();
     void flushCommandBuffer(backend::CommandBufferQueue& commandBufferQueue);
@@ -525,6 +541,8 @@ private:
     template<typename T>
     void cleanupResourceList(ResourceList<T>&& list);
 
+    void saveProgramCache() noexcept;
+
     template<typename T, typename Lock>
     void cleanupResourceListLocked(Lock& lock, ResourceList<T>&& list);
 
@@ -535,6 +553,7 @@ private:
     FeatureLevel mActiveFeatureLevel = FeatureLevel::FEATURE_LEVEL_1;
     Platform* mPlatform = nullptr;
     bool mOwnPlatform = false;
+    bool mOwnBlobFunc = false;
     bool mAutomaticInstancingEnabled = false;
     void* mSharedGLContext = nullptr;
     backend::Handle<backend::HwRenderPrimitive> mFullScreenTriangleRph;
@@ -627,6 +646,15 @@ private:
 
     bool mInitialized = false;
 
+    // persistent program cache, see Engine::Builder::programCache()
+    std::unique_ptr<BlobCache> mBlobCache;
+    std::unique_ptr<WarmUpManifest> mWarmUpManifest;
+    clock::time_point mProgramCacheSaveTime{};
+    utils::JobSystem::Job* mProgramCacheSaveJob = nullptr;
+
+    std::vector<FTexture*> mPendingPrefilters;
+    std::vector<utils::JobSystem::Job*> mCancelledPrefilterJobs;
+
     // Creation parameters
     Config mConfig;
 
@@ -666,6 +694,9 @@ public:
             bool doFrameCapture = false;
             bool disable_buffer_padding = false;
             bool disable_subpasses = false;
+            // Reports heap allocations made by the main thread in Renderer::render(), this
+            // only covers utils allocators, see utils::HeapAllocationTrap. Debug builds only.
+            bool trap_heap_allocations = false;
         } renderer;
         struct {
             bool debug_froxel_visualization = false;
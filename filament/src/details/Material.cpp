@@ -19,6 +19,7 @@
 
 #include "Froxelizer.h"
 #include "MaterialParser.h"
+#include "WarmUpManifest.h"
 
 #include "ds/ColorPassDescriptorSet.h"
 
@@ -340,6 +341,7 @@ FMaterial::FMaterial(FEngine& engine, const Material::Builder& builder,
     processPushConstants(engine, parser);
     processDescriptorSets(engine, parser);
     precacheDepthVariants(engine);
+    precacheRecordedVariants(engine);
 
 #if FILAMENT_ENABLE_MATDBG
     // Register the material with matdbg.
@@ -414,7 +416,7 @@ void FMaterial::compile(CompilerPriorityQueue priority,
         for (auto const variant: variants) {
             if (!variantFilter || variant == Variant::filterUserVariant(variant, variantFilter)) {
                 if (hasVariant(variant)) {
-                    prepareProgram(variant, priority);
+                    precacheProgram(variant, priority);
                 }
             }
         }
@@ -496,6 +498,15 @@ bool FMaterial::hasVariant(Variant variant) const noexcept {
 
 void FMaterial::prepareProgramSlow(Variant variant,
         backend::CompilerPriorityQueue priorityQueue) const noexcept {
+    // only the programs needed for drawing are recorded, not the precached ones
+    if (WarmUpManifest* const manifest = mEngine.getWarmUpManifest()) {
+        manifest->record(mCacheId, variant);
+    }
+    createProgramSlow(variant, priorityQueue);
+}
+
+void FMaterial::createProgramSlow(Variant variant,
+        backend::CompilerPriorityQueue priorityQueue) const noexcept {
     assert_invariant(mEngine.hasFeatureLevel(mFeatureLevel));
     switch (getMaterialDomain()) {
         case MaterialDomain::SURFACE:
@@ -1093,7 +1104,7 @@ void FMaterial::precacheDepthVariants(FEngine& engine) {
         for (auto const variant: allDepthVariants) {
             assert_invariant(Variant::isValidDepthVariant(variant));
             if (hasVariant(variant)) {
-                prepareProgram(variant);
+                precacheProgram(variant);
             }
         }
         return;
@@ -1113,6 +1124,21 @@ void FMaterial::precacheDepthVariants(FEngine& engine) {
     }
 }
 
+void FMaterial::precacheRecordedVariants(FEngine& engine) {
+    // compile the variants this material used in previous runs in the background, so they're
+    // likely ready (or retrieved from the program cache) by the time they're first drawn.
+    WarmUpManifest* const manifest = engine.getWarmUpManifest();
+    if (!manifest || !engine.getDriverApi().isParallelShaderCompileSupported()) {
+        return;
+    }
+    manifest->acquire(mCacheId).forEachSetBit([this](size_t key) {
+        Variant const variant{ Variant::type_t(key) };
+        if (hasVariant(variant)) {
+            precacheProgram(variant, CompilerPriorityQueue::LOW);
+        }
+    });
+}
+
 void FMaterial::processDescriptorSets(FEngine& engine, MaterialParser const* const parser) {
     UTILS_UNUSED_IN_RELEASE bool success;
 
@@ -148,6 +148,15 @@ public:
         }
     }
 
+    // Like prepareProgram(), but for a program that isn't needed for drawing yet, so it isn't
+    // recorded in the warm-up manifest.
+    void precacheProgram(Variant variant,
+            backend::CompilerPriorityQueue priorityQueue = CompilerPriorityQueue::HIGH) const noexcept {
+        if (UTILS_UNLIKELY(!isCached(variant))) {
+            createProgramSlow(variant, priorityQueue);
+        }
+    }
+
     // getProgram returns the backend program for the material's given variant.
     // Must be called after prepareProgram().
     [[nodiscard]] backend::Handle<backend::HwProgram> getProgram(Variant variant) const noexcept {
@@ -277,6 +286,8 @@ private:
     bool hasVariant(Variant variant) const noexcept;
     void prepareProgramSlow(Variant variant,
             CompilerPriorityQueue priorityQueue) const noexcept;
+    void createProgramSlow(Variant variant,
+            CompilerPriorityQueue priorityQueue) const noexcept;
     void getSurfaceProgramSlow(Variant variant,
             CompilerPriorityQueue priorityQueue) const noexcept;
     void getPostProcessProgramSlow(Variant variant,
@@ -293,6 +304,8 @@ private:
 
     void precacheDepthVariants(FEngine& engine);
 
+    void precacheRecordedVariants(FEngine& engine);
+
     void processDescriptorSets(FEngine& engine, MaterialParser const* parser);
 
     void createAndCacheProgram(backend::Program&& p, Variant variant) const noexcept;
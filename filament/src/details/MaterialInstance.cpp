@@ -326,7 +326,11 @@ const char* FMaterialInstance::getName() const noexcept {
 // ------------------------------------------------------------------------------------------------
 
 void FMaterialInstance::use(FEngine::DriverApi& driver) const {
+    prepareUse();
+    mDescriptorSet.bind(driver, DescriptorSetBindingPoints::PER_MATERIAL);
+}
 
+void FMaterialInstance::prepareUse() const {
     if (UTILS_UNLIKELY(mMissingSamplerDescriptors.any())) {
         std::call_once(mMissingSamplersFlag, [this]() {
             auto const& list = mMaterial->getSamplerInterfaceBlock().getSamplerInfoList();
@@ -346,8 +350,7 @@ void FMaterialInstance::use(FEngine::DriverApi& driver) const {
         });
         mMissingSamplerDescriptors.clear();
     }
-
-    mDescriptorSet.bind(driver, DescriptorSetBindingPoints::PER_MATERIAL);
+    mDescriptorSet.validateBind();
 }
 
 void FMaterialInstance::fixMissingSamplers() const {
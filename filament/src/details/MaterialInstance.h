@@ -69,6 +69,10 @@ public:
 
     void use(FEngine::DriverApi& driver) const;
 
+    // Performs the bookkeeping of use() ahead of time, after which use() doesn't modify this
+    // MaterialInstance and can be called from several threads.
+    void prepareUse() const;
+
     FMaterial const* getMaterial() const noexcept { return mMaterial; }
 
     uint64_t getSortingKey() const noexcept { return mMaterialSortingKey; }
@@ -27,6 +27,8 @@
 
 #include <utils/CString.h>
 
+#include <vector>
+
 namespace filament {
 
 using namespace backend;
@@ -35,6 +37,7 @@ using namespace math;
 struct MorphTargetBuffer::BuilderDetails {
     size_t mVertexCount = 0;
     size_t mCount = 0;
+    size_t mDeltaCount = 0;
 };
 
 using BuilderType = MorphTargetBuffer;
@@ -55,6 +58,11 @@ MorphTargetBuffer::Builder& MorphTargetBuffer::Builder::count(size_t count) noex
     return *this;
 }
 
+MorphTargetBuffer::Builder& MorphTargetBuffer::Builder::sparse(size_t deltaCount) noexcept {
+    mImpl->mDeltaCount = deltaCount;
+    return *this;
+}
+
 MorphTargetBuffer* MorphTargetBuffer::Builder::build(Engine& engine) {
     return downcast(engine).createMorphTargetBuffer(*this);
 }
@@ -65,6 +73,14 @@ MorphTargetBuffer* MorphTargetBuffer::Builder::build(Engine& engine) {
 // When you change this value, you must change MAX_MORPH_TARGET_BUFFER_WIDTH at getters.vs
 constexpr size_t MAX_MORPH_TARGET_BUFFER_WIDTH = 2048;
 
+// The sparse format uses a single layer of both textures, laid out as follows:
+// - texel v < vertexCount is the header of vertex v, the position texture holds the index of its
+//   first delta and its number of deltas in x and y (as floats, which is exact up to 2^24).
+// - the following texels hold the deltas, grouped by vertex; the position texture holds the
+//   position offset in xyz and the target index in w, the tangent texture holds the tangents.
+// The vertex shader then only visits the deltas of each vertex, instead of all the targets.
+// When you change this layout, you must change morphPosition() and morphNormal() at getters.vs
+
 static inline size_t getWidth(size_t vertexCount) noexcept {
     return std::min(vertexCount, MAX_MORPH_TARGET_BUFFER_WIDTH);
 }
@@ -103,7 +119,8 @@ FMorphTargetBuffer::EmptyMorphTargetBuilder::EmptyMorphTargetBuilder() {
 
 FMorphTargetBuffer::FMorphTargetBuffer(FEngine& engine, const Builder& builder)
         : mVertexCount(builder->mVertexCount),
-          mCount(builder->mCount) {
+          mCount(builder->mCount),
+          mDeltaCount(builder->mDeltaCount) {
 
     if (UTILS_UNLIKELY(engine.getActiveFeatureLevel() == FeatureLevel::FEATURE_LEVEL_0)) {
         return;
@@ -111,19 +128,23 @@ FMorphTargetBuffer::FMorphTargetBuffer(FEngine& engine, const Builder& builder)
 
     FEngine::DriverApi& driver = engine.getDriverApi();
 
+    // the sparse format stores all the targets in a single layer
+    size_t const texelCount = getTexelCount();
+    size_t const layerCount = isSparse() ? 1 : mCount;
+
     // create buffer (here a texture) to store the morphing vertex data
     mPbHandle = driver.createTexture(SamplerType::SAMPLER_2D_ARRAY, 1,
             TextureFormat::RGBA32F, 1,
-            getWidth(mVertexCount),
-            getHeight(mVertexCount),
-            mCount,
+            getWidth(texelCount),
+            getHeight(texelCount),
+            layerCount,
             TextureUsage::DEFAULT);
 
     mTbHandle = driver.createTexture(SamplerType::SAMPLER_2D_ARRAY, 1,
             TextureFormat::RGBA16I, 1,
-            getWidth(mVertexCount),
-            getHeight(mVertexCount),
-            mCount,
+            getWidth(texelCount),
+            getHeight(texelCount),
+            layerCount,
             TextureUsage::DEFAULT);
 
     if (auto name = builder.getName(); !name.empty()) {
@@ -144,6 +165,9 @@ void FMorphTargetBuffer::terminate(FEngine& engine) {
 
 void FMorphTargetBuffer::setPositionsAt(FEngine& engine, size_t targetIndex,
         math::float3 const* positions, size_t count, size_t offset) {
+    FILAMENT_CHECK_PRECONDITION(!isSparse())
+            << "sparse MorphTargetBuffer must be updated with setSparseTargets()";
+
     FILAMENT_CHECK_PRECONDITION(offset + count <= mVertexCount)
             << "MorphTargetBuffer (size=" << (unsigned)mVertexCount
             << ") overflow (count=" << (unsigned)count << ", offset=" << (unsigned)offset << ")";
@@ -167,6 +191,9 @@ void FMorphTargetBuffer::setPositionsAt(FEngine& engine, size_t targetIndex,
 
 void FMorphTargetBuffer::setPositionsAt(FEngine& engine, size_t targetIndex,
         math::float4 const* positions, size_t count, size_t offset) {
+    FILAMENT_CHECK_PRECONDITION(!isSparse())
+            << "sparse MorphTargetBuffer must be updated with setSparseTargets()";
+
     FILAMENT_CHECK_PRECONDITION(offset + count <= mVertexCount)
             << "MorphTargetBuffer (size=" << (unsigned)mVertexCount
             << ") overflow (count=" << (unsigned)count << ", offset=" << (unsigned)offset << ")";
@@ -189,6 +216,9 @@ void FMorphTargetBuffer::setPositionsAt(FEngine& engine, size_t targetIndex,
 
 void FMorphTargetBuffer::setTangentsAt(FEngine& engine, size_t targetIndex,
         math::short4 const* tangents, size_t count, size_t offset) {
+    FILAMENT_CHECK_PRECONDITION(!isSparse())
+            << "sparse MorphTargetBuffer must be updated with setSparseTargets()";
+
     FILAMENT_CHECK_PRECONDITION(offset + count <= mVertexCount)
             << "MorphTargetBuffer (size=" << (unsigned)mVertexCount
             << ") overflow (count=" << (unsigned)count << ", offset=" << (unsigned)offset << ")";
@@ -209,6 +239,84 @@ void FMorphTargetBuffer::setTangentsAt(FEngine& engine, size_t targetIndex,
             count, offset);
 }
 
+void FMorphTargetBuffer::setSparseTargets(FEngine& engine,
+        SparseTarget const* targets, size_t count) {
+    FILAMENT_CHECK_PRECONDITION(isSparse())
+            << "MorphTargetBuffer isn't sparse, use setPositionsAt() and setTangentsAt()";
+
+    FILAMENT_CHECK_PRECONDITION(count == mCount)
+            << count << " targets given, the MorphTargetBuffer has " << mCount;
+
+    size_t const vertexCount = mVertexCount;
+    size_t deltaCount = 0;
+    for (size_t t = 0; t < count; t++) {
+        SparseTarget const& target = targets[t];
+        FILAMENT_CHECK_PRECONDITION(!target.count ||
+                (target.indices && target.positions && target.tangents))
+                << "target " << t << " must provide indices, positions and tangents";
+        for (size_t i = 0; i < target.count; i++) {
+            uint32_t const index = target.indices[i];
+            FILAMENT_CHECK_PRECONDITION(index < vertexCount)
+                    << "target " << t << " vertex index " << index
+                    << " must be < " << vertexCount;
+        }
+        deltaCount += target.count;
+    }
+
+    FILAMENT_CHECK_PRECONDITION(deltaCount <= mDeltaCount)
+            << "MorphTargetBuffer (deltaCount=" << mDeltaCount
+            << ") overflow (deltaCount=" << (unsigned)deltaCount << ")";
+
+    // We only upload the texels actually used, the unused deltas at the end are never read.
+    size_t const texelCount = vertexCount + deltaCount;
+
+    // We could use a pool instead of malloc() directly.
+    auto* const positions = (float4*)malloc(getSize<VertexAttribute::POSITION>(texelCount));
+    auto* const tangents = (short4*)malloc(getSize<VertexAttribute::TANGENTS>(texelCount));
+    packSparseTargets(vertexCount, targets, count, positions, tangents);
+
+    FEngine::DriverApi& driver = engine.getDriverApi();
+    updateDataAt(driver, mPbHandle,
+            Texture::Format::RGBA, Texture::Type::FLOAT,
+            (char const*)positions, sizeof(float4), 0,
+            texelCount, 0);
+    updateDataAt(driver, mTbHandle,
+            Texture::Format::RGBA_INTEGER, Texture::Type::SHORT,
+            (char const*)tangents, sizeof(short4), 0,
+            texelCount, 0);
+}
+
+void FMorphTargetBuffer::packSparseTargets(size_t const vertexCount,
+        SparseTarget const* const targets, size_t const count,
+        float4* const positions, short4* const tangents) {
+    // count the deltas of each vertex, then turn the counts into the index of the first one
+    std::vector<uint32_t> first(vertexCount + 1, 0);
+    for (size_t t = 0; t < count; t++) {
+        SparseTarget const& target = targets[t];
+        for (size_t i = 0; i < target.count; i++) {
+            first[target.indices[i] + 1]++;
+        }
+    }
+    for (size_t v = 0; v < vertexCount; v++) {
+        first[v + 1] += first[v];
+    }
+
+    for (size_t v = 0; v < vertexCount; v++) {
+        positions[v] = { float(vertexCount + first[v]), float(first[v + 1] - first[v]), 0, 0 };
+        tangents[v] = {};
+    }
+
+    // scatter the deltas, grouped by vertex, in target order
+    for (size_t t = 0; t < count; t++) {
+        SparseTarget const& target = targets[t];
+        for (size_t i = 0; i < target.count; i++) {
+            size_t const j = vertexCount + first[target.indices[i]]++;
+            positions[j] = float4{ target.positions[i], float(t) };
+            tangents[j] = target.tangents[i];
+        }
+    }
+}
+
 UTILS_NOINLINE
 void FMorphTargetBuffer::updateDataAt(backend::DriverApi& driver,
         Handle<HwTexture> handle, PixelDataFormat format, PixelDataType type,
@@ -217,7 +325,7 @@ void FMorphTargetBuffer::updateDataAt(backend::DriverApi& driver,
 
     size_t yoffset              = offset / MAX_MORPH_TARGET_BUFFER_WIDTH;
     size_t const xoffset        = offset % MAX_MORPH_TARGET_BUFFER_WIDTH;
-    size_t const textureWidth   = getWidth(mVertexCount);
+    size_t const textureWidth   = getWidth(getTexelCount());
     size_t const alignment      = ((textureWidth - xoffset) % textureWidth);
     size_t const lineCount      = (count > alignment) ? (count - alignment) / textureWidth : 0;
     size_t const lastLineCount  = (count > alignment) ? (count - alignment) % textureWidth : 0;
@@ -56,8 +56,16 @@ public:
     void setTangentsAt(FEngine& engine, size_t targetIndex,
             math::short4 const* tangents, size_t count, size_t offset);
 
+    void setSparseTargets(FEngine& engine, SparseTarget const* targets, size_t count);
+
+    // Packs `count` validated targets in the sparse layout (see MorphTargetBuffer.cpp).
+    // `positions` and `tangents` must hold vertexCount texels plus one per delta.
+    static void packSparseTargets(size_t vertexCount, SparseTarget const* targets, size_t count,
+            math::float4* positions, math::short4* tangents);
+
     inline size_t getVertexCount() const noexcept { return mVertexCount; }
     inline size_t getCount() const noexcept { return mCount; }
+    inline bool isSparse() const noexcept { return mDeltaCount != 0; }
 
     backend::TextureHandle getPositionsHandle() const noexcept {
         return mPbHandle;
@@ -68,6 +76,9 @@ public:
     }
 
 private:
+    // number of texels of each layer of the textures
+    size_t getTexelCount() const noexcept { return mVertexCount + mDeltaCount; }
+
     void updateDataAt(backend::DriverApi& driver, backend::Handle <backend::HwTexture> handle,
             backend::PixelDataFormat format, backend::PixelDataType type, const char* out,
             size_t elementSize, size_t targetIndex, size_t count, size_t offset);
@@ -76,6 +87,7 @@ private:
     backend::TextureHandle mTbHandle;
     uint32_t mVertexCount;
     uint32_t mCount;
+    uint32_t mDeltaCount;   // non-zero for the sparse format
 };
 
 FILAMENT_DOWNCAST(MorphTargetBuffer)
@@ -50,6 +50,7 @@
 #include <math/vec3.h>
 #include <math/mat4.h>
 
+#include <utils/Allocator.h>
 #include <utils/compiler.h>
 #include <utils/JobSystem.h>
 #include <utils/Log.h>
@@ -61,6 +62,7 @@
 #include <chrono>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <utility>
 
 #include <stddef.h>
@@ -93,7 +95,8 @@ FRenderer::FRenderer(FEngine& engine) :
         mResourceAllocator(std::make_unique<ResourceAllocator>(
                 engine.getSharedResourceAllocatorDisposer(),
                 engine.getConfig(),
-                engine.getDriverApi()))
+                engine.getDriverApi())),
+        mFrameGraphArea(FrameGraph::ARENA_SIZE)
 {
     FDebugRegistry& debugRegistry = engine.getDebugRegistry();
     debugRegistry.registerProperty("d.renderer.doFrameCapture",
@@ -102,6 +105,11 @@ FRenderer::FRenderer(FEngine& engine) :
             &engine.debug.renderer.disable_buffer_padding);
     debugRegistry.registerProperty("d.renderer.disable_subpasses",
             &engine.debug.renderer.disable_subpasses);
+#ifndef NDEBUG
+    // the allocators only report heap allocations in debug builds
+    debugRegistry.registerProperty("d.renderer.trap_heap_allocations",
+            &engine.debug.renderer.trap_heap_allocations);
+#endif
     debugRegistry.registerProperty("d.shadowmap.display_shadow_texture",
             &engine.debug.shadowmap.display_shadow_texture);
     debugRegistry.registerProperty("d.shadowmap.display_shadow_texture_scale",
@@ -164,6 +172,10 @@ FRenderer::~FRenderer() noexcept {
 #endif
 }
 
+Renderer::ResourceCacheStats FRenderer::getResourceCacheStats() const noexcept {
+    return mResourceAllocator->getStats();
+}
+
 void FRenderer::terminate(FEngine& engine) {
     // Here we would cleanly free resources we've allocated, or we own, in particular we would
     // shut down threads if we created any.
@@ -588,6 +600,15 @@ void FRenderer::renderInternal(FView const* view) {
                                 engine.hasFeatureLevel(FeatureLevel::FEATURE_LEVEL_1))
                     << "post-processing is not supported at FEATURE_LEVEL_0";
 
+#ifndef NDEBUG
+    // report the heap allocations made by this thread while rendering the view. Once warmed-up,
+    // a frame shouldn't need any.
+    std::optional<HeapAllocationTrap::Scope> heapAllocationTrap;
+    if (UTILS_UNLIKELY(engine.debug.renderer.trap_heap_allocations)) {
+        heapAllocationTrap.emplace("FRenderer::render");
+    }
+#endif
+
     // per-renderpass data
     RootArenaScope rootArenaScope(engine.getPerRenderPassArena());
 
@@ -828,7 +849,7 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
      * Frame graph
      */
 
-    FrameGraph fg(*mResourceAllocator,
+    FrameGraph fg(*mResourceAllocator, { mFrameGraphArea.begin(), mFrameGraphArea.end() },
             isProtectedContent ? FrameGraph::Mode::PROTECTED : FrameGraph::Mode::UNPROTECTED);
     auto& blackboard = fg.getBlackboard();
 
@@ -1167,6 +1188,9 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
         passBuilder.renderFlags(renderFlags);
     }
 
+    // when enabled, reuse the previous frame's sorted commands
+    passBuilder.commandCache(view.getColorPassCommandCache());
+
     RenderPass const pass{ passBuilder.build(engine, driver) };
 
     FrameGraphTexture::Descriptor colorBufferDesc = {
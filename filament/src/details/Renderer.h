@@ -155,6 +155,8 @@ public:
         return MAX_FRAMETIME_HISTORY;
     }
 
+    Renderer::ResourceCacheStats getResourceCacheStats() const noexcept;
+
 private:
     friend class Renderer;
     using Command = RenderPass::Command;
@@ -213,6 +215,8 @@ private:
     std::function<void()> mBeginFrameInternal;
     uint64_t mVsyncSteadyClockTimeNano = 0;
     std::unique_ptr<ResourceAllocator> mResourceAllocator{};
+    // memory for the FrameGraph, reused each frame
+    utils::AreaPolicy::HeapArea mFrameGraphArea;
 };
 
 FILAMENT_DOWNCAST(Renderer)
@@ -36,6 +36,8 @@
 #include <math/quat.h>
 
 #include <algorithm>
+#include <limits>
+#include <vector>
 
 using namespace filament::backend;
 using namespace filament::math;
@@ -51,13 +53,59 @@ FScene::FScene(FEngine& engine) :
 
 FScene::~FScene() noexcept = default;
 
+// Computes the per-frame data of renderable `ri` and stores it at `index` in the renderable SoA.
+UTILS_ALWAYS_INLINE
+static inline void prepareRenderable(FScene::RenderableSoa& sceneData, size_t const index,
+        FRenderableManager::Instance const ri, FTransformManager::Instance const ti,
+        FRenderableManager const& rcm, FTransformManager const& tcm,
+        mat4 const& worldTransform, bool const shadowReceiversAreCasters) noexcept {
+
+    // this is where we go from double to float for our transforms
+    const mat4f shaderWorldTransform{
+            worldTransform * tcm.getWorldTransformAccurate(ti) };
+    const bool reversedWindingOrder = det(shaderWorldTransform.upperLeft()) < 0;
+
+    // compute the world AABB so we can perform culling
+    const Box worldAABB = rigidTransform(rcm.getAABB(ri), shaderWorldTransform);
+
+    auto visibility = rcm.getVisibility(ri);
+    visibility.reversedWindingOrder = reversedWindingOrder;
+    if (shadowReceiversAreCasters && visibility.receiveShadows) {
+        visibility.castShadows = true;
+    }
+
+    // FIXME: We compute and store the local scale because it's needed for glTF but
+    //        we need a better way to handle this
+    const mat4f& transform = tcm.getTransform(ti);
+    float const scale = (length(transform[0].xyz) + length(transform[1].xyz) +
+                         length(transform[2].xyz)) / 3.0f;
+
+    assert_invariant(index < sceneData.size());
+
+    sceneData.elementAt<FScene::RENDERABLE_INSTANCE>(index) = ri;
+    sceneData.elementAt<FScene::WORLD_TRANSFORM>(index)     = shaderWorldTransform;
+    sceneData.elementAt<FScene::VISIBILITY_STATE>(index)    = visibility;
+    sceneData.elementAt<FScene::SKINNING_BUFFER>(index)     = rcm.getSkinningBufferInfo(ri);
+    sceneData.elementAt<FScene::MORPHING_BUFFER>(index)     = rcm.getMorphingBufferInfo(ri);
+    sceneData.elementAt<FScene::INSTANCES>(index)           = rcm.getInstancesInfo(ri);
+    sceneData.elementAt<FScene::WORLD_AABB_CENTER>(index)   = worldAABB.center;
+    sceneData.elementAt<FScene::VISIBLE_MASK>(index)        = 0;
+    sceneData.elementAt<FScene::CHANNELS>(index)            = rcm.getChannels(ri);
+    sceneData.elementAt<FScene::LAYERS>(index)              = rcm.getLayerMask(ri);
+    sceneData.elementAt<FScene::WORLD_AABB_EXTENT>(index)   = worldAABB.halfExtent;
+    //sceneData.elementAt<FScene::PRIMITIVES>(index)          = {}; // already initialized, Slice<>
+    sceneData.elementAt<FScene::SUMMED_PRIMITIVE_COUNT>(index) = 0;
+    //sceneData.elementAt<FScene::UBO>(index)                 = {}; // not needed here
+    sceneData.elementAt<FScene::USER_DATA>(index)           = scale;
+}
+
 
 void FScene::prepare(utils::JobSystem& js,
         RootArenaScope& rootArenaScope,
         mat4 const& worldTransform,
         bool shadowReceiversAreCasters) noexcept {
-    // TODO: can we skip this in most cases? Since we rely on indices staying the same,
-    //       we could only skip, if nothing changed in the RCM.
+    // Note: when incremental updates are enabled, the renderable data is only patched with
+    //       what changed since the last call. Otherwise, it's rebuilt from scratch.
 
     SYSTRACE_CALL();
 
@@ -84,11 +132,22 @@ void FScene::prepare(utils::JobSystem& js,
     using LightInstanceContainer = FixedCapacityVector<LightContainerData,
             utils::STLAllocator< LightContainerData, LinearAllocatorArena >, false>;
 
+    // In incremental mode, try to patch the renderable data in place, in which case only the
+    // lights need to be gathered below. This is not possible with hierarchical culling, which
+    // needs the renderable data in the order of its leaves.
+    bool const renderablesUpToDate = mIncrementalUpdate && !mHierarchicalCulling &&
+            updateRenderablesIncrementally(worldTransform, shadowReceiversAreCasters);
+
+    size_t const lightInstancesCapacity = renderablesUpToDate ?
+            mLightEntities.size() : entities.size();
+
     RenderableInstanceContainer renderableInstances{
-            RenderableInstanceContainer::with_capacity(entities.size(), localArenaScope.getArena()) };
+            RenderableInstanceContainer::with_capacity(
+                    renderablesUpToDate ? 0 : entities.size(), localArenaScope.getArena()) };
 
     LightInstanceContainer lightInstances{
-            LightInstanceContainer::with_capacity(entities.size(), localArenaScope.getArena()) };
+            LightInstanceContainer::with_capacity(
+                    lightInstancesCapacity, localArenaScope.getArena()) };
 
     SYSTRACE_NAME_BEGIN("InstanceLoop");
 
@@ -96,36 +155,61 @@ void FScene::prepare(utils::JobSystem& js,
     float maxIntensity = 0.0f;
     std::pair<LightManager::Instance, TransformManager::Instance> directionalLightInstances{};
 
+    auto addLight = [&](LightManager::Instance li, TransformManager::Instance ti) {
+        // we handle the directional light here because it'd prevent multithreading below
+        if (UTILS_UNLIKELY(lcm.isDirectionalLight(li))) {
+            // we don't store the directional lights, because we only have a single one
+            if (lcm.getIntensity(li) >= maxIntensity) {
+                maxIntensity = lcm.getIntensity(li);
+                directionalLightInstances = { li, ti };
+            }
+        } else {
+            lightInstances.emplace_back(li, ti);
+        }
+    };
+
     /*
      * First compute the exact number of renderables and lights in the scene.
      * Also find the main directional light.
      */
 
-    for (Entity const e: entities) {
-        if (UTILS_LIKELY(em.isAlive(e))) {
-            auto ti = tcm.getInstance(e);
-            auto li = lcm.getInstance(e);
-            auto ri = rcm.getInstance(e);
-            if (li) {
-                // we handle the directional light here because it'd prevent multithreading below
-                if (UTILS_UNLIKELY(lcm.isDirectionalLight(li))) {
-                    // we don't store the directional lights, because we only have a single one
-                    if (lcm.getIntensity(li) >= maxIntensity) {
-                        maxIntensity = lcm.getIntensity(li);
-                        directionalLightInstances = { li, ti };
-                    }
-                } else {
-                    lightInstances.emplace_back(li, ti);
+    if (renderablesUpToDate) {
+        for (Entity const e: mLightEntities) {
+            if (UTILS_LIKELY(em.isAlive(e))) {
+                if (auto li = lcm.getInstance(e)) {
+                    addLight(li, tcm.getInstance(e));
                 }
             }
-            if (ri) {
-                renderableInstances.emplace_back(ri, ti);
+        }
+    } else {
+        if (mIncrementalUpdate) {
+            mLightEntities.clear();
+        }
+        for (Entity const e: entities) {
+            if (UTILS_LIKELY(em.isAlive(e))) {
+                auto ti = tcm.getInstance(e);
+                auto li = lcm.getInstance(e);
+                auto ri = rcm.getInstance(e);
+                if (li) {
+                    addLight(li, ti);
+                    if (mIncrementalUpdate) {
+                        mLightEntities.insert(e);
+                    }
+                }
+                if (ri) {
+                    renderableInstances.emplace_back(ri, ti);
+                }
             }
         }
     }
 
     SYSTRACE_NAME_END();
 
+    // With hierarchical culling, `order` gives the renderable to store at each index of the SoA
+    uint32_t const* const order = (mHierarchicalCulling && !renderablesUpToDate) ?
+            prepareCullingHierarchy(renderableInstances.data(), renderableInstances.size(),
+                    worldTransform) : nullptr;
+
     /*
      * Evaluate the capacity needed for the renderable and light SoAs
      */
@@ -148,7 +232,9 @@ void FScene::prepare(utils::JobSystem& js,
 
     // TODO: the resize below could happen in a job
 
-    if (!sceneData.capacity() || sceneData.size() != renderableInstances.size()) {
+    if (renderablesUpToDate) {
+        // nothing to do, the renderable data has been patched in place already
+    } else if (!sceneData.capacity() || sceneData.size() != renderableInstances.size()) {
         sceneData.clear();
         if (sceneData.capacity() < renderableDataCapacity) {
             sceneData.setCapacity(renderableDataCapacity);
@@ -170,51 +256,15 @@ void FScene::prepare(utils::JobSystem& js,
      * Fill the SoA with the JobSystem
      */
 
-    auto renderableWork = [first = renderableInstances.data(), &rcm, &tcm, &worldTransform,
+    auto renderableWork = [first = renderableInstances.data(), order, &rcm, &tcm, &worldTransform,
                  &sceneData, shadowReceiversAreCasters](auto* p, auto c) {
         SYSTRACE_NAME("renderableWork");
 
         for (size_t i = 0; i < c; i++) {
-            auto [ri, ti] = p[i];
-
-            // this is where we go from double to float for our transforms
-            const mat4f shaderWorldTransform{
-                    worldTransform * tcm.getWorldTransformAccurate(ti) };
-            const bool reversedWindingOrder = det(shaderWorldTransform.upperLeft()) < 0;
-
-            // compute the world AABB so we can perform culling
-            const Box worldAABB = rigidTransform(rcm.getAABB(ri), shaderWorldTransform);
-
-            auto visibility = rcm.getVisibility(ri);
-            visibility.reversedWindingOrder = reversedWindingOrder;
-            if (shadowReceiversAreCasters && visibility.receiveShadows) {
-                visibility.castShadows = true;
-            }
-
-            // FIXME: We compute and store the local scale because it's needed for glTF but
-            //        we need a better way to handle this
-            const mat4f& transform = tcm.getTransform(ti);
-            float const scale = (length(transform[0].xyz) + length(transform[1].xyz) +
-                                 length(transform[2].xyz)) / 3.0f;
-
             size_t const index = std::distance(first, p) + i;
-            assert_invariant(index < sceneData.size());
-
-            sceneData.elementAt<RENDERABLE_INSTANCE>(index) = ri;
-            sceneData.elementAt<WORLD_TRANSFORM>(index)     = shaderWorldTransform;
-            sceneData.elementAt<VISIBILITY_STATE>(index)    = visibility;
-            sceneData.elementAt<SKINNING_BUFFER>(index)     = rcm.getSkinningBufferInfo(ri);
-            sceneData.elementAt<MORPHING_BUFFER>(index)     = rcm.getMorphingBufferInfo(ri);
-            sceneData.elementAt<INSTANCES>(index)           = rcm.getInstancesInfo(ri);
-            sceneData.elementAt<WORLD_AABB_CENTER>(index)   = worldAABB.center;
-            sceneData.elementAt<VISIBLE_MASK>(index)        = 0;
-            sceneData.elementAt<CHANNELS>(index)            = rcm.getChannels(ri);
-            sceneData.elementAt<LAYERS>(index)              = rcm.getLayerMask(ri);
-            sceneData.elementAt<WORLD_AABB_EXTENT>(index)   = worldAABB.halfExtent;
-            //sceneData.elementAt<PRIMITIVES>(index)          = {}; // already initialized, Slice<>
-            sceneData.elementAt<SUMMED_PRIMITIVE_COUNT>(index) = 0;
-            //sceneData.elementAt<UBO>(index)                 = {}; // not needed here
-            sceneData.elementAt<USER_DATA>(index)           = scale;
+            auto [ri, ti] = order ? first[order[index]] : p[i];
+            prepareRenderable(sceneData, index, ri, ti, rcm, tcm,
+                    worldTransform, shadowReceiversAreCasters);
         }
     };
 
@@ -246,15 +296,17 @@ void FScene::prepare(utils::JobSystem& js,
 
     JobSystem::Job* rootJob = js.createJob();
 
-    auto* renderableJob = jobs::parallel_for(js, rootJob,
-            renderableInstances.data(), renderableInstances.size(),
-            std::cref(renderableWork), jobs::CountSplitter<64>());
+    if (!renderablesUpToDate) {
+        auto* renderableJob = jobs::parallel_for(js, rootJob,
+                renderableInstances.data(), renderableInstances.size(),
+                std::cref(renderableWork), jobs::CountSplitter<64>());
+        js.run(renderableJob);
+    }
 
     auto* lightJob = jobs::parallel_for(js, rootJob,
             lightInstances.data(), lightInstances.size(),
             std::cref(lightWork), jobs::CountSplitter<32, 5>());
 
-    js.run(renderableJob);
     js.run(lightJob);
 
     // Everything below can be done in parallel.
@@ -324,6 +376,189 @@ void FScene::prepare(utils::JobSystem& js,
     js.runAndWait(rootJob);
 
     SYSTRACE_NAME_END();
+
+    if (order) {
+        mCullingHierarchy.refit(js, sceneData.data<WORLD_AABB_CENTER>(),
+                sceneData.data<WORLD_AABB_EXTENT>(), sceneData.size());
+        if (UTILS_UNLIKELY(mCullingHierarchy.needsRebuild())) {
+            // renderables moved too much since the hierarchy was built, rebuild it next time
+            mCullingHierarchyInstances.clear();
+        }
+    }
+
+    if (mIncrementalUpdate && !renderablesUpToDate) {
+        // the renderable data now reflects the current state of the scene, further updates
+        // can be incremental.
+        mIncrementalDataValid = true;
+        mShadowReceiversAreCasters = shadowReceiversAreCasters;
+        mWorldTransform = worldTransform;
+        mTransformCursor = engine.getTransformManager().getChangeLog().getCursor();
+        mRenderableCursor = engine.getRenderableManager().getChangeLog().getCursor();
+        mLightCursor = engine.getLightManager().getChangeLog().getCursor();
+        mMembershipChanges.clear();
+    }
+}
+
+bool FScene::updateRenderablesIncrementally(mat4 const& worldTransform,
+        bool shadowReceiversAreCasters) noexcept {
+    SYSTRACE_CALL();
+
+    FEngine& engine = mEngine;
+    EntityManager const& em = engine.getEntityManager();
+    FRenderableManager& rcm = engine.getRenderableManager();
+    FTransformManager& tcm = engine.getTransformManager();
+    FLightManager& lcm = engine.getLightManager();
+    auto& sceneData = mRenderableData;
+
+    if (!mIncrementalDataValid || shadowReceiversAreCasters != mShadowReceiversAreCasters) {
+        return false;
+    }
+
+    // the world origin is baked into all world transforms
+    for (size_t i = 0; i < 4; i++) {
+        if (worldTransform[i] != mWorldTransform[i]) {
+            return false;
+        }
+    }
+
+    Slice<const Entity> transformChanges;
+    Slice<const Entity> renderableChanges;
+    Slice<const Entity> lightChanges;
+    if (!tcm.getChangeLog().getChangesSince(mTransformCursor, transformChanges) ||
+        !rcm.getChangeLog().getChangesSince(mRenderableCursor, renderableChanges) ||
+        !lcm.getChangeLog().getChangesSince(mLightCursor, lightChanges)) {
+        // we've lost track of what changed
+        return false;
+    }
+
+    size_t const changeCount = mMembershipChanges.size() +
+            transformChanges.size() + renderableChanges.size() + lightChanges.size();
+
+    if (UTILS_LIKELY(!changeCount)) {
+        return true;
+    }
+
+    // With many changes, rebuilding everything is cheaper, because it happens in parallel.
+    if (changeCount * 4 > mEntities.size()) {
+        return false;
+    }
+
+    // update the set of lights in the scene
+    auto updateLight = [this, &lcm](Entity e) {
+        if (lcm.getInstance(e) && mEntities.find(e) != mEntities.end()) {
+            mLightEntities.insert(e);
+        } else {
+            mLightEntities.erase(e);
+        }
+    };
+    std::for_each(mMembershipChanges.begin(), mMembershipChanges.end(), updateLight);
+    std::for_each(lightChanges.begin(), lightChanges.end(), updateLight);
+
+    // Build the renderable instance to SoA index mapping, the SoA being reordered by each
+    // View. This is only needed if a renderable might have changed.
+    constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+    auto& indices = mRenderableIndices;
+    bool indicesValid = false;
+    auto getIndices = [&]() -> std::vector<uint32_t>& {
+        if (!indicesValid) {
+            indicesValid = true;
+            indices.assign(rcm.getComponentCount() + 1, INVALID_INDEX);
+            auto const* const instances = sceneData.data<RENDERABLE_INSTANCE>();
+            for (size_t i = 0, c = sceneData.size(); i < c; i++) {
+                indices[instances[i]] = uint32_t(i);
+            }
+        }
+        return indices;
+    };
+
+    auto updateRenderable = [&](Entity e) {
+        FRenderableManager::Instance const ri = rcm.getInstance(e);
+        if (!ri) {
+            // renderables can't be destroyed without invalidating the renderable change log,
+            // so this entity has never been in the renderable data.
+            return;
+        }
+
+        bool const inScene = em.isAlive(e) && mEntities.find(e) != mEntities.end();
+        uint32_t& index = getIndices()[ri];
+        if (index == INVALID_INDEX) {
+            if (inScene) {
+                // new renderable, append it at the end. We need the capacity to be multiple of
+                // 16 for SIMD loops and 1 extra entry at the end for the summed primitive count.
+                size_t const size = sceneData.size() + 1;
+                size_t const capacity = ((size + 0xFu) & ~0xFu) + 1;
+                if (sceneData.capacity() < capacity) {
+                    sceneData.setCapacity((((size * 3) / 2 + 0xFu) & ~0xFu) + 1);
+                }
+                sceneData.resize(size);
+                index = uint32_t(size - 1);
+                prepareRenderable(sceneData, index, ri, tcm.getInstance(e), rcm, tcm,
+                        worldTransform, shadowReceiversAreCasters);
+            }
+        } else {
+            if (inScene) {
+                prepareRenderable(sceneData, index, ri, tcm.getInstance(e), rcm, tcm,
+                        worldTransform, shadowReceiversAreCasters);
+            } else {
+                // this renderable is not part of the scene anymore, replace it with the last one
+                size_t const last = sceneData.size() - 1;
+                if (index != last) {
+                    sceneData.swap(index, last);
+                    indices[sceneData.elementAt<RENDERABLE_INSTANCE>(index)] = index;
+                }
+                sceneData.pop_back();
+                index = INVALID_INDEX;
+            }
+        }
+    };
+
+    std::for_each(mMembershipChanges.begin(), mMembershipChanges.end(), updateRenderable);
+    std::for_each(renderableChanges.begin(), renderableChanges.end(), updateRenderable);
+    std::for_each(transformChanges.begin(), transformChanges.end(), [&](Entity e) {
+        // transform changes are not limited to this scene
+        if (rcm.getInstance(e)) {
+            updateRenderable(e);
+        }
+    });
+
+    mTransformCursor = tcm.getChangeLog().getCursor();
+    mRenderableCursor = rcm.getChangeLog().getCursor();
+    mLightCursor = lcm.getChangeLog().getCursor();
+    mMembershipChanges.clear();
+    return true;
+}
+
+uint32_t const* FScene::prepareCullingHierarchy(
+        std::pair<RenderableManager::Instance, TransformManager::Instance> const* instances,
+        size_t count, mat4 const& worldTransform) {
+    auto& builtFor = mCullingHierarchyInstances;
+    bool const upToDate = builtFor.size() == count &&
+            std::equal(builtFor.begin(), builtFor.end(), instances,
+                    [](RenderableManager::Instance ri, auto const& instance) {
+                        return ri == instance.first;
+                    });
+    if (UTILS_LIKELY(upToDate)) {
+        return mCullingHierarchyOrder.data();
+    }
+
+    SYSTRACE_CALL();
+
+    FRenderableManager const& rcm = mEngine.getRenderableManager();
+    FTransformManager const& tcm = mEngine.getTransformManager();
+
+    // the topology is built from the current world-space position of the renderables
+    std::vector<float3> centers(count);
+    builtFor.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        auto const [ri, ti] = instances[i];
+        mat4f const shaderWorldTransform{ worldTransform * tcm.getWorldTransformAccurate(ti) };
+        centers[i] = rigidTransform(rcm.getAABB(ri), shaderWorldTransform).center;
+        builtFor[i] = ri;
+    }
+
+    mCullingHierarchyOrder.resize(count);
+    mCullingHierarchy.build(centers.data(), count, mCullingHierarchyOrder.data());
+    return mCullingHierarchyOrder.data();
 }
 
 void FScene::prepareVisibleRenderables(Range<uint32_t> visibleRenderables) noexcept {
@@ -364,14 +599,17 @@ void FScene::prepareVisibleRenderables(Range<uint32_t> visibleRenderables) noexc
 
         uboData.worldFromModelNormalMatrix = m;
 
+        auto const& morphing = sceneData.elementAt<MORPHING_BUFFER>(i);
+
         uboData.flagsChannels = PerRenderableData::packFlagsChannels(
                 visibility.skinning,
                 visibility.morphing,
                 visibility.screenSpaceContactShadows,
                 sceneData.elementAt<INSTANCES>(i).buffer != nullptr,
+                morphing.morphTargetBuffer && morphing.morphTargetBuffer->isSparse(),
                 sceneData.elementAt<CHANNELS>(i));
 
-        uboData.morphTargetCount = sceneData.elementAt<MORPHING_BUFFER>(i).count;
+        uboData.morphTargetCount = morphing.count;
 
         uboData.objectId = rcm.getEntity(ri).getId();
 
@@ -442,6 +680,43 @@ void FScene::updateUBOs(
 }
 
 void FScene::terminate(FEngine&) {
+    setIncrementalUpdateEnabled(false);
+    setHierarchicalCullingEnabled(false);
+}
+
+void FScene::setIncrementalUpdateEnabled(bool enabled) noexcept {
+    if (enabled == mIncrementalUpdate) {
+        return;
+    }
+    mIncrementalUpdate = enabled;
+    mIncrementalDataValid = false;
+    mMembershipChanges.clear();
+    mLightEntities.clear();
+    mRenderableIndices.clear();
+    mRenderableIndices.shrink_to_fit();
+
+    FEngine& engine = mEngine;
+    if (enabled) {
+        engine.getTransformManager().getChangeLog().retain();
+        engine.getRenderableManager().getChangeLog().retain();
+        engine.getLightManager().getChangeLog().retain();
+    } else {
+        engine.getTransformManager().getChangeLog().release();
+        engine.getRenderableManager().getChangeLog().release();
+        engine.getLightManager().getChangeLog().release();
+    }
+}
+
+void FScene::setHierarchicalCullingEnabled(bool enabled) noexcept {
+    if (enabled == mHierarchicalCulling) {
+        return;
+    }
+    mHierarchicalCulling = enabled;
+    mCullingHierarchy.clear();
+    mCullingHierarchyInstances.clear();
+    mCullingHierarchyInstances.shrink_to_fit();
+    mCullingHierarchyOrder.clear();
+    mCullingHierarchyOrder.shrink_to_fit();
 }
 
 void FScene::prepareDynamicLights(const CameraInfo& camera,
@@ -527,16 +802,25 @@ inline void FScene::computeLightRanges(
 UTILS_NOINLINE
 void FScene::addEntity(Entity entity) {
     mEntities.insert(entity);
+    if (mIncrementalUpdate) {
+        mMembershipChanges.insert(entity);
+    }
 }
 
 UTILS_NOINLINE
 void FScene::addEntities(const Entity* entities, size_t count) {
     mEntities.insert(entities, entities + count);
+    if (mIncrementalUpdate) {
+        mMembershipChanges.insert(entities, entities + count);
+    }
 }
 
 UTILS_NOINLINE
 void FScene::remove(Entity entity) {
     mEntities.erase(entity);
+    if (mIncrementalUpdate) {
+        mMembershipChanges.insert(entity);
+    }
 }
 
 UTILS_NOINLINE
@@ -21,9 +21,11 @@
 
 #include "Allocators.h"
 #include "Culler.h"
+#include "RenderableBvh.h"
 
 #include "ds/DescriptorSet.h"
 
+#include "components/ChangeLog.h"
 #include "components/LightManager.h"
 #include "components/RenderableManager.h"
 #include "components/TransformManager.h"
@@ -33,6 +35,7 @@
 #include <filament/Box.h>
 #include <filament/Scene.h>
 
+#include <math/mat4.h>
 #include <math/mathfwd.h>
 
 #include <utils/compiler.h>
@@ -47,6 +50,8 @@
 #include <tsl/robin_set.h>
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace filament {
 
@@ -191,6 +196,12 @@ public:
 
     bool hasContactShadows() const noexcept;
 
+    // The hierarchy matching the current order of the renderable data, or nullptr. Only valid
+    // between prepare() and the View's partitioning of the renderable data.
+    RenderableBvh const* getCullingHierarchy() const noexcept {
+        return (mHierarchicalCulling && !mCullingHierarchy.empty()) ? &mCullingHierarchy : nullptr;
+    }
+
 private:
     friend class Scene;
     void setSkybox(FSkybox* skybox) noexcept;
@@ -204,6 +215,17 @@ private:
     size_t getLightCount() const noexcept;
     bool hasEntity(utils::Entity entity) const noexcept;
     void forEach(utils::Invocable<void(utils::Entity)>&& functor) const noexcept;
+    void setIncrementalUpdateEnabled(bool enabled) noexcept;
+    bool isIncrementalUpdateEnabled() const noexcept { return mIncrementalUpdate; }
+    void setHierarchicalCullingEnabled(bool enabled) noexcept;
+    bool isHierarchicalCullingEnabled() const noexcept { return mHierarchicalCulling; }
+
+    bool updateRenderablesIncrementally(math::mat4 const& worldTransform,
+            bool shadowReceiversAreCasters) noexcept;
+
+    uint32_t const* prepareCullingHierarchy(
+            std::pair<RenderableManager::Instance, TransformManager::Instance> const* instances,
+            size_t count, math::mat4 const& worldTransform);
 
     static inline void computeLightRanges(math::float2* zrange,
             CameraInfo const& camera, const math::float4* spheres, size_t count) noexcept;
@@ -230,6 +252,36 @@ private:
     LightSoa mLightData;
     bool mHasContactShadows = false;
 
+    /*
+     * State for incremental updates. When enabled, mRenderableData is kept from one prepare()
+     * to the next and only the entries of entities that changed are updated.
+     */
+    bool mIncrementalUpdate = false;
+    bool mIncrementalDataValid = false;         // whether mRenderableData can be patched
+    bool mShadowReceiversAreCasters = false;    // value used for mRenderableData
+    math::mat4 mWorldTransform;                 // value used for mRenderableData
+    ChangeLog::Cursor mTransformCursor = 0;
+    ChangeLog::Cursor mRenderableCursor = 0;
+    ChangeLog::Cursor mLightCursor = 0;
+    // entities added to or removed from the scene since the last prepare()
+    tsl::robin_set<utils::Entity, utils::Entity::Hasher> mMembershipChanges;
+    // entities of the scene with a light component
+    tsl::robin_set<utils::Entity, utils::Entity::Hasher> mLightEntities;
+    // scratch buffer mapping renderable instances to their index in mRenderableData
+    std::vector<uint32_t> mRenderableIndices;
+
+    /*
+     * State for hierarchical culling. When enabled, mRenderableData is stored in the order of
+     * the leaves of mCullingHierarchy, whose topology is kept as long as the renderables of
+     * the scene don't change.
+     */
+    bool mHierarchicalCulling = false;
+    RenderableBvh mCullingHierarchy;
+    // renderable instances the hierarchy was built for, in the order they're gathered
+    std::vector<RenderableManager::Instance> mCullingHierarchyInstances;
+    // index in the gathered renderables of each entry of mRenderableData
+    std::vector<uint32_t> mCullingHierarchyOrder;
+
     // State shared between Scene and driver callbacks.
     struct SharedState {
         BufferPoolAllocator<3> mBufferPoolAllocator = {};
@@ -43,12 +43,19 @@
 #include <utils/compiler.h>
 #include <utils/debug.h>
 #include <utils/FixedCapacityVector.h>
+#include <utils/Invocable.h>
+#include <utils/JobSystem.h>
+#include <utils/Mutex.h>
 #include <utils/Panic.h>
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <stddef.h>
 #include <stdint.h>
@@ -290,6 +297,7 @@ FTexture::FTexture(FEngine& engine, const Builder& builder) {
 
 // frees driver resources, object becomes invalid
 void FTexture::terminate(FEngine& engine) {
+    cancelPrefilterMipmap(engine, false);
     setHandles({});
 }
 
@@ -652,15 +660,43 @@ size_t FTexture::getFormatSize(InternalFormat format) noexcept {
 }
 
 
-void FTexture::generatePrefilterMipmap(FEngine& engine,
-        PixelBufferDescriptor&& buffer, const FaceOffsets& faceOffsets,
-        PrefilterOptions const* options) {
-    using namespace ibl;
-    using namespace backend;
-    using namespace math;
+namespace {
 
-    const size_t size = getWidth();
-    const size_t stride = buffer.stride ? buffer.stride : size;
+// a level of a reflections cubemap, ready to be uploaded
+struct PrefilteredLevel {
+    uint8_t level;
+    ibl::Image image;
+    Texture::FaceOffsets faceOffsets;   // offset of each face in image, in bytes
+};
+
+} // anonymous namespace
+
+struct FTexture::PrefilterTask {
+    // inputs, only used by the job
+    PixelBufferDescriptor buffer;
+    FaceOffsets faceOffsets;
+    PrefilterOptions options;
+    size_t size = 0;
+    size_t levelCount = 0;
+
+    // levels ready to be uploaded, guarded by lock
+    utils::Mutex lock;
+    std::vector<PrefilteredLevel> ready;
+    std::atomic<bool> cancelled = false;
+
+    // only used on the main thread
+    JobSystem::Job* job = nullptr;
+    size_t remaining = 0;
+    backend::CallbackHandler* handler = nullptr;
+    Invocable<void(Texture*)> callback;
+};
+
+static void checkPrefilterPreconditions(FTexture const& texture,
+        Texture::PixelBufferDescriptor const& buffer) {
+    using PixelDataFormat = Texture::PixelBufferDescriptor::PixelDataFormat;
+    using PixelDataType = Texture::PixelBufferDescriptor::PixelDataType;
+
+    const size_t size = texture.getWidth();
 
     /* validate input data */
 
@@ -678,13 +714,24 @@ void FTexture::generatePrefilterMipmap(FEngine& engine,
     FILAMENT_CHECK_PRECONDITION(!(size & (size - 1)))
             << "input data cubemap dimensions must be a power-of-two";
 
-    FILAMENT_CHECK_PRECONDITION(!isCompressed()) << "reflections texture cannot be compressed";
+    FILAMENT_CHECK_PRECONDITION(!texture.isCompressed())
+            << "reflections texture cannot be compressed";
+}
 
-    PrefilterOptions const defaultOptions;
-    options = options ? options : &defaultOptions;
+/*
+ * Prefilters the environment in `buffer` for each level of a size x size reflections cubemap,
+ * from the roughest (smallest) level to the sharpest, and calls emit() with each of them as soon
+ * as it's ready. Stops early if emit() returns false.
+ */
+template<typename Emit>
+static void prefilterEnvironment(JobSystem& js, Texture::PixelBufferDescriptor const& buffer,
+        Texture::FaceOffsets const& faceOffsets, Texture::PrefilterOptions const& options,
+        size_t size, size_t levelCount, Emit&& emit) {
+    using namespace ibl;
+    using namespace backend;
+    using namespace math;
 
-    JobSystem& js = engine.getJobSystem();
-    FEngine::DriverApi& driver = engine.getDriverApi();
+    const size_t stride = buffer.stride ? buffer.stride : size;
 
     auto generateMipmaps = [](JobSystem& js,
             FixedCapacityVector<Cubemap>& levels, FixedCapacityVector<Image>& images) {
@@ -704,6 +751,7 @@ void FTexture::generatePrefilterMipmap(FEngine& engine,
     };
 
 
+
     /*
      * Create a Cubemap data structure
      */
@@ -778,13 +826,13 @@ void FTexture::generatePrefilterMipmap(FEngine& engine,
      * Create the mipmap chain
      */
 
-    auto images = FixedCapacityVector<Image>::with_capacity(getLevels());
-    auto levels = FixedCapacityVector<Cubemap>::with_capacity(getLevels());
+    auto images = FixedCapacityVector<Image>::with_capacity(levelCount);
+    auto levels = FixedCapacityVector<Cubemap>::with_capacity(levelCount);
 
     images.push_back(std::move(temp));
     levels.push_back(std::move(cml));
 
-    const float3 mirror = options->mirror ? float3{ -1, 1, 1 } : float3{ 1, 1, 1 };
+    const float3 mirror = options.mirror ? float3{ -1, 1, 1 } : float3{ 1, 1, 1 };
 
     // make the cubemap seamless
     levels[0].makeSeamless();
@@ -792,11 +840,12 @@ void FTexture::generatePrefilterMipmap(FEngine& engine,
     // Now generate all the mipmap levels
     generateMipmaps(js, levels, images);
 
-    // Finally generate each pre-filtered mipmap level
+    // Finally generate each pre-filtered mipmap level, starting with the roughest (and smallest)
+    // ones, which are the cheapest and give a usable approximation the soonest.
     const size_t baseExp = ctz(size);
-    size_t const numSamples = options->sampleCount;
+    size_t const numSamples = options.sampleCount;
     const size_t numLevels = baseExp + 1;
-    for (ssize_t i = (ssize_t)baseExp; i >= 0; --i) {
+    for (size_t i = 0; i <= baseExp; ++i) {
         const size_t dim = 1U << i;
         const size_t level = baseExp - i;
         const float lod = saturate(float(level) / float(numLevels - 1));
@@ -807,30 +856,154 @@ void FTexture::generatePrefilterMipmap(FEngine& engine,
         CubemapIBL::roughnessFilter(js, dst, { levels.begin(), uint32_t(levels.size()) },
                 linearRoughness, numSamples, mirror, true);
 
-        Texture::PixelBufferDescriptor const pbd(image.getData(), image.getSize(),
-                Texture::PixelBufferDescriptor::PixelDataFormat::RGB,
-                Texture::PixelBufferDescriptor::PixelDataType::FLOAT, 1, 0, 0, image.getStride());
-
+        Texture::FaceOffsets offsets;
         uintptr_t const base = uintptr_t(image.getData());
         for (size_t j = 0; j < 6; j++) {
             Image const& faceImage = dst.getImageForFace((Cubemap::Face)j);
-            auto offset = uintptr_t(faceImage.getData()) - base;
-            driver.update3DImage(mHandle, level, 0, 0, j, dim, dim, 1, {
-                    (char*)image.getData() + offset, dim * dim * 3 * sizeof(float),
-                    Texture::PixelBufferDescriptor::PixelDataFormat::RGB,
-                    Texture::PixelBufferDescriptor::PixelDataType::FLOAT, 1,
-                    0, 0, uint32_t(image.getStride())
-            });
+            offsets[j] = uintptr_t(faceImage.getData()) - base;
         }
 
-        // enqueue a commands that holds the image data until it's executed
-        driver.queueCommand(make_copyable_function([data = image.detach()]() {}));
+        if (!emit(PrefilteredLevel{ uint8_t(level), std::move(image), offsets })) {
+            return;
+        }
+    }
+}
+
+void FTexture::uploadPrefilteredLevel(FEngine& engine, uint8_t level, ibl::Image&& image,
+        FaceOffsets const& faceOffsets, backend::CallbackHandler* handler,
+        PixelBufferDescriptor::Callback callback, void* user) {
+    FEngine::DriverApi& driver = engine.getDriverApi();
+    uint32_t const dim = uint32_t(getWidth(level));
+    for (size_t j = 0; j < 6; j++) {
+        // the callback, if any, goes with the last face so that it's called once they're all done
+        driver.update3DImage(mHandle, level, 0, 0, j, dim, dim, 1, {
+                (char*)image.getData() + faceOffsets[j], dim * dim * 3 * sizeof(float),
+                Texture::PixelBufferDescriptor::PixelDataFormat::RGB,
+                Texture::PixelBufferDescriptor::PixelDataType::FLOAT, 1,
+                0, 0, uint32_t(image.getStride()),
+                j == 5 ? handler : nullptr, j == 5 ? callback : nullptr, user
+        });
     }
 
+    // enqueue a commands that holds the image data until it's executed
+    driver.queueCommand(make_copyable_function([data = image.detach()]() {}));
+
+    updateLodRange(level);
+}
+
+void FTexture::generatePrefilterMipmap(FEngine& engine,
+        PixelBufferDescriptor&& buffer, const FaceOffsets& faceOffsets,
+        PrefilterOptions const* options) {
+    checkPrefilterPreconditions(*this, buffer);
+
+    // this supersedes any pending asynchronous prefiltering
+    cancelPrefilterMipmap(engine, false);
+
+    PrefilterOptions const defaultOptions;
+    options = options ? options : &defaultOptions;
+
+    prefilterEnvironment(engine.getJobSystem(), buffer, faceOffsets, *options,
+            getWidth(), getLevels(), [this, &engine](PrefilteredLevel&& level) {
+                uploadPrefilteredLevel(engine, level.level, std::move(level.image),
+                        level.faceOffsets);
+                return true;
+            });
+
     // no need to call the user callback because buffer is a reference, and it'll be destroyed
     // by the caller (without being move()d here).
 }
 
+void FTexture::generatePrefilterMipmapAsync(FEngine& engine,
+        PixelBufferDescriptor&& buffer, const FaceOffsets& faceOffsets,
+        PrefilterOptions const* options,
+        backend::CallbackHandler* handler, Invocable<void(Texture*)>&& callback) {
+    checkPrefilterPreconditions(*this, buffer);
+
+    cancelPrefilterMipmap(engine, false);
+
+    auto task = std::make_shared<PrefilterTask>();
+    task->buffer = std::move(buffer);
+    task->faceOffsets = faceOffsets;
+    task->options = options ? *options : PrefilterOptions{};
+    task->size = getWidth();
+    task->levelCount = getLevels();
+    task->remaining = ctz(task->size) + 1;
+    task->handler = handler;
+    task->callback = std::move(callback);
+
+    JobSystem& js = engine.getJobSystem();
+    JobSystem::Job* const job = js.createJob(nullptr, [task](JobSystem& js, JobSystem::Job*) {
+        prefilterEnvironment(js, task->buffer, task->faceOffsets, task->options,
+                task->size, task->levelCount, [&task](PrefilteredLevel&& level) {
+                    std::lock_guard const lock(task->lock);
+                    task->ready.push_back(std::move(level));
+                    return !task->cancelled.load(std::memory_order_relaxed);
+                });
+        // we're done with the environment, this calls the user's callback
+        PixelBufferDescriptor const released(std::move(task->buffer));
+    });
+    task->job = js.runInBackgroundAndRetain(job);
+
+    mPrefilterTask = std::move(task);
+    engine.addPendingPrefilter(this);
+}
+
+bool FTexture::updatePrefilterMipmap(FEngine& engine) {
+    PrefilterTask& task = *mPrefilterTask;
+    std::vector<PrefilteredLevel> ready;
+    {
+        std::lock_guard const lock(task.lock);
+        std::swap(ready, task.ready);
+    }
+
+    for (PrefilteredLevel& level : ready) {
+        if (--task.remaining || !task.callback) {
+            uploadPrefilteredLevel(engine, level.level, std::move(level.image),
+                    level.faceOffsets);
+            continue;
+        }
+        // this is the last level, signal the completion once it's uploaded
+        struct Callback {
+            Invocable<void(Texture*)> f;
+            Texture* t;
+            static void func(void*, size_t, void* user) {
+                auto* const c = reinterpret_cast<Callback*>(user);
+                c->f(c->t);
+                delete c;
+            }
+        };
+        auto* const user = new Callback{ std::move(task.callback), this };
+        uploadPrefilteredLevel(engine, level.level, std::move(level.image), level.faceOffsets,
+                task.handler, &Callback::func, user);
+    }
+
+    if (task.remaining) {
+        return false;
+    }
+    engine.getJobSystem().release(task.job);
+    mPrefilterTask.reset();
+    return true;
+}
+
+void FTexture::cancelPrefilterMipmap(FEngine& engine, bool wait) noexcept {
+    if (!mPrefilterTask) {
+        return;
+    }
+    PrefilterTask& task = *mPrefilterTask;
+    task.cancelled.store(true, std::memory_order_relaxed);
+    JobSystem& js = engine.getJobSystem();
+    JobSystem::requestCancellation(task.job);
+    if (wait) {
+        js.waitAndRelease(task.job);
+    } else {
+        // The job's children may still be running, and engine shutdown must wait for them
+        // even after this texture is gone.
+        engine.addCancelledPrefilterJob(task.job);
+    }
+    mPrefilterTask.reset();
+    engine.removePendingPrefilter(this);
+}
+
 bool FTexture::validatePixelFormatAndType(TextureFormat internalFormat,
         PixelDataFormat format, PixelDataType type) noexcept {
 
@@ -26,12 +26,19 @@
 #include <filament/Texture.h>
 
 #include <utils/compiler.h>
+#include <utils/Invocable.h>
+
+#include <memory>
 
 #include <stddef.h>
 #include <stdint.h>
 
 namespace filament {
 
+namespace ibl {
+class Image;
+} // namespace ibl
+
 class FEngine;
 class FStream;
 
@@ -66,6 +73,19 @@ public:
             PixelBufferDescriptor&& buffer, const FaceOffsets& faceOffsets,
             PrefilterOptions const* options);
 
+    void generatePrefilterMipmapAsync(FEngine& engine,
+            PixelBufferDescriptor&& buffer, const FaceOffsets& faceOffsets,
+            PrefilterOptions const* options,
+            backend::CallbackHandler* handler, utils::Invocable<void(Texture*)>&& callback);
+
+    // Uploads the levels prefiltered in the background so far, returns true when all are done.
+    // Must only be called while an asynchronous prefiltering is pending.
+    bool updatePrefilterMipmap(FEngine& engine);
+
+    // Stops the pending asynchronous prefiltering, if any. If wait is false, the job is handed
+    // over to the engine, which waits for it at shutdown.
+    void cancelPrefilterMipmap(FEngine& engine, bool wait) noexcept;
+
     void setExternalImage(FEngine& engine, void* image) noexcept;
     void setExternalImage(FEngine& engine, void* image, size_t plane) noexcept;
     void setExternalStream(FEngine& engine, FStream* stream) noexcept;
@@ -143,6 +163,9 @@ private:
     }
 
     void updateLodRange(uint8_t baseLevel, uint8_t levelCount) noexcept;
+    void uploadPrefilteredLevel(FEngine& engine, uint8_t level, ibl::Image&& image,
+            FaceOffsets const& faceOffsets, backend::CallbackHandler* handler = nullptr,
+            PixelBufferDescriptor::Callback callback = nullptr, void* user = nullptr);
     void setHandles(backend::Handle<backend::HwTexture> handle) noexcept;
     backend::Handle<backend::HwTexture> setHandleForSampling(
             backend::Handle<backend::HwTexture> handle) const noexcept;
@@ -177,6 +200,10 @@ private:
     // there is 4 bytes of padding here
 
     FStream* mStream = nullptr; // only needed for streaming textures
+
+    // state of the pending generatePrefilterMipmapAsync(), shared with its job
+    struct PrefilterTask;
+    std::shared_ptr<PrefilterTask> mPrefilterTask;
 };
 
 FILAMENT_DOWNCAST(Texture)
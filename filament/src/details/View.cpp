@@ -38,8 +38,10 @@
 #include <private/filament/UibStructs.h>
 #include <private/filament/EngineEnums.h>
 
+#include <utils/architecture.h>
 #include <utils/compiler.h>
 #include <utils/debug.h>
+#include <utils/JobSystem.h>
 #include <utils/Profiler.h>
 #include <utils/Slice.h>
 #include <utils/Systrace.h>
@@ -48,7 +50,10 @@
 #include <math/scalar.h>
 #include <math/fast.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <tuple>
 
@@ -492,11 +497,11 @@ void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootAren
      * and in particular their world-space AABB.
      */
 
-    auto getFrustum = [this, &cameraInfo]() -> Frustum {
+    auto getCullingClipFromWorld = [this, &cameraInfo]() -> mat4f {
         if (UTILS_LIKELY(mViewingCamera == nullptr)) {
             // In the common case when we don't have a viewing camera, cameraInfo.view is
             // already the culling view matrix
-            return Frustum{ mat4f{ highPrecisionMultiply(cameraInfo.cullingProjection, cameraInfo.view) }};
+            return mat4f{ highPrecisionMultiply(cameraInfo.cullingProjection, cameraInfo.view) };
         } else {
             // Otherwise, we need to recalculate it from the culling camera.
             // Note: it is correct to always do the math from mCullingCamera, but it hides the
@@ -504,11 +509,12 @@ void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootAren
             // This is an extremely uncommon case.
             const mat4 projection = mCullingCamera->getCullingProjectionMatrix();
             const mat4 view = inverse(cameraInfo.worldTransform * mCullingCamera->getModelMatrix());
-            return Frustum{ mat4f{ projection * view }};
+            return mat4f{ projection * view };
         }
     };
 
-    const Frustum cullingFrustum = getFrustum();
+    const mat4f cullingClipFromWorld = getCullingClipFromWorld();
+    const Frustum cullingFrustum{ cullingClipFromWorld };
 
     FScene* const scene = getScene();
 
@@ -562,8 +568,19 @@ void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootAren
          * (this will set the VISIBLE_RENDERABLE bit)
          */
 
-        prepareVisibleRenderables(js, cullingFrustum, renderableData);
+        prepareVisibleRenderables(js, engine.getConfig().parallelCullingThreshold,
+                cullingFrustum, renderableData);
 
+        /*
+         * Occlusion culling: clears the VISIBLE_RENDERABLE bit of renderables hidden behind
+         * occluders. This must happen before shadow culling so that hidden renderables still
+         * cast shadows.
+         */
+
+        if (UTILS_UNLIKELY(isOcclusionCullingEnabled())) {
+            cullOccludedRenderables(js, engine.getRenderableManager(), viewport,
+                    cullingClipFromWorld, renderableData);
+        }
 
         /*
          * Shadowing: compute the shadow camera and cull shadow casters
@@ -636,8 +653,10 @@ void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootAren
         // calculate the sorting key for all elements, based on their visibility
         uint8_t const* layers = renderableData.data<FScene::LAYERS>();
         auto const* visibility = renderableData.data<FScene::VISIBILITY_STATE>();
+        bool const punctualShadowCastersCulled =
+                needsShadowMap() && mShadowMapManager->arePunctualShadowCastersCulled();
         computeVisibilityMasks(getVisibleLayers(), layers, visibility, cullingMask.begin(),
-                renderableData.size());
+                renderableData.size(), punctualShadowCastersCulled);
 
         auto const beginRenderables = renderableData.begin();
 
@@ -787,7 +806,8 @@ void FView::computeVisibilityMasks(
         uint8_t visibleLayers,
         uint8_t const* UTILS_RESTRICT layers,
         FRenderableManager::Visibility const* UTILS_RESTRICT visibility,
-        Culler::result_type* UTILS_RESTRICT visibleMask, size_t count) {
+        Culler::result_type* UTILS_RESTRICT visibleMask, size_t count,
+        bool punctualShadowCastersCulled) {
     // __restrict__ seems to only be taken into account as function parameters. This is very
     // important here, otherwise, this loop doesn't get vectorized.
     // This is vectorized 16x.
@@ -803,7 +823,11 @@ void FView::computeVisibilityMasks(
         const bool visibleDirectionalShadowRenderable = (v.castShadows && inVisibleLayer) &&
                 (!v.culling || (mask & VISIBLE_DIR_SHADOW_RENDERABLE));
 
-        const bool potentialSpotShadowRenderable = v.castShadows && inVisibleLayer;
+        // when punctual shadow casters were culled, only those near a punctual shadow light
+        // are potential casters
+        const bool potentialSpotShadowRenderable = (v.castShadows && inVisibleLayer) &&
+                (!v.culling || !punctualShadowCastersCulled ||
+                        (mask & VISIBLE_DYN_SHADOW_RENDERABLE));
 
         using Type = Culler::result_type;
 
@@ -923,25 +947,103 @@ void FView::commitFroxels(DriverApi& driverApi) const noexcept {
 }
 
 UTILS_NOINLINE
-void FView::prepareVisibleRenderables(JobSystem& js,
+void FView::prepareVisibleRenderables(JobSystem& js, size_t parallelCullingThreshold,
         Frustum const& frustum, FScene::RenderableSoa& renderableData) const noexcept {
     SYSTRACE_CALL();
     if (UTILS_LIKELY(isFrustumCullingEnabled())) {
-        FView::cullRenderables(js, renderableData, frustum, VISIBLE_RENDERABLE_BIT);
+        FView::cullRenderables(js, renderableData, frustum, VISIBLE_RENDERABLE_BIT,
+                parallelCullingThreshold, mScene->getCullingHierarchy());
     } else {
         std::uninitialized_fill(renderableData.begin<FScene::VISIBLE_MASK>(),
                   renderableData.end<FScene::VISIBLE_MASK>(), VISIBLE_RENDERABLE);
     }
 }
 
-void FView::cullRenderables(JobSystem&,
-        FScene::RenderableSoa& renderableData, Frustum const& frustum, size_t bit) noexcept {
+void FView::setCommandCachingEnabled(bool enabled) noexcept {
+    mCommandCaching = enabled;
+    if (!enabled) {
+        mColorPassCommandCache.clear();
+    }
+}
+
+UTILS_NOINLINE
+void FView::cullOccludedRenderables(JobSystem& js, FRenderableManager const& rcm,
+        filament::Viewport const& viewport, mat4f const& clipFromWorld,
+        FScene::RenderableSoa& renderableData) noexcept {
+    SYSTRACE_CALL();
+
+    // The depth buffer is a lot smaller than the viewport, which is fine because occluders are
+    // expected to be large. Its aspect ratio matches the viewport's, so that pixels are square.
+    constexpr uint32_t OCCLUSION_BUFFER_WIDTH = 256;
+    uint32_t const height = viewport.width ?
+            uint32_t(uint64_t(OCCLUSION_BUFFER_WIDTH) * viewport.height / viewport.width) : 0;
+
+    OcclusionCuller& culler = mOcclusionCuller;
+    culler.prepare(OCCLUSION_BUFFER_WIDTH, height, clipFromWorld);
+
+    auto const* const UTILS_RESTRICT visibility =
+            renderableData.data<FScene::VISIBILITY_STATE>();
+    auto* const UTILS_RESTRICT visibleMask = renderableData.data<FScene::VISIBLE_MASK>();
+    size_t const count = renderableData.size();
+
+    size_t occluderCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (visibility[i].occluder && (visibleMask[i] & VISIBLE_RENDERABLE)) {
+            auto const ri = renderableData.elementAt<FScene::RENDERABLE_INSTANCE>(i);
+            culler.rasterizeOccluder(rcm.getAABB(ri),
+                    renderableData.elementAt<FScene::WORLD_TRANSFORM>(i));
+            occluderCount++;
+        }
+    }
+    if (!occluderCount) {
+        return;
+    }
+    culler.finalize();
+
+    float3 const* const worldAABBCenter = renderableData.data<FScene::WORLD_AABB_CENTER>();
+    float3 const* const worldAABBExtent = renderableData.data<FScene::WORLD_AABB_EXTENT>();
+    std::atomic_uint32_t occludedCount{ 0 };
+
+    auto functor = [&culler, &occludedCount, visibility, visibleMask,
+            worldAABBCenter, worldAABBExtent](uint32_t index, uint32_t c) {
+        uint32_t occluded = 0;
+        for (uint32_t i = index, e = index + c; i < e; i++) {
+            // occluders don't occlude each other, since their boxes are conservative
+            if ((visibleMask[i] & VISIBLE_RENDERABLE) &&
+                    visibility[i].culling && !visibility[i].occluder &&
+                    culler.isOccluded(worldAABBCenter[i], worldAABBExtent[i])) {
+                visibleMask[i] &= ~VISIBLE_RENDERABLE;
+                occluded++;
+            }
+        }
+        occludedCount.fetch_add(occluded, std::memory_order_relaxed);
+    };
+
+    // testing a renderable is a lot more expensive than frustum culling it, so it's worth
+    // going wide even for moderately sized scenes.
+    auto* job = jobs::parallel_for(js, nullptr, 0, uint32_t(count),
+            std::cref(functor), jobs::CountSplitter<256>());
+    js.runAndWait(job);
+
+    SYSTRACE_VALUE32("occludedRenderables", occludedCount.load(std::memory_order_relaxed));
+}
+
+void FView::cullRenderables(JobSystem& js,
+        FScene::RenderableSoa& renderableData, Frustum const& frustum, size_t bit,
+        size_t parallelThreshold, RenderableBvh const* hierarchy) noexcept {
     SYSTRACE_CALL();
 
     float3 const* worldAABBCenter = renderableData.data<FScene::WORLD_AABB_CENTER>();
     float3 const* worldAABBExtent = renderableData.data<FScene::WORLD_AABB_EXTENT>();
     FScene::VisibleMaskType* visibleArray = renderableData.data<FScene::VISIBLE_MASK>();
 
+    if (hierarchy) {
+        assert_invariant(hierarchy->getCount() == renderableData.size());
+        hierarchy->intersects(js, visibleArray, frustum, worldAABBCenter, worldAABBExtent, bit,
+                parallelThreshold);
+        return;
+    }
+
     // culling job (this runs on multiple threads)
     auto functor = [&frustum, worldAABBCenter, worldAABBExtent, visibleArray, bit]
             (uint32_t index, uint32_t c) {
@@ -956,8 +1058,37 @@ void FView::cullRenderables(JobSystem&,
     //       multiples of eight primitives.
     // Moreover, even with a large number of primitives, the overhead of the JobSystem is too
     // large compared to the run time of Culler::intersects, e.g.: ~100us for 4000 primitives
-    // on Pixel4.
-    functor(0, renderableData.size());
+    // on Pixel4. So we only go wide for scenes above `parallelThreshold` renderables.
+    size_t const count = renderableData.size();
+    size_t const threadCount = js.getThreadCount();
+    if (count < parallelThreshold || threadCount <= 1) {
+        functor(0, count);
+        return;
+    }
+
+    // Chunks must be a multiple of Culler::MODULO, and we also want each chunk to cover whole
+    // cache-lines of the visibility mask (which is written to), to avoid false sharing.
+    constexpr size_t CHUNK_GRANULARITY = std::max(Culler::MODULO,
+            CACHELINE_SIZE / sizeof(FScene::VisibleMaskType));
+    static_assert(CHUNK_GRANULARITY % Culler::MODULO == 0);
+
+    // Below this size, a chunk doesn't amortize the cost of its job.
+    constexpr size_t MIN_CHUNK_SIZE = 2048;
+
+    // aim for a couple chunks per thread so that work-stealing can balance the load
+    size_t chunkSize = (count + threadCount * 2 - 1) / (threadCount * 2);
+    chunkSize = std::max(chunkSize, MIN_CHUNK_SIZE);
+    chunkSize = (chunkSize + CHUNK_GRANULARITY - 1) & ~(CHUNK_GRANULARITY - 1);
+
+    JobSystem::Job* parent = js.createJob();
+    for (size_t start = 0; start < count; start += chunkSize) {
+        uint32_t const c = uint32_t(std::min(chunkSize, count - start));
+        js.run(js.createJob(parent,
+                [&functor, start = uint32_t(start), c](JobSystem&, JobSystem::Job*) {
+                    functor(start, c);
+                }));
+    }
+    js.runAndWait(parent);
 }
 
 void FView::prepareVisibleLights(FLightManager const& lcm,
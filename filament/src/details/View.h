@@ -24,7 +24,9 @@
 #include "FrameHistory.h"
 #include "FrameInfo.h"
 #include "Froxelizer.h"
+#include "OcclusionCuller.h"
 #include "PIDController.h"
+#include "RenderPass.h"
 #include "ShadowMapManager.h"
 
 #include "ds/ColorPassDescriptorSet.h"
@@ -130,6 +132,17 @@ public:
     void setFrustumCullingEnabled(bool culling) noexcept { mCulling = culling; }
     bool isFrustumCullingEnabled() const noexcept { return mCulling; }
 
+    void setOcclusionCullingEnabled(bool enabled) noexcept { mOcclusionCulling = enabled; }
+    bool isOcclusionCullingEnabled() const noexcept { return mOcclusionCulling; }
+
+    void setCommandCachingEnabled(bool enabled) noexcept;
+    bool isCommandCachingEnabled() const noexcept { return mCommandCaching; }
+
+    // The cache of the color pass commands, when enabled.
+    RenderPass::CommandCache* getColorPassCommandCache() noexcept {
+        return mCommandCaching ? &mColorPassCommandCache : nullptr;
+    }
+
     void setFrontFaceWindingInverted(bool inverted) noexcept { mFrontFaceWindingInverted = inverted; }
     bool isFrontFaceWindingInverted() const noexcept { return mFrontFaceWindingInverted; }
 
@@ -429,8 +442,14 @@ public:
         }
     }
 
+    // Culls renderableData against the frustum and sets the given visibility bit accordingly.
+    // When there are at least `parallelThreshold` renderables, the work is split into
+    // cache-line aligned chunks processed in parallel by the JobSystem.
+    // If not null, `hierarchy` must match the order of renderableData and is used to cull
+    // whole groups of renderables at once.
     static void cullRenderables(utils::JobSystem& js, FScene::RenderableSoa& renderableData,
-            Frustum const& frustum, size_t bit) noexcept;
+            Frustum const& frustum, size_t bit, size_t parallelThreshold,
+            RenderableBvh const* hierarchy) noexcept;
 
     ColorPassDescriptorSet& getColorPassDescriptorSet() noexcept { return mColorPassDescriptorSet; }
 
@@ -494,9 +513,14 @@ private:
         PickingQueryResult result;
     };
 
-    void prepareVisibleRenderables(utils::JobSystem& js,
+    void prepareVisibleRenderables(utils::JobSystem& js, size_t parallelCullingThreshold,
             Frustum const& frustum, FScene::RenderableSoa& renderableData) const noexcept;
 
+    // Clears the VISIBLE_RENDERABLE bit of the renderables entirely hidden by visible occluders.
+    void cullOccludedRenderables(utils::JobSystem& js, FRenderableManager const& rcm,
+            Viewport const& viewport, math::mat4f const& clipFromWorld,
+            FScene::RenderableSoa& renderableData) noexcept;
+
     static void prepareVisibleLights(FLightManager const& lcm,
             utils::Slice<float> scratch,
             math::mat4f const& viewMatrix, Frustum const& frustum,
@@ -509,7 +533,7 @@ private:
             uint8_t visibleLayers, uint8_t const* layers,
             FRenderableManager::Visibility const* visibility,
             Culler::result_type* visibleMask,
-            size_t count);
+            size_t count, bool punctualShadowCastersCulled);
 
     // we don't inline this one, because the function is quite large and there is not much to
     // gain from inlining.
@@ -530,10 +554,14 @@ private:
     FCamera* mViewingCamera = nullptr;
 
     mutable Froxelizer mFroxelizer;
+    OcclusionCuller mOcclusionCuller;
+    RenderPass::CommandCache mColorPassCommandCache;
     utils::JobSystem::Job* mFroxelizerSync = nullptr;
 
     Viewport mViewport;
     bool mCulling = true;
+    bool mOcclusionCulling = false;
+    bool mCommandCaching = false;
     bool mFrontFaceWindingInverted = false;
     bool mIsTransparentPickingEnabled = false;
 
@@ -165,6 +165,11 @@ public:
         mDescriptorSet[index].bind(driver, DescriptorSetBindingPoints::PER_VIEW);
     }
 
+    // see DescriptorSet::validateBind()
+    void validateBind(uint8_t index) const noexcept {
+        mDescriptorSet[index].validateBind();
+    }
+
 private:
     static constexpr size_t DESCRIPTOR_LAYOUT_COUNT = 8;
 
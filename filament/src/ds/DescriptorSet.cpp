@@ -109,11 +109,16 @@ void DescriptorSet::bind(FEngine::DriverApi& driver, DescriptorSetBindingPoints
 
     assert_invariant(mDescriptorSetHandle);
 
+    validateBind();
+    driver.bindDescriptorSet(mDescriptorSetHandle, +set, std::move(dynamicOffsets));
+}
+
+void DescriptorSet::validateBind() const noexcept {
     // TODO: Make sure clients do the right thing and not change material instance parameters
     // within the renderpass. We have to comment the assert out since it crashed a client's debug
     // build.
     // assert_invariant(mDirty.none());
-    if (mDirty.any() && !mSetAfterCommitWarning) {
+    if (UTILS_UNLIKELY(mDirty.any() && !mSetAfterCommitWarning)) {
         mDirty.forEachSetBit([&](uint8_t binding) {
             utils::slog.w << "Descriptor set (handle=" << mDescriptorSetHandle.getId()
                           << ") binding=" << (int) binding
@@ -121,7 +126,6 @@ void DescriptorSet::bind(FEngine::DriverApi& driver, DescriptorSetBindingPoints
         });
         mSetAfterCommitWarning = true;
     }
-    driver.bindDescriptorSet(mDescriptorSetHandle, +set, std::move(dynamicOffsets));
 }
 
 void DescriptorSet::setBuffer(
@@ -61,6 +61,10 @@ public:
     void bind(backend::DriverApi& driver, DescriptorSetBindingPoints set,
             backend::DescriptorSetOffsetArray dynamicOffsets) const noexcept;
 
+    // performs the checks of bind() ahead of time, after which bind() doesn't modify this
+    // descriptor set and can be called from several threads.
+    void validateBind() const noexcept;
+
     // sets a ubo/ssbo descriptor
     void setBuffer(backend::descriptor_binding_t binding,
             backend::Handle<backend::HwBufferObject> boh,
@@ -20,7 +20,9 @@
 
 namespace filament {
 
-Blackboard::Blackboard() noexcept = default;
+Blackboard::Blackboard(FrameGraphArena& arena) noexcept
+        : mMap(Container::allocator_type(arena)) {
+}
 
 Blackboard::~Blackboard() noexcept = default;
 
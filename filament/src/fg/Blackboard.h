@@ -18,7 +18,9 @@
 #define TNT_FILAMENT_FG_BLACKBOARD_H
 
 #include <fg/FrameGraphId.h>
+#include <fg/details/Utilities.h>
 
+#include <functional>
 #include <string_view>
 #include <unordered_map>
 
@@ -27,10 +29,13 @@ namespace filament {
 class Blackboard {
     using Container = std::unordered_map<
             std::string_view,
-            FrameGraphHandle>;
+            FrameGraphHandle,
+            std::hash<std::string_view>,
+            std::equal_to<std::string_view>,
+            Allocator<std::pair<const std::string_view, FrameGraphHandle>>>;
 
 public:
-    Blackboard() noexcept;
+    explicit Blackboard(FrameGraphArena& arena) noexcept;
     ~Blackboard() noexcept;
 
     FrameGraphHandle& operator [](std::string_view name) noexcept;
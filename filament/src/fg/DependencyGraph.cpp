@@ -18,11 +18,12 @@
 
 #include <utils/Systrace.h>
 
-#include <iterator>
+#include <algorithm>
 
 namespace filament {
 
-DependencyGraph::DependencyGraph() noexcept {
+DependencyGraph::DependencyGraph(FrameGraphArena& arena) noexcept
+        : mArena(arena), mNodes(arena), mEdges(arena) {
     // Some reasonable defaults size for our vectors
     mNodes.reserve(8);
     mEdges.reserve(16);
@@ -37,13 +38,7 @@ uint32_t DependencyGraph::generateNodeId() noexcept {
 void DependencyGraph::registerNode(Node* node, NodeID id) noexcept {
     // Node* is not fully constructed here
     assert_invariant(id == mNodes.size());
-
-    // here we manually grow the fixed-size vector
-    NodeContainer& nodes = mNodes;
-    if (UTILS_UNLIKELY(nodes.capacity() == nodes.size())) {
-        nodes.reserve(nodes.capacity() * 2);
-    }
-    nodes.push_back(node);
+    mNodes.push_back(node);
 }
 
 bool DependencyGraph::isEdgeValid(DependencyGraph::Edge const* edge) const noexcept {
@@ -54,12 +49,7 @@ bool DependencyGraph::isEdgeValid(DependencyGraph::Edge const* edge) const noexc
 }
 
 void DependencyGraph::link(DependencyGraph::Edge* edge) noexcept {
-    // here we manually grow the fixed-size vector
-    EdgeContainer& edges = mEdges;
-    if (UTILS_UNLIKELY(edges.capacity() == edges.size())) {
-        edges.reserve(edges.capacity() * 2);
-    }
-    edges.push_back(edge);
+    mEdges.push_back(edge);
 }
 
 DependencyGraph::EdgeContainer const& DependencyGraph::getEdges() const noexcept {
@@ -71,28 +61,6 @@ DependencyGraph::NodeContainer const& DependencyGraph::getNodes() const noexcept
     return mNodes;
 }
 
-DependencyGraph::EdgeContainer DependencyGraph::getIncomingEdges(
-        DependencyGraph::Node const* node) const noexcept {
-    // TODO: we might need something more efficient
-    auto result = EdgeContainer::with_capacity(mEdges.size());
-    NodeID const nodeId = node->getId();
-    std::copy_if(mEdges.begin(), mEdges.end(),
-            std::back_insert_iterator<EdgeContainer>(result),
-            [nodeId](auto edge) { return edge->to == nodeId; });
-    return result;
-}
-
-DependencyGraph::EdgeContainer DependencyGraph::getOutgoingEdges(
-        DependencyGraph::Node const* node) const noexcept {
-    // TODO: we might need something more efficient
-    auto result = EdgeContainer::with_capacity(mEdges.size());
-    NodeID const nodeId = node->getId();
-    std::copy_if(mEdges.begin(), mEdges.end(),
-            std::back_insert_iterator<EdgeContainer>(result),
-            [nodeId](auto edge) { return edge->from == nodeId; });
-    return result;
-}
-
 DependencyGraph::Node const* DependencyGraph::getNode(DependencyGraph::NodeID id) const noexcept {
     return mNodes[id];
 }
@@ -115,7 +83,8 @@ void DependencyGraph::cull() noexcept {
     }
 
     // cull nodes with a 0 reference count
-    auto stack = NodeContainer::with_capacity(nodes.size());
+    NodeContainer stack(mArena);
+    stack.reserve(nodes.size());
     for (Node* const pNode : nodes) {
         if (pNode->getRefCount() == 0) {
             stack.push_back(pNode);
@@ -124,13 +93,12 @@ void DependencyGraph::cull() noexcept {
     while (!stack.empty()) {
         Node* const pNode = stack.back();
         stack.pop_back();
-        EdgeContainer const& incoming = getIncomingEdges(pNode);
-        for (Edge* edge : incoming) {
+        forEachIncomingEdge(pNode, [&](Edge const* edge) {
             Node* pLinkedNode = getNode(edge->from);
             if (--pLinkedNode->mRefCount == 0) {
                 stack.push_back(pLinkedNode);
             }
-        }
+        });
     }
 }
 
@@ -159,7 +127,8 @@ void DependencyGraph::export_graphviz(utils::io::ostream& out, char const* name)
     for (Node const* node : nodes) {
         uint32_t id = node->getId();
 
-        auto edges = getOutgoingEdges(node);
+        EdgeContainer edges(mArena);
+        forEachOutgoingEdge(node, [&edges](Edge* edge) { edges.push_back(edge); });
         auto first = edges.begin();
         auto pos = std::partition(first, edges.end(),
                 [this](auto const& edge) { return isEdgeValid(edge); });
@@ -194,7 +163,7 @@ void DependencyGraph::export_graphviz(utils::io::ostream& out, char const* name)
 bool DependencyGraph::isAcyclic() const noexcept {
 #ifndef NDEBUG
     // We work on a copy of the graph
-    DependencyGraph graph;
+    DependencyGraph graph(mArena);
     graph.mEdges = mEdges;
     graph.mNodes = mNodes;
     return DependencyGraph::isAcyclicInternal(graph);
@@ -39,6 +39,8 @@
 
 #include <algorithm>
 #include <functional>
+#include <limits>
+#include <tuple>
 
 #include <stdint.h>
 
@@ -75,8 +77,23 @@ FrameGraphId<FrameGraphTexture> FrameGraph::Builder::declareRenderPass(
 // ------------------------------------------------------------------------------------------------
 
 FrameGraph::FrameGraph(ResourceAllocatorInterface& resourceAllocator, Mode mode)
+        : FrameGraph(resourceAllocator, {}, ARENA_SIZE, mode) {
+}
+
+FrameGraph::FrameGraph(ResourceAllocatorInterface& resourceAllocator,
+        utils::AreaPolicy::StaticArea const& area, Mode mode)
+        : FrameGraph(resourceAllocator, area, 0, mode) {
+}
+
+FrameGraph::FrameGraph(ResourceAllocatorInterface& resourceAllocator,
+        utils::AreaPolicy::StaticArea const& area, size_t heapAreaSize, Mode mode)
         : mResourceAllocator(resourceAllocator),
-          mArena("FrameGraph Arena", 262144),
+          mHeapArea(heapAreaSize),
+          mArena("FrameGraph Arena", heapAreaSize ?
+                  utils::AreaPolicy::StaticArea{ mHeapArea.begin(), mHeapArea.end() } :
+                  utils::AreaPolicy::StaticArea{ area }),
+          mBlackboard(mArena),
+          mGraph(mArena),
           mMode(mode),
           mResourceSlots(mArena),
           mResources(mArena),
@@ -92,7 +109,7 @@ FrameGraph::FrameGraph(ResourceAllocatorInterface& resourceAllocator, Mode mode)
 UTILS_NOINLINE
 void FrameGraph::destroyInternal() noexcept {
     // the order of destruction is important here
-    LinearAllocatorArena& arena = mArena;
+    FrameGraphArena& arena = mArena;
     std::for_each(mPassNodes.begin(), mPassNodes.end(), [&arena](auto item) {
         arena.destroy(item);
     });
@@ -143,22 +160,20 @@ FrameGraph& FrameGraph::compile() noexcept {
         assert_invariant(!passNode->isCulled());
 
 
-        auto const& reads = dependencyGraph.getIncomingEdges(passNode);
-        for (auto const& edge : reads) {
+        dependencyGraph.forEachIncomingEdge(passNode, [&](DependencyGraph::Edge const* edge) {
             // all incoming edges should be valid by construction
             assert_invariant(dependencyGraph.isEdgeValid(edge));
             auto pNode = static_cast<ResourceNode*>(dependencyGraph.getNode(edge->from));
             passNode->registerResource(pNode->resourceHandle);
-        }
+        });
 
-        auto const& writes = dependencyGraph.getOutgoingEdges(passNode);
-        for (auto const& edge : writes) {
+        dependencyGraph.forEachOutgoingEdge(passNode, [&](DependencyGraph::Edge const* edge) {
             // An outgoing edge might be invalid if the node it points to has been culled
             // but because we are not culled, and we're a pass we add a reference to
             // the resource we are writing to.
             auto pNode = static_cast<ResourceNode*>(dependencyGraph.getNode(edge->to));
             passNode->registerResource(pNode->resourceHandle);
-        }
+        });
 
         passNode->resolve();
     }
@@ -190,9 +205,117 @@ FrameGraph& FrameGraph::compile() noexcept {
         pNode->resolveResourceUsage(dependencyGraph);
     }
 
+    planTransientTextures();
+
     return *this;
 }
 
+void FrameGraph::planTransientTextures() noexcept {
+    SYSTRACE_CALL();
+
+    /*
+     * The ResourceAllocator recycles a texture destroyed by a pass into a later texture with
+     * the same description, so textures with disjoint lifetimes already share concrete textures
+     * when they match exactly. Here we make more of them match, by giving the same usage to all
+     * the textures that differ only by their usage. We're careful to keep attachment-only
+     * textures apart because backends can use lazily-allocated memory for them.
+     * Passes are executed in the order of their id, which we use as a timeline.
+     */
+
+    using Usage = FrameGraphTexture::Usage;
+
+    struct Candidate {
+        Resource<FrameGraphTexture>* resource;
+        uint32_t begin;     // id of the first pass using the texture
+        uint32_t end;       // id of the last pass using the texture, UINT32_MAX if detached
+        size_t size;
+    };
+
+    auto const attachmentOnly = [](Usage usage) {
+        return any(usage & Usage::ALL_ATTACHMENTS) && none(usage & ~Usage::ALL_ATTACHMENTS);
+    };
+
+    // only textures with the same key can share a concrete texture
+    auto const key = [&attachmentOnly](Candidate const& c) {
+        auto const& d = c.resource->descriptor;
+        return std::make_tuple(d.type, d.format, d.width, d.height, d.depth, d.levels,
+                std::max(d.samples, uint8_t(1)),
+                d.swizzle.r, d.swizzle.g, d.swizzle.b, d.swizzle.a,
+                attachmentOnly(c.resource->usage));
+    };
+
+    Vector<Candidate> candidates(mArena);
+    candidates.reserve(mResources.size());
+    for (VirtualResource* pResource : mResources) {
+        // FrameGraphTexture is the only type of resource
+        auto* const resource = static_cast<Resource<FrameGraphTexture>*>(pResource);
+        if (!resource->refcount || !resource->first ||
+                resource->isSubResource() || resource->isImported()) {
+            continue;
+        }
+        auto const& d = resource->descriptor;
+        candidates.push_back({ resource,
+                uint32_t(resource->first->getId()),
+                resource->detached ? std::numeric_limits<uint32_t>::max() :
+                        uint32_t(resource->last->getId()),
+                ResourceAllocator::getTextureSize(d.format, std::max(d.samples, uint8_t(1)),
+                        d.levels, d.width, d.height, d.depth) });
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [&key](auto const& lhs, auto const& rhs) {
+        auto const l = key(lhs);
+        auto const r = key(rhs);
+        return l < r || (l == r && lhs.begin < rhs.begin);
+    });
+
+    TransientTextureStats stats{};
+    Vector<uint32_t> slots(mArena); // last pass of the texture assigned to each concrete texture
+    slots.reserve(candidates.size());
+    for (auto first = candidates.begin(); first != candidates.end();) {
+        auto const last = std::find_if(first, candidates.end(), [&](auto const& c) {
+            return key(c) != key(*first);
+        });
+
+        Usage usage{};
+        std::for_each(first, last, [&usage](auto const& c) { usage |= c.resource->usage; });
+
+        // Textures are sorted by their first pass, so greedily reusing any concrete texture
+        // whose last user came before, yields the minimum number of concrete textures.
+        slots.clear();
+        for (auto it = first; it != last; ++it) {
+            it->resource->usage = usage;
+            auto const pos = std::find_if(slots.begin(), slots.end(),
+                    [begin = it->begin](uint32_t end) { return end < begin; });
+            if (pos == slots.end()) {
+                slots.push_back(it->end);
+            } else {
+                *pos = it->end;
+            }
+            stats.size += it->size;
+        }
+        stats.textureCount += uint32_t(last - first);
+        stats.physicalTextureCount += uint32_t(slots.size());
+        stats.physicalSize += slots.size() * first->size;
+        first = last;
+    }
+
+    // the high-water mark is reached when a texture is created
+    for (auto const& c : candidates) {
+        size_t live = 0;
+        for (auto const& other : candidates) {
+            if (other.begin <= c.begin && c.begin <= other.end) {
+                live += other.size;
+            }
+        }
+        stats.peakSize = std::max(stats.peakSize, live);
+    }
+
+    SYSTRACE_VALUE32("transientTexturesKiB", uint32_t(stats.physicalSize >> 10));
+    SYSTRACE_VALUE32("transientTexturesPeakKiB", uint32_t(stats.peakSize >> 10));
+
+    mTransientTextureStats = stats;
+}
+
 void FrameGraph::execute(backend::DriverApi& driver) noexcept {
 
     bool const useProtectedMemory = mMode == Mode::PROTECTED;
@@ -291,7 +414,7 @@ FrameGraphHandle FrameGraph::addSubResourceInternal(FrameGraphHandle parent,
 }
 
 FrameGraphHandle FrameGraph::readInternal(FrameGraphHandle handle, PassNode* passNode,
-        const std::function<bool(ResourceNode*, VirtualResource*)>& connect) {
+        const std::function<bool(DependencyGraph&, ResourceNode*, VirtualResource*)>& connect) {
 
     assertValid(handle);
 
@@ -311,7 +434,7 @@ FrameGraphHandle FrameGraph::readInternal(FrameGraphHandle handle, PassNode* pas
     }
 
     // Connect can fail if usage flags are incorrectly used
-    if (connect(node, resource)) {
+    if (connect(mGraph, node, resource)) {
         if (resource->isSubResource()) {
             // this is a read() from a subresource, so we need to add a "read" from the parent's
             // node to the subresource -- but we may have two parent nodes, one for reads and
@@ -349,7 +472,7 @@ FrameGraphHandle FrameGraph::readInternal(FrameGraphHandle handle, PassNode* pas
 }
 
 FrameGraphHandle FrameGraph::writeInternal(FrameGraphHandle handle, PassNode* passNode,
-        const std::function<bool(ResourceNode*, VirtualResource*)>& connect) {
+        const std::function<bool(DependencyGraph&, ResourceNode*, VirtualResource*)>& connect) {
 
     assertValid(handle);
 
@@ -381,7 +504,7 @@ FrameGraphHandle FrameGraph::writeInternal(FrameGraphHandle handle, PassNode* pa
         }
     }
 
-    if (connect(node, resource)) {
+    if (connect(mGraph, node, resource)) {
         if (resource->isSubResource()) {
             node->setParentWriteDependency(parentNode);
         }
@@ -223,8 +223,21 @@ public:
         PROTECTED,
     };
 
+    //! size of the memory a FrameGraph allocates all its data from
+    static constexpr size_t ARENA_SIZE = 262144;
+
     explicit FrameGraph(ResourceAllocatorInterface& resourceAllocator,
             Mode mode = Mode::UNPROTECTED);
+
+    /**
+     * Creates a FrameGraph that allocates all its data from memory owned by the caller, which
+     * can then reuse that memory from one frame to the next.
+     * @param resourceAllocator allocator for the concrete resources
+     * @param area              memory to allocate from, must outlive the FrameGraph.
+     * @param mode              whether resources use protected memory
+     */
+    FrameGraph(ResourceAllocatorInterface& resourceAllocator,
+            utils::AreaPolicy::StaticArea const& area, Mode mode = Mode::UNPROTECTED);
     FrameGraph(FrameGraph const&) = delete;
     FrameGraph& operator=(FrameGraph const&) = delete;
     ~FrameGraph() noexcept;
@@ -238,6 +251,18 @@ public:
     /** Empty struct to use for passes with no data */
     struct Empty { };
 
+    /**
+     * Memory used by the textures the FrameGraph allocates (i.e. not imported), computed by
+     * compile(). Sizes are estimates in bytes, see ResourceAllocator::getTextureSize().
+     */
+    struct TransientTextureStats {
+        uint32_t textureCount = 0;          // number of virtual textures
+        uint32_t physicalTextureCount = 0;  // number of concrete textures needed after aliasing
+        size_t size = 0;                    // total size of the virtual textures
+        size_t physicalSize = 0;            // total size of the concrete textures
+        size_t peakSize = 0;                // high-water mark of the size of the live textures
+    };
+
     /**
      * Add a pass to the frame graph. Typically:
      *
@@ -291,6 +316,13 @@ public:
      */
     FrameGraph& compile() noexcept;
 
+    /**
+     * Returns the memory used by the textures of this frame, valid after compile().
+     */
+    TransientTextureStats const& getTransientTextureStats() const noexcept {
+        return mTransientTextureStats;
+    }
+
     /**
      * Execute all referenced passes
      *
@@ -440,7 +472,10 @@ private:
     friend class ResourceNode;
     friend class RenderPassNode;
 
-    LinearAllocatorArena& getArena() noexcept { return mArena; }
+    FrameGraph(ResourceAllocatorInterface& resourceAllocator,
+            utils::AreaPolicy::StaticArea const& area, size_t heapAreaSize, Mode mode);
+
+    FrameGraphArena& getArena() noexcept { return mArena; }
     DependencyGraph& getGraph() noexcept { return mGraph; }
     ResourceAllocatorInterface& getResourceAllocator() noexcept { return mResourceAllocator; }
 
@@ -460,9 +495,9 @@ private:
     FrameGraphHandle addResourceInternal(VirtualResource* resource) noexcept;
     FrameGraphHandle addSubResourceInternal(FrameGraphHandle parent, VirtualResource* resource) noexcept;
     FrameGraphHandle readInternal(FrameGraphHandle handle, PassNode* passNode,
-            const std::function<bool(ResourceNode*, VirtualResource*)>& connect);
+            const std::function<bool(DependencyGraph&, ResourceNode*, VirtualResource*)>& connect);
     FrameGraphHandle writeInternal(FrameGraphHandle handle, PassNode* passNode,
-            const std::function<bool(ResourceNode*, VirtualResource*)>& connect);
+            const std::function<bool(DependencyGraph&, ResourceNode*, VirtualResource*)>& connect);
     FrameGraphHandle forwardResourceInternal(FrameGraphHandle resourceHandle,
             FrameGraphHandle replaceResourceHandle);
 
@@ -519,9 +554,12 @@ private:
 
     void destroyInternal() noexcept;
 
-    Blackboard mBlackboard;
+    void planTransientTextures() noexcept;
+
     ResourceAllocatorInterface& mResourceAllocator;
-    LinearAllocatorArena mArena;
+    utils::AreaPolicy::HeapArea mHeapArea; // only used if the caller doesn't provide the memory
+    FrameGraphArena mArena;
+    Blackboard mBlackboard;
     DependencyGraph mGraph;
     const Mode mMode;
 
@@ -530,6 +568,7 @@ private:
     Vector<ResourceNode*> mResourceNodes;
     Vector<PassNode*> mPassNodes;
     Vector<PassNode*>::iterator mActivePassNodesEnd;
+    TransientTextureStats mTransientTextureStats;
 };
 
 template<typename Data, typename Setup, typename Execute>
@@ -599,10 +638,11 @@ FrameGraphId<RESOURCE> FrameGraph::import(char const* name,
 template<typename RESOURCE>
 FrameGraphId<RESOURCE> FrameGraph::read(PassNode* passNode, FrameGraphId<RESOURCE> input,
         typename RESOURCE::Usage usage) {
+    // the lambda is kept small enough for std::function to store it without allocating
     FrameGraphId<RESOURCE> result(readInternal(input, passNode,
-            [this, passNode, usage](ResourceNode* node, VirtualResource* vrsrc) {
+            [passNode, usage](DependencyGraph& graph, ResourceNode* node, VirtualResource* vrsrc) {
                 Resource<RESOURCE>* resource = static_cast<Resource<RESOURCE>*>(vrsrc);
-                return resource->connect(mGraph, node, passNode, usage);
+                return resource->connect(graph, node, passNode, usage);
             }));
     return result;
 }
@@ -611,9 +651,9 @@ template<typename RESOURCE>
 FrameGraphId<RESOURCE> FrameGraph::write(PassNode* passNode, FrameGraphId<RESOURCE> input,
         typename RESOURCE::Usage usage) {
     FrameGraphId<RESOURCE> result(writeInternal(input, passNode,
-            [this, passNode, usage](ResourceNode* node, VirtualResource* vrsrc) {
+            [passNode, usage](DependencyGraph& graph, ResourceNode* node, VirtualResource* vrsrc) {
                 Resource<RESOURCE>* resource = static_cast<Resource<RESOURCE>*>(vrsrc);
-                return resource->connect(mGraph, passNode, node, usage);
+                return resource->connect(graph, passNode, node, usage);
             }));
     return result;
 }
@@ -38,8 +38,7 @@ VirtualResource& FrameGraphResources::getResource(FrameGraphHandle handle) const
 
     VirtualResource* const resource = mFrameGraph.getResource(handle);
 
-    auto& declaredHandles = mPassNode.mDeclaredHandles;
-    const bool hasReadOrWrite = declaredHandles.find(handle.index) != declaredHandles.cend();
+    const bool hasReadOrWrite = mPassNode.hasDeclaredHandle(handle);
 
     FILAMENT_CHECK_PRECONDITION(hasReadOrWrite)
             << "Pass \"" << mPassNode.getName() << "\" didn't declare any access to resource \""
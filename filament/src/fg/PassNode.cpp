@@ -32,6 +32,7 @@ namespace filament {
 PassNode::PassNode(FrameGraph& fg) noexcept
         : DependencyGraph::Node(fg.getGraph()),
           mFrameGraph(fg),
+          mDeclaredHandles(fg.getArena()),
           devirtualize(fg.getArena()),
           destroy(fg.getArena()) {
 }
@@ -47,13 +48,16 @@ utils::CString PassNode::graphvizifyEdgeColor() const noexcept {
 void PassNode::registerResource(FrameGraphHandle resourceHandle) noexcept {
     VirtualResource* resource = mFrameGraph.getResource(resourceHandle);
     resource->neededByPass(this);
-    mDeclaredHandles.insert(resourceHandle.index);
+    if (!hasDeclaredHandle(resourceHandle)) {
+        mDeclaredHandles.push_back(resourceHandle.index);
+    }
 }
 
 // ------------------------------------------------------------------------------------------------
 
 RenderPassNode::RenderPassNode(FrameGraph& fg, const char* name, FrameGraphPassBase* base) noexcept
-        : PassNode(fg), mName(name), mPassBase(base, fg.getArena()) {
+        : PassNode(fg), mName(name), mPassBase(base, fg.getArena()),
+          mRenderTargetData(fg.getArena()) {
 }
 RenderPassNode::RenderPassNode(RenderPassNode&& rhs) noexcept = default;
 RenderPassNode::~RenderPassNode() noexcept = default;
@@ -87,7 +91,6 @@ uint32_t RenderPassNode::declareRenderTarget(FrameGraph& fg, FrameGraph::Builder
     // to compute the discard flags.
 
     DependencyGraph const& dependencyGraph = fg.getGraph();
-    auto incomingEdges = dependencyGraph.getIncomingEdges(this);
 
     for (size_t i = 0; i < RenderPassData::ATTACHMENT_COUNT; i++) {
         FrameGraphId<FrameGraphTexture> const& handle =
@@ -96,19 +99,13 @@ uint32_t RenderPassNode::declareRenderTarget(FrameGraph& fg, FrameGraph::Builder
             data.attachmentInfo[i] = handle;
 
             // TODO: this is not very efficient
-            auto incomingPos = std::find_if(incomingEdges.begin(), incomingEdges.end(),
-                    [&dependencyGraph, handle]
-                            (DependencyGraph::Edge const* edge) {
-                        ResourceNode const* node = static_cast<ResourceNode const*>(
-                                dependencyGraph.getNode(edge->from));
-                        return node->resourceHandle == handle;
-                    });
-
-            if (incomingPos != incomingEdges.end()) {
-                data.incoming[i] = const_cast<ResourceNode*>(
-                        static_cast<ResourceNode const*>(
-                                dependencyGraph.getNode((*incomingPos)->from)));
-            }
+            dependencyGraph.forEachIncomingEdge(this, [&](DependencyGraph::Edge const* edge) {
+                ResourceNode const* node = static_cast<ResourceNode const*>(
+                        dependencyGraph.getNode(edge->from));
+                if (!data.incoming[i] && node->resourceHandle == handle) {
+                    data.incoming[i] = const_cast<ResourceNode*>(node);
+                }
+            });
 
             // this could be either outgoing or incoming (if there are no outgoing)
             data.outgoing[i] = fg.getActiveResourceNode(handle);
@@ -28,13 +28,15 @@ ResourceNode::ResourceNode(FrameGraph& fg, FrameGraphHandle h, FrameGraphHandle
 ResourceNode::~ResourceNode() noexcept {
     VirtualResource* resource = mFrameGraph.getResource(resourceHandle);
     assert_invariant(resource);
-    resource->destroyEdge(mWriterPass);
+    DependencyGraph& graph = mFrameGraph.getGraph();
+    resource->destroyEdge(graph, mWriterPass);
     for (auto* pEdge : mReaderPasses) {
-        resource->destroyEdge(pEdge);
+        resource->destroyEdge(graph, pEdge);
     }
-    delete mParentReadEdge;
-    delete mParentWriteEdge;
-    delete mForwardedEdge;
+    FrameGraphArena& arena = mFrameGraph.getArena();
+    arena.destroy(mParentReadEdge);
+    arena.destroy(mParentWriteEdge);
+    arena.destroy(mForwardedEdge);
 }
 
 ResourceNode* ResourceNode::getParentNode() noexcept {
@@ -69,21 +71,22 @@ void ResourceNode::setIncomingEdge(ResourceEdgeBase* edge) noexcept {
 bool ResourceNode::hasActiveReaders() const noexcept {
     // here we don't use mReaderPasses because this wouldn't account for subresources
     DependencyGraph& dependencyGraph = mFrameGraph.getGraph();
-    auto const& readers = dependencyGraph.getOutgoingEdges(this);
-    for (auto const& reader : readers) {
-        if (!dependencyGraph.getNode(reader->to)->isCulled()) {
-            return true;
-        }
-    }
-    return false;
+    bool hasActiveReaders = false;
+    dependencyGraph.forEachOutgoingEdge(this, [&](DependencyGraph::Edge const* reader) {
+        hasActiveReaders = hasActiveReaders || !dependencyGraph.getNode(reader->to)->isCulled();
+    });
+    return hasActiveReaders;
 }
 
 bool ResourceNode::hasActiveWriters() const noexcept {
     // here we don't use mReaderPasses because this wouldn't account for subresources
     DependencyGraph const& dependencyGraph = mFrameGraph.getGraph();
-    auto const& writers = dependencyGraph.getIncomingEdges(this);
     // writers are not culled by definition if we're not culled ourselves
-    return !writers.empty();
+    bool hasWriters = false;
+    dependencyGraph.forEachIncomingEdge(this, [&](DependencyGraph::Edge const*) {
+        hasWriters = true;
+    });
+    return hasWriters;
 }
 
 ResourceEdgeBase* ResourceNode::getReaderEdgeForPass(PassNode const* node) const noexcept {
@@ -105,20 +108,23 @@ bool ResourceNode::hasWriteFrom(PassNode const* node) const noexcept {
 
 void ResourceNode::setParentReadDependency(ResourceNode* parent) noexcept {
     if (!mParentReadEdge) {
-        mParentReadEdge = new DependencyGraph::Edge(mFrameGraph.getGraph(), parent, this);
+        mParentReadEdge = mFrameGraph.getArena().make<DependencyGraph::Edge>(
+                mFrameGraph.getGraph(), parent, this);
     }
 }
 
 
 void ResourceNode::setParentWriteDependency(ResourceNode* parent) noexcept {
     if (!mParentWriteEdge) {
-        mParentWriteEdge = new DependencyGraph::Edge(mFrameGraph.getGraph(), this, parent);
+        mParentWriteEdge = mFrameGraph.getArena().make<DependencyGraph::Edge>(
+                mFrameGraph.getGraph(), this, parent);
     }
 }
 
 void ResourceNode::setForwardResourceDependency(ResourceNode* source) noexcept {
     assert_invariant(!mForwardedEdge);
-    mForwardedEdge = new DependencyGraph::Edge(mFrameGraph.getGraph(), this, source);
+    mForwardedEdge = mFrameGraph.getArena().make<DependencyGraph::Edge>(
+            mFrameGraph.getGraph(), this, source);
 }
 
 
@@ -17,13 +17,12 @@
 #ifndef TNT_FILAMENT_FG_DETAILS_DEPENDENCYGRAPH_H
 #define TNT_FILAMENT_FG_DETAILS_DEPENDENCYGRAPH_H
 
+#include "fg/details/Utilities.h"
+
 #include <utils/ostream.h>
 #include <utils/CString.h>
-#include <utils/FixedCapacityVector.h>
 #include <utils/debug.h>
 
-#include <vector>
-
 namespace filament {
 
 /**
@@ -31,7 +30,11 @@ namespace filament {
  */
 class DependencyGraph {
 public:
-    DependencyGraph() noexcept;
+    /**
+     * Creates an empty graph. Its lists of nodes and edges are allocated from `arena`.
+     * @param arena arena to allocate from, must outlive the graph.
+     */
+    explicit DependencyGraph(FrameGraphArena& arena) noexcept;
     ~DependencyGraph() noexcept;
     DependencyGraph(const DependencyGraph&) noexcept = delete;
     DependencyGraph& operator=(const DependencyGraph&) noexcept = delete;
@@ -127,8 +130,8 @@ public:
         const NodeID mId;           // unique id
     };
 
-    using EdgeContainer = utils::FixedCapacityVector<Edge*, std::allocator<Edge*>, false>;
-    using NodeContainer = utils::FixedCapacityVector<Node*, std::allocator<Node*>, false>;
+    using EdgeContainer = Vector<Edge*>;
+    using NodeContainer = Vector<Node*>;
 
     /**
      * Removes all edges and nodes from the graph.
@@ -142,19 +145,38 @@ public:
     /** return the list of all nodes */
     NodeContainer const& getNodes() const noexcept;
 
+    /** return the arena the graph allocates from, nodes and edges can be allocated from it too */
+    FrameGraphArena& getArena() const noexcept { return mArena; }
+
     /**
-     * Returns the list of incoming edges to a node
+     * Calls a function for each incoming edge to a node
      * @param node the node to consider
-     * @return A list of incoming edges
+     * @param f    function called with each incoming Edge*
      */
-    EdgeContainer getIncomingEdges(Node const* node) const noexcept;
+    template<typename F>
+    void forEachIncomingEdge(Node const* node, F&& f) const noexcept {
+        NodeID const nodeId = node->getId();
+        for (Edge* const edge : mEdges) {
+            if (edge->to == nodeId) {
+                f(edge);
+            }
+        }
+    }
 
     /**
-     * Returns the list of outgoing edges to a node
+     * Calls a function for each outgoing edge of a node
      * @param node the node to consider
-     * @return A list of outgoing edges
+     * @param f    function called with each outgoing Edge*
      */
-    EdgeContainer getOutgoingEdges(Node const* node) const noexcept;
+    template<typename F>
+    void forEachOutgoingEdge(Node const* node, F&& f) const noexcept {
+        NodeID const nodeId = node->getId();
+        for (Edge* const edge : mEdges) {
+            if (edge->from == nodeId) {
+                f(edge);
+            }
+        }
+    }
 
     Node const* getNode(NodeID id) const noexcept;
 
@@ -181,6 +203,7 @@ private:
     void registerNode(Node* node, NodeID id) noexcept;
     void link(Edge* edge) noexcept;
     static bool isAcyclicInternal(DependencyGraph& graph) noexcept;
+    FrameGraphArena& mArena;
     NodeContainer mNodes;
     EdgeContainer mEdges;
 };
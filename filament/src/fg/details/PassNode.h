@@ -26,7 +26,7 @@
 
 #include <backend/TargetBufferInfo.h>
 
-#include <unordered_set>
+#include <algorithm>
 
 namespace utils {
 class CString;
@@ -43,7 +43,7 @@ class PassNode : public DependencyGraph::Node {
 protected:
     friend class FrameGraphResources;
     FrameGraph& mFrameGraph;
-    std::unordered_set<FrameGraphHandle::Index> mDeclaredHandles;
+    Vector<FrameGraphHandle::Index> mDeclaredHandles; // a pass only declares a few handles
 public:
     explicit PassNode(FrameGraph& fg) noexcept;
     PassNode(PassNode&& rhs) noexcept;
@@ -54,6 +54,11 @@ public:
 
     void registerResource(FrameGraphHandle resourceHandle) noexcept;
 
+    bool hasDeclaredHandle(FrameGraphHandle handle) const noexcept {
+        return std::find(mDeclaredHandles.begin(), mDeclaredHandles.end(), handle.index) !=
+                mDeclaredHandles.end();
+    }
+
     virtual void execute(FrameGraphResources const& resources, backend::DriverApi& driver) noexcept = 0;
     virtual void resolve() noexcept = 0;
     utils::CString graphvizifyEdgeColor() const noexcept override;
@@ -101,10 +106,10 @@ private:
 
     // constants
     const char* const mName = nullptr;
-    UniquePtr<FrameGraphPassBase, LinearAllocatorArena> mPassBase;
+    UniquePtr<FrameGraphPassBase, FrameGraphArena> mPassBase;
 
     // set during setup
-    std::vector<RenderPassData> mRenderTargetData;
+    Vector<RenderPassData> mRenderTargetData;
 };
 
 class PresentPassNode : public PassNode {
@@ -91,7 +91,7 @@ public:
     virtual void destroy(ResourceAllocatorInterface& resourceAllocator) noexcept = 0;
 
     /* Destroy an Edge instantiated by this resource */
-    virtual void destroyEdge(DependencyGraph::Edge* edge) noexcept = 0;
+    virtual void destroyEdge(DependencyGraph& graph, DependencyGraph::Edge* edge) noexcept = 0;
 
     virtual utils::CString usageString() const noexcept = 0;
 
@@ -169,7 +169,7 @@ public:
         if (edge) {
             edge->usage |= u;
         } else {
-            edge = new ResourceEdge(graph,
+            edge = graph.getArena().make<ResourceEdge>(graph,
                     toDependencyGraphNode(passNode), toDependencyGraphNode(resourceNode), u);
             setIncomingEdge(resourceNode, edge);
         }
@@ -186,7 +186,7 @@ public:
         if (edge) {
             edge->usage |= u;
         } else {
-            edge = new ResourceEdge(graph,
+            edge = graph.getArena().make<ResourceEdge>(graph,
                     toDependencyGraphNode(resourceNode), toDependencyGraphNode(passNode), u);
             addOutgoingEdge(resourceNode, edge);
         }
@@ -225,9 +225,9 @@ protected:
         }
     }
 
-    void destroyEdge(DependencyGraph::Edge* edge) noexcept override {
+    void destroyEdge(DependencyGraph& graph, DependencyGraph::Edge* edge) noexcept override {
         // this Edge is guaranteed to be a ResourceEdge<RESOURCE> by construction
-        delete static_cast<ResourceEdge *>(edge);
+        graph.getArena().destroy(static_cast<ResourceEdge *>(edge));
     }
 
     void devirtualize(ResourceAllocatorInterface& resourceAllocator,
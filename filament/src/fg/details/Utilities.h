@@ -33,8 +33,24 @@ struct Deleter {
     void operator()(T* object) noexcept { arena->destroy(object); }
 };
 
+// The FrameGraph allocates everything it needs for a frame from this arena, which doesn't own
+// its memory, so that memory can be reused from one frame to the next.
+#ifndef NDEBUG
+using FrameGraphArena = utils::Arena<
+        utils::LinearAllocator,
+        utils::LockingPolicy::NoLock,
+        utils::TrackingPolicy::DebugAndHighWatermark,
+        utils::AreaPolicy::StaticArea>;
+#else
+using FrameGraphArena = utils::Arena<
+        utils::LinearAllocator,
+        utils::LockingPolicy::NoLock,
+        utils::TrackingPolicy::Untracked,
+        utils::AreaPolicy::StaticArea>;
+#endif
+
 template<typename T, typename ARENA> using UniquePtr = std::unique_ptr<T, Deleter<T, ARENA>>;
-template<typename T> using Allocator = utils::STLAllocator<T, LinearAllocatorArena>;
+template<typename T> using Allocator = utils::STLAllocator<T, FrameGraphArena>;
 template<typename T> using Vector = std::vector<T, Allocator<T>>; // 32 bytes
 
 } // namespace filament
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "BlobCache.h"
+#include "WarmUpManifest.h"
+
+#include <utils/Path.h>
+
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace filament;
+using namespace utils;
+
+class BlobCacheTest : public testing::Test {
+protected:
+    void SetUp() override {
+        mDirectory = Path::getTemporaryDirectory().concat(
+                "filament_BlobCache_test_" + std::to_string(rand()));
+    }
+
+    void TearDown() override {
+        for (Path const& path : mDirectory.listContents()) {
+            Path(path).unlinkFile();
+        }
+        remove(mDirectory.c_str());
+    }
+
+    Path mDirectory;
+};
+
+TEST_F(BlobCacheTest, InsertRetrieve) {
+    std::string const key = "key";
+    std::vector<char> const value(100, 'v');
+    std::vector<char> result(100);
+    {
+        BlobCache cache(mDirectory.getPath(), 1024);
+        EXPECT_EQ(cache.retrieve(key.data(), key.size(), result.data(), result.size()), 0);
+        cache.insert(key.data(), key.size(), value.data(), value.size());
+        EXPECT_EQ(cache.retrieve(key.data(), key.size(), result.data(), result.size()), 100);
+        EXPECT_EQ(result, value);
+    }
+
+    // the entries survive the cache
+    BlobCache cache(mDirectory.getPath(), 1024);
+    result.assign(100, 0);
+    EXPECT_EQ(cache.retrieve(key.data(), key.size(), result.data(), result.size()), 100);
+    EXPECT_EQ(result, value);
+
+    // too small buffers only get the size
+    char small = 0;
+    EXPECT_EQ(cache.retrieve(key.data(), key.size(), &small, 1), 100);
+    EXPECT_EQ(small, 0);
+}
+
+TEST_F(BlobCacheTest, EvictsLeastRecentlyUsed) {
+    std::vector<char> const value(200, 'v');
+    std::vector<char> result(200);
+    BlobCache cache(mDirectory.getPath(), 1024);
+    for (char k = 'a'; k <= 'd'; k++) {
+        cache.insert(&k, 1, value.data(), value.size());
+    }
+    char const a = 'a';
+    EXPECT_EQ(cache.retrieve(&a, 1, result.data(), result.size()), 200);
+
+    // this doesn't fit, the least recently used entries are evicted
+    char const e = 'e';
+    cache.insert(&e, 1, value.data(), value.size());
+    EXPECT_LE(cache.getSize(), 1024);
+    EXPECT_EQ(cache.retrieve(&a, 1, result.data(), result.size()), 200);
+    EXPECT_EQ(cache.retrieve(&e, 1, result.data(), result.size()), 200);
+    char const b = 'b';
+    EXPECT_EQ(cache.retrieve(&b, 1, result.data(), result.size()), 0);
+}
+
+TEST_F(BlobCacheTest, WarmUpManifest) {
+    mDirectory.mkdirRecursive();
+    std::string const path = mDirectory.concat("warmup").getPath();
+    {
+        WarmUpManifest manifest(path);
+        EXPECT_FALSE(manifest.acquire(42).any());
+        manifest.record(42, Variant{ 3 });
+        manifest.record(42, Variant{ 7 });
+        EXPECT_TRUE(manifest.save());
+    }
+
+    WarmUpManifest manifest(path);
+    VariantList const variants = manifest.acquire(42);
+    EXPECT_EQ(variants.count(), 2);
+    EXPECT_TRUE(variants[3]);
+    EXPECT_TRUE(variants[7]);
+    EXPECT_FALSE(manifest.acquire(43).any());
+}
+
+TEST_F(BlobCacheTest, DirtyUntilSaved) {
+    mDirectory.mkdirRecursive();
+    WarmUpManifest manifest(mDirectory.concat("warmup").getPath());
+    EXPECT_FALSE(manifest.isDirty());
+    manifest.record(42, Variant{ 3 });
+    EXPECT_TRUE(manifest.isDirty());
+    EXPECT_TRUE(manifest.save());
+    EXPECT_FALSE(manifest.isDirty());
+
+    // recording the same variant again doesn't change the manifest
+    manifest.record(42, Variant{ 3 });
+    EXPECT_FALSE(manifest.isDirty());
+
+    std::vector<char> const value(100, 'v');
+    BlobCache cache(mDirectory.getPath(), 1024);
+    EXPECT_FALSE(cache.isDirty());
+    char const k = 'k';
+    cache.insert(&k, 1, value.data(), value.size());
+    EXPECT_TRUE(cache.isDirty());
+    cache.flush();
+    EXPECT_FALSE(cache.isDirty());
+
+    // retrieving entries doesn't require saving the index
+    std::vector<char> result(100);
+    EXPECT_EQ(cache.retrieve(&k, 1, result.data(), result.size()), 100);
+    EXPECT_FALSE(cache.isDirty());
+}
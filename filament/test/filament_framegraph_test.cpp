@@ -96,7 +96,9 @@ public:
 };
 
 TEST(DependencyGraphTest, Simple) {
-    DependencyGraph graph;
+    utils::AreaPolicy::HeapArea area(65536);
+    FrameGraphArena arena("DependencyGraphTest", { area.begin(), area.end() });
+    DependencyGraph graph(arena);
     Node* n0 = new Node(graph, "node 0");
     Node* n1 = new Node(graph, "node 1");
     Node* n2 = new Node(graph, "node 2");
@@ -128,7 +130,9 @@ TEST(DependencyGraphTest, Simple) {
 }
 
 TEST(DependencyGraphTest, Culling1) {
-    DependencyGraph graph;
+    utils::AreaPolicy::HeapArea area(65536);
+    FrameGraphArena arena("DependencyGraphTest", { area.begin(), area.end() });
+    DependencyGraph graph(arena);
     Node* n0 = new Node(graph, "node 0");
     Node* n1 = new Node(graph, "node 1");
     Node* n2 = new Node(graph, "node 2");
@@ -165,7 +169,9 @@ TEST(DependencyGraphTest, Culling1) {
 }
 
 TEST(DependencyGraphTest, Culling2) {
-    DependencyGraph graph;
+    utils::AreaPolicy::HeapArea area(65536);
+    FrameGraphArena arena("DependencyGraphTest", { area.begin(), area.end() });
+    DependencyGraph graph(arena);
     Node* n0 = new Node(graph, "node 0");
     Node* n1 = new Node(graph, "node 1");
     Node* n2 = new Node(graph, "node 2");
@@ -232,6 +238,35 @@ TEST_F(FrameGraphTest, ReadRead) {
     fg.execute(driverApi);
 }
 
+TEST_F(FrameGraphTest, ReuseArea) {
+    struct PassData {
+        FrameGraphId<FrameGraphTexture> output;
+    };
+    // Successive FrameGraphs can allocate from the same memory
+    utils::AreaPolicy::HeapArea area(FrameGraph::ARENA_SIZE);
+    for (size_t i = 0; i < 2; i++) {
+        FrameGraph graph(resourceAllocator, { area.begin(), area.end() });
+        auto& pass = graph.addPass<PassData>("Pass", [&](FrameGraph::Builder& builder, auto& data) {
+                    data.output = builder.create<FrameGraphTexture>("Output buffer", {.width=16, .height=32});
+                    data.output = builder.write(data.output, FrameGraphTexture::Usage::COLOR_ATTACHMENT);
+                    builder.declareRenderPass("Render target", {.attachments = {.color = {data.output}}});
+                },
+                [=](FrameGraphResources const& resources, auto const& data, backend::DriverApi& driver) {
+                    EXPECT_EQ(resources.getUsage(data.output), FrameGraphTexture::Usage::COLOR_ATTACHMENT);
+                });
+        graph.getBlackboard()["output"] = pass->output;
+        graph.present(graph.getBlackboard().get<FrameGraphTexture>("output"));
+
+        EXPECT_TRUE(graph.isAcyclic());
+
+        graph.compile();
+
+        EXPECT_FALSE(graph.isCulled(pass));
+
+        graph.execute(driverApi);
+    }
+}
+
 TEST_F(FrameGraphTest, WriteWrite) {
     struct PassData {
         FrameGraphId<FrameGraphTexture> output1;
@@ -951,3 +986,114 @@ TEST_F(FrameGraphTest, WriteResourceReadAsAttachment) {
 
     fg.execute(driverApi);
 }
+
+TEST_F(FrameGraphTest, TransientTextureAliasing) {
+
+    // Textures that only differ by their usage and whose lifetimes don't overlap must share
+    // the same concrete texture.
+
+    ResourceAllocator allocator{ Engine::Config{}, driverApi };
+    FrameGraph graph{ allocator };
+
+    struct PassData {
+        FrameGraphId<FrameGraphTexture> input;
+        FrameGraphId<FrameGraphTexture> output;
+    };
+
+    FrameGraphTexture::Descriptor const desc{ .width = 16, .height = 32 };
+    backend::TextureHandle handles[3];
+
+    auto& passA = graph.addPass<PassData>("Pass A", [&](FrameGraph::Builder& builder, auto& data) {
+                data.output = builder.create<FrameGraphTexture>("Texture A", desc);
+                data.output = builder.declareRenderPass(data.output);
+            },
+            [&](FrameGraphResources const& resources, auto const& data, backend::DriverApi&) {
+                handles[0] = resources.get(data.output).handle;
+            });
+
+    auto& passB = graph.addPass<PassData>("Pass B", [&](FrameGraph::Builder& builder, auto& data) {
+                data.input = builder.sample(passA->output);
+                data.output = builder.create<FrameGraphTexture>("Texture B", desc);
+                data.output = builder.declareRenderPass(data.output);
+            },
+            [&](FrameGraphResources const& resources, auto const& data, backend::DriverApi&) {
+                handles[1] = resources.get(data.output).handle;
+            });
+
+    auto& passC = graph.addPass<PassData>("Pass C", [&](FrameGraph::Builder& builder, auto& data) {
+                data.input = builder.sample(passB->output);
+                data.output = builder.create<FrameGraphTexture>("Texture C", desc);
+                data.output = builder.declareRenderPass(data.output);
+            },
+            [&](FrameGraphResources const& resources, auto const& data, backend::DriverApi&) {
+                handles[2] = resources.get(data.output).handle;
+            });
+
+    graph.addPass<PassData>("Pass D", [&](FrameGraph::Builder& builder, auto& data) {
+                // Texture C gets an extra usage, which makes it different from Texture A
+                data.input = builder.read(passC->output,
+                        FrameGraphTexture::Usage::SAMPLEABLE | FrameGraphTexture::Usage::BLIT_SRC);
+                builder.sideEffect();
+            },
+            [=](FrameGraphResources const&, auto const&, backend::DriverApi&) {
+            });
+
+    graph.compile();
+
+    FrameGraph::TransientTextureStats const& stats = graph.getTransientTextureStats();
+    size_t const size = 16 * 32 * 4;
+    EXPECT_EQ(stats.textureCount, 3);
+    EXPECT_EQ(stats.physicalTextureCount, 2);
+    EXPECT_EQ(stats.size, 3 * size);
+    EXPECT_EQ(stats.physicalSize, 2 * size);
+    EXPECT_EQ(stats.peakSize, 2 * size);
+
+    graph.execute(driverApi);
+
+    EXPECT_TRUE((bool)handles[0]);
+    EXPECT_NE(handles[0], handles[1]);
+    EXPECT_NE(handles[1], handles[2]);
+    EXPECT_EQ(handles[0], handles[2]);
+
+    allocator.terminate();
+}
+
+TEST_F(FrameGraphTest, ResourceAllocatorCacheBudget) {
+    Engine::Config config{};
+    config.resourceAllocatorCacheBudgetMB = 1;
+    ResourceAllocator allocator{ config, driverApi };
+
+    using TS = backend::TextureSwizzle;
+    std::array<TS, 4> const swizzle{ TS::CHANNEL_0, TS::CHANNEL_1, TS::CHANNEL_2, TS::CHANNEL_3 };
+    auto create = [&](uint32_t size) {
+        return allocator.createTexture("texture", SamplerType::SAMPLER_2D, 1,
+                TextureFormat::RGBA8, 1, size, size, 1, swizzle, TextureUsage::COLOR_ATTACHMENT);
+    };
+
+    // both textures don't fit in the budget, the largest one is evicted
+    backend::TextureHandle const small = create(16);
+    allocator.destroyTexture(create(512));
+    allocator.destroyTexture(small);
+    allocator.gc();
+
+    ResourceAllocator::Stats stats = allocator.getStats();
+    EXPECT_EQ(stats.hitCount, 0);
+    EXPECT_EQ(stats.missCount, 2);
+    EXPECT_EQ(stats.evictionCount, 1);
+    EXPECT_EQ(stats.createdSize, 512 * 512 * 4 + 16 * 16 * 4);
+    EXPECT_EQ(stats.evictedSize, 512 * 512 * 4);
+    EXPECT_EQ(stats.cacheSize, 16 * 16 * 4);
+
+    // the small texture is still in the cache
+    backend::TextureHandle const reused = create(16);
+    EXPECT_EQ(reused, small);
+    allocator.destroyTexture(reused);
+    allocator.gc();
+
+    stats = allocator.getStats();
+    EXPECT_EQ(stats.hitCount, 1);
+    EXPECT_EQ(stats.missCount, 0);
+    EXPECT_EQ(stats.evictionCount, 0);
+
+    allocator.terminate();
+}
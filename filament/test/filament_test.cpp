@@ -15,7 +15,9 @@
  */
 
 #include <iostream>
+#include <limits>
 #include <random>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -31,6 +33,13 @@
 #include <filament/Frustum.h>
 #include <filament/Material.h>
 #include <filament/Engine.h>
+#include <filament/RenderableManager.h>
+#include <filament/Renderer.h>
+#include <filament/Scene.h>
+#include <filament/SwapChain.h>
+#include <filament/TransformManager.h>
+#include <filament/View.h>
+#include <filament/Viewport.h>
 
 #include <private/filament/BufferInterfaceBlock.h>
 #include <private/filament/UibStructs.h>
@@ -40,11 +49,19 @@
 #include "details/Material.h"
 #include "details/Camera.h"
 #include "Froxelizer.h"
+#include "OcclusionCuller.h"
+#include "RenderableBvh.h"
+#include "RenderPass.h"
 #include "details/Engine.h"
+#include "details/MorphTargetBuffer.h"
+#include "details/Scene.h"
+#include "details/View.h"
 #include "components/RenderableManager.h"
 #include "components/TransformManager.h"
 #include "UniformBuffer.h"
 
+#include <utils/JobSystem.h>
+
 using namespace filament;
 using namespace filament::math;
 using namespace utils;
@@ -300,6 +317,82 @@ TEST(FilamentTest, TransformManager) {
     EXPECT_EQ(c, tcm.getChildCount(newParent));
 }
 
+TEST(FilamentTest, TransformManagerTransactions) {
+    // `reference` is updated serially, and without transactions when possible
+    JobSystem js(4);
+    js.adopt();
+    filament::FTransformManager tcm;
+    filament::FTransformManager reference;
+    tcm.init(js);
+
+    // large enough to commit in parallel
+    constexpr size_t COUNT = 10000;
+    EntityManager& em = EntityManager::get();
+    std::vector<Entity> entities(COUNT);
+    em.create(entities.size(), entities.data());
+
+    std::default_random_engine generator(82828); // NOLINT
+    auto rand = [&generator](size_t n) { return size_t(generator() % n); };
+
+    for (size_t i = 0; i < COUNT; i++) {
+        Entity const parent = (i && rand(8)) ? entities[rand(i)] : Entity{};
+        mat4f const m = mat4f::translation(float3{ float(i % 13), 1, 2 }) *
+                mat4f::rotation(0.01f * float(i), float3{ 0, 0, 1 });
+        tcm.create(entities[i], tcm.getInstance(parent), m);
+        reference.create(entities[i], reference.getInstance(parent), m);
+    }
+
+    auto check = [&]() {
+        for (Entity const e : entities) {
+            if (reference.hasComponent(e)) {
+                mat4f const expected = reference.getWorldTransform(reference.getInstance(e));
+                mat4f const actual = tcm.getWorldTransform(tcm.getInstance(e));
+                for (size_t i = 0; i < 4; i++) {
+                    for (size_t j = 0; j < 4; j++) {
+                        EXPECT_NEAR(expected[i][j], actual[i][j],
+                                1e-3f * std::max(1.0f, std::abs(expected[i][j])));
+                    }
+                }
+            }
+        }
+    };
+
+    // a few changes only update the dirty subtrees, many changes update everything
+    for (size_t changeCount : { 1, 10, 100, 1000, 10000 }) {
+        tcm.openLocalTransformTransaction();
+        for (size_t i = 0; i < changeCount; i++) {
+            Entity const e = entities[rand(COUNT)];
+            mat4f const m = mat4f::translation(float3{ float(i), float(changeCount), 0 });
+            tcm.setTransform(tcm.getInstance(e), m);
+            reference.setTransform(reference.getInstance(e), m);
+        }
+        // move a subtree under a root created after it, so that nodes must be reordered
+        Entity const child = entities[rand(COUNT / 2)];
+        Entity const root = entities[COUNT / 2 + rand(COUNT / 2)];
+        if (!tcm.getParent(tcm.getInstance(root))) {
+            tcm.setParent(tcm.getInstance(child), tcm.getInstance(root));
+            reference.setParent(reference.getInstance(child), reference.getInstance(root));
+        }
+        tcm.commitLocalTransformTransaction();
+        check();
+    }
+
+    // destroying a node orphans its children
+    tcm.openLocalTransformTransaction();
+    reference.openLocalTransformTransaction();
+    for (size_t i = 0; i < 10; i++) {
+        Entity const e = entities[rand(COUNT)];
+        tcm.destroy(e);
+        reference.destroy(e);
+    }
+    tcm.commitLocalTransformTransaction();
+    reference.commitLocalTransformTransaction();
+    check();
+
+    em.destroy(entities.size(), entities.data());
+    js.emancipate();
+}
+
 TEST(FilamentTest, UniformInterfaceBlock) {
 
     BufferInterfaceBlock::Builder b;
@@ -612,6 +705,336 @@ TEST(FilamentTest, SphereCulling) {
     EXPECT_TRUE(frustum.intersects({ 0, 200 }));
 }
 
+TEST(FilamentTest, HierarchicalCulling) {
+    JobSystem js;
+    js.adopt();
+
+    constexpr size_t count = 10000;
+    Frustum const frustum(mat4f::frustum(-1, 1, -1, 1, 1, 100));
+    float4 const sphere{ 20, 0, -50, 30 };
+
+    std::default_random_engine gen; // NOLINT
+    std::uniform_int_distribution<int> position(-200, 200);
+    std::uniform_int_distribution<int> size(1, 8);
+
+    std::vector<float3> centers(count);
+    std::vector<float3> extents(count);
+    for (size_t i = 0; i < count; i++) {
+        centers[i] = { position(gen), position(gen), position(gen) };
+        extents[i] = float3{ size(gen), size(gen), size(gen) } * 0.5f;
+    }
+
+    RenderableBvh bvh;
+    std::vector<uint32_t> order(count);
+    bvh.build(centers.data(), count, order.data());
+
+    // store the boxes in tree order, with room for the Culler's rounding
+    size_t const capacity = Culler::round(count);
+    std::vector<float3> c(capacity);
+    std::vector<float3> e(capacity);
+    for (size_t i = 0; i < count; i++) {
+        c[i] = centers[order[i]];
+        e[i] = extents[order[i]];
+    }
+    bvh.refit(js, c.data(), e.data(), count);
+    EXPECT_FALSE(bvh.needsRebuild());
+
+    // the hierarchy must give the same results as culling every box
+    std::vector<Culler::result_type> expected(capacity, 0);
+    Culler::Test::intersects(expected.data(), frustum, c.data(), e.data(), count);
+
+    for (size_t parallelThreshold : { std::numeric_limits<size_t>::max(), size_t(0) }) {
+        std::vector<Culler::result_type> results(capacity, 0xFE);
+        bvh.intersects(js, results.data(), frustum, c.data(), e.data(), 0, parallelThreshold);
+        for (size_t i = 0; i < count; i++) {
+            EXPECT_EQ(expected[i] & 1, results[i] & 1);
+            EXPECT_EQ(0xFE, results[i] & 0xFE);
+        }
+    }
+
+    // sphere queries only set the bit of the boxes touching the sphere
+    std::vector<Culler::result_type> results(capacity, 0);
+    bvh.intersects(results.data(), sphere, c.data(), e.data(), 2);
+    for (size_t i = 0; i < count; i++) {
+        float3 const d = clamp(sphere.xyz, c[i] - e[i], c[i] + e[i]) - sphere.xyz;
+        bool const touches = dot(d, d) <= sphere.w * sphere.w;
+        EXPECT_EQ(touches ? 4 : 0, results[i]);
+    }
+
+    // moving boxes far apart degrades the hierarchy
+    for (size_t i = 0; i < count; i++) {
+        c[i] *= 10.0f;
+    }
+    bvh.refit(js, c.data(), e.data(), count);
+    EXPECT_TRUE(bvh.needsRebuild());
+
+    js.emancipate();
+}
+
+TEST(FilamentTest, SortCommandsRadix) {
+    JobSystem js(4);
+    js.adopt();
+
+    std::vector<uint8_t> memory(8 * 1024 * 1024);
+    RenderPass::Arena arena("SortCommandsRadix", { memory.data(), memory.data() + memory.size() });
+
+    std::default_random_engine gen; // NOLINT
+    std::uniform_int_distribution<uint64_t> anyKey;
+    std::uniform_int_distribution<uint32_t> fewKeys(0, 63);
+    std::uniform_int_distribution<uint32_t> kind(0, 3);
+
+    // sizes for the serial and the parallel radix sorts, excluding sentinels
+    for (size_t keyCount : { RenderPass::RADIX_SORT_THRESHOLD + 1000,
+                             RenderPass::RADIX_SORT_PARALLEL_THRESHOLD + 5000 }) {
+        // a third of the commands are sentinels, and many keys are duplicates
+        size_t const count = keyCount + keyCount / 2;
+        std::vector<RenderPass::Command> unsorted(count);
+        for (size_t i = 0; i < count; i++) {
+            uint32_t const k = kind(gen);
+            RenderPass::CommandKey key;
+            if (i % 3 == 2) {
+                key = uint64_t(RenderPass::Pass::SENTINEL);
+            } else if (k == 0) {
+                key = uint64_t(fewKeys(gen)) << RenderPass::Z_BUCKET_SHIFT;
+            } else {
+                key = anyKey(gen) >> 1; // never a sentinel
+            }
+            unsorted[i].key = key;
+            unsorted[i].info.index = uint32_t(i);
+        }
+
+        std::vector<RenderPass::Command> expected(unsorted);
+        RenderPass::Command const* const expectedLast =
+                RenderPass::sortCommands(expected.data(), expected.data() + count);
+        size_t const expectedCount = expectedLast - expected.data();
+        EXPECT_EQ(count - count / 3, expectedCount);
+
+        std::vector<RenderPass::Command> sorted(unsorted);
+        RenderPass::Command const* const last =
+                RenderPass::sortCommandsRadix(js, arena, sorted.data(), sorted.data() + count);
+        ASSERT_EQ(expectedCount, size_t(last - sorted.data()));
+        for (size_t i = 0; i < expectedCount; i++) {
+            EXPECT_EQ(expected[i].key, sorted[i].key);
+            // the radix sort is stable
+            if (i && sorted[i - 1].key == sorted[i].key) {
+                EXPECT_LT(sorted[i - 1].info.index, sorted[i].info.index);
+            }
+        }
+
+        // the scratch memory is released
+        EXPECT_EQ(memory.data(), arena.getCurrent());
+
+        // too small an arena falls back to the comparison sort
+        RenderPass::Arena small("SortCommandsRadix", { memory.data(), memory.data() + 1024 });
+        sorted = unsorted;
+        RenderPass::Command const* const fallbackLast =
+                RenderPass::sortCommands(js, small, sorted.data(), sorted.data() + count);
+        ASSERT_EQ(expectedCount, size_t(fallbackLast - sorted.data()));
+        for (size_t i = 0; i < expectedCount; i++) {
+            EXPECT_EQ(expected[i].key, sorted[i].key);
+        }
+        EXPECT_EQ(memory.data(), small.getCurrent());
+    }
+
+    js.emancipate();
+}
+
+TEST(FilamentTest, OcclusionCulling) {
+    mat4f const clipFromWorld = mat4f::frustum(-1, 1, -1, 1, 1, 100);
+
+    OcclusionCuller culler;
+    culler.prepare(256, 128, clipFromWorld);
+    EXPECT_EQ(256, culler.getWidth());
+    EXPECT_EQ(128, culler.getHeight());
+
+    // a wall in front of the camera
+    culler.rasterizeOccluder({{ 0, 0, 0 }, { 3, 3, 0.5f }},
+            mat4f::translation(float3{ 0, 0, -10 }));
+    culler.finalize();
+
+    // entirely behind the wall
+    EXPECT_TRUE(culler.isOccluded({ 0, 0, -50 }, { 1, 1, 1 }));
+    EXPECT_TRUE(culler.isOccluded({ 2, -2, -20 }, { 1, 1, 1 }));
+
+    // beside the wall
+    EXPECT_FALSE(culler.isOccluded({ 30, 0, -50 }, { 1, 1, 1 }));
+
+    // partially behind the wall
+    EXPECT_FALSE(culler.isOccluded({ 0, 0, -50 }, { 20, 1, 1 }));
+
+    // in front of the wall
+    EXPECT_FALSE(culler.isOccluded({ 0, 0, -5 }, { 0.5f, 0.5f, 0.5f }));
+
+    // crossing the near plane
+    EXPECT_FALSE(culler.isOccluded({ 0, 0, 0 }, { 2, 2, 2 }));
+
+    // nothing occludes without occluders
+    culler.prepare(256, 128, clipFromWorld);
+    culler.finalize();
+    EXPECT_FALSE(culler.isOccluded({ 0, 0, -50 }, { 1, 1, 1 }));
+
+    // a floor crossing the near plane
+    culler.prepare(256, 128, clipFromWorld);
+    culler.rasterizeOccluder({{ 0, -2, -50 }, { 20, 1, 50 }}, mat4f{});
+    culler.finalize();
+    EXPECT_TRUE(culler.isOccluded({ 0, -10, -20 }, { 1, 1, 1 }));
+    EXPECT_FALSE(culler.isOccluded({ 0, 0, -20 }, { 1, 1, 1 }));
+}
+
+TEST(FilamentTest, OcclusionCullingCoverage) {
+    // one pixel per world unit
+    mat4f const clipFromWorld = mat4f::ortho(-4, 4, -4, 4, 1, 100);
+
+    OcclusionCuller culler;
+    culler.prepare(8, 8, clipFromWorld);
+
+    // a wall covering pixel columns 3 and 4 entirely, and the centers of columns 2 and 5
+    culler.rasterizeOccluder({{ 0, 0, 0 }, { 1.9f, 4, 0.5f }},
+            mat4f::translation(float3{ 0, 0, -10 }));
+    culler.finalize();
+
+    // within the columns covered entirely
+    EXPECT_TRUE(culler.isOccluded({ 0, 0, -50 }, { 0.9f, 1, 1 }));
+
+    // wider than the wall, but only touching the pixel centers it covers
+    EXPECT_FALSE(culler.isOccluded({ 0, 0, -50 }, { 1.95f, 1, 1 }));
+
+    // a flat wall, seen from a mirrored transform, works the same
+    culler.prepare(8, 8, clipFromWorld);
+    culler.rasterizeOccluder({{ 0, 0, 0 }, { 1.9f, 4, 0 }},
+            mat4f::translation(float3{ 0, 0, -10 }) * mat4f::scaling(float3{ -1, 1, 1 }));
+    culler.finalize();
+    EXPECT_TRUE(culler.isOccluded({ 0, 0, -50 }, { 0.9f, 1, 1 }));
+    EXPECT_FALSE(culler.isOccluded({ 0, 0, -50 }, { 1.95f, 1, 1 }));
+}
+
+TEST(FilamentTest, OcclusionCullingView) {
+    Engine* engine = Engine::create(Engine::Backend::NOOP);
+    ASSERT_NE(engine, nullptr);
+
+    SwapChain* swapChain = engine->createSwapChain(256, 256);
+    Renderer* renderer = engine->createRenderer();
+    Scene* scene = engine->createScene();
+    View* view = engine->createView();
+
+    EntityManager& em = EntityManager::get();
+    Entity const cameraEntity = em.create();
+    Camera* camera = engine->createCamera(cameraEntity);
+    camera->setProjection(Camera::Projection::PERSPECTIVE, -1, 1, -1, 1, 1, 100);
+    view->setCamera(camera);
+    view->setScene(scene);
+    view->setViewport({ 0, 0, 256, 256 });
+
+    auto& tcm = engine->getTransformManager();
+    auto& rcm = engine->getRenderableManager();
+    auto createBox = [&](Box const& box, float3 const& position, bool occluder) {
+        Entity const e = em.create();
+        RenderableManager::Builder(0)
+                .boundingBox(box)
+                .occluder(occluder)
+                .build(*engine, e);
+        tcm.create(e, {}, mat4f::translation(position));
+        scene->addEntity(e);
+        return e;
+    };
+    Entity const wall = createBox({{ 0, 0, 0 }, { 3, 3, 0.5f }}, { 0, 0, -10 }, true);
+    Entity const hidden = createBox({{ 0, 0, 0 }, { 1, 1, 1 }}, { 0, 0, -50 }, false);
+    Entity const beside = createBox({{ 0, 0, 0 }, { 1, 1, 1 }}, { 30, 0, -50 }, false);
+
+    auto isVisible = [&](Entity e) {
+        auto const& renderableData = downcast(scene)->getRenderableData();
+        auto const visible = downcast(view)->getVisibleRenderables();
+        auto const ri = rcm.getInstance(e);
+        for (uint32_t i = visible.first; i < visible.last; i++) {
+            if (renderableData.elementAt<FScene::RENDERABLE_INSTANCE>(i) == ri) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    auto renderFrame = [&]() {
+        ASSERT_TRUE(renderer->beginFrame(swapChain));
+        renderer->render(view);
+        renderer->endFrame();
+    };
+
+    renderFrame();
+    EXPECT_TRUE(isVisible(wall));
+    EXPECT_TRUE(isVisible(hidden));
+    EXPECT_TRUE(isVisible(beside));
+
+    view->setOcclusionCullingEnabled(true);
+    renderFrame();
+    EXPECT_TRUE(isVisible(wall));
+    EXPECT_FALSE(isVisible(hidden));
+    EXPECT_TRUE(isVisible(beside));
+
+    // once the wall isn't an occluder anymore, the box behind it is visible again
+    rcm.setOccluder(rcm.getInstance(wall), false);
+    renderFrame();
+    EXPECT_TRUE(isVisible(hidden));
+
+    engine->flushAndWait();
+    for (Entity e : { wall, hidden, beside }) {
+        engine->destroy(e);
+        em.destroy(e);
+    }
+    engine->destroyCameraComponent(cameraEntity);
+    em.destroy(cameraEntity);
+    engine->destroy(view);
+    engine->destroy(scene);
+    engine->destroy(renderer);
+    engine->destroy(swapChain);
+    Engine::destroy(&engine);
+}
+
+TEST(FilamentTest, SparseMorphTargetPacking) {
+    using SparseTarget = MorphTargetBuffer::SparseTarget;
+
+    // target 1 overlaps target 0 (in a different order), target 2 is disjoint, target 3 is empty
+    uint32_t const indices0[] = { 1, 3, 4 };
+    uint32_t const indices1[] = { 4, 1 };
+    uint32_t const indices2[] = { 5 };
+    float3 const positions0[] = { { 1, 0, 0 }, { 3, 0, 0 }, { 4, 0, 0 } };
+    float3 const positions1[] = { { 4, 1, 0 }, { 1, 1, 0 } };
+    float3 const positions2[] = { { 5, 2, 0 } };
+    short4 const tangents0[] = { { 1, 0, 0, 0 }, { 3, 0, 0, 0 }, { 4, 0, 0, 0 } };
+    short4 const tangents1[] = { { 4, 1, 0, 0 }, { 1, 1, 0, 0 } };
+    short4 const tangents2[] = { { 5, 2, 0, 0 } };
+    SparseTarget const targets[] = {
+            { indices0, positions0, tangents0, 3 },
+            { indices1, positions1, tangents1, 2 },
+            { indices2, positions2, tangents2, 1 },
+            {},
+    };
+
+    constexpr size_t vertexCount = 6;
+    constexpr size_t deltaCount = 6;
+    float4 positions[vertexCount + deltaCount];
+    short4 tangents[vertexCount + deltaCount];
+    FMorphTargetBuffer::packSparseTargets(vertexCount, targets, 4, positions, tangents);
+
+    // headers: index of the first delta and number of deltas of each vertex
+    float2 const headers[vertexCount] = {
+            { 6, 0 }, { 6, 2 }, { 8, 0 }, { 8, 1 }, { 9, 2 }, { 11, 1 } };
+    for (size_t v = 0; v < vertexCount; v++) {
+        EXPECT_EQ(headers[v], positions[v].xy) << "vertex " << v;
+    }
+
+    // deltas, grouped by vertex and in target order within each vertex
+    float4 const deltas[deltaCount] = {
+            { 1, 0, 0, 0 }, { 1, 1, 0, 1 },     // vertex 1
+            { 3, 0, 0, 0 },                     // vertex 3
+            { 4, 0, 0, 0 }, { 4, 1, 0, 1 },     // vertex 4
+            { 5, 2, 0, 2 },                     // vertex 5
+    };
+    for (size_t i = 0; i < deltaCount; i++) {
+        EXPECT_EQ(deltas[i], positions[vertexCount + i]) << "delta " << i;
+        EXPECT_EQ(short4(deltas[i].xy, 0, 0), tangents[vertexCount + i]) << "delta " << i;
+    }
+}
+
 TEST(FilamentTest, ColorConversion) {
     // Linear to Gamma
     // 0.0 stays 0.0
@@ -225,11 +225,12 @@ struct PerRenderableData {
 
     static uint32_t packFlagsChannels(
             bool skinning, bool morphing, bool contactShadows, bool hasInstanceBuffer,
-            uint8_t channels) noexcept {
+            bool sparseMorphing, uint8_t channels) noexcept {
         return (skinning              ? 0x100 : 0) |
                (morphing              ? 0x200 : 0) |
                (contactShadows        ? 0x400 : 0) |
                (hasInstanceBuffer     ? 0x800 : 0) |
+               (sparseMorphing        ? 0x1000 : 0) |
                channels;
     }
 };
@@ -137,6 +137,7 @@ protected:
     bool mSaveRawVariants = false;
     bool mGenerateDebugInfo = false;
     bool mIncludeEssl1 = true;
+    utils::CString mShaderCacheDirectory;
     utils::bitset32 mShaderModels;
     struct CodeGenParams {
         ShaderModel shaderModel;
@@ -601,6 +602,15 @@ public:
     //! If true, will include debugging information in generated SPIRV.
     MaterialBuilder& generateDebugInfo(bool generateDebugInfo) noexcept;
 
+    /**
+     * Specifies a directory where the compiled shaders (optimized GLSL, SPIR-V and MSL) are cached
+     * across builds. Entries are addressed by the content of the generated shader and the
+     * compilation settings, so unchanged shaders are not compiled again. The directory can be
+     * shared by concurrent builds, but must be cleared when filamat itself is updated.
+     * The cache is disabled by default, and while printShaders() is enabled.
+     */
+    MaterialBuilder& shaderCache(const char* directory) noexcept;
+
     //! Specifies a list of variants that should be filtered out during code generation.
     MaterialBuilder& variantFilter(filament::UserVariantFilterMask variantFilter) noexcept;
 
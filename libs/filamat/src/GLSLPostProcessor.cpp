@@ -501,6 +501,62 @@ void GLSLPostProcessor::spirvToMsl(const SpirvBlob* spirv, std::string* outMsl,
     }
 }
 
+static EShLanguage getShaderLanguage(ShaderStage stage) noexcept {
+    switch (stage) {
+        case ShaderStage::VERTEX:
+            return EShLangVertex;
+        case ShaderStage::FRAGMENT:
+            return EShLangFragment;
+        case ShaderStage::COMPUTE:
+            return EShLangCompute;
+    }
+    return EShLangFragment;
+}
+
+static EShMessages getMessages(GLSLPostProcessor::Config const& config) noexcept {
+    EShMessages msg = GLSLTools::glslangFlagsFromTargetApi(config.targetApi, config.targetLanguage);
+    if (config.hasFramebufferFetch) {
+        // FIXME: subpasses require EShMsgVulkanRules, which I think is a mistake.
+        //        SpvRules should be enough.
+        //        I think this could cause the compilation to fail on gl_VertexID.
+        using Type = std::underlying_type_t<EShMessages>;
+        msg = EShMessages(Type(msg) | Type(EShMessages::EShMsgVulkanRules));
+    }
+    return msg;
+}
+
+uint8_t GLSLPostProcessor::getVariantDependencies(Config const& config) noexcept {
+    // the descriptor sets (see collectDescriptorsForSet()), the clip distance and the multiview
+    // setup depend on these
+    filament::Variant const variant = config.variant;
+    return uint8_t(filament::Variant::isValidDepthVariant(variant))
+            | uint8_t(filament::Variant::isSSRVariant(variant)) << 1
+            | uint8_t(filament::Variant::isVSMVariant(variant)) << 2
+            | uint8_t(variant.hasStereo()) << 3;
+}
+
+bool GLSLPostProcessor::preprocess(const std::string& inputShader, Config const& config,
+        std::string* outputShader) const {
+    EShLanguage const shLang = getShaderLanguage(config.shaderType);
+    TShader tShader(shLang);
+
+    // The cleaner must be declared after the TShader to prevent ASAN failures.
+    GLSLangCleaner const cleaner;
+
+    // This must match the setup of process()
+    const char* shaderCString = inputShader.c_str();
+    tShader.setStrings(&shaderCString, 1);
+    tShader.setPreamble("#define FILAMENT_GLSLANG\n");
+
+    int const langVersion = GLSLTools::getGlslDefaultVersion(config.shaderModel);
+    GLSLTools::prepareShaderParser(config.targetApi, config.targetLanguage, tShader,
+            shLang, langVersion);
+
+    TShader::ForbidIncluder forbidIncluder;
+    return tShader.preprocess(&DefaultTBuiltInResource, langVersion, ENoProfile, false, false,
+            getMessages(config), outputShader, forbidIncluder);
+}
+
 bool GLSLPostProcessor::process(const std::string& inputShader, Config const& config,
         std::string* outputGlsl, SpirvBlob* outputSpirv, std::string* outputMsl) {
     using TargetLanguage = MaterialBuilder::TargetLanguage;
@@ -519,17 +575,7 @@ bool GLSLPostProcessor::process(const std::string& inputShader, Config const& co
             .mslOutput = outputMsl,
     };
 
-    switch (config.shaderType) {
-        case ShaderStage::VERTEX:
-            internalConfig.shLang = EShLangVertex;
-            break;
-        case ShaderStage::FRAGMENT:
-            internalConfig.shLang = EShLangFragment;
-            break;
-        case ShaderStage::COMPUTE:
-            internalConfig.shLang = EShLangCompute;
-            break;
-    }
+    internalConfig.shLang = getShaderLanguage(config.shaderType);
 
     TProgram program;
     TShader tShader(internalConfig.shLang);
@@ -548,14 +594,7 @@ bool GLSLPostProcessor::process(const std::string& inputShader, Config const& co
     GLSLTools::prepareShaderParser(config.targetApi, config.targetLanguage, tShader,
             internalConfig.shLang, internalConfig.langVersion);
 
-    EShMessages msg = GLSLTools::glslangFlagsFromTargetApi(config.targetApi, config.targetLanguage);
-    if (config.hasFramebufferFetch) {
-        // FIXME: subpasses require EShMsgVulkanRules, which I think is a mistake.
-        //        SpvRules should be enough.
-        //        I think this could cause the compilation to fail on gl_VertexID.
-        using Type = std::underlying_type_t<EShMessages>;
-        msg = EShMessages(Type(msg) | Type(EShMessages::EShMsgVulkanRules));
-    }
+    EShMessages const msg = getMessages(config);
 
     bool const ok = tShader.parse(&DefaultTBuiltInResource, internalConfig.langVersion, false, msg);
     if (!ok) {
@@ -83,6 +83,15 @@ public:
             SpirvBlob* outputSpirv,
             std::string* outputMsl);
 
+    // Returns the shader as seen by the compiler after preprocessing. Shaders with the same
+    // preprocessed source, and configs that only differ by variants with the same
+    // getVariantDependencies(), produce the same output in process().
+    bool preprocess(const std::string& inputShader, Config const& config,
+            std::string* outputShader) const;
+
+    // Returns the properties of config.variant that process() depends on, besides the source.
+    static uint8_t getVariantDependencies(Config const& config) noexcept;
+
     // public so backend_test can also use it
     static void spirvToMsl(const SpirvBlob* spirv, std::string* outMsl,
             filament::backend::ShaderStage stage, filament::backend::ShaderModel shaderModel,
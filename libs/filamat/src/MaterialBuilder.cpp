@@ -25,6 +25,7 @@
 #include "shaders/UibGenerator.h"
 
 #include "GLSLPostProcessor.h"
+#include "ShaderCache.h"
 #include "sca/GLSLTools.h"
 
 #include "shaders/MaterialInfo.h"
@@ -61,7 +62,11 @@
 
 #include <algorithm>
 #include <atomic>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <tuple>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <iostream>
@@ -582,6 +587,11 @@ MaterialBuilder& MaterialBuilder::generateDebugInfo(bool generateDebugInfo) noex
     return *this;
 }
 
+MaterialBuilder& MaterialBuilder::shaderCache(const char* directory) noexcept {
+    mShaderCacheDirectory = CString(directory);
+    return *this;
+}
+
 MaterialBuilder& MaterialBuilder::variantFilter(UserVariantFilterMask variantFilter) noexcept {
     mVariantFilter = variantFilter;
     return *this;
@@ -865,6 +875,12 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
     flags |= mGenerateDebugInfo ? GLSLPostProcessor::GENERATE_DEBUG_INFO : 0;
     GLSLPostProcessor postProcessor(mOptimization, flags);
 
+    // Printing happens while compiling, so it requires bypassing the cache.
+    std::optional<ShaderCache> shaderCache;
+    if (!mShaderCacheDirectory.empty() && !mPrintShaders) {
+        shaderCache.emplace(mShaderCacheDirectory.c_str());
+    }
+
     // Start: must be protected by lock
     Mutex entriesLock;
     std::vector<TextEntry> glslEntries;
@@ -882,8 +898,14 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
 
     container.emplace<bool>(ChunkType::MaterialHasCustomDepthShader, needsStandardDepthProgram());
 
+    // Identical shaders are compiled only once. Their generated source differs by the variant
+    // defines, so they're compared once preprocessed. This is skipped when printing shaders or
+    // generating debug info, which both depend on the original source.
+    const bool deduplicateShaders = !mPrintShaders && !mGenerateDebugInfo;
+
     std::atomic_bool cancelJobs(false);
     bool firstJob = true;
+    bool firstPreprocessJob = true;
 
     for (const auto& params : mCodeGenPermutations) {
         if (cancelJobs.load()) {
@@ -903,39 +925,47 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
         const bool targetApiNeedsMsl = targetApi == TargetApi::METAL;
         const bool targetApiNeedsGlsl = targetApi == TargetApi::OPENGL;
 
-        // Set when a job fails
-        JobSystem::Job* parent = jobSystem.createJob();
-
-        for (const auto& v : variants) {
-            JobSystem::Job* job = jobs::createJob(jobSystem, parent, [&]() {
-                if (cancelJobs.load()) {
-                    return;
-                }
-
-                // TODO: avoid allocations when not required
-                std::vector<uint32_t> spirv;
-                std::string msl;
-
-                std::vector<uint32_t>* pSpirv = targetApiNeedsSpirv ? &spirv : nullptr;
-                std::string* pMsl = targetApiNeedsMsl ? &msl : nullptr;
+        // GLSL shaders are not post-processed.
+        const bool deduplicate = deduplicateShaders && targetLanguage == TargetLanguage::SPIRV;
+
+        auto getConfig = [&](const Variant& v) {
+            GLSLPostProcessor::Config config{
+                    .variant = v.variant,
+                    .variantFilter = mVariantFilter,
+                    .targetApi = targetApi,
+                    .targetLanguage = targetLanguage,
+                    .shaderType = v.stage,
+                    .shaderModel = shaderModel,
+                    .featureLevel = featureLevel,
+                    .domain = mMaterialDomain,
+                    .materialInfo = &info,
+                    .hasFramebufferFetch = mEnableFramebufferFetch,
+                    .usesClipDistance = v.variant.hasStereo() && info.stereoscopicType == StereoscopicType::INSTANCED,
+                    .glsl = {},
+            };
+
+            if (mEnableFramebufferFetch) {
+                config.glsl.subpassInputToColorLocation.emplace_back(0, 0);
+            }
+            return config;
+        };
 
-                TextEntry glslEntry{};
-                BinaryEntry spirvEntry{};
-                TextEntry metalEntry{};
+        // First, generate the raw shader code of all the variants, and their preprocessed source
+        // when deduplicating.
+        std::vector<std::string> shaders(variants.size());
+        std::vector<std::string> preprocessedShaders(deduplicate ? variants.size() : 0);
 
-                glslEntry.shaderModel  = params.shaderModel;
-                spirvEntry.shaderModel = params.shaderModel;
-                metalEntry.shaderModel = params.shaderModel;
+        JobSystem::Job* parent = jobSystem.createJob();
 
-                glslEntry.variant  = v.variant;
-                spirvEntry.variant = v.variant;
-                metalEntry.variant = v.variant;
+        for (size_t i = 0; i < variants.size(); i++) {
+            JobSystem::Job* job = jobs::createJob(jobSystem, parent, [&, i]() {
+                const Variant& v = variants[i];
 
                 // Generate raw shader code.
                 // The quotes in Google-style line directives cause problems with certain drivers. These
                 // directives are optimized away when using the full filamat, so down below we
                 // explicitly remove them when using filamat lite.
-                std::string shader;
+                std::string& shader = shaders[i];
                 if (v.stage == backend::ShaderStage::VERTEX) {
                     shader = sg.createVertexProgram(
                             shaderModel, targetApi, targetLanguage, featureLevel,
@@ -974,31 +1004,89 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
                     }
                 }
 
+                if (deduplicate) {
+                    // The stage and the parts of the variant the post-processor depends on are
+                    // part of the key. On failure the key is left empty and the shader is
+                    // compiled on its own, which reports the error.
+                    GLSLPostProcessor::Config const config = getConfig(v);
+                    std::string preprocessed;
+                    if (postProcessor.preprocess(shader, config, &preprocessed)) {
+                        std::string& key = preprocessedShaders[i];
+                        key.reserve(preprocessed.size() + 2);
+                        key.push_back(char(v.stage));
+                        key.push_back(char(GLSLPostProcessor::getVariantDependencies(config)));
+                        key.append(preprocessed);
+                    }
+                }
+            });
+
+            // NOTE: We run the first job separately to work the lack of thread safety
+            //       guarantees in glslang. This library performs unguarded global
+            //       operations on first use.
+            if (deduplicate && firstPreprocessJob) {
+                jobSystem.runAndWait(job);
+                firstPreprocessJob = false;
+            } else {
+                jobSystem.run(job);
+            }
+        }
+
+        jobSystem.runAndWait(parent);
+
+        // Then group the variants with the same preprocessed source, the first one of each group
+        // is compiled and its output is used for all of them.
+        std::vector<std::vector<size_t>> groups;
+        groups.reserve(variants.size());
+        std::unordered_map<std::string_view, size_t> groupIndices;
+        for (size_t i = 0; i < variants.size(); i++) {
+            if (deduplicate && !preprocessedShaders[i].empty()) {
+                auto [pos, inserted] = groupIndices.emplace(preprocessedShaders[i], groups.size());
+                if (!inserted) {
+                    groups[pos->second].push_back(i);
+                    continue;
+                }
+            }
+            groups.push_back({ i });
+        }
+
+        // Set when a job fails
+        parent = jobSystem.createJob();
+
+        for (const auto& group : groups) {
+            JobSystem::Job* job = jobs::createJob(jobSystem, parent, [&]() {
+                if (cancelJobs.load()) {
+                    return;
+                }
+
+                const Variant& v = variants[group.front()];
+                std::string shader = std::move(shaders[group.front()]);
+
+                // TODO: avoid allocations when not required
+                std::vector<uint32_t> spirv;
+                std::string msl;
+
+                std::vector<uint32_t>* pSpirv = targetApiNeedsSpirv ? &spirv : nullptr;
+                std::string* pMsl = targetApiNeedsMsl ? &msl : nullptr;
+
                 std::string* pGlsl = nullptr;
                 if (targetApiNeedsGlsl) {
                     pGlsl = &shader;
                 }
 
-                GLSLPostProcessor::Config config{
-                        .variant = v.variant,
-                        .variantFilter = mVariantFilter,
-                        .targetApi = targetApi,
-                        .targetLanguage = targetLanguage,
-                        .shaderType = v.stage,
-                        .shaderModel = shaderModel,
-                        .featureLevel = featureLevel,
-                        .domain = mMaterialDomain,
-                        .materialInfo = &info,
-                        .hasFramebufferFetch = mEnableFramebufferFetch,
-                        .usesClipDistance = v.variant.hasStereo() && info.stereoscopicType == StereoscopicType::INSTANCED,
-                        .glsl = {},
-                };
+                GLSLPostProcessor::Config const config = getConfig(v);
 
-                if (mEnableFramebufferFetch) {
-                    config.glsl.subpassInputToColorLocation.emplace_back(0, 0);
+                std::optional<ShaderCache::Key> cacheKey;
+                bool ok = false;
+                if (shaderCache) {
+                    cacheKey = ShaderCache::computeKey(shader, config, mOptimization, flags);
+                    ok = shaderCache->get(*cacheKey, pGlsl, pSpirv, pMsl);
+                }
+                if (!ok) {
+                    ok = postProcessor.process(shader, config, pGlsl, pSpirv, pMsl);
+                    if (ok && cacheKey) {
+                        shaderCache->put(*cacheKey, pGlsl, pSpirv, pMsl);
+                    }
                 }
-
-                bool const ok = postProcessor.process(shader, config, pGlsl, pSpirv, pMsl);
                 if (!ok) {
                     showErrorMessage(mMaterialName.c_str_safe(), v.variant, targetApi, v.stage,
                                      featureLevel, shader);
@@ -1016,6 +1104,13 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
                     }
                 }
 
+                std::vector<uint8_t> spirvData;
+                if (targetApi == TargetApi::VULKAN) {
+                    assert(!spirv.empty());
+                    spirvData.assign(reinterpret_cast<uint8_t*>(spirv.data()),
+                            reinterpret_cast<uint8_t*>(spirv.data() + spirv.size()));
+                }
+
                 // NOTE: Everything below touches shared structures protected by a lock
                 // NOTE: do not execute expensive work from here on!
                 std::unique_lock<Mutex> const lock(entriesLock);
@@ -1023,36 +1118,46 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
                 // below we rely on casting ShaderStage to uint8_t
                 static_assert(sizeof(filament::backend::ShaderStage) == 1);
 
-
-                switch (targetApi) {
-                    case TargetApi::ALL:
-                        // should never happen
-                        break;
-                    case TargetApi::OPENGL:
-                        glslEntry.stage = v.stage;
-                        glslEntry.shader = shader;
-                        if (featureLevel == FeatureLevel::FEATURE_LEVEL_0) {
-                            essl1Entries.push_back(glslEntry);
-                        } else {
-                            glslEntries.push_back(glslEntry);
+                for (size_t const index : group) {
+                    const Variant& variant = variants[index];
+                    switch (targetApi) {
+                        case TargetApi::ALL:
+                            // should never happen
+                            break;
+                        case TargetApi::OPENGL: {
+                            TextEntry glslEntry{};
+                            glslEntry.shaderModel = params.shaderModel;
+                            glslEntry.variant = variant.variant;
+                            glslEntry.stage = variant.stage;
+                            glslEntry.shader = shader;
+                            if (featureLevel == FeatureLevel::FEATURE_LEVEL_0) {
+                                essl1Entries.push_back(std::move(glslEntry));
+                            } else {
+                                glslEntries.push_back(std::move(glslEntry));
+                            }
+                            break;
+                        }
+                        case TargetApi::VULKAN: {
+                            BinaryEntry spirvEntry{};
+                            spirvEntry.shaderModel = params.shaderModel;
+                            spirvEntry.variant = variant.variant;
+                            spirvEntry.stage = variant.stage;
+                            spirvEntry.data = spirvData;
+                            spirvEntries.push_back(std::move(spirvEntry));
+                            break;
+                        }
+                        case TargetApi::METAL: {
+                            assert(!spirv.empty());
+                            assert(msl.length() > 0);
+                            TextEntry metalEntry{};
+                            metalEntry.shaderModel = params.shaderModel;
+                            metalEntry.variant = variant.variant;
+                            metalEntry.stage = variant.stage;
+                            metalEntry.shader = msl;
+                            metalEntries.push_back(std::move(metalEntry));
+                            break;
                         }
-                        break;
-                    case TargetApi::VULKAN: {
-                        assert(!spirv.empty());
-                        const std::vector<uint8_t> d(reinterpret_cast<uint8_t*>(spirv.data()),
-                                reinterpret_cast<uint8_t*>(spirv.data() + spirv.size()));
-                        spirvEntry.stage = v.stage;
-                        spirvEntry.data = std::move(d);
-                        spirvEntries.push_back(spirvEntry);
-                        break;
                     }
-                    case TargetApi::METAL:
-                        assert(!spirv.empty());
-                        assert(msl.length() > 0);
-                        metalEntry.stage = v.stage;
-                        metalEntry.shader = msl;
-                        metalEntries.push_back(metalEntry);
-                        break;
                 }
             });
 
@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ShaderCache.h"
+
+#include "shaders/MaterialInfo.h"
+
+#include <filament/MaterialEnums.h>
+
+#include <private/filament/SamplerInterfaceBlock.h>
+
+#include <utils/Hash.h>
+#include <utils/Path.h>
+
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <utility>
+
+#include <stdio.h>
+#include <string.h>
+
+namespace filamat {
+
+using namespace filament;
+using namespace utils;
+
+// Must be bumped when the format of the entries or of the key changes.
+static constexpr uint32_t CACHE_VERSION = 1;
+static constexpr uint32_t CACHE_MAGIC = 'F' | 'S' << 8 | 'H' << 16 | 'C' << 24;
+
+template<typename T>
+static void append(std::string& blob, T const& value) {
+    blob.append(reinterpret_cast<char const*>(&value), sizeof(value));
+}
+
+static void appendString(std::string& blob, std::string_view value) {
+    append(blob, uint32_t(value.size()));
+    blob.append(value.data(), value.size());
+}
+
+ShaderCache::Key ShaderCache::computeKey(std::string const& shader,
+        GLSLPostProcessor::Config const& config, MaterialBuilder::Optimization optimization,
+        uint32_t flags) {
+    std::string blob;
+    blob.reserve(shader.size() + 1024);
+
+    append(blob, CACHE_VERSION);
+    append(blob, MATERIAL_VERSION);
+    append(blob, uint8_t(optimization));
+    append(blob, flags);
+
+    append(blob, config.variant.key);
+    append(blob, config.variantFilter);
+    append(blob, uint8_t(config.targetApi));
+    append(blob, uint8_t(config.targetLanguage));
+    append(blob, uint8_t(config.shaderType));
+    append(blob, uint8_t(config.shaderModel));
+    append(blob, uint8_t(config.featureLevel));
+    append(blob, uint8_t(config.domain));
+    append(blob, config.hasFramebufferFetch);
+    append(blob, config.usesClipDistance);
+    append(blob, uint32_t(config.glsl.subpassInputToColorLocation.size()));
+    for (auto const& [subpassInput, location] : config.glsl.subpassInputToColorLocation) {
+        append(blob, subpassInput);
+        append(blob, location);
+    }
+
+    // the descriptor sets and multiview settings are derived from the material
+    MaterialInfo const& info = *config.materialInfo;
+    append(blob, info.isLit);
+    append(blob, info.hasShadowMultiplier);
+    append(blob, uint8_t(info.reflectionMode));
+    append(blob, uint8_t(info.refractionMode));
+    append(blob, uint8_t(info.stereoscopicType));
+    append(blob, info.stereoscopicEyeCount);
+    auto const& samplers = info.sib.getSamplerInfoList();
+    append(blob, uint32_t(samplers.size()));
+    for (auto const& sampler : samplers) {
+        appendString(blob, { sampler.name.c_str_safe(), sampler.name.size() });
+        appendString(blob, { sampler.uniformName.c_str_safe(), sampler.uniformName.size() });
+        append(blob, sampler.binding);
+        append(blob, uint8_t(sampler.type));
+        append(blob, uint8_t(sampler.format));
+        append(blob, uint8_t(sampler.precision));
+        append(blob, sampler.multisample);
+    }
+
+    appendString(blob, shader);
+
+    // four independent 32-bit hashes make collisions practically impossible
+    auto const* data = reinterpret_cast<uint8_t const*>(blob.data());
+    Key key{};
+    for (uint32_t i = 0; i < 4; i++) {
+        key.words[i] = hash::murmurSlow(data, blob.size(), 0x9e3779b9u * (i + 1));
+    }
+    return key;
+}
+
+std::string ShaderCache::Key::toString() const {
+    char name[33];
+    snprintf(name, sizeof(name), "%08x%08x%08x%08x", words[0], words[1], words[2], words[3]);
+    return name;
+}
+
+ShaderCache::ShaderCache(std::string directory)
+        : mDirectory(std::move(directory)), mTempSeed(std::random_device{}()) {
+    Path(mDirectory).mkdirRecursive();
+}
+
+bool ShaderCache::get(Key const& key,
+        std::string* outputGlsl, SpirvBlob* outputSpirv, std::string* outputMsl) const {
+    std::ifstream in(Path::concat(mDirectory, key.toString()).getPath(), std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::string const file{ std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+
+    size_t offset = 0;
+    auto read = [&file, &offset](void* out, size_t size) {
+        if (file.size() - offset < size) {
+            return false;
+        }
+        memcpy(out, file.data() + offset, size);
+        offset += size;
+        return true;
+    };
+
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    if (!read(&magic, sizeof(magic)) || !read(&version, sizeof(version)) ||
+            magic != CACHE_MAGIC || version != CACHE_VERSION) {
+        return false;
+    }
+
+    // each output is stored as a presence flag, a byte count and the data
+    std::string_view outputs[3];
+    for (auto& output : outputs) {
+        uint8_t present = 0;
+        uint32_t size = 0;
+        if (!read(&present, sizeof(present)) || !read(&size, sizeof(size)) ||
+                file.size() - offset < size) {
+            return false;
+        }
+        output = present ? std::string_view{ file.data() + offset, size } : std::string_view{};
+        offset += size;
+    }
+
+    auto const& [glsl, spirv, msl] = outputs;
+    if ((outputGlsl && !glsl.data()) || (outputSpirv && !spirv.data()) ||
+            (outputMsl && !msl.data())) {
+        return false;
+    }
+    if (outputGlsl) {
+        *outputGlsl = glsl;
+    }
+    if (outputSpirv) {
+        outputSpirv->resize(spirv.size() / sizeof(uint32_t));
+        memcpy(outputSpirv->data(), spirv.data(), outputSpirv->size() * sizeof(uint32_t));
+    }
+    if (outputMsl) {
+        *outputMsl = msl;
+    }
+    return true;
+}
+
+void ShaderCache::put(Key const& key, std::string const* glsl, SpirvBlob const* spirv,
+        std::string const* msl) const {
+    std::string file;
+    append(file, CACHE_MAGIC);
+    append(file, CACHE_VERSION);
+    auto appendOutput = [&file](void const* data, size_t size, bool present) {
+        append(file, uint8_t(present));
+        append(file, uint32_t(size));
+        if (size) {
+            file.append(static_cast<char const*>(data), size);
+        }
+    };
+    appendOutput(glsl ? glsl->data() : nullptr, glsl ? glsl->size() : 0, glsl);
+    appendOutput(spirv ? spirv->data() : nullptr,
+            spirv ? spirv->size() * sizeof(uint32_t) : 0, spirv);
+    appendOutput(msl ? msl->data() : nullptr, msl ? msl->size() : 0, msl);
+
+    // Write to a unique temporary file first and rename it, so that concurrent readers never see
+    // a partial entry.
+    std::string const path = Path::concat(mDirectory, key.toString()).getPath();
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%016llx.%u", (unsigned long long) mTempSeed,
+            mTempCount.fetch_add(1, std::memory_order_relaxed));
+    std::string const temp = path + suffix;
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out.write(file.data(), std::streamsize(file.size()))) {
+            out.close();
+            remove(temp.c_str());
+            return;
+        }
+    }
+    if (rename(temp.c_str(), path.c_str()) != 0) {
+        remove(temp.c_str());
+    }
+}
+
+} // namespace filamat
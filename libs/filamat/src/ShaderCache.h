@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMAT_SHADERCACHE_H
+#define TNT_FILAMAT_SHADERCACHE_H
+
+#include "GLSLPostProcessor.h"
+
+#include <filamat/MaterialBuilder.h>
+
+#include <atomic>
+#include <string>
+
+#include <stdint.h>
+
+namespace filamat {
+
+/*
+ * An on-disk cache of the output of GLSLPostProcessor, i.e. optimized GLSL, SPIR-V and MSL.
+ *
+ * Entries are addressed by a 128-bit hash of everything the post-processor depends on: the
+ * generated shader, the target API and language, the shader model, the optimization level and
+ * the parts of the material that end up in the descriptor sets. Each entry is stored in its own
+ * file in the cache directory, which can be shared by concurrent processes.
+ *
+ * Entries don't depend on the version of the shader compilers, so the cache directory must be
+ * cleared when they're updated.
+ */
+class ShaderCache {
+public:
+    struct Key {
+        uint32_t words[4];
+        std::string toString() const;
+    };
+
+    static Key computeKey(std::string const& shader, GLSLPostProcessor::Config const& config,
+            MaterialBuilder::Optimization optimization, uint32_t flags);
+
+    // The directory is created if needed.
+    explicit ShaderCache(std::string directory);
+
+    // Fills the requested outputs and returns true if an entry with all of them exists.
+    bool get(Key const& key,
+            std::string* outputGlsl, SpirvBlob* outputSpirv, std::string* outputMsl) const;
+
+    // Stores an entry, failures are ignored since the cache is only an optimization.
+    void put(Key const& key, std::string const* glsl, SpirvBlob const* spirv,
+            std::string const* msl) const;
+
+private:
+    std::string mDirectory;
+    uint64_t mTempSeed;
+    mutable std::atomic<uint32_t> mTempCount = 0;
+};
+
+} // namespace filamat
+
+#endif // TNT_FILAMAT_SHADERCACHE_H
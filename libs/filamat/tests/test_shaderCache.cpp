@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "ShaderCache.h"
+#include "shaders/MaterialInfo.h"
+
+#include <utils/Path.h>
+
+#include <string>
+
+using namespace filamat;
+using namespace filament;
+
+class ShaderCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        mDirectory = utils::Path::getTemporaryDirectory().concat(
+                ::testing::UnitTest::GetInstance()->current_test_info()->name()).getPath();
+        mConfig = {
+                .variant = {},
+                .variantFilter = {},
+                .targetApi = MaterialBuilder::TargetApi::METAL,
+                .targetLanguage = MaterialBuilder::TargetLanguage::SPIRV,
+                .shaderType = backend::ShaderStage::FRAGMENT,
+                .shaderModel = backend::ShaderModel::DESKTOP,
+                .featureLevel = backend::FeatureLevel::FEATURE_LEVEL_3,
+                .domain = MaterialDomain::SURFACE,
+                .materialInfo = &mInfo,
+                .hasFramebufferFetch = false,
+                .usesClipDistance = false,
+                .glsl = {},
+        };
+    }
+
+    std::string mDirectory;
+    MaterialInfo mInfo{};
+    GLSLPostProcessor::Config mConfig{};
+};
+
+TEST_F(ShaderCacheTest, KeyDependsOnInputs) {
+    auto const optimization = MaterialBuilder::Optimization::PERFORMANCE;
+    auto const key = ShaderCache::computeKey("void main() {}", mConfig, optimization, 0);
+
+    EXPECT_EQ(key.toString(),
+            ShaderCache::computeKey("void main() {}", mConfig, optimization, 0).toString());
+    EXPECT_NE(key.toString(),
+            ShaderCache::computeKey("void main() { }", mConfig, optimization, 0).toString());
+    EXPECT_NE(key.toString(), ShaderCache::computeKey("void main() {}", mConfig,
+            MaterialBuilder::Optimization::SIZE, 0).toString());
+
+    GLSLPostProcessor::Config config = mConfig;
+    config.shaderModel = backend::ShaderModel::MOBILE;
+    EXPECT_NE(key.toString(),
+            ShaderCache::computeKey("void main() {}", config, optimization, 0).toString());
+}
+
+TEST_F(ShaderCacheTest, RoundTrip) {
+    ShaderCache const cache(mDirectory);
+    auto const key = ShaderCache::computeKey("void main() {}", mConfig,
+            MaterialBuilder::Optimization::PERFORMANCE, 0);
+
+    SpirvBlob spirv;
+    std::string msl;
+    EXPECT_FALSE(cache.get(key, nullptr, &spirv, &msl));
+
+    SpirvBlob const expectedSpirv = { 0x07230203, 0x00010000, 42 };
+    std::string const expectedMsl = "fragment void main0() {}";
+    cache.put(key, nullptr, &expectedSpirv, &expectedMsl);
+
+    ASSERT_TRUE(cache.get(key, nullptr, &spirv, &msl));
+    EXPECT_EQ(expectedSpirv, spirv);
+    EXPECT_EQ(expectedMsl, msl);
+
+    // an entry without all the requested outputs is a miss
+    std::string glsl;
+    EXPECT_FALSE(cache.get(key, &glsl, nullptr, nullptr));
+
+    utils::Path(utils::Path::concat(mDirectory, key.toString())).unlinkFile();
+}
@@ -48,8 +48,10 @@ public:
     void applyAnimation(size_t animationIndex, float time) const;
 
     /**
-     * Computes root-to-node transforms for all bone nodes, then passes
-     * the results into filament::RenderableManager::setBones.
+     * Computes root-to-node transforms for all bone nodes, then uploads the results into a
+     * filament::SkinningBuffer shared by the skinned renderables, which are bound to it with
+     * filament::RenderableManager::setSkinningBuffer. Renderables that the AssetLoader didn't
+     * create get their bones with filament::RenderableManager::setBones instead.
      * Uses filament::TransformManager and filament::RenderableManager.
      *
      * NOTE: this operation is independent of \c animation.
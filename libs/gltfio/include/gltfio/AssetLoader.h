@@ -20,6 +20,8 @@
 #include <filament/Engine.h>
 #include <filament/Material.h>
 
+#include <backend/BufferDescriptor.h>
+
 #include <gltfio/FilamentAsset.h>
 #include <gltfio/FilamentInstance.h>
 #include <gltfio/MaterialProvider.h>
@@ -152,6 +154,8 @@ struct AssetConfiguration {
  */
 class UTILS_PUBLIC AssetLoader {
 public:
+    using BufferDescriptor = filament::backend::BufferDescriptor;
+
 
     /**
      * Creates an asset loader for the given configuration, which specifies the Filament engine.
@@ -177,6 +181,17 @@ public:
      */
     FilamentAsset* createAsset(const uint8_t* bytes, uint32_t nbytes);
 
+    /**
+     * Same as createAsset(const uint8_t*, uint32_t), but the asset takes ownership of the content
+     * rather than copying it. The callback of the buffer descriptor is called once the content is
+     * no longer needed, i.e. after the source data has been released and all the GPU uploads that
+     * read from it (in the case of a GLB) have completed.
+     *
+     * This lets clients load large GLB files without holding two copies of them, e.g. by mapping
+     * the file in memory and unmapping it from the callback.
+     */
+    FilamentAsset* createAsset(BufferDescriptor&& content);
+
     /**
      * Consumes the contents of a glTF 2.0 file and produces a primary asset with one or more
      * instances. The primary asset has ownership over the instances.
@@ -204,6 +219,14 @@ public:
     FilamentAsset* createInstancedAsset(const uint8_t* bytes, uint32_t numBytes,
             FilamentInstance** instances, size_t numInstances);
 
+    /**
+     * Same as createInstancedAsset(const uint8_t*, uint32_t, FilamentInstance**, size_t), but
+     * the asset takes ownership of the content rather than copying it.
+     * See also createAsset(BufferDescriptor&&).
+     */
+    FilamentAsset* createInstancedAsset(BufferDescriptor&& content,
+            FilamentInstance** instances, size_t numInstances);
+
     /**
      * Adds a new instance to the asset.
      *
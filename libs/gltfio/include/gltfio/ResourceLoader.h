@@ -24,6 +24,7 @@
 #include <utils/compiler.h>
 
 namespace filament {
+    class Camera;
     class Engine;
 }
 
@@ -51,6 +52,36 @@ struct ResourceConfiguration {
     bool normalizeSkinningWeights;
 };
 
+/**
+ * \struct TextureResidency ResourceLoader.h gltfio/ResourceLoader.h
+ * \brief Lets asynchronous loads prioritize and size textures by how large they appear on screen.
+ *
+ * The on-screen size of each renderable is estimated from its world-space bounding box as seen
+ * from the camera. Textures are decoded from the largest to the smallest user, including across
+ * assets being loaded at the same time, and their size is limited to the number of pixels their
+ * largest user covers. When a budget is given, textures are further reduced, starting with those
+ * of the smallest users, until their estimated memory use fits. Only providers of hierarchical
+ * images (e.g. KTX2) can reduce the size of their textures.
+ *
+ * Once loaded, textures follow the on-screen size of their users with
+ * ResourceLoader::updateTextureResidency().
+ */
+struct TextureResidency {
+    //! Camera the asset is viewed from, or null to disable residency (the default).
+    //! It is used while textures are pushed to the providers, and by updateTextureResidency().
+    const filament::Camera* camera = nullptr;
+
+    //! Height of the viewport in pixels.
+    uint32_t viewportHeight = 1080;
+
+    //! Textures are never limited below this size.
+    uint32_t minTextureSize = 64;
+
+    //! Upper bound of the memory used by the textures of an asset in bytes, or 0 for no limit.
+    //! This is an estimate based on uncompressed RGBA8 textures with all their miplevels.
+    size_t budget = 0;
+};
+
 /**
  * \class ResourceLoader ResourceLoader.h gltfio/ResourceLoader.h
  * \brief Prepares and uploads vertex buffers and textures to the GPU.
@@ -155,6 +186,34 @@ public:
      */
     void asyncCancelLoad();
 
+    /**
+     * Sets how subsequent asynchronous loads prioritize and size their textures.
+     *
+     * Textures are pushed to their providers by #asyncBeginLoad, or by #addResourceData for
+     * textures that were still being downloaded.
+     */
+    void setTextureResidency(const TextureResidency& residency);
+
+    /**
+     * Resizes the textures of a loaded asset to follow the on-screen size of their users, as seen
+     * from the camera of the current TextureResidency. This is meant to be called every few
+     * frames while the camera moves.
+     *
+     * A texture that appears larger than its size limit is decoded again with more miplevels,
+     * and one that appears at least 4 times smaller is decoded again with fewer, which frees its
+     * memory. The budget applies as it does for the initial load. Textures are decoded in the
+     * background, and each replaces the current one in the asset's material instances once it's
+     * complete, in this method or in #asyncUpdateLoad.
+     *
+     * Only the textures that were limited by the initial load can be resized. This requires their
+     * source data, so it does nothing once FilamentAsset::releaseSourceData() has been called,
+     * and the resources given to #addResourceData must not have been evicted.
+     *
+     * #asyncCancelLoad drops the textures that are being decoded again. It must be called
+     * before destroying an asset whose textures are being resized.
+     */
+    void updateTextureResidency(FilamentAsset* asset);
+
 private:
     bool loadResources(FFilamentAsset* asset, bool async);
     struct Impl;
@@ -164,6 +164,23 @@ public:
     /** Total number of textures that have become ready-to-pop since the provider was created. */
     virtual size_t getDecodedCount() const = 0;
 
+    /**
+     * Limits the width and height of the textures created by subsequent calls to pushTexture().
+     *
+     * Providers of hierarchical images (e.g. KTX2) honor this by skipping the miplevels that are
+     * larger, other providers are free to ignore it. Zero means no limit, which is the default.
+     */
+    virtual void setMaxTextureSize(uint32_t size) {}
+
+    /**
+     * Sets the priority of the textures pushed by subsequent calls to pushTexture().
+     *
+     * Textures with a higher priority are decoded first, regardless of the order in which they
+     * were pushed. Decoding runs in the background of the JobSystem so that it doesn't delay
+     * the rendering of frames. Zero is the lowest priority, which is the default.
+     */
+    virtual void setDecodingPriority(uint16_t priority) {}
+
     virtual ~TextureProvider() = default;
 };
 
@@ -24,8 +24,10 @@
 
 #include <filament/VertexBuffer.h>
 #include <filament/RenderableManager.h>
+#include <filament/SkinningBuffer.h>
 #include <filament/TransformManager.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Log.h>
 
 #include <math/mat4.h>
@@ -34,6 +36,8 @@
 #include <math/vec3.h>
 #include <math/vec4.h>
 
+#include <algorithm>
+#include <functional>
 #include <map>
 #include <string>
 #include <vector>
@@ -45,13 +49,17 @@ using namespace utils;
 
 namespace filament::gltfio {
 
-using TimeValues = map<float, size_t>;
+using TimeValues = vector<float>;
 using SourceValues = vector<float>;
 using BoneVector = vector<mat4f>;
 
 struct Sampler {
-    TimeValues times;
+    TimeValues times;           // keyframe times in increasing order
+    vector<uint32_t> keyframes; // index of the value of each keyframe
     SourceValues values;
+    size_t componentCount = 0;  // number of floats of each value
+    size_t resultOffset = 0;    // where the evaluated value goes in AnimatorImpl::samplerResults
+    bool isRotation = false;
     enum { LINEAR, STEP, CUBIC } interpolation;
 };
 
@@ -65,26 +73,81 @@ struct Animation {
     float duration;
     std::string name;
     vector<Sampler> samplers;
-    vector<Channel> channels;
+    vector<Channel> channels;   // sorted by target entity
+    size_t resultCount = 0;     // total number of floats of the evaluated samplers
 };
 
 struct AnimatorImpl {
+    // The bones of a skin of an instance, updated by updateBoneMatrices()
+    struct SkinUpdate {
+        FFilamentInstance::Skin const* skin;
+        FFilamentAsset::Skin const* assetSkin;
+        size_t firstJoint;      // in jointTransforms
+        size_t firstTarget;     // in targetUpdates
+        size_t targetCount;
+    };
+
+    // A renderable influenced by a skin, whose bones go in boneMatrices
+    struct TargetUpdate {
+        Entity entity;
+        RenderableManager::Instance renderable;
+        size_t firstBone;
+        uint32_t page;      // in skinningPages, or NO_PAGE if not in skinning buffer mode
+        uint32_t offset;    // in the page's SkinningBuffer
+    };
+
+    // A SkinningBuffer shared by many renderables, whose bones are uploaded at once
+    struct SkinningPage {
+        SkinningBuffer* buffer = nullptr;
+        size_t firstBone;   // in boneMatrices
+        size_t boneCount;   // number of bones to upload
+        size_t size;        // required size of the buffer, in bones
+    };
+
+    // A renderable bound to a SkinningPage by updateBoneMatrices()
+    struct Binding {
+        Entity entity;
+        uint32_t page;
+        uint32_t offset;
+        bool operator==(Binding const& rhs) const noexcept {
+            return entity == rhs.entity && page == rhs.page && offset == rhs.offset;
+        }
+    };
+
+    static constexpr uint32_t NO_PAGE = ~0u;
+
+    // Offsets into a SkinningBuffer must be aligned to the UBO offset alignment, which is at
+    // most 256 bytes, i.e. 4 bones.
+    static constexpr size_t BONE_OFFSET_ALIGNMENT = 4;
+
+    // Number of bones in a SkinningPage (1 MiB), offsets into a SkinningBuffer are 16 bits.
+    static constexpr size_t SKINNING_PAGE_SIZE = 16384;
+
     vector<Animation> animations;
     BoneVector boneMatrices;
+    vector<mat4> jointTransforms;
+    vector<SkinUpdate> skinUpdates;
+    vector<TargetUpdate> targetUpdates;
+    vector<SkinningPage> skinningPages;
+    vector<Binding> bindings;       // as of the last updateBoneMatrices()
+    vector<Binding> newBindings;
     FFilamentAsset const* asset = nullptr;
     FFilamentInstance* instance = nullptr;
     RenderableManager* renderableManager;
     TransformManager* transformManager;
     TrsTransformManager* trsTransformManager;
-    vector<float> weights;
+    vector<float> samplerResults;
     FixedCapacityVector<mat4f> crossFade;
     void addChannels(const FixedCapacityVector<Entity>& nodeMap, const cgltf_animation& srcAnim,
             Animation& dst);
-    void applyAnimation(const Channel& channel, float t, size_t prevIndex, size_t nextIndex);
+    bool applyAnimation(const Channel& channel, TrsTransformManager::Instance trsNode,
+            const float* value);
     void stashCrossFade();
     void applyCrossFade(float alpha);
     void resetBoneMatrices(FFilamentInstance* instance);
-    void updateBoneMatrices(FFilamentInstance* instance);
+    void updateBoneMatrices(FFilamentInstance* const* instances, size_t count);
+    void updateSkinBones(SkinUpdate const& update);
+    void destroySkinningPages();
 };
 
 static void createSampler(const cgltf_animation_sampler& src, Sampler& dst) {
@@ -100,42 +163,130 @@ static void createSampler(const cgltf_animation_sampler& src, Sampler& dst) {
         timelineFloats = (const float*) (timelineBlob + timelineAccessor->offset +
                 timelineAccessor->buffer_view->offset);
     }
+    map<float, size_t> times;
     for (size_t i = 0, len = timelineAccessor->count; i < len; ++i) {
-        dst.times[timelineFloats[i]] = i;
+        times[timelineFloats[i]] = i;
+    }
+
+    // Flatten the tree into arrays, which are faster to search.
+    dst.times.reserve(times.size());
+    dst.keyframes.reserve(times.size());
+    for (auto [time, index] : times) {
+        dst.times.push_back(time);
+        dst.keyframes.push_back(uint32_t(index));
+    }
+
+    switch (src.interpolation) {
+        case cgltf_interpolation_type_linear:
+            dst.interpolation = Sampler::LINEAR;
+            break;
+        case cgltf_interpolation_type_step:
+            dst.interpolation = Sampler::STEP;
+            break;
+        case cgltf_interpolation_type_cubic_spline:
+            dst.interpolation = Sampler::CUBIC;
+            break;
+        case cgltf_interpolation_type_max_enum:
+            break;
     }
 
     // Convert source data to float.
     const cgltf_accessor* valuesAccessor = src.output;
     switch (valuesAccessor->type) {
-        case cgltf_type_scalar:
+        case cgltf_type_scalar: {
+            // morph target weights, each keyframe has a weight per target
+            const size_t valueCount = timelineAccessor->count *
+                    (dst.interpolation == Sampler::CUBIC ? 3 : 1);
             dst.values.resize(valuesAccessor->count);
             cgltf_accessor_unpack_floats(src.output, &dst.values[0], valuesAccessor->count);
+            dst.componentCount = valueCount ? valuesAccessor->count / valueCount : 0;
             break;
+        }
         case cgltf_type_vec3:
             dst.values.resize(valuesAccessor->count * 3);
             cgltf_accessor_unpack_floats(src.output, &dst.values[0], valuesAccessor->count * 3);
+            dst.componentCount = 3;
             break;
         case cgltf_type_vec4:
+            // only rotations are animated with vec4 values
             dst.values.resize(valuesAccessor->count * 4);
             cgltf_accessor_unpack_floats(src.output, &dst.values[0], valuesAccessor->count * 4);
+            dst.componentCount = 4;
+            dst.isRotation = true;
             break;
         default:
             GLTFIO_WARN("Unknown animation type.");
             return;
     }
+}
 
-    switch (src.interpolation) {
-        case cgltf_interpolation_type_linear:
-            dst.interpolation = Sampler::LINEAR;
-            break;
-        case cgltf_interpolation_type_step:
-            dst.interpolation = Sampler::STEP;
-            break;
-        case cgltf_interpolation_type_cubic_spline:
-            dst.interpolation = Sampler::CUBIC;
-            break;
-        case cgltf_interpolation_type_max_enum:
-            break;
+// Evaluates the sampler at the given time, into its componentCount floats at `out`.
+static void evaluateSampler(const Sampler& sampler, float time, float* UTILS_RESTRICT out) {
+    const TimeValues& times = sampler.times;
+
+    // Find the first keyframe after the given time, or the keyframe that matches it exactly.
+    auto const iter = std::lower_bound(times.begin(), times.end(), time);
+
+    // Compute the interpolant (between 0 and 1) and determine the keyframe pair.
+    float t = 0.0f;
+    size_t nextIndex;
+    size_t prevIndex;
+    if (iter == times.end()) {
+        nextIndex = times.size() - 1;
+        prevIndex = nextIndex;
+    } else if (iter == times.begin()) {
+        nextIndex = 0;
+        prevIndex = 0;
+    } else {
+        size_t const next = iter - times.begin();
+        nextIndex = sampler.keyframes[next];
+        prevIndex = sampler.keyframes[next - 1];
+        const float nextTime = times[next];
+        const float prevTime = times[next - 1];
+        float deltaTime = nextTime - prevTime;
+        assert(deltaTime >= 0);
+        if (deltaTime > 0) {
+            t = (time - prevTime) / deltaTime;
+        }
+    }
+
+    if (sampler.interpolation == Sampler::STEP) {
+        t = 0.0f;
+    }
+
+    // Values are processed as arrays of floats, regardless of what they are, so these loops
+    // can be vectorized.
+    const size_t count = sampler.componentCount;
+    const float* const values = sampler.values.data();
+    if (sampler.interpolation == Sampler::CUBIC) {
+        // each keyframe has an in-tangent, a value and an out-tangent
+        const float* const vert0 = values + (prevIndex * 3 + 1) * count;
+        const float* const tang0 = values + (prevIndex * 3 + 2) * count;
+        const float* const tang1 = values + (nextIndex * 3 + 0) * count;
+        const float* const vert1 = values + (nextIndex * 3 + 1) * count;
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = cubicSpline(vert0[i], tang0[i], vert1[i], tang1[i], t);
+        }
+        if (sampler.isRotation) {
+            const quatf rotation = normalize(quatf{ float4{ out[0], out[1], out[2], out[3] }});
+            out[0] = rotation.x;
+            out[1] = rotation.y;
+            out[2] = rotation.z;
+            out[3] = rotation.w;
+        }
+    } else if (sampler.isRotation) {
+        const quatf* srcQuat = (const quatf*) values;
+        const quatf rotation = slerp(srcQuat[prevIndex], srcQuat[nextIndex], t);
+        out[0] = rotation.x;
+        out[1] = rotation.y;
+        out[2] = rotation.z;
+        out[3] = rotation.w;
+    } else {
+        const float* const previous = values + prevIndex * count;
+        const float* const current = values + nextIndex * count;
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = (1 - t) * previous[i] + t * current[i];
+        }
     }
 }
 
@@ -222,9 +373,11 @@ Animator::Animator(FFilamentAsset const* asset, FFilamentInstance* instance) {
             Sampler& dstSampler = dstAnim.samplers[j];
             createSampler(srcSampler, dstSampler);
             if (dstSampler.times.size() > 1) {
-                float maxtime = (--dstSampler.times.end())->first;
+                float maxtime = dstSampler.times.back();
                 dstAnim.duration = std::max(dstAnim.duration, maxtime);
             }
+            dstSampler.resultOffset = dstAnim.resultCount;
+            dstAnim.resultCount += dstSampler.componentCount;
         }
 
         // Import each glTF channel into a custom data structure.
@@ -255,6 +408,7 @@ void Animator::addInstance(FFilamentInstance* instance) {
 }
 
 Animator::~Animator() {
+    mImpl->destroySkinningPages();
     delete mImpl;
 }
 
@@ -265,48 +419,42 @@ size_t Animator::getAnimationCount() const {
 void Animator::applyAnimation(size_t animationIndex, float time) const {
     const Animation& anim = mImpl->animations[animationIndex];
     time = time == anim.duration ? time : fmod(time, anim.duration);
-    TransformManager& transformManager = *mImpl->transformManager;
-    transformManager.openLocalTransformTransaction();
-    for (const auto& channel : anim.channels) {
-        const Sampler* sampler = channel.sourceData;
-        if (sampler->times.size() < 2) {
-            continue;
-        }
 
-        const TimeValues& times = sampler->times;
+    // Evaluate each sampler once, they're typically shared by the channels of many instances.
+    vector<float>& results = mImpl->samplerResults;
+    results.resize(anim.resultCount);
+    for (const Sampler& sampler : anim.samplers) {
+        if (sampler.times.size() >= 2) {
+            evaluateSampler(sampler, time, results.data() + sampler.resultOffset);
+        }
+    }
 
-        // Find the first keyframe after the given time, or the keyframe that matches it exactly.
-        TimeValues::const_iterator iter = times.lower_bound(time);
+    TransformManager& transformManager = *mImpl->transformManager;
+    TrsTransformManager& trsTransformManager = *mImpl->trsTransformManager;
+    transformManager.openLocalTransformTransaction();
 
-        // Compute the interpolant (between 0 and 1) and determine the keyframe pair.
-        float t = 0.0f;
-        size_t nextIndex;
-        size_t prevIndex;
-        if (iter == times.end()) {
-            nextIndex = times.size() - 1;
-            prevIndex = nextIndex;
-        } else if (iter == times.begin()) {
-            nextIndex = 0;
-            prevIndex = 0;
-        } else {
-            TimeValues::const_iterator prev = iter; --prev;
-            nextIndex = iter->second;
-            prevIndex = prev->second;
-            const float nextTime = iter->first;
-            const float prevTime = prev->first;
-            float deltaTime = nextTime - prevTime;
-            assert(deltaTime >= 0);
-            if (deltaTime > 0) {
-                t = (time - prevTime) / deltaTime;
+    // Channels are sorted by target, so a node's local transform is set only once, after all
+    // its channels have been applied.
+    const vector<Channel>& channels = anim.channels;
+    for (size_t i = 0, n = channels.size(); i < n;) {
+        const Entity target = channels[i].targetEntity;
+        const TrsTransformManager::Instance trsNode = trsTransformManager.getInstance(target);
+        bool transformed = false;
+        for (; i < n && channels[i].targetEntity == target; ++i) {
+            const Channel& channel = channels[i];
+            const Sampler* sampler = channel.sourceData;
+            if (sampler->times.size() < 2) {
+                continue;
             }
+            transformed |= mImpl->applyAnimation(channel, trsNode,
+                    results.data() + sampler->resultOffset);
         }
-
-        if (sampler->interpolation == Sampler::STEP) {
-            t = 0.0f;
+        if (transformed) {
+            transformManager.setTransform(transformManager.getInstance(target),
+                    trsTransformManager.getTransform(trsNode));
         }
-
-        mImpl->applyAnimation(channel, t, prevIndex, nextIndex);
     }
+
     transformManager.commitLocalTransformTransaction();
 }
 
@@ -326,14 +474,12 @@ void Animator::resetBoneMatrices() {
 void Animator::updateBoneMatrices() {
     // If this is a single-instance animator, then update only this instance.
     if (mImpl->instance) {
-        mImpl->updateBoneMatrices(mImpl->instance);
+        mImpl->updateBoneMatrices(&mImpl->instance, 1);
         return;
     }
 
     // If this is a broadcast animator, then update all instances.
-    for (FFilamentInstance* instance : mImpl->asset->mInstances) {
-        mImpl->updateBoneMatrices(instance);
-    }
+    mImpl->updateBoneMatrices(mImpl->asset->mInstances.data(), mImpl->asset->mInstances.size());
 }
 
 float Animator::getAnimationDuration(size_t animationIndex) const {
@@ -432,101 +578,37 @@ void AnimatorImpl::addChannels(const FixedCapacityVector<Entity>& nodeMap,
         setTransformType(srcChannel, dstChannel);
         dst.channels.push_back(dstChannel);
     }
-}
 
-void AnimatorImpl::applyAnimation(const Channel& channel, float t, size_t prevIndex,
-        size_t nextIndex) {
-    const Sampler* sampler = channel.sourceData;
-    const TimeValues& times = sampler->times;
-    TrsTransformManager::Instance trsNode = trsTransformManager->getInstance(channel.targetEntity);
-    TransformManager::Instance node = transformManager->getInstance(channel.targetEntity);
+    // Group the channels by target, the order of the channels of a given target is preserved.
+    std::stable_sort(dst.channels.begin(), dst.channels.end(),
+            [](const Channel& lhs, const Channel& rhs) {
+                return lhs.targetEntity.getId() < rhs.targetEntity.getId();
+            });
+}
 
+bool AnimatorImpl::applyAnimation(const Channel& channel, TrsTransformManager::Instance trsNode,
+        const float* value) {
     switch (channel.transformType) {
+        case Channel::SCALE:
+            trsTransformManager->setScale(trsNode, float3{ value[0], value[1], value[2] });
+            return true;
 
-        case Channel::SCALE: {
-            float3 scale;
-            const float3* srcVec3 = (const float3*) sampler->values.data();
-            if (sampler->interpolation == Sampler::CUBIC) {
-                float3 vert0 = srcVec3[prevIndex * 3 + 1];
-                float3 tang0 = srcVec3[prevIndex * 3 + 2];
-                float3 tang1 = srcVec3[nextIndex * 3];
-                float3 vert1 = srcVec3[nextIndex * 3 + 1];
-                scale = cubicSpline(vert0, tang0, vert1, tang1, t);
-            } else {
-                scale = ((1 - t) * srcVec3[prevIndex]) + (t * srcVec3[nextIndex]);
-            }
-            trsTransformManager->setScale(trsNode, scale);
-            break;
-        }
+        case Channel::TRANSLATION:
+            trsTransformManager->setTranslation(trsNode, float3{ value[0], value[1], value[2] });
+            return true;
 
-        case Channel::TRANSLATION: {
-            float3 translation;
-            const float3* srcVec3 = (const float3*) sampler->values.data();
-            if (sampler->interpolation == Sampler::CUBIC) {
-                float3 vert0 = srcVec3[prevIndex * 3 + 1];
-                float3 tang0 = srcVec3[prevIndex * 3 + 2];
-                float3 tang1 = srcVec3[nextIndex * 3];
-                float3 vert1 = srcVec3[nextIndex * 3 + 1];
-                translation = cubicSpline(vert0, tang0, vert1, tang1, t);
-            } else {
-                translation = ((1 - t) * srcVec3[prevIndex]) + (t * srcVec3[nextIndex]);
-            }
-            trsTransformManager->setTranslation(trsNode, translation);
-            break;
-        }
-
-        case Channel::ROTATION: {
-            quatf rotation;
-            const quatf* srcQuat = (const quatf*) sampler->values.data();
-            if (sampler->interpolation == Sampler::CUBIC) {
-                quatf vert0 = srcQuat[prevIndex * 3 + 1];
-                quatf tang0 = srcQuat[prevIndex * 3 + 2];
-                quatf tang1 = srcQuat[nextIndex * 3];
-                quatf vert1 = srcQuat[nextIndex * 3 + 1];
-                rotation = normalize(cubicSpline(vert0, tang0, vert1, tang1, t));
-            } else {
-                rotation = slerp(srcQuat[prevIndex], srcQuat[nextIndex], t);
-            }
-            trsTransformManager->setRotation(trsNode, rotation);
-            break;
-        }
+        case Channel::ROTATION:
+            trsTransformManager->setRotation(trsNode,
+                    quatf{ float4{ value[0], value[1], value[2], value[3] }});
+            return true;
 
         case Channel::WEIGHTS: {
-            const float* const samplerValues = sampler->values.data();
-            assert(sampler->values.size() % times.size() == 0);
-            const int valuesPerKeyframe = sampler->values.size() / times.size();
-
-            if (sampler->interpolation == Sampler::CUBIC) {
-                assert(valuesPerKeyframe % 3 == 0);
-                const int numMorphTargets = valuesPerKeyframe / 3;
-                const float* const inTangents = samplerValues;
-                const float* const splineVerts = samplerValues + numMorphTargets;
-                const float* const outTangents = samplerValues + numMorphTargets * 2;
-
-                weights.resize(numMorphTargets);
-                for (int comp = 0; comp < numMorphTargets; ++comp) {
-                    float vert0 = splineVerts[comp + prevIndex * valuesPerKeyframe];
-                    float tang0 = outTangents[comp + prevIndex * valuesPerKeyframe];
-                    float tang1 = inTangents[comp + nextIndex * valuesPerKeyframe];
-                    float vert1 = splineVerts[comp + nextIndex * valuesPerKeyframe];
-                    weights[comp] = cubicSpline(vert0, tang0, vert1, tang1, t);
-                }
-            } else {
-                weights.resize(valuesPerKeyframe);
-                for (int comp = 0; comp < valuesPerKeyframe; ++comp) {
-                    float previous = samplerValues[comp + prevIndex * valuesPerKeyframe];
-                    float current = samplerValues[comp + nextIndex * valuesPerKeyframe];
-                    weights[comp] = (1 - t) * previous + t * current;
-                }
-            }
-
             auto ci = renderableManager->getInstance(channel.targetEntity);
-            renderableManager->setMorphWeights(ci, weights.data(), weights.size());
-            return;
+            renderableManager->setMorphWeights(ci, value, channel.sourceData->componentCount);
+            return false;
         }
     }
-
-    transformManager->setTransform(node, trsTransformManager->getTransform(trsNode));
+    return false;
 }
 
 void AnimatorImpl::resetBoneMatrices(FFilamentInstance* instance) {
@@ -535,43 +617,198 @@ void AnimatorImpl::resetBoneMatrices(FFilamentInstance* instance) {
         boneMatrices.resize(njoints);
         for (const auto& entity : skin.targets) {
             auto renderable = renderableManager->getInstance(entity);
-            if (renderable) {
-                for (size_t boneIndex = 0; boneIndex < njoints; ++boneIndex) {
-                    boneMatrices[boneIndex] = mat4f();
-                }
-                renderableManager->setBones(renderable, boneMatrices.data(), boneMatrices.size());
+            if (!renderable) {
+                continue;
+            }
+            if (asset->mSkinnedRenderables.count(entity)) {
+                renderableManager->setSkinningBuffer(renderable, asset->mIdentityBones,
+                        njoints, 0);
+                continue;
+            }
+            for (size_t boneIndex = 0; boneIndex < njoints; ++boneIndex) {
+                boneMatrices[boneIndex] = mat4f();
             }
+            renderableManager->setBones(renderable, boneMatrices.data(), boneMatrices.size());
         }
     }
+    // the next update must bind the renderables again
+    bindings.clear();
 }
 
-void AnimatorImpl::updateBoneMatrices(FFilamentInstance* instance) {
-    assert_invariant(instance->mSkins.size() == asset->mSkins.size());
-    size_t skinIndex = 0;
-    for (const auto& skin : instance->mSkins) {
-        const auto& assetSkin = asset->mSkins[skinIndex++];
-        size_t njoints = skin.joints.size();
-        boneMatrices.resize(njoints);
-        for (Entity entity : skin.targets) {
-            auto renderable = renderableManager->getInstance(entity);
-            if (!renderable) {
-                continue;
+void AnimatorImpl::destroySkinningPages() {
+    // give the renderables that are still alive their identity bones back
+    for (Binding const& binding : bindings) {
+        auto renderable = renderableManager->getInstance(binding.entity);
+        if (renderable) {
+            renderableManager->setSkinningBuffer(renderable, asset->mIdentityBones,
+                    MAX_BONE_COUNT, 0);
+        }
+    }
+    bindings.clear();
+    for (SkinningPage const& page : skinningPages) {
+        asset->mEngine->destroy(page.buffer);
+    }
+    skinningPages.clear();
+}
+
+void AnimatorImpl::updateBoneMatrices(FFilamentInstance* const* instances, size_t count) {
+    // Gather the skins to update and the renderables they influence, and give each renderable
+    // its range of boneMatrices. The renderables built by the asset loader are in skinning
+    // buffer mode, their bones are packed into pages which are uploaded with a single call
+    // each. Any other renderable gets its bones after those of the pages.
+    skinUpdates.clear();
+    targetUpdates.clear();
+    newBindings.clear();
+    size_t boneCount = 0;
+    size_t otherBoneCount = 0;
+    size_t jointCount = 0;
+    size_t pageCount = 0;
+    for (size_t i = 0; i < count; ++i) {
+        FFilamentInstance const* instance = instances[i];
+        assert_invariant(instance->mSkins.size() == asset->mSkins.size());
+        size_t skinIndex = 0;
+        for (const auto& skin : instance->mSkins) {
+            const auto& assetSkin = asset->mSkins[skinIndex++];
+            const size_t njoints = skin.joints.size();
+            SkinUpdate update{ &skin, &assetSkin, jointCount, targetUpdates.size(), 0 };
+            for (Entity entity : skin.targets) {
+                auto renderable = renderableManager->getInstance(entity);
+                if (!renderable) {
+                    continue;
+                }
+                if (!asset->mSkinnedRenderables.count(entity)) {
+                    targetUpdates.push_back({ entity, renderable, otherBoneCount, NO_PAGE, 0 });
+                    otherBoneCount += njoints;
+                    continue;
+                }
+                // each renderable binds MAX_BONE_COUNT bones, whatever its joint count
+                size_t offset = pageCount ? skinningPages[pageCount - 1].boneCount : 0;
+                offset = (offset + BONE_OFFSET_ALIGNMENT - 1) & ~(BONE_OFFSET_ALIGNMENT - 1);
+                if (!pageCount || offset + MAX_BONE_COUNT > SKINNING_PAGE_SIZE) {
+                    if (pageCount == skinningPages.size()) {
+                        skinningPages.emplace_back();
+                    }
+                    skinningPages[pageCount].firstBone = boneCount;
+                    pageCount++;
+                    offset = 0;
+                }
+                SkinningPage& page = skinningPages[pageCount - 1];
+                page.boneCount = offset + njoints;
+                page.size = offset + MAX_BONE_COUNT;
+                boneCount = page.firstBone + page.boneCount;
+                uint32_t const pageIndex = uint32_t(pageCount - 1);
+                targetUpdates.push_back({ entity, renderable, page.firstBone + offset,
+                        pageIndex, uint32_t(offset) });
+                newBindings.push_back({ entity, pageIndex, uint32_t(offset) });
             }
-            mat4 inverseGlobalTransform;
-            auto xformable = transformManager->getInstance(entity);
-            if (xformable) {
-                inverseGlobalTransform = inverse(transformManager->getWorldTransformAccurate(xformable));
+            update.targetCount = targetUpdates.size() - update.firstTarget;
+            if (update.targetCount) {
+                skinUpdates.push_back(update);
+                jointCount += njoints;
             }
-            for (size_t boneIndex = 0; boneIndex < njoints; ++boneIndex) {
-                const auto& joint = skin.joints[boneIndex];
-                const mat4f& inverseBindMatrix = assetSkin.inverseBindMatrices[boneIndex];
-                TransformManager::Instance jointInstance = transformManager->getInstance(joint);
-                mat4 globalJointTransform = transformManager->getWorldTransformAccurate(jointInstance);
-                boneMatrices[boneIndex] =
-                        mat4f{ inverseGlobalTransform * globalJointTransform } *
-                        inverseBindMatrix;
+        }
+    }
+    for (TargetUpdate& target : targetUpdates) {
+        if (target.page == NO_PAGE) {
+            target.firstBone += boneCount;
+        }
+    }
+    boneMatrices.resize(boneCount + otherBoneCount);
+    jointTransforms.resize(jointCount);
+
+    // Compute the bones of each skin. Skins are independent and only read the transform
+    // manager, so with many instances they're processed in parallel.
+    constexpr size_t SKINS_PER_JOB = 8;
+    if (skinUpdates.size() <= SKINS_PER_JOB) {
+        for (SkinUpdate const& update : skinUpdates) {
+            updateSkinBones(update);
+        }
+    } else {
+        auto updateSkins = [this](SkinUpdate const* updates, uint32_t c) {
+            for (uint32_t k = 0; k < c; ++k) {
+                updateSkinBones(updates[k]);
             }
-            renderableManager->setBones(renderable, boneMatrices.data(), boneMatrices.size());
+        };
+        JobSystem& js = asset->mEngine->getJobSystem();
+        auto* job = jobs::parallel_for(js, nullptr, skinUpdates.data(),
+                uint32_t(skinUpdates.size()), std::cref(updateSkins),
+                jobs::CountSplitter<SKINS_PER_JOB>());
+        js.runAndWait(job);
+    }
+
+    // Upload the bones, this must happen on this thread. The pages that are too small are
+    // replaced, and the ones no longer needed are destroyed.
+    Engine& engine = *asset->mEngine;
+    bool rebind = newBindings != bindings;
+    for (size_t p = 0; p < pageCount; ++p) {
+        SkinningPage& page = skinningPages[p];
+        if (!page.buffer || page.buffer->getBoneCount() < page.size) {
+            engine.destroy(page.buffer);
+            page.buffer = SkinningBuffer::Builder().boneCount(page.size).build(engine);
+            rebind = true;
+        }
+        page.buffer->setBones(engine, boneMatrices.data() + page.firstBone, page.boneCount, 0);
+    }
+    if (rebind) {
+        // renderables may have been detached from their skin since the last update
+        for (Binding const& binding : bindings) {
+            auto renderable = renderableManager->getInstance(binding.entity);
+            if (renderable) {
+                renderableManager->setSkinningBuffer(renderable, asset->mIdentityBones,
+                        MAX_BONE_COUNT, 0);
+            }
+        }
+    }
+    for (size_t p = pageCount; p < skinningPages.size(); ++p) {
+        engine.destroy(skinningPages[p].buffer);
+    }
+    skinningPages.resize(pageCount);
+
+    // Only the renderables that aren't in skinning buffer mode need their own upload.
+    for (SkinUpdate const& update : skinUpdates) {
+        const size_t njoints = update.skin->joints.size();
+        for (size_t t = update.firstTarget; t < update.firstTarget + update.targetCount; ++t) {
+            TargetUpdate const& target = targetUpdates[t];
+            if (target.page != NO_PAGE) {
+                if (rebind) {
+                    renderableManager->setSkinningBuffer(target.renderable,
+                            skinningPages[target.page].buffer, njoints, target.offset);
+                }
+                continue;
+            }
+            renderableManager->setBones(target.renderable,
+                    boneMatrices.data() + target.firstBone, njoints);
+        }
+    }
+    std::swap(bindings, newBindings);
+}
+
+void AnimatorImpl::updateSkinBones(SkinUpdate const& update) {
+    const auto& skin = *update.skin;
+    const auto& assetSkin = *update.assetSkin;
+    const size_t njoints = skin.joints.size();
+
+    // The joint transforms are shared by all the targets.
+    mat4* const joints = jointTransforms.data() + update.firstJoint;
+    for (size_t boneIndex = 0; boneIndex < njoints; ++boneIndex) {
+        const auto& joint = skin.joints[boneIndex];
+        TransformManager::Instance jointInstance = transformManager->getInstance(joint);
+        joints[boneIndex] = transformManager->getWorldTransformAccurate(jointInstance);
+    }
+
+    for (size_t t = update.firstTarget; t < update.firstTarget + update.targetCount; ++t) {
+        TargetUpdate const& target = targetUpdates[t];
+        mat4 inverseGlobalTransform;
+        auto xformable = transformManager->getInstance(target.entity);
+        if (xformable) {
+            inverseGlobalTransform = inverse(transformManager->getWorldTransformAccurate(xformable));
+        }
+        mat4f* const bones = boneMatrices.data() + target.firstBone;
+        for (size_t boneIndex = 0; boneIndex < njoints; ++boneIndex) {
+            const mat4f& inverseBindMatrix = assetSkin.inverseBindMatrices[boneIndex];
+            bones[boneIndex] =
+                    mat4f{ inverseGlobalTransform * joints[boneIndex] } *
+                    inverseBindMatrix;
         }
     }
 }
@@ -30,8 +30,6 @@
 #include <utils/memalign.h>
 #include <utils/ostream.h>
 
-#include <zstd.h>
-
 #include <stdint.h>
 #include <stddef.h>
 #include <string.h>
@@ -60,17 +58,41 @@ static bool strIsEqual(const CString& a, const char* b) {
 
 void ArchiveCache::load(const void* archiveData, uint64_t archiveByteCount) {
     assert_invariant(mArchive == nullptr && "Do not call load() twice");
-    const uint64_t decompSize = ZSTD_getFrameContentSize(archiveData, archiveByteCount);
-    if (decompSize == ZSTD_CONTENTSIZE_UNKNOWN || decompSize == ZSTD_CONTENTSIZE_ERROR) {
+    size_t metadataByteCount = 0;
+    mArchive = decompressArchiveMetadata(archiveData, archiveByteCount, &metadataByteCount);
+    if (mArchive == nullptr) {
         PANIC_POSTCONDITION("Decompression error.");
     }
-    uint64_t* basePointer = (uint64_t*) utils::aligned_alloc(decompSize, 8);
-    ZSTD_decompress(basePointer, decompSize, archiveData, archiveByteCount);
-    mArchive = (ReadableArchive*) basePointer;
-    convertOffsetsToPointers(mArchive);
+
+    // The caller's archive does not need to outlive this call, so we hold on to a copy of the
+    // package frames. They stay compressed until their material is needed.
+    if (isSeekable(*mArchive)) {
+        mPackages = FixedCapacityVector<uint8_t>(archiveByteCount - metadataByteCount);
+        memcpy(mPackages.data(), (const uint8_t*) archiveData + metadataByteCount,
+                mPackages.size());
+    }
     mMaterials = FixedCapacityVector<Material*>(mArchive->specsCount, nullptr);
 }
 
+Material* ArchiveCache::createMaterial(size_t specIndex) {
+    const ArchiveSpec& spec = mArchive->specs[specIndex];
+    if (!isSeekable(*mArchive)) {
+        return Material::Builder()
+            .package(spec.package, spec.packageByteCount)
+            .build(mEngine);
+    }
+
+    // The package is only needed until the material is built.
+    FixedCapacityVector<uint8_t> package(spec.packageByteCount);
+    if (!decompressPackage(spec, mPackages.data(), mPackages.size(), package.data())) {
+        slog.e << "Unable to decompress ubershader " << specIndex << io::endl;
+        return nullptr;
+    }
+    return Material::Builder()
+        .package(package.data(), package.size())
+        .build(mEngine);
+}
+
 // This loops though all ubershaders and returns the first one that meets the given requirements.
 Material* ArchiveCache::getMaterial(const ArchiveRequirements& reqs) {
     assert_invariant(mArchive && "Please call load() before requesting any materials.");
@@ -132,9 +154,7 @@ Material* ArchiveCache::getMaterial(const ArchiveRequirements& reqs) {
 
         if (specIsSuitable) {
             if (mMaterials[i] == nullptr) {
-                mMaterials[i] = Material::Builder()
-                    .package(spec.package, spec.packageByteCount)
-                    .build(mEngine);
+                mMaterials[i] = createMaterial(i);
             }
 
             return mMaterials[i];
@@ -148,9 +168,7 @@ Material* ArchiveCache::getDefaultMaterial() {
     assert_invariant(!mMaterials.empty() && "Archive must have at least one material.");
     if (!mArchive) return nullptr;
     if (mMaterials[0] == nullptr) {
-        mMaterials[0] = Material::Builder()
-            .package(mArchive->specs[0].package, mArchive->specs[0].packageByteCount)
-            .build(mEngine);
+        mMaterials[0] = createMaterial(0);
     }
     return mMaterials[0];
 }
@@ -50,9 +50,15 @@ namespace filament::gltfio {
         FeatureMap getFeatureMap(Material* material) const;
 
     private:
+        Material* createMaterial(size_t specIndex);
+
         Engine& mEngine;
         utils::FixedCapacityVector<Material*> mMaterials;
         uberz::ReadableArchive* mArchive = nullptr;
+
+        // Compressed package frames of seekable archives, each one is decompressed only when its
+        // material is first requested.
+        utils::FixedCapacityVector<uint8_t> mPackages;
     };
 
     struct ArchiveRequirements {
@@ -36,6 +36,7 @@
 #include <filament/MorphTargetBuffer.h>
 #include <filament/RenderableManager.h>
 #include <filament/Scene.h>
+#include <filament/SkinningBuffer.h>
 #include <filament/TextureSampler.h>
 #include <filament/TransformManager.h>
 #include <filament/VertexBuffer.h>
@@ -272,6 +273,8 @@ struct FAssetLoader : public AssetLoader {
     FFilamentAsset* createAsset(const uint8_t* bytes, uint32_t nbytes);
     FFilamentAsset* createInstancedAsset(const uint8_t* bytes, uint32_t numBytes,
             FilamentInstance** instances, size_t numInstances);
+    FFilamentAsset* createInstancedAsset(BufferDescriptor&& content,
+            FilamentInstance** instances, size_t numInstances);
     FilamentInstance* createInstance(FFilamentAsset* fAsset);
 
     static void destroy(FAssetLoader** loader) noexcept {
@@ -364,6 +367,18 @@ FFilamentAsset* FAssetLoader::createAsset(const uint8_t* bytes, uint32_t byteCou
 
 FFilamentAsset* FAssetLoader::createInstancedAsset(const uint8_t* bytes, uint32_t byteCount,
         FilamentInstance** instances, size_t numInstances) {
+    // Clients can free up their source blob immediately, but cgltf has pointers into the data that
+    // need to stay valid. Therefore we create a copy of the source blob and stash it inside the
+    // asset.
+    void* content = malloc(byteCount);
+    std::copy_n(bytes, byteCount, (uint8_t*) content);
+    return createInstancedAsset(BufferDescriptor(content, byteCount,
+                    [](void* buffer, size_t, void*) { free(buffer); }),
+            instances, numInstances);
+}
+
+FFilamentAsset* FAssetLoader::createInstancedAsset(BufferDescriptor&& content,
+        FilamentInstance** instances, size_t numInstances) {
     // This method can be used to load JSON or GLB. By using a default options struct, we are asking
     // cgltf to examine the magic identifier to determine which type of file is being loaded.
     cgltf_options options {};
@@ -380,17 +395,14 @@ FFilamentAsset* FAssetLoader::createInstancedAsset(const uint8_t* bytes, uint32_
         // This callback also gets called for the root-level file_data, but since we use
         // `cgltf_parse`, the file_data field is always null.
         options.file.release = [](const cgltf_memory_options*, const cgltf_file_options*, void*) {};
+    } else {
+        // External buffers may be mapped rather than read, see utility::loadCgltfBuffers().
+        options.file.release = utility::releaseCgltfFile;
     }
 
-    // Clients can free up their source blob immediately, but cgltf has pointers into the data that
-    // need to stay valid. Therefore we create a copy of the source blob and stash it inside the
-    // asset.
-    utils::FixedCapacityVector<uint8_t> glbdata(byteCount);
-    std::copy_n(bytes, byteCount, glbdata.data());
-
     // The ownership of an allocated `sourceAsset` will be moved to FFilamentAsset::mSourceAsset.
     cgltf_data* sourceAsset;
-    cgltf_result result = cgltf_parse(&options, glbdata.data(), byteCount, &sourceAsset);
+    cgltf_result result = cgltf_parse(&options, content.buffer, content.size, &sourceAsset);
     if (result != cgltf_result_success) {
         slog.e << "Unable to parse glTF file." << io::endl;
         return nullptr;
@@ -403,7 +415,7 @@ FFilamentAsset* FAssetLoader::createInstancedAsset(const uint8_t* bytes, uint32_
         mError = false;
         return nullptr;
     }
-    glbdata.swap(fAsset->mSourceAsset->glbData);
+    fAsset->mSourceAsset->glbData = std::move(content);
 
     createInstances(numInstances, fAsset);
     if (mError) {
@@ -870,7 +882,16 @@ void FAssetLoader::createRenderable(const cgltf_node* node, Entity entity, const
     nm.setMorphTargetNames(nm.getInstance(entity), std::move(morphTargetNames));
 
     if (node->skin) {
-        builder.skinning(node->skin->joints_count);
+        // the bones start as identity, see FFilamentAsset::mIdentityBones
+        if (!fAsset->mIdentityBones) {
+            fAsset->mIdentityBones = SkinningBuffer::Builder()
+                    .boneCount(MAX_BONE_COUNT)
+                    .initialize(true)
+                    .build(mEngine);
+        }
+        builder.enableSkinningBuffers(true)
+                .skinning(fAsset->mIdentityBones, node->skin->joints_count, 0);
+        fAsset->mSkinnedRenderables.insert(entity);
     }
 
     // Per the spec, glTF models must have valid mix / max annotations for position attributes.
@@ -1754,11 +1775,21 @@ FilamentAsset* AssetLoader::createAsset(uint8_t const* bytes, uint32_t nbytes) {
     return downcast(this)->createAsset(bytes, nbytes);
 }
 
+FilamentAsset* AssetLoader::createAsset(BufferDescriptor&& content) {
+    FilamentInstance* instances;
+    return downcast(this)->createInstancedAsset(std::move(content), &instances, 1);
+}
+
 FilamentAsset* AssetLoader::createInstancedAsset(const uint8_t* bytes, uint32_t numBytes,
         FilamentInstance** instances, size_t numInstances) {
     return downcast(this)->createInstancedAsset(bytes, numBytes, instances, numInstances);
 }
 
+FilamentAsset* AssetLoader::createInstancedAsset(BufferDescriptor&& content,
+        FilamentInstance** instances, size_t numInstances) {
+    return downcast(this)->createInstancedAsset(std::move(content), instances, numInstances);
+}
+
 FilamentInstance* AssetLoader::createInstance(FilamentAsset* asset) {
     return downcast(this)->createInstance(downcast(asset));
 }
@@ -25,6 +25,7 @@
 #include <filament/IndexBuffer.h>
 #include <filament/MaterialInstance.h>
 #include <filament/RenderableManager.h>
+#include <filament/SkinningBuffer.h>
 #include <filament/Texture.h>
 #include <filament/TextureSampler.h>
 #include <filament/TransformManager.h>
@@ -33,6 +34,8 @@
 #include <gltfio/MaterialProvider.h>
 #include <gltfio/TextureProvider.h>
 
+#include <backend/BufferDescriptor.h>
+
 #include <math/mat4.h>
 
 #include <utils/FixedCapacityVector.h>
@@ -41,6 +44,8 @@
 
 #include <cgltf.h>
 
+#include <tsl/robin_set.h>
+
 #include "downcast.h"
 #include "DependencyGraph.h"
 #include "DracoCache.h"
@@ -102,6 +107,9 @@ struct Primitive {
 };
 using MeshCache = utils::FixedCapacityVector<utils::FixedCapacityVector<Primitive>>;
 
+// The number of bones bound by RenderableManager::setSkinningBuffer(), whatever the joint count
+static constexpr size_t MAX_BONE_COUNT = 256; // this is limited by filament::CONFIG_MAX_BONE_COUNT
+
 struct FFilamentAsset : public FilamentAsset {
     struct ResourceInfo;
     struct ResourceInfoExtended;
@@ -265,6 +273,13 @@ struct FFilamentAsset : public FilamentAsset {
     std::vector<IndexBuffer*> mIndexBuffers;
     std::vector<MorphTargetBuffer*> mMorphTargetBuffers;
     utils::FixedCapacityVector<Skin> mSkins;
+
+    // Skinned renderables are built in skinning buffer mode, so that an Animator can upload the
+    // bones of all of them at once. Until then (or after resetBoneMatrices()) they're bound to
+    // mIdentityBones, which holds MAX_BONE_COUNT identity bones.
+    SkinningBuffer* mIdentityBones = nullptr;
+    tsl::robin_set<utils::Entity, utils::Entity::Hasher> mSkinnedRenderables;
+
     utils::FixedCapacityVector<utils::CString> mScenes;
     Aabb mBoundingBox;
     utils::Entity mRoot;
@@ -289,7 +304,8 @@ struct FFilamentAsset : public FilamentAsset {
         ~SourceAsset() { cgltf_free(hierarchy); }
         cgltf_data* hierarchy;
         DracoCache dracoCache;
-        utils::FixedCapacityVector<uint8_t> glbData;
+        // The content given to AssetLoader, cgltf points into it
+        filament::backend::BufferDescriptor glbData;
     };
 
     // We used shared ownership for the raw cgltf data in order to permit ResourceLoader to
@@ -310,6 +326,8 @@ struct FFilamentAsset : public FilamentAsset {
         Texture* texture;
         TextureProvider::TextureFlags flags;
         bool isOwner;
+        // Size limit the texture was decoded with under TextureResidency, 0 if it's not limited.
+        uint32_t maxSize;
     };
 
     // Mapping from cgltf_texture to Texture* is required when creating new instances.
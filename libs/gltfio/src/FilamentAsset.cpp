@@ -93,6 +93,7 @@ FFilamentAsset::~FFilamentAsset() {
     for (auto tb : mMorphTargetBuffers) {
         mEngine->destroy(tb);
     }
+    mEngine->destroy(mIdentityBones);
 }
 
 const char* FFilamentAsset::getExtras(utils::Entity entity) const noexcept {
@@ -119,13 +120,15 @@ void FFilamentAsset::addTextureBinding(MaterialInstance* materialInstance,
     assert_invariant(info.bindings.size() == 0 || info.flags == flags);
     info.flags = flags;
 
+    // Bindings are kept even once the texture is loaded, in case it's replaced by
+    // ResourceLoader::updateTextureResidency().
     const TextureSlot slot = { materialInstance, parameterName };
     if (info.texture) {
         applyTextureBinding(textureIndex, slot, false);
     } else {
         mDependencyGraph.addEdge(materialInstance, parameterName);
-        info.bindings.push_back(slot);
     }
+    info.bindings.push_back(slot);
 }
 
 void FFilamentAsset::applyTextureBinding(size_t textureIndex, const TextureSlot& tb,
@@ -52,6 +52,8 @@ public:
     size_t getPushedCount() const final { return mPushedCount; }
     size_t getPoppedCount() const final { return mPoppedCount; }
     size_t getDecodedCount() const final { return mDecodedCount; }
+    void setDecodingPriority(uint16_t priority) final { mDecodingPriority = priority; }
+    void setMaxTextureSize(uint32_t size) final { mKtxReader->setMaxTextureSize(size); }
 
 private:
     enum class QueueItemState {
@@ -78,6 +80,7 @@ private:
     size_t mPushedCount = 0;
     size_t mPoppedCount = 0;
     size_t mDecodedCount = 0;
+    uint16_t mDecodingPriority = 0;
     vector<unique_ptr<QueueItem> > mQueueItems;
     JobSystem::Job* mDecoderRootJob;
     std::string mRecentPushMessage;
@@ -122,7 +125,7 @@ Texture* Ktx2Provider::pushTexture(const uint8_t* data, size_t byteCount,
         item->transcoderState.store(success ? TranscoderState::SUCCESS : TranscoderState::ERROR);
     });
 
-    js->runAndRetain(item->job);
+    js->runInBackgroundAndRetain(item->job, mDecodingPriority);
     return async->getTexture();
 }
 
@@ -160,19 +163,23 @@ void Ktx2Provider::updateQueue() {
         }
         item->async->getTexture();
         const TranscoderState state = item->transcoderState.load();
-        if (state != TranscoderState::NOT_STARTED) {
-            if (item->job) {
-                js->waitAndRelease(item->job);
-            }
-            if (state == TranscoderState::ERROR) {
-                item->state = QueueItemState::READY;
-                ++mDecodedCount;
-                continue;
-            }
+        if (state == TranscoderState::NOT_STARTED) {
+            // Miplevels are transcoded from the smallest to the largest, upload those that are
+            // ready so that the texture is displayed at a low resolution in the meantime.
             item->async->uploadImages();
+            continue;
+        }
+        if (item->job) {
+            js->waitAndRelease(item->job);
+        }
+        if (state == TranscoderState::ERROR) {
             item->state = QueueItemState::READY;
             ++mDecodedCount;
+            continue;
         }
+        item->async->uploadImages();
+        item->state = QueueItemState::READY;
+        ++mDecodedCount;
     }
 
     // Here we periodically clean up the "queue" (which is really just a vector) by removing unused
@@ -193,9 +200,13 @@ void Ktx2Provider::waitForCompletion() {
 }
 
 void Ktx2Provider::cancelDecoding() {
-    // TODO: Currently, Ktx2Provider runs jobs eagerly and JobSystem does not allow cancellation of
-    // in-flight jobs. We should consider throttling the number of simultaneous decoder jobs, which
-    // would allow for actual cancellation.
+    // Jobs that haven't started yet are skipped, we only have to wait for those that are
+    // transcoding right now.
+    for (auto& item : mQueueItems) {
+        if (item->job) {
+            JobSystem::requestCancellation(item->job);
+        }
+    }
     waitForCompletion();
 
     // For cancelled jobs, we need to set the QueueItemState to POPPED and free the decoded data
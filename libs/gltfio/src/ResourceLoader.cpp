@@ -24,11 +24,15 @@
 #include "Utility.h"
 #include "extended/ResourceLoaderExtended.h"
 
+#include <filament/Box.h>
 #include <filament/BufferObject.h>
+#include <filament/Camera.h>
 #include <filament/Engine.h>
 #include <filament/IndexBuffer.h>
 #include <filament/MaterialInstance.h>
+#include <filament/RenderableManager.h>
 #include <filament/Texture.h>
+#include <filament/TransformManager.h>
 #include <filament/VertexBuffer.h>
 #include <filament/MorphTargetBuffer.h>
 
@@ -43,16 +47,20 @@
 #include <cgltf.h>
 #include <meshoptimizer.h>
 
+#include <math/mat4.h>
 #include <math/quat.h>
 #include <math/vec3.h>
 #include <math/vec4.h>
 
 #include <tsl/robin_map.h>
 
+#include <algorithm>
 #include <fstream>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <tuple>
+#include <vector>
 
 using namespace filament;
 using namespace filament::math;
@@ -101,14 +109,30 @@ struct ResourceLoader::Impl {
 
     FFilamentAsset* mAsyncAsset = nullptr;
     size_t mRemainingTextureDownloads = 0;
+    TextureResidency mTextureResidency;
 
     void addResourceData(const char* uri, BufferDescriptor&& buffer);
     void computeTangents(FFilamentAsset* asset);
     void createTextures(FFilamentAsset* asset, bool async);
+    void computeTextureResidency(FFilamentAsset* asset, uint32_t* order, uint32_t* maxSizes,
+            uint16_t* priorities) const;
     void cancelTextureDecoding();
     std::pair<Texture*, CacheResult> getOrCreateTexture(FFilamentAsset* asset, size_t textureIndex,
-            TextureProvider::TextureFlags flags);
+            TextureProvider::TextureFlags flags, bool useCache = true);
+    void popTextures();
+    void updateTextureResidency(FFilamentAsset* asset);
     ~Impl();
+
+    // Textures decoded again by updateTextureResidency(), each replaces the texture of the asset
+    // once it's popped from its provider.
+    struct PendingTexture {
+        FFilamentAsset* asset;
+        size_t textureIndex;
+        Texture* texture;
+        uint32_t maxSize;
+    };
+    std::vector<PendingTexture> mPendingTextures;
+    void replaceTexture(const PendingTexture& pending);
 };
 
 namespace {
@@ -229,13 +253,9 @@ inline void createSkins(cgltf_data const* gltf, bool normalize,
 
 inline void uploadBuffers(FFilamentAsset* asset, Engine& engine,
         UriDataCacheHandle uriDataCache) {
-    // Upload VertexBuffer and IndexBuffer data to the GPU.
     auto& slots = std::get<FFilamentAsset::ResourceInfo>(asset->mResourceInfo).mBufferSlots;
-    for (auto const& slot: slots) {
-        const cgltf_accessor* accessor = slot.accessor;
-        if (!accessor->buffer_view) {
-            continue;
-        }
+
+    auto getData = [](const cgltf_accessor* accessor) {
         const uint8_t* bufferData = nullptr;
         const uint8_t* data = nullptr;
         if (accessor->buffer_view->has_meshopt_compression) {
@@ -246,13 +266,57 @@ inline void uploadBuffers(FFilamentAsset* asset, Engine& engine,
             data = utility::computeBindingOffset(accessor) + bufferData;
         }
         assert_invariant(bufferData);
+        return data;
+    };
+
+    // Most buffers are uploaded straight from the glTF data. The few that need a conversion are
+    // converted up front, in parallel, since this can take a while for large assets.
+    std::vector<void*> converted(slots.size(), nullptr);
+    JobSystem& js = engine.getJobSystem();
+    JobSystem::Job* parent = js.createJob();
+    for (size_t i = 0, n = slots.size(); i < n; ++i) {
+        auto const& slot = slots[i];
+        const cgltf_accessor* accessor = slot.accessor;
+        if (!accessor->buffer_view) {
+            continue;
+        }
+        if (slot.indexBuffer) {
+            if (accessor->component_type == cgltf_component_type_r_8u) {
+                const uint8_t* data = getData(accessor);
+                const uint32_t size = utility::computeBindingSize(accessor);
+                uint16_t* data16 = (uint16_t*) malloc(size * 2);
+                converted[i] = data16;
+                js.run(jobs::createJob(js, parent, [data16, data, size] {
+                    utility::convertBytesToShorts(data16, data, size);
+                }));
+            }
+            continue;
+        }
+        if (slot.vertexBuffer ? utility::requiresConversion(accessor)
+                : utility::requiresPacking(accessor)) {
+            const size_t floatsCount = accessor->count * cgltf_num_components(accessor->type);
+            float* floatsData = (float*) malloc(sizeof(float) * floatsCount);
+            converted[i] = floatsData;
+            js.run(jobs::createJob(js, parent, [accessor, floatsData, floatsCount] {
+                cgltf_accessor_unpack_floats(accessor, floatsData, floatsCount);
+            }));
+        }
+    }
+    js.runAndWait(parent);
+
+    // Upload VertexBuffer and IndexBuffer data to the GPU.
+    for (size_t i = 0, n = slots.size(); i < n; ++i) {
+        auto const& slot = slots[i];
+        const cgltf_accessor* accessor = slot.accessor;
+        if (!accessor->buffer_view) {
+            continue;
+        }
+        const uint8_t* data = getData(accessor);
         const uint32_t size = utility::computeBindingSize(accessor);
         if (slot.vertexBuffer) {
-            if (utility::requiresConversion(accessor)) {
+            if (float* floatsData = (float*) converted[i]; floatsData) {
                 const size_t floatsCount = accessor->count * cgltf_num_components(accessor->type);
                 const size_t floatsByteCount = sizeof(float) * floatsCount;
-                float* floatsData = (float*) malloc(floatsByteCount);
-                cgltf_accessor_unpack_floats(accessor, floatsData, floatsCount);
                 BufferObject* bo = BufferObject::Builder().size(floatsByteCount).build(engine);
                 asset->mBufferObjects.push_back(bo);
                 bo->setBuffer(engine, BufferDescriptor(floatsData, floatsByteCount, FREE_CALLBACK));
@@ -267,11 +331,8 @@ inline void uploadBuffers(FFilamentAsset* asset, Engine& engine,
             slot.vertexBuffer->setBufferObjectAt(engine, slot.bufferIndex, bo);
             continue;
         } else if (slot.indexBuffer) {
-            if (accessor->component_type == cgltf_component_type_r_8u) {
-                const size_t size16 = size * 2;
-                uint16_t* data16 = (uint16_t*) malloc(size16);
-                utility::convertBytesToShorts(data16, data, size);
-                IndexBuffer::BufferDescriptor bd(data16, size16, FREE_CALLBACK);
+            if (uint16_t* data16 = (uint16_t*) converted[i]; data16) {
+                IndexBuffer::BufferDescriptor bd(data16, size * 2, FREE_CALLBACK);
 
                 slot.indexBuffer->setBuffer(engine, std::move(bd));
                 continue;
@@ -286,11 +347,7 @@ inline void uploadBuffers(FFilamentAsset* asset, Engine& engine,
         // must be a morph target.
         assert(slot.morphTargetBuffer);
 
-        if (utility::requiresPacking(accessor)) {
-            const size_t floatsCount = accessor->count * cgltf_num_components(accessor->type);
-            const size_t floatsByteCount = sizeof(float) * floatsCount;
-            float* floatsData = (float*) malloc(floatsByteCount);
-            cgltf_accessor_unpack_floats(accessor, floatsData, floatsCount);
+        if (float* floatsData = (float*) converted[i]; floatsData) {
             if (accessor->type == cgltf_type_vec3) {
                 slot.morphTargetBuffer->setPositionsAt(engine, slot.bufferIndex,
                         (const float3*) floatsData,
@@ -490,6 +547,10 @@ void ResourceLoader::asyncCancelLoad() {
     pImpl->mEngine->flushAndWait();
 }
 
+void ResourceLoader::setTextureResidency(const TextureResidency& residency) {
+    pImpl->mTextureResidency = residency;
+}
+
 void ResourceLoader::addTextureProvider(const char* mimeType, TextureProvider* provider) {
     pImpl->mTextureProviders[mimeType] = provider;
 }
@@ -513,19 +574,18 @@ float ResourceLoader::asyncGetLoadProgress() const {
 }
 
 void ResourceLoader::asyncUpdateLoad() {
-    if (!pImpl->mAsyncAsset) {
+    if (!pImpl->mAsyncAsset && pImpl->mPendingTextures.empty()) {
         return;
     }
-    for (const auto& iter : pImpl->mTextureProviders) {
-        iter.second->updateQueue();
-        while (Texture* texture = iter.second->popTexture()) {
-            pImpl->mAsyncAsset->mDependencyGraph.markAsReady(texture);
-        }
-    }
+    pImpl->popTextures();
+}
+
+void ResourceLoader::updateTextureResidency(FilamentAsset* asset) {
+    pImpl->updateTextureResidency(downcast(asset));
 }
 
 std::pair<Texture*, CacheResult> ResourceLoader::Impl::getOrCreateTexture(FFilamentAsset* asset,
-        size_t textureIndex, TextureProvider::TextureFlags flags) {
+        size_t textureIndex, TextureProvider::TextureFlags flags, bool useCache) {
     const cgltf_texture& srcTexture = asset->mSourceAsset->hierarchy->textures[textureIndex];
     const cgltf_image* image = srcTexture.basisu_image ?
             srcTexture.basisu_image : srcTexture.image;
@@ -555,12 +615,15 @@ std::pair<Texture*, CacheResult> ResourceLoader::Impl::getOrCreateTexture(FFilam
         assert_invariant(!dataUriContent);
         const size_t offset = bv ? bv->offset : 0;
         const uint8_t* sourceData = offset + (const uint8_t*) *bufferViewData;
-        if (auto iter = mBufferTextureCache.find(sourceData); iter != mBufferTextureCache.end()) {
+        if (auto iter = mBufferTextureCache.find(sourceData);
+                useCache && iter != mBufferTextureCache.end()) {
             return {iter->second, CacheResult::FOUND};
         }
         const uint32_t totalSize = uint32_t(bv ? bv->size : 0);
         if (Texture* texture = provider->pushTexture(sourceData, totalSize, mime.c_str(), flags); texture) {
-            mBufferTextureCache[sourceData] = texture;
+            if (useCache) {
+                mBufferTextureCache[sourceData] = texture;
+            }
             return {texture, CacheResult::MISS};
         }
     }
@@ -569,13 +632,16 @@ std::pair<Texture*, CacheResult> ResourceLoader::Impl::getOrCreateTexture(FFilam
     // Note that this is a data URI in an image, not a buffer. Data URI's in buffers are decoded
     // by the cgltf_load_buffers() function.
     else if (dataUriContent) {
-        if (auto iter = mBufferTextureCache.find(uri); iter != mBufferTextureCache.end()) {
+        if (auto iter = mBufferTextureCache.find(uri);
+                useCache && iter != mBufferTextureCache.end()) {
             free((void*)dataUriContent);
             return {iter->second, CacheResult::FOUND};
         }
         if (Texture* texture = provider->pushTexture(dataUriContent, dataUriSize, mime.c_str(), flags); texture) {
             free((void*)dataUriContent);
-            mBufferTextureCache[uri] = texture;
+            if (useCache) {
+                mBufferTextureCache[uri] = texture;
+            }
             return {texture, CacheResult::MISS};
         }
         free((void*)dataUriContent);
@@ -584,18 +650,22 @@ std::pair<Texture*, CacheResult> ResourceLoader::Impl::getOrCreateTexture(FFilam
     // Check the user-supplied resource cache for this URI.
     else if (auto iter = mUriDataCache->find(uri); iter != mUriDataCache->end()) {
         const uint8_t* sourceData = (const uint8_t*) iter->second.buffer;
-        if (auto iter = mBufferTextureCache.find(sourceData); iter != mBufferTextureCache.end()) {
+        if (auto iter = mBufferTextureCache.find(sourceData);
+                useCache && iter != mBufferTextureCache.end()) {
             return {iter->second, CacheResult::FOUND};
         }
         if (Texture* texture = provider->pushTexture(sourceData, iter->second.size, mime.c_str(), flags); texture) {
-            mBufferTextureCache[sourceData] = texture;
+            if (useCache) {
+                mBufferTextureCache[sourceData] = texture;
+            }
             return {texture, CacheResult::MISS};
         }
     }
 
     // Finally, try the file system.
     else if constexpr (GLTFIO_USE_FILESYSTEM) {
-        if (auto iter = mFilepathTextureCache.find(uri); iter != mFilepathTextureCache.end()) {
+        if (auto iter = mFilepathTextureCache.find(uri);
+                useCache && iter != mFilepathTextureCache.end()) {
             return {iter->second, CacheResult::FOUND};
         }
         Path fullpath = Path(mGltfPath).getParent() + uri;
@@ -603,15 +673,29 @@ std::pair<Texture*, CacheResult> ResourceLoader::Impl::getOrCreateTexture(FFilam
             slog.e << "Unable to open " << fullpath << io::endl;
             return {};
         }
+        // Texture providers keep their own copy of the content, so we map the file if possible
+        // rather than reading it.
+        size_t byteCount = 0;
+        void* const mapped = utility::mapFile(fullpath.c_str(), &byteCount);
         using namespace std;
-        ifstream filest(fullpath, std::ifstream::in | std::ifstream::binary);
         vector<uint8_t> buffer;
-        filest.seekg(0, ios::end);
-        buffer.reserve((size_t) filest.tellg());
-        filest.seekg(0, ios::beg);
-        buffer.assign((istreambuf_iterator<char>(filest)), istreambuf_iterator<char>());
-        if (Texture* texture = provider->pushTexture(buffer.data(), buffer.size(), mime.c_str(), flags); texture) {
-            mFilepathTextureCache[uri] = texture;
+        if (!mapped) {
+            ifstream filest(fullpath, std::ifstream::in | std::ifstream::binary);
+            filest.seekg(0, ios::end);
+            buffer.reserve((size_t) filest.tellg());
+            filest.seekg(0, ios::beg);
+            buffer.assign((istreambuf_iterator<char>(filest)), istreambuf_iterator<char>());
+            byteCount = buffer.size();
+        }
+        const uint8_t* content = mapped ? (const uint8_t*) mapped : buffer.data();
+        Texture* texture = provider->pushTexture(content, byteCount, mime.c_str(), flags);
+        if (mapped) {
+            utility::unmapFile(mapped);
+        }
+        if (texture) {
+            if (useCache) {
+                mFilepathTextureCache[uri] = texture;
+            }
             return {texture, CacheResult::MISS};
         }
 
@@ -631,14 +715,161 @@ void ResourceLoader::Impl::cancelTextureDecoding() {
         iter.second->cancelDecoding();
     }
     mAsyncAsset = nullptr;
+
+    // The textures being decoded again are dropped, the assets keep their current ones.
+    for (const PendingTexture& pending : mPendingTextures) {
+        mEngine->destroy(pending.texture);
+    }
+    mPendingTextures.clear();
+}
+
+void ResourceLoader::Impl::popTextures() {
+    for (const auto& iter : mTextureProviders) {
+        iter.second->updateQueue();
+        while (Texture* texture = iter.second->popTexture()) {
+            auto pending = std::find_if(mPendingTextures.begin(), mPendingTextures.end(),
+                    [texture](const PendingTexture& item) { return item.texture == texture; });
+            if (pending != mPendingTextures.end()) {
+                if (const char* message = iter.second->getPopMessage()) {
+                    // Keep the current texture, and stop trying to update it.
+                    slog.e << "Unable to update texture: " << message << io::endl;
+                    pending->asset->mTextures[pending->textureIndex].maxSize = 0;
+                    mEngine->destroy(texture);
+                } else {
+                    replaceTexture(*pending);
+                }
+                mPendingTextures.erase(pending);
+            } else if (mAsyncAsset) {
+                mAsyncAsset->mDependencyGraph.markAsReady(texture);
+            }
+        }
+    }
+}
+
+void ResourceLoader::Impl::replaceTexture(const PendingTexture& pending) {
+    FFilamentAsset* asset = pending.asset;
+    Texture* const previous = asset->mTextures[pending.textureIndex].texture;
+    asset->mTextures[pending.textureIndex].maxSize = pending.maxSize;
+
+    // Several glTF textures can share the same Filament texture, they're all rebound.
+    for (size_t textureIndex = 0, n = asset->mTextures.size(); textureIndex < n; ++textureIndex) {
+        FFilamentAsset::TextureInfo& info = asset->mTextures[textureIndex];
+        if (info.texture != previous) {
+            continue;
+        }
+        info.texture = pending.texture;
+        for (const TextureSlot& slot : info.bindings) {
+            asset->applyTextureBinding(textureIndex, slot, false);
+        }
+    }
+    mEngine->destroy(previous);
+}
+
+void ResourceLoader::Impl::updateTextureResidency(FFilamentAsset* asset) {
+    SYSTRACE_CALL();
+
+    const size_t textureCount = asset->mTextures.size();
+    if (!mTextureResidency.camera || !asset->mResourcesLoaded || !asset->mSourceAsset ||
+            !textureCount) {
+        return;
+    }
+
+    // Textures of a load in progress are not updated until they're all decoded.
+    if (asset == mAsyncAsset) {
+        size_t pushedCount = 0;
+        size_t poppedCount = 0;
+        for (const auto& iter : mTextureProviders) {
+            pushedCount += iter.second->getPushedCount();
+            poppedCount += iter.second->getPoppedCount();
+        }
+        if (mRemainingTextureDownloads || poppedCount + mPendingTextures.size() < pushedCount) {
+            return;
+        }
+    }
+
+    FixedCapacityVector<uint32_t> order(textureCount);
+    FixedCapacityVector<uint32_t> maxSizes(textureCount);
+    FixedCapacityVector<uint16_t> priorities(textureCount);
+    computeTextureResidency(asset, order.data(), maxSizes.data(), priorities.data());
+
+    // A texture shared by several glTF textures gets the largest of their sizes.
+    tsl::robin_map<const Texture*, uint32_t> textureSizes;
+    for (size_t textureIndex = 0; textureIndex < textureCount; ++textureIndex) {
+        if (const Texture* texture = asset->mTextures[textureIndex].texture) {
+            uint32_t& size = textureSizes[texture];
+            size = std::max(size, maxSizes[textureIndex]);
+        }
+    }
+
+    for (size_t i = 0; i < textureCount; ++i) {
+        const size_t textureIndex = order[i];
+        FFilamentAsset::TextureInfo& info = asset->mTextures[textureIndex];
+        if (!info.isOwner || !info.texture || !info.maxSize) {
+            continue;
+        }
+        const bool isPending = std::any_of(mPendingTextures.begin(), mPendingTextures.end(),
+                [asset, textureIndex](const PendingTexture& pending) {
+                    return pending.asset == asset && pending.textureIndex == textureIndex;
+                });
+        if (isPending) {
+            continue;
+        }
+
+        // Textures grow when they appear larger than their limit, unless they're already smaller
+        // than it, in which case they don't have larger miplevels. They shrink when they appear at
+        // least 4 times smaller, so that they don't alternate between two sizes.
+        const uint32_t maxSize = textureSizes[info.texture];
+        const uint32_t size = uint32_t(std::max(info.texture->getWidth(),
+                info.texture->getHeight()));
+        const bool grow = maxSize > info.maxSize && size * 2 > info.maxSize;
+        const bool shrink = maxSize * 4 <= info.maxSize && size > maxSize;
+        if (!grow && !shrink) {
+            continue;
+        }
+
+        for (const auto& iter : mTextureProviders) {
+            iter.second->setMaxTextureSize(maxSize);
+            iter.second->setDecodingPriority(priorities[textureIndex]);
+        }
+        if (Texture* texture = getOrCreateTexture(asset, textureIndex, info.flags, false).first) {
+            mPendingTextures.push_back({ asset, textureIndex, texture, maxSize });
+        } else {
+            info.maxSize = 0; // the source is gone, don't try again
+        }
+    }
+
+    for (const auto& iter : mTextureProviders) {
+        iter.second->setMaxTextureSize(0);
+        iter.second->setDecodingPriority(0);
+    }
+
+    popTextures();
 }
 
 void ResourceLoader::Impl::createTextures(FFilamentAsset* asset, bool async) {
     mRemainingTextureDownloads = 0;
 
+    const size_t textureCount = asset->mTextures.size();
+    FixedCapacityVector<uint32_t> order(textureCount);
+    FixedCapacityVector<uint32_t> maxSizes(textureCount);
+    FixedCapacityVector<uint16_t> priorities(textureCount);
+    const bool residency = async && mTextureResidency.camera && textureCount;
+    if (residency) {
+        computeTextureResidency(asset, order.data(), maxSizes.data(), priorities.data());
+    } else {
+        std::iota(order.begin(), order.end(), 0u);
+    }
+
     // Create new texture objects if they are not cached and kick off decoding jobs.
-    for (size_t textureIndex = 0, n = asset->mTextures.size(); textureIndex < n; ++textureIndex) {
+    for (size_t i = 0; i < textureCount; ++i) {
+        const size_t textureIndex = order[i];
         FFilamentAsset::TextureInfo& info = asset->mTextures[textureIndex];
+        if (residency) {
+            for (const auto& iter : mTextureProviders) {
+                iter.second->setMaxTextureSize(maxSizes[textureIndex]);
+                iter.second->setDecodingPriority(priorities[textureIndex]);
+            }
+        }
         auto [texture, cacheResult] = getOrCreateTexture(asset, textureIndex, info.flags);
         if (texture == nullptr) {
             if (cacheResult == CacheResult::NOT_READY) {
@@ -652,6 +883,12 @@ void ResourceLoader::Impl::createTextures(FFilamentAsset* asset, bool async) {
         if (info.texture == nullptr) {
             info.texture = texture;
             info.isOwner = cacheResult == CacheResult::MISS;
+
+            // Only textures whose provider honored the limit can be decoded again at another
+            // size by updateTextureResidency().
+            const uint32_t size = uint32_t(std::max(texture->getWidth(), texture->getHeight()));
+            info.maxSize = residency && info.isOwner && size <= maxSizes[textureIndex] ?
+                    maxSizes[textureIndex] : 0;
         }
 
         // For each binding to a material instance, call setParameter(...) on the material.
@@ -660,6 +897,13 @@ void ResourceLoader::Impl::createTextures(FFilamentAsset* asset, bool async) {
         }
     }
 
+    if (residency) {
+        for (const auto& iter : mTextureProviders) {
+            iter.second->setMaxTextureSize(0);
+            iter.second->setDecodingPriority(0);
+        }
+    }
+
     // Non-threaded systems are required to use the asynchronous API.
     assert_invariant(UTILS_HAS_THREADING || async);
 
@@ -673,6 +917,96 @@ void ResourceLoader::Impl::createTextures(FFilamentAsset* asset, bool async) {
     }
 }
 
+void ResourceLoader::Impl::computeTextureResidency(FFilamentAsset* asset, uint32_t* order,
+        uint32_t* maxSizes, uint16_t* priorities) const {
+    const TextureResidency& residency = mTextureResidency;
+    const RenderableManager& rm = mEngine->getRenderableManager();
+    const TransformManager& tcm = mEngine->getTransformManager();
+    const mat4 view = residency.camera->getViewMatrix();
+    const mat4 projection = residency.camera->getProjectionMatrix();
+    const bool perspective = projection[2][3] != 0.0;
+    const float viewportHeight = float(residency.viewportHeight);
+
+    // Height in pixels of the bounding sphere of the largest renderable of each material instance.
+    tsl::robin_map<const MaterialInstance*, float> screenSizes;
+    const Entity* entities = asset->getRenderableEntities();
+    for (size_t i = 0, n = asset->getRenderableEntityCount(); i < n; ++i) {
+        const auto ri = rm.getInstance(entities[i]);
+        if (!ri) {
+            continue;
+        }
+        const auto ti = tcm.getInstance(entities[i]);
+        const mat4f worldFromModel = ti ? tcm.getWorldTransform(ti) : mat4f{};
+        const Box box = Box::transform(worldFromModel.upperLeft(), worldFromModel[3].xyz,
+                rm.getAxisAlignedBoundingBox(ri));
+        const float4 sphere = box.getBoundingSphere();
+        const float distance = -float((view * double4(sphere.xyz, 1.0)).z);
+        float pixels = viewportHeight;
+        if (!perspective) {
+            pixels *= sphere.w * float(projection[1][1]);
+        } else if (distance <= -sphere.w) {
+            pixels = 0.0f; // behind the camera
+        } else if (distance > sphere.w) {
+            pixels *= sphere.w * float(projection[1][1]) / distance;
+        }
+        pixels = std::min(pixels, viewportHeight);
+        for (size_t p = 0, c = rm.getPrimitiveCount(ri); p < c; ++p) {
+            const MaterialInstance* mi = rm.getMaterialInstanceAt(ri, p);
+            if (auto iter = screenSizes.find(mi); iter != screenSizes.end()) {
+                iter.value() = std::max(iter->second, pixels);
+            } else {
+                screenSizes[mi] = pixels;
+            }
+        }
+    }
+
+    // Each texture gets the size of its largest user, rounded up to a power of two.
+    const size_t textureCount = asset->mTextures.size();
+    FixedCapacityVector<float> textureSizes(textureCount, 0.0f);
+    for (size_t textureIndex = 0; textureIndex < textureCount; ++textureIndex) {
+        for (const TextureSlot& slot : asset->mTextures[textureIndex].bindings) {
+            if (auto iter = screenSizes.find(slot.materialInstance); iter != screenSizes.end()) {
+                textureSizes[textureIndex] = std::max(textureSizes[textureIndex], iter->second);
+            }
+        }
+        uint32_t size = std::max(residency.minTextureSize, 1u);
+        while (float(size) < textureSizes[textureIndex]) {
+            size *= 2;
+        }
+        maxSizes[textureIndex] = size;
+
+        // The size in pixels also orders the decoding of textures across assets.
+        priorities[textureIndex] = uint16_t(std::min(textureSizes[textureIndex], 65535.0f));
+    }
+
+    std::iota(order, order + textureCount, 0u);
+    std::stable_sort(order, order + textureCount, [&textureSizes](uint32_t a, uint32_t b) {
+        return textureSizes[a] > textureSizes[b];
+    });
+
+    if (!residency.budget) {
+        return;
+    }
+
+    // Halve the textures of the smallest users first, until the estimate fits in the budget.
+    auto byteCount = [](uint32_t size) { return size_t(size) * size * 4 * 4 / 3; };
+    size_t total = 0;
+    for (size_t textureIndex = 0; textureIndex < textureCount; ++textureIndex) {
+        total += byteCount(maxSizes[textureIndex]);
+    }
+    for (bool reduced = true; total > residency.budget && reduced;) {
+        reduced = false;
+        for (size_t i = textureCount; i-- > 0 && total > residency.budget;) {
+            uint32_t& size = maxSizes[order[i]];
+            if (size / 2 >= residency.minTextureSize && size > 1) {
+                total -= byteCount(size) - byteCount(size / 2);
+                size /= 2;
+                reduced = true;
+            }
+        }
+    }
+}
+
 void ResourceLoader::Impl::computeTangents(FFilamentAsset* asset) {
     SYSTRACE_CALL();
 
@@ -740,10 +1074,13 @@ void ResourceLoader::Impl::computeTangents(FFilamentAsset* asset) {
     // Kick off jobs for computing tangent frames.
     JobSystem* js = &mEngine->getJobSystem();
     JobSystem::Job* parent = js->createJob();
+    std::vector<JobSystem::Job*> tangentJobs;
+    tangentJobs.reserve(jobParams.size());
     for (Params& params : jobParams) {
         Params* pptr = &params;
-        js->run(jobs::createJob(*js, parent, [pptr] { TangentsJob::run(pptr); }));
+        tangentJobs.push_back(jobs::createJob(*js, parent, [pptr] { TangentsJob::run(pptr); }));
     }
+    js->run(tangentJobs.data(), tangentJobs.size());
     js->runAndWait(parent);
 
     // Finally, upload quaternions to the GPU from the main thread.
@@ -768,6 +1105,9 @@ ResourceLoader::Impl::~Impl() {
     for (const auto& iter : mTextureProviders) {
         iter.second->cancelDecoding();
     }
+    for (const PendingTexture& pending : mPendingTextures) {
+        mEngine->destroy(pending.texture);
+    }
 }
 
 } // namespace filament::gltfio
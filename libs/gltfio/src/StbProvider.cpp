@@ -53,6 +53,7 @@ public:
     size_t getPushedCount() const final { return mPushedCount; }
     size_t getPoppedCount() const final { return mPoppedCount; }
     size_t getDecodedCount() const final { return mDecodedCount; }
+    void setDecodingPriority(uint16_t priority) final { mDecodingPriority = priority; }
 
 private:
     enum class TextureState {
@@ -79,6 +80,7 @@ private:
     size_t mPushedCount = 0;
     size_t mPoppedCount = 0;
     size_t mDecodedCount = 0;
+    uint16_t mDecodingPriority = 0;
     vector<unique_ptr<TextureInfo> > mTextures;
     JobSystem::Job* mDecoderRootJob;
     std::string mRecentPushMessage;
@@ -140,7 +142,7 @@ Texture* StbProvider::pushTexture(const uint8_t* data, size_t byteCount,
         info->decodedTexelsBaseMipmap.store(texels ? intptr_t(texels) : DECODING_ERROR);
     });
 
-    js->runAndRetain(info->decoderJob);
+    js->runInBackgroundAndRetain(info->decoderJob, mDecodingPriority);
     return texture;
 }
 
@@ -215,9 +217,13 @@ void StbProvider::waitForCompletion() {
 }
 
 void StbProvider::cancelDecoding() {
-    // TODO: Currently, StbProvider runs jobs eagerly and JobSystem does not allow cancellation of
-    // in-flight jobs. We should consider throttling the number of simultaneous decoder jobs, which
-    // would allow for actual cancellation.
+    // Jobs that haven't started yet are skipped, we only have to wait for those that are
+    // decoding right now.
+    for (auto& info : mTextures) {
+        if (info->decoderJob) {
+            JobSystem::requestCancellation(info->decoderJob);
+        }
+    }
     waitForCompletion();
 
     // For cancelled jobs, we need to set the TextureInfo to the popped state and free the decoded
@@ -230,8 +236,9 @@ void StbProvider::cancelDecoding() {
         // decodedTexelsBaseMipmap is loaded is in the job threads, and we have waited them to
         // completion above. We also expect the TextureProvider API calls to be made only from one
         // thread.
-        if (intptr_t data = info->decodedTexelsBaseMipmap.load()) {
-            delete [] (uint8_t*) data;
+        intptr_t const data = info->decodedTexelsBaseMipmap.load();
+        if (data != DECODING_NOT_READY && data != DECODING_ERROR) {
+            stbi_image_free((void*) data);
         }
         info->state = TextureState::POPPED;
     }
@@ -27,6 +27,20 @@
 #include <cgltf.h>
 #include <meshoptimizer.h>
 
+#include <tsl/robin_map.h>
+
+#include <mutex>
+
+#if GLTFIO_USE_FILESYSTEM && !defined(WIN32)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#    define HAS_MMAP 1
+#else
+#    define HAS_MMAP 0
+#endif
+
 namespace filament::gltfio::utility {
 
 using namespace utils;
@@ -244,6 +258,22 @@ bool loadCgltfBuffers(cgltf_data const* gltf, char const* gltfPath,
     };
 #endif
 
+#if HAS_MMAP
+    // Map files rather than reading them, which spares a copy of their content and lets the
+    // GPU uploads read straight from the page cache. See releaseCgltfFile().
+    options.file.read = [](const cgltf_memory_options* memoryOpts,
+                                const cgltf_file_options* fileOpts, const char* path,
+                                cgltf_size* size, void** data) {
+        size_t byteCount = *size;
+        if (void* mapped = mapFile(path, &byteCount); mapped) {
+            *size = byteCount;
+            *data = mapped;
+            return cgltf_result_success;
+        }
+        return cgltf_default_file_read(memoryOpts, fileOpts, path, size, data);
+    };
+#endif
+
     // Read data from the file system and base64 URIs.
     cgltf_result result = cgltf_load_buffers(&options, (cgltf_data*) gltf, gltfPath);
     if (result != cgltf_result_success) {
@@ -262,4 +292,61 @@ bool loadCgltfBuffers(cgltf_data const* gltf, char const* gltfPath,
     return true;
 }
 
+// munmap() needs the size of the mapping, which cgltf does not give to its release callback.
+static std::mutex sMappedFilesLock;
+static tsl::robin_map<void*, size_t> sMappedFiles;
+
+void* mapFile(char const* path, size_t* size) {
+#if HAS_MMAP
+    int const fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    // mapping past the end of the file would fault on access, and empty mappings are invalid
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 || size_t(st.st_size) < *size) {
+        close(fd);
+        return nullptr;
+    }
+    size_t const byteCount = *size ? *size : size_t(st.st_size);
+    void* data = mmap(nullptr, byteCount, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> const lock(sMappedFilesLock);
+    sMappedFiles[data] = byteCount;
+    *size = byteCount;
+    return data;
+#else
+    return nullptr;
+#endif
+}
+
+bool unmapFile(void* data) {
+#if HAS_MMAP
+    size_t byteCount;
+    {
+        std::lock_guard<std::mutex> const lock(sMappedFilesLock);
+        auto iter = sMappedFiles.find(data);
+        if (iter == sMappedFiles.end()) {
+            return false;
+        }
+        byteCount = iter->second;
+        sMappedFiles.erase(iter);
+    }
+    munmap(data, byteCount);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void releaseCgltfFile(cgltf_memory_options const* memoryOpts, cgltf_file_options const* fileOpts,
+        void* data) {
+    if (!unmapFile(data)) {
+        cgltf_default_file_release(memoryOpts, fileOpts, data);
+    }
+}
+
 } // namespace filament::gltfio::utility
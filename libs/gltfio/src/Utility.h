@@ -30,6 +30,8 @@ struct cgltf_data;
 class DracoCache;
 
 struct cgltf_accessor;
+struct cgltf_memory_options;
+struct cgltf_file_options;
 
 namespace filament::gltfio {
 
@@ -54,6 +56,19 @@ bool requiresPacking(cgltf_accessor const* accessor);
 bool loadCgltfBuffers(cgltf_data const* gltf, char const* gltfPath,
         UriDataCacheHandle uriDataCacheHandle);
 
+// Maps `size` bytes of a file into memory, or the whole file if `size` is zero, in which case its
+// size is returned in `size`. The mapping is copy-on-write and must be released with unmapFile().
+// Returns nullptr if the file could not be mapped, or if the platform does not support it.
+void* mapFile(char const* path, size_t* size);
+
+// Returns false if `data` was not returned by mapFile().
+bool unmapFile(void* data);
+
+// The cgltf release callback that matches the buffers read by loadCgltfBuffers(), which maps
+// files rather than reading them when possible.
+void releaseCgltfFile(cgltf_memory_options const* memoryOpts, cgltf_file_options const* fileOpts,
+        void* data);
+
 } // namespace filament::gltfio::utility
 
 #endif
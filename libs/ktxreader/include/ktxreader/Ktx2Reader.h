@@ -76,6 +76,14 @@ class Ktx2Reader {
          */
         void unrequestFormat(Texture::InternalFormat format) noexcept;
 
+        /**
+         * Limits the width and height of the textures created by subsequent calls to load() and
+         * asyncCreate(), by skipping the miplevels of the KTX2 content that are larger.
+         *
+         * The smallest miplevel is always kept. Zero means no limit, which is the default.
+         */
+        void setMaxTextureSize(uint32_t size) noexcept { mMaxTextureSize = size; }
+
         /**
          * Attempts to create and load a Filament texture from the given KTX2 blob.
          *
@@ -127,7 +135,9 @@ class Ktx2Reader {
              * Loads all mipmaps from the KTX2 file and transcodes them to the resolved format.
              *
              * This does not return until all mipmaps have been transcoded. This is typically
-             * called from a background thread.
+             * called from a background thread. Mipmaps are transcoded from the smallest to the
+             * largest, so that uploadImages() can be called meanwhile to display the texture at
+             * a low resolution early.
              */
             Result doTranscoding();
 
@@ -190,11 +200,12 @@ class Ktx2Reader {
         Ktx2Reader& operator=(Ktx2Reader&& that) noexcept = delete;
 
         Texture* createTexture(basist::ktx2_transcoder* transcoder, const void* data,
-                size_t size, TransferFunction transfer);
+                size_t size, TransferFunction transfer, uint32_t* firstLevel);
 
         Engine& mEngine;
         basist::ktx2_transcoder* const mTranscoder;
         utils::FixedCapacityVector<Texture::InternalFormat> mRequestedFormats;
+        uint32_t mMaxTextureSize = 0;
         bool mQuiet;
 };
 
@@ -21,6 +21,7 @@
 
 #include <utils/Log.h>
 
+#include <algorithm>
 #include <atomic>
 #include <vector>
 
@@ -165,9 +166,10 @@ namespace ktxreader {
 
 class FAsync : public Async {
 public:
-    FAsync(Texture* texture, Engine& engine, ktx2_transcoder* transcoder, Buffer&& buf) :
+    FAsync(Texture* texture, Engine& engine, ktx2_transcoder* transcoder, Buffer&& buf,
+            uint32_t firstLevel) :
             mTexture(texture), mEngine(engine), mTranscoder(transcoder),
-            mSourceBuffer(std::move(buf)) {}
+            mSourceBuffer(std::move(buf)), mFirstLevel(firstLevel) {}
     Texture* getTexture() const noexcept { return mTexture; }
     Result doTranscoding();
     void uploadImages();
@@ -194,6 +196,9 @@ private:
 
     // Storage for the content of the KTX2 file.
     Buffer mSourceBuffer;
+
+    // Miplevel of the KTX2 file that corresponds to the base level of the texture.
+    uint32_t const mFirstLevel;
 };
 
 Ktx2Reader::Ktx2Reader(Engine& engine, bool quiet) :
@@ -231,7 +236,8 @@ void Ktx2Reader::unrequestFormat(Texture::InternalFormat format) noexcept {
 }
 
 Texture* Ktx2Reader::load(const void* data, size_t size, TransferFunction transfer) {
-    Texture* texture = createTexture(mTranscoder, data, size, transfer);
+    uint32_t firstLevel;
+    Texture* texture = createTexture(mTranscoder, data, size, transfer, &firstLevel);
     if (texture == nullptr) {
         return nullptr;
     }
@@ -247,7 +253,8 @@ Texture* Ktx2Reader::load(const void* data, size_t size, TransferFunction transf
     ktx2_transcoder_state basisThreadState;
     basisThreadState.clear();
 
-    for (uint32_t levelIndex = 0, n = mTranscoder->get_levels(); levelIndex < n; levelIndex++) {
+    for (uint32_t levelIndex = firstLevel, n = mTranscoder->get_levels(); levelIndex < n;
+            levelIndex++) {
         Texture::PixelBufferDescriptor* pbd;
         Result result = transcodeImageLevel(*mTranscoder, basisThreadState, texture->getFormat(),
                 levelIndex, &pbd);
@@ -258,7 +265,7 @@ Texture* Ktx2Reader::load(const void* data, size_t size, TransferFunction transf
             }
             return nullptr;
         }
-        texture->setImage(mEngine, levelIndex, std::move(*pbd));
+        texture->setImage(mEngine, levelIndex - firstLevel, std::move(*pbd));
     }
     return texture;
 }
@@ -275,14 +282,17 @@ FAsync::~FAsync() {
 Result FAsync::doTranscoding() {
     ktx2_transcoder_state basisThreadState;
     basisThreadState.clear();
-    for (uint32_t levelIndex = 0, n = mTranscoder->get_levels(); levelIndex < n; levelIndex++) {
+    // Go from the smallest miplevel to the largest, so that the texture can be sampled at a low
+    // resolution while the larger levels are still being transcoded. Filament restricts sampling
+    // to the levels that have been uploaded.
+    for (uint32_t levelIndex = mTranscoder->get_levels(); levelIndex-- > mFirstLevel;) {
         Texture::PixelBufferDescriptor* pbd;
         Result result = transcodeImageLevel(*mTranscoder, basisThreadState, mTexture->getFormat(),
                 levelIndex, &pbd);
         if (UTILS_UNLIKELY(result != Result::SUCCESS)) {
             return result;
         }
-        mTranscoderResults[levelIndex].store(pbd);
+        mTranscoderResults[levelIndex - mFirstLevel].store(pbd);
     }
     return Result::SUCCESS;
 }
@@ -304,7 +314,9 @@ void FAsync::uploadImages() {
 Async* Ktx2Reader::asyncCreate(const void* data, size_t size, TransferFunction transfer) {
     Buffer ktx2content((uint8_t*)data, (uint8_t*)data + size);
     ktx2_transcoder* transcoder = new ktx2_transcoder();
-    Texture* texture = createTexture(transcoder, ktx2content.data(), ktx2content.size(), transfer);
+    uint32_t firstLevel;
+    Texture* texture = createTexture(transcoder, ktx2content.data(), ktx2content.size(), transfer,
+            &firstLevel);
     if (texture == nullptr) {
         delete transcoder;
         return nullptr;
@@ -317,7 +329,7 @@ Async* Ktx2Reader::asyncCreate(const void* data, size_t size, TransferFunction t
     // There's no need to do any further work at this point but it should be noted that this is the
     // point at which we first come to know the number of miplevels, dimensions, etc. If we had a
     // dynamically sized array to store decoder results, we would reserve it here.
-    return new FAsync(texture, mEngine, transcoder, std::move(ktx2content));
+    return new FAsync(texture, mEngine, transcoder, std::move(ktx2content), firstLevel);
 }
 
 void Ktx2Reader::asyncDestroy(Async** async) {
@@ -326,7 +338,7 @@ void Ktx2Reader::asyncDestroy(Async** async) {
 }
 
 Texture* Ktx2Reader::createTexture(ktx2_transcoder* transcoder, const void* data, size_t size,
-        TransferFunction transfer) {
+        TransferFunction transfer, uint32_t* firstLevel) {
     if (!transcoder->init(data, size)) {
         if (!mQuiet) {
             utils::slog.e << "BasisU transcoder init failed." << utils::io::endl;
@@ -403,10 +415,21 @@ Texture* Ktx2Reader::createTexture(ktx2_transcoder* transcoder, const void* data
         return nullptr;
     }
 
+    // Skip the miplevels that exceed the maximum size, but always keep the smallest one.
+    uint32_t skippedLevels = 0;
+    if (mMaxTextureSize) {
+        const uint32_t size = std::max(transcoder->get_width(), transcoder->get_height());
+        while (skippedLevels + 1 < transcoder->get_levels() &&
+                (size >> skippedLevels) > mMaxTextureSize) {
+            skippedLevels++;
+        }
+    }
+    *firstLevel = skippedLevels;
+
     Texture* texture = Texture::Builder()
-        .width(transcoder->get_width())
-        .height(transcoder->get_height())
-        .levels(transcoder->get_levels())
+        .width(std::max(1u, transcoder->get_width() >> skippedLevels))
+        .height(std::max(1u, transcoder->get_height() >> skippedLevels))
+        .levels(transcoder->get_levels() - skippedLevels)
         .sampler(Texture::Sampler::SAMPLER_2D)
         .format(resolvedFormat)
         .build(mEngine);
@@ -25,6 +25,7 @@
 
 #include <sstream>
 #include <iomanip>
+#include <unordered_set>
 
 #include "CommonWriter.h"
 
@@ -405,6 +406,16 @@ static void printShaderInfo(ostream& text, const vector<ShaderInfo>& info,
         text << formatVariantString(item.variant, domain);
         text << endl;
     }
+    if (!info.empty()) {
+        // identical shaders are stored once, their entries point to the same offset
+        unordered_set<uint32_t> offsets;
+        for (const auto& item : info) {
+            offsets.insert(item.offset);
+        }
+        text << "    " << offsets.size() << " unique of " << info.size() << " shaders";
+        text << " (" << fixed << setprecision(1) << double(info.size()) / double(offsets.size());
+        text << defaultfloat << "x deduplication)" << endl;
+    }
     text << endl;
 }
 
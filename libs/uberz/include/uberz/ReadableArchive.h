@@ -17,6 +17,7 @@
 #ifndef UBERZ_READABLE_ARCHIVE_H
 #define UBERZ_READABLE_ARCHIVE_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <uberz/ArchiveEnums.h>
@@ -28,14 +29,34 @@ namespace filament::uberz {
 // ArchiveSpec is a parse-free binary format. The client simply casts a word-aligned content blob
 // into a ReadableArchive struct pointer, then calls the following function to convert all the
 // offset fields into pointers.
+// In seekable archives, package offsets are left untouched (see ReadableArchive::version).
 void convertOffsetsToPointers(struct ReadableArchive* archive);
 
+// Decompresses the first zstd frame of an archive, which holds the entire archive in version 0
+// and only the header, specs and flags in seekable archives. Offsets are converted to pointers.
+// Returns nullptr if the data is not a valid archive, otherwise the result must be freed with
+// utils::aligned_free(). If non-null, frameByteCount receives the compressed size of the frame,
+// which is where the package frames of seekable archives begin.
+struct ReadableArchive* decompressArchiveMetadata(const void* archiveData,
+        size_t archiveByteCount, size_t* frameByteCount);
+
+// Decompresses the package of a spec from a seekable archive into a buffer of at least
+// spec.packageByteCount bytes. The packages span the archive data that follows the first frame.
+// Returns false if the package could not be decompressed.
+bool decompressPackage(struct ArchiveSpec const& spec,
+        const void* packages, size_t packagesByteCount, uint8_t* package);
+
 UTILS_WARNING_PUSH
 UTILS_WARNING_ENABLE_PADDED
 
 // Precompiled set of materials bundled with a list of features flags that each material supports.
 // This is the readable counterpart to WriteableArchive.
 // Used by gltfio; users do not need to access this class directly.
+//
+// In version 0, the archive is a single zstd frame. Seekable archives (version 1) start with a
+// frame that holds everything but the packages, followed by one frame per package, so that
+// clients can decompress only the packages they need. In that case, packageOffset is the
+// byte offset of the package's frame from the end of the first frame.
 struct ReadableArchive {
     uint32_t magic;
     uint32_t version;
@@ -46,6 +67,8 @@ struct ReadableArchive {
     };
 };
 
+static constexpr uint32_t SEEKABLE_ARCHIVE_VERSION = 1;
+
 static constexpr Shading INVALID_SHADING_MODEL = (Shading) 0xff;
 static constexpr BlendingMode INVALID_BLENDING = (BlendingMode) 0xff;
 
@@ -74,6 +97,10 @@ struct ArchiveFlag {
 
 UTILS_WARNING_POP
 
+inline bool isSeekable(ReadableArchive const& archive) noexcept {
+    return archive.version >= SEEKABLE_ARCHIVE_VERSION;
+}
+
 } // namespace filament::uberz
 
 #endif // UBERZ_READABLE_ARCHIVE_H
@@ -16,7 +16,11 @@
 
 #include <uberz/ReadableArchive.h>
 
+#include <utils/compiler.h>
 #include <utils/debug.h>
+#include <utils/memalign.h>
+
+#include <zstd.h>
 
 using namespace filament;
 using namespace utils;
@@ -36,7 +40,9 @@ void convertOffsetsToPointers(ReadableArchive* archive) {
         ArchiveSpec& spec = archive->specs[i];
         assert_invariant(spec.flagsOffset % wordSize == 0);
         spec.flags = (ArchiveFlag*) (basePointer + (spec.flagsOffset / wordSize));
-        spec.package = ((uint8_t*) basePointer) + spec.packageOffset;
+        if (!isSeekable(*archive)) {
+            spec.package = ((uint8_t*) basePointer) + spec.packageOffset;
+        }
         for (uint64_t j = 0; j < spec.flagsCount; ++j) {
             ArchiveFlag& flag = spec.flags[j];
             flag.name = ((const char*) basePointer) + flag.nameOffset;
@@ -44,4 +50,41 @@ void convertOffsetsToPointers(ReadableArchive* archive) {
     }
 }
 
+ReadableArchive* decompressArchiveMetadata(const void* archiveData, size_t archiveByteCount,
+        size_t* frameByteCount) {
+    const size_t compSize = ZSTD_findFrameCompressedSize(archiveData, archiveByteCount);
+    const uint64_t decompSize = ZSTD_getFrameContentSize(archiveData, archiveByteCount);
+    if (ZSTD_isError(compSize) || decompSize == ZSTD_CONTENTSIZE_UNKNOWN ||
+            decompSize == ZSTD_CONTENTSIZE_ERROR || decompSize < sizeof(ReadableArchive)) {
+        return nullptr;
+    }
+    uint64_t* basePointer = (uint64_t*) utils::aligned_alloc(decompSize, 8);
+    const size_t result = ZSTD_decompress(basePointer, decompSize, archiveData, compSize);
+    if (ZSTD_isError(result) || result != decompSize) {
+        utils::aligned_free(basePointer);
+        return nullptr;
+    }
+    ReadableArchive* archive = (ReadableArchive*) basePointer;
+    convertOffsetsToPointers(archive);
+    if (frameByteCount) {
+        *frameByteCount = compSize;
+    }
+    return archive;
+}
+
+bool decompressPackage(ArchiveSpec const& spec, const void* packages, size_t packagesByteCount,
+        uint8_t* package) {
+    if (UTILS_UNLIKELY(spec.packageOffset >= packagesByteCount)) {
+        return false;
+    }
+    const uint8_t* frame = ((const uint8_t*) packages) + spec.packageOffset;
+    const size_t frameSize = ZSTD_findFrameCompressedSize(frame,
+            packagesByteCount - spec.packageOffset);
+    if (UTILS_UNLIKELY(ZSTD_isError(frameSize))) {
+        return false;
+    }
+    const size_t result = ZSTD_decompress(package, spec.packageByteCount, frame, frameSize);
+    return !ZSTD_isError(result) && result == spec.packageByteCount;
+}
+
 } // namespace filament::uberz
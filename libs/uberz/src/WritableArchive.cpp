@@ -226,6 +226,29 @@ void WritableArchive::addSpecLine(string_view line) {
     ++mLineNumber;
 }
 
+// Compresses the given data into a single zstd frame.
+static FixedCapacityVector<uint8_t> compress(const uint8_t* data, size_t size) {
+    FixedCapacityVector<uint8_t> compressedBuf(ZSTD_compressBound(size));
+
+    // Maximum zstd compression is slow, but that's okay since uberz is invoked during the build,
+    // not at run time.  However in debug builds it is debilitatingly slow, and we're fine with
+    // larger archives, so we use minimum compression.
+#ifdef NDEBUG
+    const int compressionLevel = ZSTD_maxCLevel();
+#else
+    const int compressionLevel = ZSTD_minCLevel();
+#endif
+
+    size_t zstdResult = ZSTD_compress(compressedBuf.data(), compressedBuf.size(), data, size,
+            compressionLevel);
+    if (ZSTD_isError(zstdResult)) {
+        PANIC_POSTCONDITION("Error during archive compression: %s", ZSTD_getErrorName(zstdResult));
+    }
+
+    compressedBuf.resize(zstdResult);
+    return compressedBuf;
+}
+
 FixedCapacityVector<uint8_t> WritableArchive::serialize() const {
     size_t byteCount = sizeof(ReadableArchive);
     for (const auto& mat : mMaterials) {
@@ -243,29 +266,34 @@ FixedCapacityVector<uint8_t> WritableArchive::serialize() const {
             byteCount += pair.first.size() + 1;
         }
     }
-    size_t filamatOffset = byteCount;
+
+    // Each package gets its own frame, so that clients can decompress them individually.
+    auto packages = FixedCapacityVector<FixedCapacityVector<uint8_t>>::with_capacity(
+            mMaterials.size());
     for (const auto& mat : mMaterials) {
-        byteCount += mat.package.size();
+        packages.push_back(compress(mat.package.data(), mat.package.size()));
     }
 
     ReadableArchive archive;
     archive.magic = 'UBER';
-    archive.version = 0;
+    archive.version = SEEKABLE_ARCHIVE_VERSION;
     archive.specsCount = mMaterials.size();
     archive.specsOffset = sizeof(ReadableArchive);
 
     auto specs = FixedCapacityVector<ArchiveSpec>::with_capacity(mMaterials.size());
     size_t flagCount = 0;
-    for (const auto& mat : mMaterials) {
+    size_t packageOffset = 0;
+    for (size_t i = 0; i < mMaterials.size(); ++i) {
+        const Material& mat = mMaterials[i];
         ArchiveSpec spec = {};
         spec.shadingModel = mat.shadingModel;
         spec.blendingMode = mat.blendingMode;
         spec.flagsCount = mat.flags.size();
         spec.flagsOffset = flaglistOffset + flagCount * sizeof(ArchiveFlag);
         spec.packageByteCount = mat.package.size();
-        spec.packageOffset = filamatOffset;
+        spec.packageOffset = packageOffset;
         specs.push_back(spec);
-        filamatOffset += mat.package.size();
+        packageOffset += packages[i].size();
         flagCount += mat.flags.size();
     }
 
@@ -291,8 +319,8 @@ FixedCapacityVector<uint8_t> WritableArchive::serialize() const {
     }
     assert(flagNamesPtr - flagNames.data() == flagNames.size());
 
-    FixedCapacityVector<uint8_t> outputBuf(byteCount);
-    uint8_t* writeCursor = outputBuf.data();
+    FixedCapacityVector<uint8_t> metadataBuf(byteCount);
+    uint8_t* writeCursor = metadataBuf.data();
     memcpy(writeCursor, &archive, sizeof(archive));
     writeCursor += sizeof(archive);
     memcpy(writeCursor, specs.data(), sizeof(ArchiveSpec) * specs.size());
@@ -301,31 +329,20 @@ FixedCapacityVector<uint8_t> WritableArchive::serialize() const {
     writeCursor += sizeof(ArchiveFlag) * flags.size();
     memcpy(writeCursor, flagNames.data(), charCount);
     writeCursor += charCount;
-    for (const auto& mat : mMaterials) {
-        memcpy(writeCursor, mat.package.data(), mat.package.size());
-        writeCursor += mat.package.size();
-    }
-    assert_invariant(writeCursor - outputBuf.data() == outputBuf.size());
+    assert_invariant(writeCursor - metadataBuf.data() == metadataBuf.size());
 
-    FixedCapacityVector<uint8_t> compressedBuf(ZSTD_compressBound(outputBuf.size()));
+    FixedCapacityVector<uint8_t> metadata = compress(metadataBuf.data(), metadataBuf.size());
 
-    // Maximum zstd compression is slow, but that's okay since uberz is invoked during the build,
-    // not at run time.  However in debug builds it is debilitatingly slow, and we're fine with
-    // larger archives, so we use minimum compression.
-#ifdef NDEBUG
-    const int compressionLevel = ZSTD_maxCLevel();
-#else
-    const int compressionLevel = ZSTD_minCLevel();
-#endif
-
-    size_t zstdResult = ZSTD_compress(compressedBuf.data(), compressedBuf.size(), outputBuf.data(),
-            outputBuf.size(), compressionLevel);
-    if (ZSTD_isError(zstdResult)) {
-        PANIC_POSTCONDITION("Error during archive compression: %s", ZSTD_getErrorName(zstdResult));
+    FixedCapacityVector<uint8_t> outputBuf(metadata.size() + packageOffset);
+    writeCursor = outputBuf.data();
+    memcpy(writeCursor, metadata.data(), metadata.size());
+    writeCursor += metadata.size();
+    for (const auto& package : packages) {
+        memcpy(writeCursor, package.data(), package.size());
+        writeCursor += package.size();
     }
-
-    compressedBuf.resize(zstdResult);
-    return compressedBuf;
+    assert_invariant(writeCursor - outputBuf.data() == outputBuf.size());
+    return outputBuf;
 }
 
 void WritableArchive::setShadingModel(Shading sm) {
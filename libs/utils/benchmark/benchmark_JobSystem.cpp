@@ -21,6 +21,8 @@
 
 #include <benchmark/benchmark.h>
 
+#include <vector>
+
 using namespace utils;
 
 
@@ -61,6 +63,49 @@ static void BM_JobSystemAsChildren4k(benchmark::State& state) {
     js.emancipate();
 }
 
+static void BM_JobSystemAsChildren4kBatched(benchmark::State& state) {
+    JobSystem js;
+    js.adopt();
+
+    std::vector<JobSystem::Job*> children(4095);
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            auto root = js.create(nullptr, &emptyJob);
+            for (auto& job : children) {
+                job = js.create(root, &emptyJob);
+            }
+            js.run(children.data(), children.size());
+            js.runAndWait(root);
+        }
+    }
+    state.SetItemsProcessed((int64_t)state.iterations() * 4096);
+
+    js.emancipate();
+}
+
+static void BM_JobSystemAsChildren32kBatched(benchmark::State& state) {
+    JobSystem js;
+    js.adopt();
+
+    // this doesn't fit in a single chunk of the job pool
+    std::vector<JobSystem::Job*> children(32767);
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            auto root = js.create(nullptr, &emptyJob);
+            for (auto& job : children) {
+                job = js.create(root, &emptyJob);
+            }
+            js.run(children.data(), children.size());
+            js.runAndWait(root);
+        }
+    }
+    state.SetItemsProcessed((int64_t)state.iterations() * 32768);
+
+    js.emancipate();
+}
+
 static void BM_JobSystemParallelFor(benchmark::State& state) {
     JobSystem js;
     js.adopt();
@@ -81,4 +126,6 @@ static void BM_JobSystemParallelFor(benchmark::State& state) {
 
 BENCHMARK(BM_JobSystem);
 BENCHMARK(BM_JobSystemAsChildren4k);
+BENCHMARK(BM_JobSystemAsChildren4kBatched);
+BENCHMARK(BM_JobSystemAsChildren32kBatched);
 BENCHMARK(BM_JobSystemParallelFor);
@@ -142,6 +142,44 @@ private:
     uint32_t mCur = 0;
 };
 
+/* ------------------------------------------------------------------------------------------------
+ * HeapAllocationTrap
+ *
+ * Reports the heap allocations made by the calling thread while a HeapAllocationTrap::Scope is
+ * alive, along with their call stack. This is used to find what reaches the heap in code that
+ * shouldn't, e.g. steady-state frames.
+ *
+ * + HeapAllocator and HeapArea report their allocations in debug builds
+ * + debug builds configured with FILAMENT_TRAP_HEAP_ALLOCATIONS replace the global operator new,
+ *   so that all C++ heap allocations are reported
+ * + other allocators (e.g. an application's own operator new) can call onHeapAllocation()
+ * ------------------------------------------------------------------------------------------------
+ */
+class HeapAllocationTrap {
+public:
+    class Scope {
+    public:
+        // `name` identifies the scope in reports and must outlive it
+        explicit Scope(const char* name) noexcept;
+        ~Scope() noexcept;
+
+        Scope(Scope const& rhs) = delete;
+        Scope& operator=(Scope const& rhs) = delete;
+
+        // number of heap allocations made so far in this scope (including nested scopes)
+        size_t getCount() const noexcept { return mCount; }
+
+    private:
+        friend class HeapAllocationTrap;
+        const char* mName;
+        Scope* mParent;
+        size_t mCount = 0;
+    };
+
+    // Reports a heap allocation of `size` bytes if the calling thread is in a Scope.
+    static void onHeapAllocation(size_t size) noexcept;
+};
+
 /* ------------------------------------------------------------------------------------------------
  * HeapAllocator
  *
@@ -158,6 +196,9 @@ public:
 
     // our allocator concept
     void* alloc(size_t size, size_t alignment = alignof(std::max_align_t)) {
+#ifndef NDEBUG
+        HeapAllocationTrap::onHeapAllocation(size);
+#endif
         return aligned_alloc(size, alignment);
     }
 
@@ -216,6 +257,11 @@ public:
     bool isHeapAllocation(void* p) const noexcept {
         return p < LinearAllocator::base() || p >= LinearAllocator::end();
     }
+
+    // space left before allocations fall back to the heap
+    size_t available() const noexcept {
+        return LinearAllocator::available();
+    }
 };
 
 // ------------------------------------------------------------------------------------------------
@@ -530,6 +576,9 @@ public:
     explicit HeapArea(size_t size) {
         if (size) {
             // TODO: policy committing memory
+#ifndef NDEBUG
+            HeapAllocationTrap::onHeapAllocation(size);
+#endif
             mBegin = malloc(size);
             mEnd = pointermath::add(mBegin, size);
         }
@@ -44,11 +44,17 @@
 namespace utils {
 
 class JobSystem {
-    static constexpr size_t MAX_JOB_COUNT = 1 << 14; // 16384
-    static constexpr uint32_t JOB_COUNT_MASK = MAX_JOB_COUNT - 1;
+    // Jobs are stored in chunks allocated as needed, and referenced by a 16-bits index.
+    static constexpr size_t JOB_CHUNK_SIZE = 1 << 14; // 16384
+    static constexpr size_t MAX_JOB_CHUNK_COUNT = 4;
+    static constexpr size_t MAX_JOB_COUNT = JOB_CHUNK_SIZE * MAX_JOB_CHUNK_COUNT - 1; // 65535
+    static constexpr uint16_t NO_PARENT = uint16_t(MAX_JOB_COUNT); // not a valid job index
     static constexpr uint32_t WAITER_COUNT_SHIFT = 24;
-    static_assert(MAX_JOB_COUNT <= 0x7FFE, "MAX_JOB_COUNT must be <= 0x7FFE");
-    using WorkQueue = WorkStealingDequeue<uint16_t, MAX_JOB_COUNT>;
+    static constexpr uint32_t CANCELLED_BIT = 1u << (WAITER_COUNT_SHIFT - 1);
+    static constexpr uint32_t JOB_COUNT_MASK = CANCELLED_BIT - 1;
+    static_assert(MAX_JOB_COUNT <= 0xFFFF, "MAX_JOB_COUNT must be <= 0xFFFF");
+    static_assert(MAX_JOB_COUNT <= JOB_COUNT_MASK);
+    using WorkQueue = WorkStealingDequeue<uint16_t, MAX_JOB_COUNT + 1>;
     using Mutex = utils::Mutex;
     using Condition = utils::Condition;
 
@@ -108,10 +114,14 @@ public:
     void emancipate();
 
 
-    // If a parent is not specified when creating a job, that job will automatically take the
-    // root job as a parent.
+    // If a parent is not specified when creating a job on the thread that set the root job,
+    // that job will automatically take the root job as a parent. Jobs created without a parent
+    // on other threads (e.g. in background jobs) don't have a parent.
     // The root job is reset when waited on.
-    Job* setRootJob(Job* job) noexcept { return mRootJob = job; }
+    Job* setRootJob(Job* job) noexcept {
+        mRootJobThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        return mRootJob = job;
+    }
 
      // use setRootJob() instead
     UTILS_DEPRECATED
@@ -190,7 +200,9 @@ public:
     Job* createJob(Job* parent, T* data) noexcept {
         Job* job = create(parent, +[](void* storage, JobSystem& js, Job* job) {
             T* const that = static_cast<T*>(reinterpret_cast<void**>(storage)[0]);
-            (that->*method)(js, job);
+            if (UTILS_LIKELY(!isCancelled(job))) {
+                (that->*method)(js, job);
+            }
         });
         if (job) {
             job->storage[0] = data;
@@ -204,7 +216,9 @@ public:
         static_assert(sizeof(data) <= sizeof(Job::storage), "user data too large");
         Job* job = create(parent, [](void* storage, JobSystem& js, Job* job) {
             T* const that = static_cast<T*>(storage);
-            (that->*method)(js, job);
+            if (UTILS_LIKELY(!isCancelled(job))) {
+                (that->*method)(js, job);
+            }
             that->~T();
         });
         if (job) {
@@ -219,7 +233,9 @@ public:
         static_assert(sizeof(T) <= sizeof(Job::storage), "user data too large");
         Job* job = create(parent, [](void* storage, JobSystem& js, Job* job) {
             T* const that = static_cast<T*>(storage);
-            (that->*method)(js, job);
+            if (UTILS_LIKELY(!isCancelled(job))) {
+                (that->*method)(js, job);
+            }
             that->~T();
         });
         if (job) {
@@ -234,7 +250,9 @@ public:
         static_assert(sizeof(functor) <= sizeof(Job::storage), "functor too large");
         Job* job = create(parent, [](void* storage, JobSystem& js, Job* job){
             T* const that = static_cast<T*>(storage);
-            that->operator()(js, job);
+            if (UTILS_LIKELY(!isCancelled(job))) {
+                that->operator()(js, job);
+            }
             that->~T();
         });
         if (job) {
@@ -249,7 +267,9 @@ public:
         static_assert(sizeof(T) <= sizeof(Job::storage), "functor too large");
         Job* job = create(parent, [](void* storage, JobSystem& js, Job* job){
             T* const that = static_cast<T*>(storage);
-            that->operator()(js, job);
+            if (UTILS_LIKELY(!isCancelled(job))) {
+                that->operator()(js, job);
+            }
             that->~T();
         });
         if (job) {
@@ -266,6 +286,31 @@ public:
      */
     void cancel(Job*& job) noexcept;
 
+    /*
+     * Requests the cancellation of a job, this can be called from any thread as long as a
+     * reference to the job is held (e.g. with runAndRetain()).
+     *
+     * If the job hasn't started yet, its function won't be called, but the job still completes
+     * normally: it must be waited on or released as usual, and its parent is notified. A job that
+     * is already running is not interrupted, but it can poll isCancelled() to return early.
+     * Children of the job are not affected.
+     *
+     * Jobs created with create() directly must check isCancelled() themselves.
+     */
+    static void requestCancellation(Job* job) noexcept {
+        job->runningJobCount.fetch_or(CANCELLED_BIT, std::memory_order_relaxed);
+    }
+
+    // Returns whether requestCancellation() was called on this job.
+    static bool isCancelled(Job const* job) noexcept {
+        return job->runningJobCount.load(std::memory_order_relaxed) & CANCELLED_BIT;
+    }
+
+    // Returns whether a retained job and all its children have completed.
+    static bool hasJobCompleted(Job const* job) noexcept {
+        return (job->runningJobCount.load(std::memory_order_acquire) & JOB_COUNT_MASK) == 0;
+    }
+
     /*
      * Adds a reference to a Job.
      *
@@ -299,6 +344,17 @@ public:
         run(p);
     }
 
+    /*
+     * Add `count` jobs to this thread's execution queue. This is equivalent to calling run()
+     * on each job, but all the jobs are published with a single store to the queue, and
+     * sleeping threads are woken up once.
+     * Their references will drop automatically.
+     * The current thread must be owned by JobSystem's thread pool. See adopt().
+     *
+     * The jobs can't be used after this call.
+     */
+    void run(Job* const* jobs, size_t count) noexcept;
+
     /*
      * Add job to this thread's execution queue. Its reference will drop automatically.
      * The current thread must be owned by JobSystem's thread pool. See adopt().
@@ -343,6 +399,32 @@ public:
         runAndWait(p);
     }
 
+    /*
+     * Add job to the background queue. Its reference will drop automatically.
+     *
+     * Background jobs are meant for long-running work that must not compete with the frame
+     * (e.g. decoding textures). They only run on the thread pool, when it has nothing else to do,
+     * highest priority first and in submission order for equal priorities. Threads waiting on a
+     * job never pick them up, so they can't delay the job being waited on. At most half of the
+     * pool's threads (at least one) run background jobs at once, at a lower priority, so that
+     * the rest of the pool stays available for the next frame.
+     * Unlike run(), this can be called from any thread.
+     *
+     * The job can't be used after this call.
+     */
+    void runInBackground(Job*& job, uint16_t priority = 0) noexcept;
+    void runInBackground(Job*&& job, uint16_t priority = 0) noexcept {
+        Job* p = job;
+        runInBackground(p, priority);
+    }
+
+    /*
+     * Add job to the background queue and keep a reference to it. See runInBackground().
+     *
+     * This job MUST BE waited on with waitAndRelease(), or released with release().
+     */
+    Job* runInBackgroundAndRetain(Job* job, uint16_t priority = 0) noexcept;
+
     // for debugging
     friend utils::io::ostream& operator << (utils::io::ostream& out, JobSystem const& js);
 
@@ -419,34 +501,65 @@ private:
     void decRef(Job const* job) noexcept;
 
     Job* allocateJob() noexcept;
+    void freeJob(Job const* job) noexcept;
+    Job* growJobPool() noexcept;
+    size_t getJobIndex(Job const* job) const noexcept;
+    Job* getRootJob() const noexcept;
+    Job* getJob(size_t index) const noexcept;
     JobSystem::ThreadState* getStateToStealFrom(JobSystem::ThreadState& state) noexcept;
-    static bool hasJobCompleted(Job const* job) noexcept;
 
     void requestExit() noexcept;
     bool exitRequested() const noexcept;
     bool hasActiveJobs() const noexcept;
 
     void loop(ThreadState* state) noexcept;
-    bool execute(JobSystem::ThreadState& state) noexcept;
+    bool execute(JobSystem::ThreadState& state, bool background) noexcept;
     Job* steal(JobSystem::ThreadState& state) noexcept;
     void finish(Job* job) noexcept;
 
     void put(WorkQueue& workQueue, Job* job) noexcept;
+    void put(WorkQueue& workQueue, Job* const* jobs, size_t count) noexcept;
     Job* pop(WorkQueue& workQueue) noexcept;
     Job* steal(WorkQueue& workQueue) noexcept;
+    Job* popBackground() noexcept;
+    bool hasBackgroundJobs() const noexcept;
 
     [[nodiscard]]
     uint32_t wait(std::unique_lock<Mutex>& lock, Job* job) noexcept;
     void wait(std::unique_lock<Mutex>& lock) noexcept;
     void wakeAll() noexcept;
     void wakeOne() noexcept;
+    void wake(size_t count) noexcept;
 
     // these have thread contention, keep them together
     Mutex mWaiterLock;
     Condition mWaiterCondition;
 
     std::atomic<int32_t> mActiveJobs = { 0 };
-    utils::Arena<utils::ObjectPoolAllocator<Job>, LockingPolicy::Mutex> mJobPool;
+
+    // Free jobs are linked through their storage, the pool grows one chunk at a time.
+    Mutex mJobPoolLock;
+    Job* mFreeJobs = nullptr;
+    std::atomic<Job*> mJobChunks[MAX_JOB_CHUNK_COUNT] = {};
+
+    // Background jobs are kept in a heap, highest priority first. This is rarely accessed
+    // compared to the work queues, so a lock is fine.
+    struct BackgroundJob {
+        uint16_t priority;
+        uint16_t index;
+        uint32_t sequence;  // submission order, for equal priorities
+        // the heap keeps the largest element first: the highest priority, then the oldest
+        bool operator<(BackgroundJob const& rhs) const noexcept {
+            return priority != rhs.priority ? priority < rhs.priority
+                                            : int32_t(sequence - rhs.sequence) > 0;
+        }
+    };
+    Mutex mBackgroundLock;
+    std::vector<BackgroundJob> mBackgroundJobs;
+    uint32_t mBackgroundSequence = 0;
+    std::atomic<int32_t> mBackgroundJobCount = { 0 };
+    std::atomic<uint16_t> mRunningBackgroundJobs = { 0 };
+    uint16_t mMaxRunningBackgroundJobs = 1;             // never changes after construction
 
     template <typename T>
     using aligned_vector = std::vector<T, utils::STLAlignedAllocator<T>>;
@@ -461,10 +574,10 @@ private:
     aligned_vector<ThreadState> mThreadStates;          // actual data is stored offline
     std::atomic<bool> mExitRequested = { false };       // this one is almost never written
     std::atomic<uint16_t> mAdoptedThreads = { 0 };      // this one is almost never written
-    Job* const mJobStorageBase;                         // Base for conversion to indices
     uint16_t mThreadCount = 0;                          // total # of threads in the pool
     uint8_t mParallelSplitCount = 0;                    // # of split allowable in parallel_for
-    Job* mRootJob = nullptr;
+    Job* mRootJob = nullptr;                            // only used by mRootJobThread
+    std::atomic<std::thread::id> mRootJobThread{};      // the thread that set mRootJob
 
     Mutex mThreadMapLock; // this should have very little contention
     tsl::robin_map<std::thread::id, ThreadState *> mThreadMap;
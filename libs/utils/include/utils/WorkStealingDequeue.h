@@ -68,6 +68,8 @@ public:
     using value_type = TYPE;
 
     inline void push(TYPE item) noexcept;
+    template<typename F>
+    inline void push(size_t count, F&& itemAt) noexcept;
     inline TYPE pop() noexcept;
     inline TYPE steal() noexcept;
 
@@ -100,6 +102,24 @@ void WorkStealingDequeue<TYPE, COUNT>::push(TYPE item) noexcept {
     mBottom.store(bottom + 1, std::memory_order_seq_cst);
 }
 
+/*
+ * Adds `count` items at the BOTTOM of the queue, they're published all at once.
+ * Item `i` is `itemAt(i)`, which lets the caller convert its items without a temporary array.
+ *
+ * Must be called from the main thread.
+ */
+template <typename TYPE, size_t COUNT>
+template <typename F>
+void WorkStealingDequeue<TYPE, COUNT>::push(size_t count, F&& itemAt) noexcept {
+    assert(getCount() + count <= COUNT);
+    // see push() above for the memory orders
+    index_t bottom = mBottom.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; i++) {
+        setItemAt(bottom + index_t(i), itemAt(i));
+    }
+    mBottom.store(bottom + index_t(count), std::memory_order_seq_cst);
+}
+
 /*
  * Removes an item from the BOTTOM of the queue.
  *
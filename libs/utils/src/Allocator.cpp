@@ -16,11 +16,15 @@
 
 #include <utils/Allocator.h>
 
+#include <utils/CallStack.h>
 #include <utils/compiler.h>
 #include <utils/debug.h>
 #include <utils/Log.h>
+#include <utils/memalign.h>
+#include <utils/ostream.h>
 
 #include <algorithm>
+#include <new>
 
 #include <stdlib.h>
 #include <assert.h>
@@ -55,6 +59,40 @@ void LinearAllocator::swap(LinearAllocator& rhs) noexcept {
 }
 
 
+// ------------------------------------------------------------------------------------------------
+// HeapAllocationTrap
+// ------------------------------------------------------------------------------------------------
+
+// innermost scope of the calling thread
+static thread_local HeapAllocationTrap::Scope* sHeapAllocationTrapScope = nullptr;
+
+// set while reporting, which can itself allocate
+static thread_local bool sHeapAllocationTrapReporting = false;
+
+HeapAllocationTrap::Scope::Scope(const char* name) noexcept
+        : mName(name), mParent(sHeapAllocationTrapScope) {
+    sHeapAllocationTrapScope = this;
+}
+
+HeapAllocationTrap::Scope::~Scope() noexcept {
+    assert_invariant(sHeapAllocationTrapScope == this);
+    sHeapAllocationTrapScope = mParent;
+}
+
+void HeapAllocationTrap::onHeapAllocation(size_t size) noexcept {
+    Scope* const scope = sHeapAllocationTrapScope;
+    if (UTILS_LIKELY(!scope || sHeapAllocationTrapReporting)) {
+        return;
+    }
+    for (Scope* s = scope; s; s = s->mParent) {
+        s->mCount++;
+    }
+    sHeapAllocationTrapReporting = true;
+    slog.w << "heap allocation of " << size << " bytes in " << scope->mName << io::endl
+           << CallStack::unwind(1) << io::endl;
+    sHeapAllocationTrapReporting = false;
+}
+
 // ------------------------------------------------------------------------------------------------
 // LinearAllocatorWithFallback
 // ------------------------------------------------------------------------------------------------
@@ -224,3 +262,87 @@ void TrackingPolicy::Debug::onRewind(void* addr) noexcept {
 }
 
 } // namespace utils
+
+// ------------------------------------------------------------------------------------------------
+// Global operator new
+// ------------------------------------------------------------------------------------------------
+
+#if defined(UTILS_TRAP_HEAP_ALLOCATIONS) && !defined(NDEBUG)
+
+// In debug builds configured with FILAMENT_TRAP_HEAP_ALLOCATIONS, every C++ heap allocation (e.g.
+// std::vector, std::function, std::string) is reported to HeapAllocationTrap. malloc() itself
+// can't be replaced portably, HeapAllocator and HeapArea report their own allocations.
+
+static void* trappedAlloc(size_t size, size_t alignment) noexcept {
+    utils::HeapAllocationTrap::onHeapAllocation(size);
+    size = size ? size : 1;
+    void* const p = alignment > alignof(std::max_align_t) ?
+            utils::aligned_alloc(size, alignment) : ::malloc(size);
+    if (UTILS_UNLIKELY(!p)) {
+        // we can't throw std::bad_alloc, since exceptions are disabled
+        abort();
+    }
+    return p;
+}
+
+void* operator new(size_t size) {
+    return trappedAlloc(size, 0);
+}
+
+void* operator new[](size_t size) {
+    return trappedAlloc(size, 0);
+}
+
+void* operator new(size_t size, std::nothrow_t const&) noexcept {
+    return trappedAlloc(size, 0);
+}
+
+void* operator new[](size_t size, std::nothrow_t const&) noexcept {
+    return trappedAlloc(size, 0);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return trappedAlloc(size, size_t(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return trappedAlloc(size, size_t(alignment));
+}
+
+void operator delete(void* p) noexcept {
+    ::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    ::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    ::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    ::free(p);
+}
+
+void operator delete(void* p, std::align_val_t alignment) noexcept {
+    if (size_t(alignment) > alignof(std::max_align_t)) {
+        utils::aligned_free(p);
+    } else {
+        ::free(p);
+    }
+}
+
+void operator delete[](void* p, std::align_val_t alignment) noexcept {
+    operator delete(p, alignment);
+}
+
+void operator delete(void* p, size_t, std::align_val_t alignment) noexcept {
+    operator delete(p, alignment);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t alignment) noexcept {
+    operator delete(p, alignment);
+}
+
+#endif // UTILS_TRAP_HEAP_ALLOCATIONS && !NDEBUG
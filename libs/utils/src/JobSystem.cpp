@@ -28,6 +28,7 @@
 #include <utils/compiler.h>
 #include <utils/debug.h>
 #include <utils/Log.h>
+#include <utils/memalign.h>
 #include <utils/ostream.h>
 #include <utils/Panic.h>
 #include <utils/Systrace.h>
@@ -40,6 +41,7 @@
 #include <condition_variable>
 #include <iterator>
 #include <mutex>
+#include <new>
 #include <random>
 #include <thread>
 
@@ -171,11 +173,12 @@ void JobSystem::setThreadAffinityById(size_t id) noexcept {
 }
 
 JobSystem::JobSystem(const size_t userThreadCount, const size_t adoptableThreadsCount) noexcept
-    : mJobPool("JobSystem Job pool", MAX_JOB_COUNT * sizeof(Job)),
-      mJobStorageBase(static_cast<Job *>(mJobPool.getAllocator().getCurrent()))
 {
     SYSTRACE_ENABLE();
 
+    // the first chunk of jobs is always needed
+    growJobPool();
+
     unsigned int threadPoolCount = userThreadCount;
     if (threadPoolCount == 0) {
         // default value, system dependant
@@ -196,6 +199,8 @@ JobSystem::JobSystem(const size_t userThreadCount, const size_t adoptableThreads
 
     mThreadStates = aligned_vector<ThreadState>(threadPoolCount + adoptableThreadsCount);
     mThreadCount = uint16_t(threadPoolCount);
+    // leave at least half of the pool to the frame, whatever the number of background jobs
+    mMaxRunningBackgroundJobs = uint16_t(std::max(1u, threadPoolCount / 2));
     mParallelSplitCount = (uint8_t)std::ceil((std::log2f(threadPoolCount + adoptableThreadsCount)));
 
     static_assert(std::atomic<bool>::is_always_lock_free);
@@ -227,6 +232,10 @@ JobSystem::~JobSystem() {
             state.thread.join();
         }
     }
+
+    for (auto& chunk : mJobChunks) {
+        aligned_free(chunk.load(std::memory_order_relaxed));
+    }
 }
 
 inline void JobSystem::incRef(Job const* job) noexcept {
@@ -250,7 +259,7 @@ void JobSystem::decRef(Job const* job) noexcept {
     assert(c > 0);
     if (c == 1) {
         // This was the last reference, it's safe to destroy the job.
-        mJobPool.destroy(job);
+        freeJob(job);
     }
 }
 
@@ -269,8 +278,11 @@ inline bool JobSystem::hasActiveJobs() const noexcept {
     return mActiveJobs.load(std::memory_order_relaxed) > 0;
 }
 
-inline bool JobSystem::hasJobCompleted(JobSystem::Job const* job) noexcept {
-    return (job->runningJobCount.load(std::memory_order_acquire) & JOB_COUNT_MASK) == 0;
+inline bool JobSystem::hasBackgroundJobs() const noexcept {
+    // background jobs that can't start because too many are running don't count, so that the
+    // threads that can't pick them up go to sleep.
+    return mBackgroundJobCount.load(std::memory_order_relaxed) > 0 &&
+            mRunningBackgroundJobs.load(std::memory_order_relaxed) < mMaxRunningBackgroundJobs;
 }
 
 inline void JobSystem::wait(std::unique_lock<Mutex>& lock) noexcept {
@@ -324,6 +336,20 @@ void JobSystem::wakeOne() noexcept {
     mWaiterCondition.notify_one();
 }
 
+void JobSystem::wake(size_t count) noexcept {
+    // wake() is called when several jobs are added to a queue at once
+    HEAVY_SYSTRACE_CALL();
+    if (count == 1) {
+        wakeOne();
+        return;
+    }
+    mWaiterLock.lock();
+    // see wakeOne()
+    mWaiterLock.unlock();
+    // there is enough work for all threads
+    mWaiterCondition.notify_all();
+}
+
 inline JobSystem::ThreadState& JobSystem::getState() noexcept {
     std::lock_guard<Mutex> const lock(mThreadMapLock);
     auto iter = mThreadMap.find(std::this_thread::get_id());
@@ -332,13 +358,82 @@ inline JobSystem::ThreadState& JobSystem::getState() noexcept {
 }
 
 JobSystem::Job* JobSystem::allocateJob() noexcept {
-    return mJobPool.make<Job>();
+    std::lock_guard<Mutex> const lock(mJobPoolLock);
+    Job* job = mFreeJobs;
+    if (UTILS_UNLIKELY(!job)) {
+        job = growJobPool();
+        if (UTILS_UNLIKELY(!job)) {
+            return nullptr;
+        }
+    }
+    mFreeJobs = *reinterpret_cast<Job**>(job->storage);
+    return new(job) Job();
+}
+
+void JobSystem::freeJob(Job const* job) noexcept {
+    Job* const p = const_cast<Job*>(job);
+    p->~Job();
+    std::lock_guard<Mutex> const lock(mJobPoolLock);
+    *reinterpret_cast<Job**>(p->storage) = mFreeJobs;
+    mFreeJobs = p;
+}
+
+UTILS_NOINLINE
+JobSystem::Job* JobSystem::growJobPool() noexcept {
+    // this is called with mJobPoolLock held, or from the constructor
+    SYSTRACE_CALL();
+    size_t i = 0;
+    while (i < MAX_JOB_CHUNK_COUNT && mJobChunks[i].load(std::memory_order_relaxed)) {
+        i++;
+    }
+    if (UTILS_UNLIKELY(i == MAX_JOB_CHUNK_COUNT)) {
+        return nullptr;
+    }
+
+    Job* const chunk = static_cast<Job*>(aligned_alloc(JOB_CHUNK_SIZE * sizeof(Job), alignof(Job)));
+    if (UTILS_UNLIKELY(!chunk)) {
+        return nullptr;
+    }
+
+    // the last index is reserved for NO_PARENT
+    size_t const count = std::min(JOB_CHUNK_SIZE, MAX_JOB_COUNT - i * JOB_CHUNK_SIZE);
+    for (size_t j = 0; j < count; j++) {
+        *reinterpret_cast<Job**>(chunk[j].storage) = (j + 1 < count) ? &chunk[j + 1] : mFreeJobs;
+    }
+    mFreeJobs = chunk;
+
+    // Jobs are always handed to other threads through a WorkQueue or a parent job, which
+    // guarantees they see the chunk.
+    mJobChunks[i].store(chunk, std::memory_order_relaxed);
+    return chunk;
+}
+
+size_t JobSystem::getJobIndex(Job const* job) const noexcept {
+    for (size_t i = 0; i < MAX_JOB_CHUNK_COUNT; i++) {
+        uintptr_t const base = uintptr_t(mJobChunks[i].load(std::memory_order_relaxed));
+        if (UTILS_UNLIKELY(!base)) {
+            // chunks are allocated in order
+            break;
+        }
+        size_t const offset = (uintptr_t(job) - base) / sizeof(Job);
+        if (offset < JOB_CHUNK_SIZE) {
+            return i * JOB_CHUNK_SIZE + offset;
+        }
+    }
+    assert_invariant(false);
+    return NO_PARENT;
+}
+
+inline JobSystem::Job* JobSystem::getJob(size_t index) const noexcept {
+    assert_invariant(index < MAX_JOB_COUNT);
+    return mJobChunks[index / JOB_CHUNK_SIZE].load(std::memory_order_relaxed) +
+           index % JOB_CHUNK_SIZE;
 }
 
 void JobSystem::put(WorkQueue& workQueue, Job* job) noexcept {
     assert(job);
-    size_t const index = job - mJobStorageBase;
-    assert(index >= 0 && index < MAX_JOB_COUNT);
+    size_t const index = getJobIndex(job);
+    assert(index < MAX_JOB_COUNT);
 
     // put the job into the queue
     workQueue.push(uint16_t(index + 1));
@@ -354,10 +449,25 @@ void JobSystem::put(WorkQueue& workQueue, Job* job) noexcept {
     wakeOne();
 }
 
+void JobSystem::put(WorkQueue& workQueue, Job* const* jobs, size_t count) noexcept {
+    // put all the jobs into the queue, they're published with a single store
+    workQueue.push(count, [this, jobs](size_t i) {
+        assert(jobs[i]);
+        size_t const index = getJobIndex(jobs[i]);
+        assert(index < MAX_JOB_COUNT);
+        return uint16_t(index + 1);
+    });
+
+    // see put() above
+    mActiveJobs.fetch_add(int32_t(count), std::memory_order_relaxed);
+
+    wake(count);
+}
+
 JobSystem::Job* JobSystem::pop(WorkQueue& workQueue) noexcept {
     size_t const index = workQueue.pop();
     assert(index <= MAX_JOB_COUNT);
-    Job* const job = !index ? nullptr : &mJobStorageBase[index - 1];
+    Job* const job = !index ? nullptr : getJob(index - 1);
     if (UTILS_LIKELY(job)) {
         mActiveJobs.fetch_sub(1, std::memory_order_relaxed);
     }
@@ -367,13 +477,32 @@ JobSystem::Job* JobSystem::pop(WorkQueue& workQueue) noexcept {
 JobSystem::Job* JobSystem::steal(WorkQueue& workQueue) noexcept {
     size_t const index = workQueue.steal();
     assert_invariant(index <= MAX_JOB_COUNT);
-    Job* const job = !index ? nullptr : &mJobStorageBase[index - 1];
+    Job* const job = !index ? nullptr : getJob(index - 1);
     if (UTILS_LIKELY(job)) {
         mActiveJobs.fetch_sub(1, std::memory_order_relaxed);
     }
     return job;
 }
 
+JobSystem::Job* JobSystem::popBackground() noexcept {
+    if (!hasBackgroundJobs()) {
+        return nullptr;
+    }
+    std::lock_guard<Mutex> const lock(mBackgroundLock);
+    // mRunningBackgroundJobs is only incremented with the lock held, so it can't go over the
+    // limit even though it's decremented without it.
+    if (mBackgroundJobs.empty() ||
+            mRunningBackgroundJobs.load(std::memory_order_relaxed) >= mMaxRunningBackgroundJobs) {
+        return nullptr;
+    }
+    std::pop_heap(mBackgroundJobs.begin(), mBackgroundJobs.end());
+    size_t const index = mBackgroundJobs.back().index;
+    mBackgroundJobs.pop_back();
+    mBackgroundJobCount.fetch_sub(1, std::memory_order_relaxed);
+    mRunningBackgroundJobs.fetch_add(1, std::memory_order_relaxed);
+    return getJob(index);
+}
+
 inline JobSystem::ThreadState* JobSystem::getStateToStealFrom(JobSystem::ThreadState& state) noexcept {
     auto& threadStates = mThreadStates;
     // memory_order_relaxed is okay because we don't take any action that has data dependency
@@ -410,7 +539,7 @@ JobSystem::Job* JobSystem::steal(JobSystem::ThreadState& state) noexcept {
     return job;
 }
 
-bool JobSystem::execute(JobSystem::ThreadState& state) noexcept {
+bool JobSystem::execute(JobSystem::ThreadState& state, bool background) noexcept {
     HEAVY_SYSTRACE_CALL();
 
     Job* job = pop(state.workQueue);
@@ -424,8 +553,19 @@ bool JobSystem::execute(JobSystem::ThreadState& state) noexcept {
         job = steal(state);
     }
 
+    bool isBackgroundJob = false;
+    if (UTILS_UNLIKELY(!job && background)) {
+        // there is nothing else to do, pick-up a background job
+        job = popBackground();
+        isBackgroundJob = job != nullptr;
+    }
+
     if (UTILS_LIKELY(job)) {
         assert((job->runningJobCount.load(std::memory_order_relaxed) & JOB_COUNT_MASK) >= 1);
+        if (UTILS_UNLIKELY(isBackgroundJob)) {
+            // don't compete with the threads doing frame work
+            setThreadPriority(Priority::NORMAL);
+        }
         if (UTILS_LIKELY(job->function)) {
             HEAVY_SYSTRACE_NAME("job->function");
             job->id = std::distance(mThreadStates.data(), &state);
@@ -433,6 +573,10 @@ bool JobSystem::execute(JobSystem::ThreadState& state) noexcept {
             job->id = invalidThreadId;
         }
         finish(job);
+        if (UTILS_UNLIKELY(isBackgroundJob)) {
+            setThreadPriority(Priority::DISPLAY);
+            mRunningBackgroundJobs.fetch_sub(1, std::memory_order_relaxed);
+        }
     }
     return job != nullptr;
 }
@@ -450,9 +594,9 @@ void JobSystem::loop(ThreadState* state) noexcept {
 
     // run our main loop...
     do {
-        if (!execute(*state)) {
+        if (!execute(*state, true)) {
             std::unique_lock<Mutex> lock(mWaiterLock);
-            while (!exitRequested() && !hasActiveJobs()) {
+            while (!exitRequested() && !hasActiveJobs() && !hasBackgroundJobs()) {
                 wait(lock);
             }
         }
@@ -466,7 +610,6 @@ void JobSystem::finish(Job* job) noexcept {
     bool notify = false;
 
     // terminate this job and notify its parent
-    Job* const storage = mJobStorageBase;
     do {
         // std::memory_order_release here is needed to synchronize with JobSystem::wait()
         // which needs to "see" all changes that happened before the job terminated.
@@ -480,7 +623,7 @@ void JobSystem::finish(Job* job) noexcept {
             if (waiters) {
                 notify = true;
             }
-            Job* const parent = job->parent == 0x7FFF ? nullptr : &storage[job->parent];
+            Job* const parent = job->parent == NO_PARENT ? nullptr : getJob(job->parent);
             decRef(job);
             job = parent;
         } else {
@@ -500,11 +643,19 @@ void JobSystem::finish(Job* job) noexcept {
 // public API...
 
 
+inline JobSystem::Job* JobSystem::getRootJob() const noexcept {
+    // Only the thread that set the root job can read it. Other threads can't synchronize
+    // with it, and their jobs (e.g. background ones) mustn't hold back the root job.
+    // memory_order_relaxed is enough, since another thread can never read its own id here.
+    return mRootJobThread.load(std::memory_order_relaxed) == std::this_thread::get_id() ?
+            mRootJob : nullptr;
+}
+
 JobSystem::Job* JobSystem::create(JobSystem::Job* parent, JobFunc func) noexcept {
-    parent = (parent == nullptr) ? mRootJob : parent;
+    parent = (parent == nullptr) ? getRootJob() : parent;
     Job* const job = allocateJob();
     if (UTILS_LIKELY(job)) {
-        size_t index = 0x7FFF;
+        size_t index = NO_PARENT;
         if (parent) {
             // add a reference to the parent to make sure it can't be terminated.
             // memory_order_relaxed is safe because no action is taken at this point
@@ -515,7 +666,7 @@ JobSystem::Job* JobSystem::create(JobSystem::Job* parent, JobFunc func) noexcept
             // can't create a child job of a terminated parent
             assert((parentJobCount & JOB_COUNT_MASK) > 0);
 
-            index = parent - mJobStorageBase;
+            index = getJobIndex(parent);
             assert(index < MAX_JOB_COUNT);
         }
         job->function = func;
@@ -563,6 +714,18 @@ void JobSystem::run(Job*& job, uint8_t id) noexcept {
     job = nullptr;
 }
 
+void JobSystem::run(Job* const* jobs, size_t count) noexcept {
+    HEAVY_SYSTRACE_CALL();
+
+    if (UTILS_UNLIKELY(!count)) {
+        return;
+    }
+
+    ThreadState& state(getState());
+
+    put(state.workQueue, jobs, count);
+}
+
 JobSystem::Job* JobSystem::runAndRetain(Job* job) noexcept {
     JobSystem::Job* retained = retain(job);
     run(job);
@@ -576,8 +739,12 @@ void JobSystem::waitAndRelease(Job*& job) noexcept {
     assert(job->refCount.load(std::memory_order_relaxed) >= 1);
 
     ThreadState& state(getState());
+
+    // Background jobs are left to the thread pool, unless there is none.
+    bool const background = mThreadCount == 0;
+
     do {
-        if (UTILS_UNLIKELY(!execute(state))) {
+        if (UTILS_UNLIKELY(!execute(state, background))) {
             // test if job has completed first, to possibly avoid taking the lock
             if (hasJobCompleted(job)) {
                 break;
@@ -611,7 +778,7 @@ void JobSystem::waitAndRelease(Job*& job) noexcept {
         }
     } while (UTILS_LIKELY(!hasJobCompleted(job) && !exitRequested()));
 
-    if (job == mRootJob) {
+    if (job == getRootJob()) {
         mRootJob = nullptr;
     }
 
@@ -624,6 +791,32 @@ void JobSystem::runAndWait(JobSystem::Job*& job) noexcept {
     waitAndRelease(job);
 }
 
+void JobSystem::runInBackground(Job*& job, uint16_t priority) noexcept {
+    HEAVY_SYSTRACE_CALL();
+    assert(job);
+    size_t const index = getJobIndex(job);
+    assert(index < MAX_JOB_COUNT);
+
+    mBackgroundLock.lock();
+    mBackgroundJobs.push_back({ priority, uint16_t(index), mBackgroundSequence++ });
+    std::push_heap(mBackgroundJobs.begin(), mBackgroundJobs.end());
+    mBackgroundJobCount.fetch_add(1, std::memory_order_relaxed);
+    mBackgroundLock.unlock();
+
+    // Not all sleeping threads run background jobs (e.g. adopted threads waiting on a job),
+    // so we can't use wakeOne(). This isn't called often.
+    wakeAll();
+
+    // after runInBackground() returns, the job is virtually invalid (it'll die on its own)
+    job = nullptr;
+}
+
+JobSystem::Job* JobSystem::runInBackgroundAndRetain(Job* job, uint16_t priority) noexcept {
+    JobSystem::Job* retained = retain(job);
+    runInBackground(job, priority);
+    return retained;
+}
+
 void JobSystem::adopt() {
     const auto tid = std::this_thread::get_id();
 
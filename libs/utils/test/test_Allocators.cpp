@@ -330,3 +330,29 @@ TEST(AllocatorTest, STLAllocator) {
 
     EXPECT_EQ(0, arena.getListener().allocations.size());
 }
+
+TEST(AllocatorTest, HeapAllocationTrap) {
+    // outside a scope, allocations aren't reported
+    HeapAllocationTrap::onHeapAllocation(16);
+
+    HeapAllocationTrap::Scope outer("outer");
+    EXPECT_EQ(0, outer.getCount());
+    {
+        HeapAllocationTrap::Scope inner("inner");
+        HeapAllocationTrap::onHeapAllocation(16);
+        EXPECT_EQ(1, inner.getCount());
+    }
+    EXPECT_EQ(1, outer.getCount());
+
+    // arenas whose allocator doesn't use the heap aren't reported
+    LinearAllocator la(nullptr, nullptr);
+    la.alloc(0);
+    EXPECT_EQ(1, outer.getCount());
+
+#ifndef NDEBUG
+    HeapAllocator allocator;
+    void* p = allocator.alloc(16);
+    allocator.free(p);
+    EXPECT_EQ(2, outer.getCount());
+#endif
+}
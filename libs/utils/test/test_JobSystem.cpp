@@ -23,7 +23,10 @@
 #include <math/mat3.h>
 
 #include <array>
+#include <chrono>
+#include <memory>
 #include <thread>
+#include <vector>
 #include <utils/Allocator.h>
 
 using namespace utils;
@@ -60,6 +63,16 @@ TEST(JobSystem, WorkStealingDequeueSingleThreaded) {
         MyJob* j = queue.steal();
         EXPECT_EQ(&jobs[i], j);
     }
+
+    // Make sure a batched push works like individual pushes
+    queue.push(4096, [&jobs](size_t i) { return &jobs[i]; });
+    EXPECT_EQ(4096, queue.getCount());
+    EXPECT_EQ(&jobs[0], queue.steal());
+    for (size_t i=0 ; i<4095 ; i++) {
+        MyJob* j = queue.pop();
+        EXPECT_EQ(&jobs[4095-i], j);
+    }
+    EXPECT_EQ(0, queue.getCount());
 }
 
 TEST(JobSystem, WorkStealingDequeue_PopSteal) {
@@ -218,6 +231,56 @@ TEST(JobSystem, JobSystemParallelChildren) {
     js.emancipate();
 }
 
+TEST(JobSystem, JobSystemBatchedChildren) {
+    JobSystem js;
+    js.adopt();
+
+    struct User {
+        std::atomic_int calls = {0};
+        void func(JobSystem&, JobSystem::Job*) {
+            calls++;
+        };
+    } j;
+
+    JobSystem::Job* root = js.createJob<User, &User::func>(nullptr, &j);
+    std::vector<JobSystem::Job*> children(1000);
+    for (auto& job : children) {
+        job = js.createJob<User, &User::func>(root, &j);
+    }
+    js.run(children.data(), children.size());
+    js.runAndWait(root);
+
+    EXPECT_EQ(1001, j.calls);
+
+    js.emancipate();
+}
+
+TEST(JobSystem, JobSystemGrowJobPool) {
+    JobSystem js;
+    js.adopt();
+
+    struct User {
+        std::atomic_int calls = {0};
+        void func(JobSystem&, JobSystem::Job*) {
+            calls++;
+        };
+    } j;
+
+    // more jobs in flight than a single chunk of the pool holds
+    JobSystem::Job* root = js.createJob<User, &User::func>(nullptr, &j);
+    std::vector<JobSystem::Job*> children(40000);
+    for (auto& job : children) {
+        job = js.createJob<User, &User::func>(root, &j);
+        ASSERT_NE(nullptr, job);
+    }
+    js.run(children.data(), children.size());
+    js.runAndWait(root);
+
+    EXPECT_EQ(40001, j.calls);
+
+    js.emancipate();
+}
+
 
 TEST(JobSystem, JobSystemSequentialChildren) {
     JobSystem js;
@@ -342,5 +405,166 @@ TEST(JobSystem, JobSystemDelegates) {
     EXPECT_EQ(4, functor.result);
 
 
+    js.emancipate();
+}
+
+TEST(JobSystem, JobSystemCancellation) {
+    JobSystem js;
+    js.adopt();
+
+    std::atomic_int calls = {0};
+    JobSystem::Job* root = js.createJob();
+    for (int i = 0; i < 256; i++) {
+        JobSystem::Job* job = js.createJob(root, [&calls](JobSystem&, JobSystem::Job*) {
+            calls++;
+        });
+        if (i & 1) {
+            JobSystem::requestCancellation(job);
+        }
+        js.run(job);
+    }
+    js.runAndWait(root);
+    EXPECT_EQ(128, calls);
+
+    // cancelled jobs still destroy their captures
+    auto shared = std::make_shared<int>(42);
+    JobSystem::Job* job = jobs::createJob(js, nullptr, [shared]() { *shared = 0; });
+    EXPECT_EQ(2, shared.use_count());
+    JobSystem::requestCancellation(job);
+    EXPECT_TRUE(JobSystem::isCancelled(job));
+    js.runAndWait(job);
+    EXPECT_EQ(42, *shared);
+    EXPECT_EQ(1, shared.use_count());
+
+    js.emancipate();
+}
+
+TEST(JobSystem, JobSystemBackground) {
+    JobSystem js(1);
+    js.adopt();
+
+    std::atomic_bool started = false;
+    std::atomic_bool go = false;
+    std::vector<int> order;
+
+    // occupy the only thread of the pool, so that the jobs below are queued
+    JobSystem::Job* root = js.createJob();
+    js.runInBackground(js.createJob(root, [&](JobSystem&, JobSystem::Job*) {
+        started = true;
+        while (!go) {
+            std::this_thread::yield();
+        }
+    }));
+    while (!started) {
+        std::this_thread::yield();
+    }
+
+    constexpr uint16_t priorities[] = { 1, 3, 3, 2, 0 };
+    for (int i = 0; i < 5; i++) {
+        js.runInBackground(js.createJob(root, [&order, i](JobSystem&, JobSystem::Job*) {
+            order.push_back(i);
+        }), priorities[i]);
+    }
+
+    // foreground jobs are not held back by background jobs
+    int result = 0;
+    js.runAndWait(js.createJob(nullptr, [&result](JobSystem&, JobSystem::Job*) {
+        result = 1;
+    }));
+    EXPECT_EQ(1, result);
+
+    go = true;
+    js.runAndWait(root);
+    EXPECT_EQ(std::vector<int>({ 1, 2, 3, 0, 4 }), order);
+
+    js.emancipate();
+}
+
+TEST(JobSystem, JobSystemBackgroundLimit) {
+    JobSystem js(4);
+    js.adopt();
+
+    std::atomic_int running = 0;
+    std::atomic_int maxRunning = 0;
+    std::atomic_bool go = false;
+
+    JobSystem::Job* root = js.createJob();
+    for (int i = 0; i < 4; i++) {
+        js.runInBackground(js.createJob(root, [&](JobSystem&, JobSystem::Job*) {
+            int const r = ++running;
+            int m = maxRunning;
+            while (r > m && !maxRunning.compare_exchange_weak(m, r)) {
+            }
+            while (!go) {
+                std::this_thread::yield();
+            }
+            running--;
+        }));
+    }
+    while (running < 2) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // half of the pool runs background jobs, the other half is available
+    EXPECT_EQ(2, running);
+    std::atomic_int calls = 0;
+    js.runAndWait(jobs::parallel_for(js, nullptr, 0, 1024,
+            [&calls](uint32_t, uint32_t count) { calls += int(count); },
+            jobs::CountSplitter<64>()));
+    EXPECT_EQ(1024, calls);
+
+    go = true;
+    js.runAndWait(root);
+    EXPECT_EQ(2, maxRunning);
+    EXPECT_EQ(0, running);
+
+    js.emancipate();
+}
+
+TEST(JobSystem, JobSystemBackgroundIgnoresRootJob) {
+    JobSystem js(2);
+    js.adopt();
+
+    std::atomic_bool created = false;
+    std::atomic_bool go = false;
+    std::atomic_int calls = 0;
+
+    // A background job that splits its work without a parent, like the IBL prefiltering does.
+    // Its jobs mustn't become children of the root job set by the main thread below.
+    JobSystem::Job* background = js.createJob(nullptr,
+            [&](JobSystem& js, JobSystem::Job*) {
+                auto* job = jobs::parallel_for(js, nullptr, 0, 1024,
+                        [&calls](uint32_t, uint32_t count) { calls += int(count); },
+                        jobs::CountSplitter<64>());
+                created = true;
+                while (!go) {
+                    std::this_thread::yield();
+                }
+                js.runAndWait(job);
+            });
+
+    // a frame, like FRenderer::renderInternal(), which must complete while the background job
+    // is still running
+    JobSystem::Job* root = js.setRootJob(js.createJob());
+    background = js.runInBackgroundAndRetain(background);
+    while (!created) {
+        std::this_thread::yield();
+    }
+    js.run(js.createJob(nullptr, [](JobSystem&, JobSystem::Job*) {}));
+    JobSystem::Job* frame = js.retain(root);
+    js.run(root);
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!JobSystem::hasJobCompleted(frame) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    EXPECT_TRUE(JobSystem::hasJobCompleted(frame));
+    js.release(frame);
+    js.setRootJob(nullptr);
+
+    go = true;
+    js.waitAndRelease(background);
+    EXPECT_EQ(1024, calls);
+
     js.emancipate();
 }
@@ -39,3 +39,4 @@ struct PerRenderableData {
 #define FILAMENT_OBJECT_MORPHING_ENABLED_BIT   0x200
 #define FILAMENT_OBJECT_CONTACT_SHADOWS_BIT    0x400
 #define FILAMENT_OBJECT_INSTANCE_BUFFER_BIT    0x800
+#define FILAMENT_OBJECT_SPARSE_MORPHING_BIT    0x1000
@@ -152,9 +152,23 @@ void skinNormalTangent(inout vec3 n, inout vec3 t, const uvec4 ids, const vec4 w
 
 #define MAX_MORPH_TARGET_BUFFER_WIDTH 2048
 
+ivec3 getMorphTexcoord(int index) {
+    return ivec3(index % MAX_MORPH_TARGET_BUFFER_WIDTH, index / MAX_MORPH_TARGET_BUFFER_WIDTH, 0);
+}
+
 void morphPosition(inout vec4 p) {
     int index = getVertexIndex() + pushConstants.morphingBufferOffset;
-    ivec3 texcoord = ivec3(index % MAX_MORPH_TARGET_BUFFER_WIDTH, index / MAX_MORPH_TARGET_BUFFER_WIDTH, 0);
+    if ((object_uniforms_flagsChannels & FILAMENT_OBJECT_SPARSE_MORPHING_BIT) != 0) {
+        // only visit the deltas of this vertex, see MorphTargetBuffer.cpp for the layout
+        vec4 header = texelFetch(sampler1_positions, getMorphTexcoord(index), 0);
+        int end = int(header.x) + int(header.y);
+        for (int i = int(header.x); i < end; ++i) {
+            vec4 delta = texelFetch(sampler1_positions, getMorphTexcoord(i), 0);
+            p.xyz += morphingUniforms.weights[int(delta.w)][0] * delta.xyz;
+        }
+        return;
+    }
+    ivec3 texcoord = getMorphTexcoord(index);
     int c = object_uniforms_morphTargetCount;
     for (int i = 0; i < c; ++i) {
         float w = morphingUniforms.weights[i][0];
@@ -168,7 +182,22 @@ void morphPosition(inout vec4 p) {
 void morphNormal(inout vec3 n) {
     vec3 baseNormal = n;
     int index = getVertexIndex() + pushConstants.morphingBufferOffset;
-    ivec3 texcoord = ivec3(index % MAX_MORPH_TARGET_BUFFER_WIDTH, index / MAX_MORPH_TARGET_BUFFER_WIDTH, 0);
+    if ((object_uniforms_flagsChannels & FILAMENT_OBJECT_SPARSE_MORPHING_BIT) != 0) {
+        vec4 header = texelFetch(sampler1_positions, getMorphTexcoord(index), 0);
+        int end = int(header.x) + int(header.y);
+        for (int i = int(header.x); i < end; ++i) {
+            ivec3 texcoord = getMorphTexcoord(i);
+            float w = morphingUniforms.weights[int(texelFetch(sampler1_positions, texcoord, 0).w)][0];
+            if (w != 0.0) {
+                ivec4 tangent = texelFetch(sampler1_tangents, texcoord, 0);
+                vec3 normal;
+                toTangentFrame(float4(tangent) * (1.0 / 32767.0), normal);
+                n += w * (normal - baseNormal);
+            }
+        }
+        return;
+    }
+    ivec3 texcoord = getMorphTexcoord(index);
     int c = object_uniforms_morphTargetCount;
     for (int i = 0; i < c; ++i) {
         float w = morphingUniforms.weights[i][0];
@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BatchCompiler.h"
+
+#include "MaterialCompiler.h"
+
+#include <filamat/MaterialBuilder.h>
+
+#include <utils/JobSystem.h>
+#include <utils/Path.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+using namespace filamat;
+using namespace utils;
+
+namespace matc {
+
+namespace {
+
+// The configuration of one material of the batch, i.e. the batch's configuration with its own
+// input and output.
+class ItemConfig final : public Config {
+public:
+    ItemConfig(Config const& batch, BatchCompiler::Item const& item)
+            : Config(batch), mBatch(batch),
+              mInput(item.input.c_str()), mOutput(item.output.c_str()) {
+    }
+
+    Output* getOutput() const noexcept override {
+        return &mOutput;
+    }
+
+    Input* getInput() const noexcept override {
+        return &mInput;
+    }
+
+    std::string toString() const noexcept override {
+        return mBatch.toString();
+    }
+
+private:
+    Config const& mBatch;
+    mutable FilesystemInput mInput;
+    mutable FilesystemOutput mOutput;
+};
+
+} // anonymous namespace
+
+bool BatchCompiler::parseManifest(std::istream& in, std::string const& baseDirectory,
+        std::string const& outputDirectory, std::string const& extension,
+        std::vector<Item>& items) {
+    std::string line;
+    for (size_t lineNumber = 1; std::getline(in, line); lineNumber++) {
+        std::istringstream fields(line);
+        std::string input;
+        std::string output;
+        std::string extra;
+        if (!(fields >> input) || input[0] == '#') {
+            continue;
+        }
+        fields >> output;
+        if (fields >> extra) {
+            std::cerr << "Invalid batch manifest line " << lineNumber << ": " << line
+                    << std::endl;
+            return false;
+        }
+        Path const inputPath = Path(baseDirectory).concat(input);
+        Path const outputPath = output.empty() ?
+                Path(outputDirectory).concat(inputPath.getNameWithoutExtension() + extension) :
+                Path(baseDirectory).concat(output);
+        items.push_back({ inputPath.getPath(), outputPath.getPath() });
+    }
+    return true;
+}
+
+bool BatchCompiler::collectItems(const Config& config, std::vector<Item>& items) const {
+    Path const batch(config.getBatchPath());
+    std::string const extension =
+            config.getOutputFormat() == Config::OutputFormat::C_HEADER ? ".inc" : ".filamat";
+    std::string const& outputDirectory = config.getOutputPath();
+
+    if (batch.isDirectory()) {
+        std::vector<Path> contents = batch.listContents();
+        std::sort(contents.begin(), contents.end(), [](Path const& lhs, Path const& rhs) {
+            return lhs.getPath() < rhs.getPath();
+        });
+        for (Path const& path : contents) {
+            if (path.isFile() && path.getExtension() == "mat") {
+                Path const output = Path(outputDirectory).concat(
+                        path.getNameWithoutExtension() + extension);
+                items.push_back({ path.getPath(), output.getPath() });
+            }
+        }
+        return true;
+    }
+
+    std::ifstream manifest(batch.getPath());
+    if (!manifest) {
+        std::cerr << "Unable to open batch manifest '" << batch.getPath() << "'" << std::endl;
+        return false;
+    }
+    return parseManifest(manifest, batch.getParent().getPath(), outputDirectory, extension,
+            items);
+}
+
+bool BatchCompiler::checkParameters(const Config& config) {
+    if (config.rawShaderMode() || config.getReflectionTarget() != Config::Metadata::NONE) {
+        std::cerr << "--raw and --reflect are not supported in batch mode." << std::endl;
+        return false;
+    }
+    if (config.printShaders()) {
+        std::cerr << "--print is not supported in batch mode." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool BatchCompiler::run(const Config& config) {
+    std::vector<Item> items;
+    if (!collectItems(config, items)) {
+        return false;
+    }
+    if (items.empty()) {
+        std::cerr << "No material to compile in '" << config.getBatchPath() << "'" << std::endl;
+        return false;
+    }
+
+    for (Item const& item : items) {
+        Path const outputDirectory = Path(item.output).getParent();
+        if (!outputDirectory.isEmpty() && !outputDirectory.exists()) {
+            outputDirectory.mkdirRecursive();
+        }
+    }
+
+    // Each driver thread compiles one material at a time and helps executing the jobs of all the
+    // materials while it waits for its own. About one material per physical core is enough to keep
+    // the worker threads busy.
+    size_t const driverCount = std::clamp<size_t>(
+            std::thread::hardware_concurrency() / 2, 1, items.size());
+
+    MaterialBuilder::init();
+    JobSystem js(0, driverCount);
+
+    std::atomic<size_t> next = 0;
+    std::atomic<size_t> failureCount = 0;
+    std::mutex reportLock;
+
+    auto drive = [&]() {
+        js.adopt();
+        MaterialCompiler compiler;
+        compiler.setJobSystem(&js);
+        for (size_t i = next++; i < items.size(); i = next++) {
+            ItemConfig const itemConfig(config, items[i]);
+            if (!compiler.compile(itemConfig)) {
+                failureCount++;
+                std::lock_guard const lock(reportLock);
+                std::cerr << "Failed to compile " << items[i].input << std::endl;
+            }
+        }
+        js.emancipate();
+    };
+
+    std::vector<std::thread> drivers;
+    drivers.reserve(driverCount - 1);
+    for (size_t i = 1; i < driverCount; i++) {
+        drivers.emplace_back(drive);
+    }
+    drive();
+    for (auto& driver : drivers) {
+        driver.join();
+    }
+
+    MaterialBuilder::shutdown();
+
+    if (failureCount) {
+        std::cerr << failureCount << " of " << items.size() << " materials failed to compile."
+                << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace matc
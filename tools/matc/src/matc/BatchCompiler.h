@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_BATCHCOMPILER_H
+#define TNT_BATCHCOMPILER_H
+
+#include "Compiler.h"
+
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace matc {
+
+/*
+ * Compiles several materials in one process.
+ *
+ * All the materials are built with the same JobSystem: a few materials are in flight at once,
+ * each on its own adopted thread, so that the shader compilation jobs of all of them share the
+ * worker threads. This keeps the workers busy while a material is parsed, written out or waits
+ * for its last few variants.
+ */
+class BatchCompiler final : public Compiler {
+public:
+    struct Item {
+        std::string input;
+        std::string output;
+    };
+
+    bool run(const Config& config) override;
+
+    bool checkParameters(const Config& config) override;
+
+    // Parses a manifest with one "<input> [output]" per line. Relative paths are resolved against
+    // baseDirectory, missing outputs are named after the input in outputDirectory.
+    static bool parseManifest(std::istream& in, std::string const& baseDirectory,
+            std::string const& outputDirectory, std::string const& extension,
+            std::vector<Item>& items);
+
+private:
+    bool collectItems(const Config& config, std::vector<Item>& items) const;
+};
+
+} // namespace matc
+
+#endif // TNT_BATCHCOMPILER_H
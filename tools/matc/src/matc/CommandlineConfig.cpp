@@ -41,6 +41,7 @@ static void usage(char* name) {
             "\n"
             "Usages:\n"
             "    MATC [options] <input-file>\n"
+            "    MATC [options] --batch <manifest-file|directory>\n"
             "\n"
             "Supported input formats:\n"
             "    Filament material definition (.mat)\n"
@@ -51,7 +52,15 @@ static void usage(char* name) {
             "   --license\n"
             "       Print copyright and license information\n\n"
             "   --output, -o\n"
-            "       Specify path to output file\n\n"
+            "       Specify path to output file, or to the output directory in batch mode\n\n"
+            "   --batch <manifest-file|directory>, -b <manifest-file|directory>\n"
+            "       Compile several materials at once, sharing the worker threads between them.\n"
+            "       The manifest lists one material per line, optionally followed by the path of\n"
+            "       its output; lines starting with '#' are ignored and relative paths are\n"
+            "       relative to the manifest. When given a directory, all the .mat files it\n"
+            "       contains are compiled. Outputs default to the material name in the output\n"
+            "       directory, and all the other options apply to every material:\n"
+            "           MATC --batch materials.txt -o out/ -a all\n\n"
             "   --platform, -p\n"
             "       Shader family to generate: desktop, mobile or all (default)\n\n"
             "   --optimize-size, -S\n"
@@ -81,6 +90,10 @@ static void usage(char* name) {
             "           MATC -PflipUV=false -PshadingModel=lit -Pname=myMat ...\n\n"
             "   --reflect, -r\n"
             "       Reflect the specified metadata as JSON: parameters\n\n"
+            "   --shader-cache <directory>, -c <directory>\n"
+            "       Cache the compiled shaders in the given directory, so that they are reused by\n"
+            "       subsequent builds when they haven't changed. The directory can be shared by\n"
+            "       concurrent builds but must be cleared when MATC is updated.\n\n"
             "   --variant-filter=<filter>, -V <filter>\n"
             "       Filter out specified comma-separated variants:\n"
             "           directionalLighting, dynamicLighting, shadowReceiver, skinning, vsm, fog,"
@@ -181,7 +194,7 @@ static void parseDefine(std::string defineString, Config::StringReplacementMap&
 }
 
 bool CommandlineConfig::parse() {
-    static constexpr const char* OPTSTR = "hLxo:f:dm:a:l:p:D:T:P:OSEr:vV:gtwF1R";
+    static constexpr const char* OPTSTR = "hLxo:f:dm:a:l:p:D:T:P:OSEr:vV:gtwF1Rc:b:";
     static const struct option OPTIONS[] = {
             { "help",                    no_argument, nullptr, 'h' },
             { "license",                 no_argument, nullptr, 'L' },
@@ -207,6 +220,8 @@ bool CommandlineConfig::parse() {
             { "raw",                     no_argument, nullptr, 'w' },
             { "no-sampler-validation",   no_argument, nullptr, 'F' },
             { "save-raw-variants",       no_argument, nullptr, 'R' },
+            { "shader-cache",      required_argument, nullptr, 'c' },
+            { "batch",             required_argument, nullptr, 'b' },
             { nullptr, 0, nullptr, 0 }  // termination of the option list
     };
 
@@ -227,6 +242,7 @@ bool CommandlineConfig::parse() {
                 break;
             case 'o':
                 mOutput = new FilesystemOutput(arg.c_str());
+                mOutputPath = arg;
                 break;
             case 'f':
                 if (arg == "blob") {
@@ -332,9 +348,20 @@ bool CommandlineConfig::parse() {
             case 'R':
                 mSaveRawVariants = true;
                 break;
+            case 'c':
+                mShaderCacheDirectory = arg;
+                break;
+            case 'b':
+                mBatchPath = arg;
+                break;
         }
     }
 
+    if (!mBatchPath.empty() && mArgc - optind > 0) {
+        std::cerr << "Input files can't be specified on the command line in batch mode."
+                << std::endl;
+        return false;
+    }
     if (mArgc - optind > 1) {
         std::cerr << "Only one input file should be specified on the command line." << std::endl;
         return false;
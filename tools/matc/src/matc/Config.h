@@ -25,6 +25,7 @@
 #include <map>
 #include <memory>
 #include <ostream>
+#include <string>
 
 #include <utils/compiler.h>
 
@@ -147,6 +148,19 @@ public:
         return mFeatureLevel;
     }
 
+    const std::string& getShaderCacheDirectory() const noexcept {
+        return mShaderCacheDirectory;
+    }
+
+    // Manifest or directory of materials to compile in batch mode, empty otherwise.
+    const std::string& getBatchPath() const noexcept {
+        return mBatchPath;
+    }
+
+    const std::string& getOutputPath() const noexcept {
+        return mOutputPath;
+    }
+
 protected:
     bool mDebug = false;
     bool mIsValid = true;
@@ -165,6 +179,9 @@ protected:
     StringReplacementMap mMaterialParameters;
     filament::UserVariantFilterMask mVariantFilter = 0;
     bool mIncludeEssl1 = true;
+    std::string mShaderCacheDirectory;
+    std::string mBatchPath;
+    std::string mOutputPath;
 };
 
 }
@@ -413,6 +413,10 @@ bool MaterialCompiler::run(const Config& config) {
         .generateDebugInfo(config.isDebug())
         .variantFilter(config.getVariantFilter() | builder.getVariantFilter());
 
+    if (!config.getShaderCacheDirectory().empty()) {
+        builder.shaderCache(config.getShaderCacheDirectory().c_str());
+    }
+
     for (const auto& define : config.getDefines()) {
         builder.shaderDefine(define.first.c_str(), define.second.c_str());
     }
@@ -422,13 +426,18 @@ bool MaterialCompiler::run(const Config& config) {
         return false;
     }
 
-    JobSystem js;
-    js.adopt();
-
     // Write builder.build() to output.
-    Package const package = builder.build(js);
+    Package package;
+    if (mJobSystem) {
+        // the calling thread must already be adopted by the shared JobSystem
+        package = builder.build(*mJobSystem);
+    } else {
+        JobSystem js;
+        js.adopt();
+        package = builder.build(js);
+        js.emancipate();
+    }
 
-    js.emancipate();
     MaterialBuilder::shutdown();
 
     if (!package.isValid()) {
@@ -26,6 +26,9 @@
 namespace filamat {
 class MaterialBuilder;
 }
+namespace utils {
+class JobSystem;
+}
 class TestMaterialCompiler;
 
 namespace matc {
@@ -39,6 +42,10 @@ public:
 
     bool checkParameters(const Config& config) override;
 
+    // Builds materials using the given JobSystem instead of a private one. The thread calling
+    // compile() must be adopted by it.
+    void setJobSystem(utils::JobSystem* jobSystem) noexcept { mJobSystem = jobSystem; }
+
 private:
     friend class ::TestMaterialCompiler;
 
@@ -83,6 +90,8 @@ private:
     using MaterialConfigProcessorJSON = bool (MaterialCompiler::*)
             (const JsonishValue*, filamat::MaterialBuilder& builder) const;
     std::unordered_map<std::string, MaterialConfigProcessorJSON> mConfigProcessorJSON;
+
+    utils::JobSystem* mJobSystem = nullptr;
 };
 
 } // namespace matc
@@ -19,11 +19,15 @@
 #include "MockConfig.h"
 #include "TestMaterialCompiler.h"
 
+#include <matc/BatchCompiler.h>
 #include <matc/MaterialCompiler.h>
 #include <matc/MaterialLexer.h>
 #include <matc/JsonishLexer.h>
 #include <matc/JsonishParser.h>
 
+#include <sstream>
+#include <vector>
+
 class MaterialLexer: public ::testing::Test {
 protected:
     MaterialLexer() = default;
@@ -283,6 +287,29 @@ TEST_F(MaterialLexer, JsonMaterialCompiler) {
   EXPECT_EQ(result, true);
 }
 
+TEST(BatchCompiler, ManifestParsing) {
+    std::istringstream manifest(R"(
+        # comments and empty lines are ignored
+
+        lit.mat
+        unlit.mat    out/unlit_material.filamat
+        /materials/sky.mat
+    )");
+    std::vector<matc::BatchCompiler::Item> items;
+    EXPECT_TRUE(matc::BatchCompiler::parseManifest(manifest, "/src", "/build", ".filamat", items));
+    ASSERT_EQ(items.size(), 3);
+    EXPECT_EQ(items[0].input, "/src/lit.mat");
+    EXPECT_EQ(items[0].output, "/build/lit.filamat");
+    EXPECT_EQ(items[1].input, "/src/unlit.mat");
+    EXPECT_EQ(items[1].output, "/src/out/unlit_material.filamat");
+    EXPECT_EQ(items[2].input, "/materials/sky.mat");
+    EXPECT_EQ(items[2].output, "/build/sky.filamat");
+
+    std::istringstream invalid("lit.mat lit.filamat extra\n");
+    items.clear();
+    EXPECT_FALSE(matc::BatchCompiler::parseManifest(invalid, "/src", "/build", ".filamat", items));
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
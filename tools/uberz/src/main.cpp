@@ -30,8 +30,6 @@
 #include <uberz/ReadableArchive.h>
 #include <uberz/WritableArchive.h>
 
-#include <zstd.h>
-
 using namespace std;
 using namespace utils;
 using namespace filament::uberz;
@@ -172,25 +170,23 @@ int main(int argc, char* argv[]) {
 
     size_t existingMaterialsCount = 0;
     ReadableArchive* existingArchive = nullptr;
+    FixedCapacityVector<uint8_t> archiveBuffer;
+    size_t metadataSize = 0;
 
     // In append mode, the first step is to consume the output file.
     if (g_appendMode) {
         const size_t archiveSize = getFileSize(g_outputFile.c_str());
-        FixedCapacityVector<uint8_t> archiveBuffer(archiveSize);
+        archiveBuffer = FixedCapacityVector<uint8_t>(archiveSize);
         uint8_t* archiveData = archiveBuffer.data();
         std::ifstream in(g_outputFile.c_str(), std::ifstream::in | std::ifstream::binary);
         if (!in.read((char*) archiveData, archiveSize)) {
             cerr << "Unable to consume " << g_outputFile << endl;
             exit(1);
         }
-        const uint64_t decompSize = ZSTD_getFrameContentSize(archiveData, archiveSize);
-        if (decompSize == ZSTD_CONTENTSIZE_UNKNOWN || decompSize == ZSTD_CONTENTSIZE_ERROR) {
+        existingArchive = decompressArchiveMetadata(archiveData, archiveSize, &metadataSize);
+        if (!existingArchive) {
             PANIC_POSTCONDITION("Decompression error.");
         }
-        uint64_t* basePointer = (uint64_t*) utils::aligned_alloc(decompSize, 8);
-        ZSTD_decompress(basePointer, decompSize, archiveData, archiveSize);
-        existingArchive = (ReadableArchive*) basePointer;
-        convertOffsetsToPointers(existingArchive);
         existingMaterialsCount = existingArchive->specsCount;
     }
 
@@ -203,7 +199,17 @@ int main(int argc, char* argv[]) {
             // a made-up string (it is only used for error messages).
             std::string materialName = "mat" + to_string(specIndex);
             const ArchiveSpec& spec = existingArchive->specs[specIndex];
-            outputArchive.addMaterial(materialName.c_str(), spec.package, spec.packageByteCount);
+            if (isSeekable(*existingArchive)) {
+                FixedCapacityVector<uint8_t> package(spec.packageByteCount);
+                if (!decompressPackage(spec, archiveBuffer.data() + metadataSize,
+                        archiveBuffer.size() - metadataSize, package.data())) {
+                    PANIC_POSTCONDITION("Decompression error.");
+                }
+                outputArchive.addMaterial(materialName.c_str(), package.data(), package.size());
+            } else {
+                outputArchive.addMaterial(materialName.c_str(), spec.package,
+                        spec.packageByteCount);
+            }
             outputArchive.setShadingModel(spec.shadingModel);
             outputArchive.setBlendingModel(spec.blendingMode);
             for (uint16_t flagIndex = 0; flagIndex < spec.flagsCount; ++flagIndex) {